@@ -465,6 +465,22 @@ public:
               realT secZ ///< [in] is the secant of the zenith distance.
             );
    
+   ///Calculate all of the Fresnel propagation and chromaticity factors at a spatial frequency in one pass over the layers.
+   /** This gives the same results as calling \ref X, \ref Y, \ref dX, \ref dY, and \ref X_Z separately,
+     * but shares the trigonometry between them.
+     */
+   void chromaticTerms( realT & X,     ///< [out] the value of X(k, lam_sci, secZ)
+                        realT & Y,     ///< [out] the value of Y(k, lam_sci, secZ)
+                        realT & dX,    ///< [out] the value of dX(k, lam_sci, lam_wfs)
+                        realT & dY,    ///< [out] the value of dY(k, lam_sci, lam_wfs)
+                        realT & X_wfs, ///< [out] the value of X(k, lam_wfs, secZ)
+                        realT & XZ,    ///< [out] the value of X_Z(k, lam_wfs, lam_sci, secZ), the dispersive anisoplanatism of the WFS w.r.t. the science wavelength
+                        realT k,       ///< [in] the spatial frequency, in inverse meters 
+                        realT lam_sci, ///< [in] is the science observation wavelength.
+                        realT lam_wfs, ///< [in] is the wavefront sensor wavelength.
+                        realT secZ     ///< [in] is the secant of the zenith distance.
+                      );
+   
    ///Calculate the full-width at half-maximum of a seeing limited image for this atmosphere for a small telescope (ignoring L_0)
    /** Calculate the FWHM of a seeing limited image with the current parameters according to Floyd et al. (2010) \cite floyd_2010
      \f[
@@ -1073,6 +1089,58 @@ realT aoAtmosphere<realT>::X_Z(realT k, realT lambda_i, realT lambda_wfs, realT
    return 4*c;
 }
 
+template<typename realT>
+void aoAtmosphere<realT>::chromaticTerms( realT & X,
+                                          realT & Y,
+                                          realT & dX,
+                                          realT & dY,
+                                          realT & X_wfs,
+                                          realT & XZ,
+                                          realT k,
+                                          realT lam_sci,
+                                          realT lam_wfs,
+                                          realT secZ
+                                        )
+{
+   X = 0;
+   Y = 0;
+   dX = 0;
+   dY = 0;
+   X_wfs = 0;
+   XZ = 0;
+   
+   realT sinZ = sqrt(1.0 - pow(1.0/secZ,2));
+   realT tanZ = sinZ*secZ;
+   realT x0 = (n_air(lam_sci) - n_air(lam_wfs)) * m_H*tanZ*secZ;
+   
+   realT pkk = math::pi<realT>()*k*k;
+   
+   for(size_t i = 0; i < m_layer_Cn2.size(); ++i)
+   {
+      realT Cn2 = m_layer_Cn2[i];
+      realT z = m_layer_z[i];
+      
+      realT cs = cos(pkk*lam_sci*z*secZ);
+      realT ss = sin(pkk*lam_sci*z*secZ);
+      X += Cn2*cs*cs;
+      Y += Cn2*ss*ss;
+      
+      realT cw = cos(pkk*lam_wfs*z*secZ);
+      X_wfs += Cn2*cw*cw;
+      
+      realT dc = cos(pkk*lam_sci*z) - cos(pkk*lam_wfs*z);
+      realT ds = sin(pkk*lam_sci*z) - sin(pkk*lam_wfs*z);
+      dX += Cn2*dc*dc;
+      dY += Cn2*ds*ds;
+      
+      realT x = x0*(1-exp((z+m_h_obs)/m_H));
+      realT sx = sin(math::pi<realT>()*x*k);
+      XZ += Cn2*cw*cw*sx*sx;
+   }
+   
+   XZ *= 4;
+}
+
 template<typename realT>
 realT aoAtmosphere<realT>::fwhm0(realT lam_sci)
 {
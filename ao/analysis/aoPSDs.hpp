@@ -28,6 +28,7 @@
 #define aoPSDs_hpp
 
 #include <string>
+#include <vector>
 
 #include "../../mxError.hpp"
 #include "../../math/constants.hpp"
@@ -89,6 +90,14 @@ protected:
 
    const char * m_id = "von Karman";
    
+   bool m_useTable {false}; ///< Flag controlling whether the piston and tip/tilt filter is interpolated from a table.  Default is false.
+   realT m_tableTol {1e-6}; ///< The maximum relative error of the tabulated filter.  Default is 1e-6.
+   
+   std::vector<realT> m_filterTable; ///< The tabulated filter, \f$ 1 - P_{piston}(x) - P_{tiptilt}(x) \f$ with \f$ x = \pi k D \f$.
+   realT m_table_x0 {0};   ///< The value of x below which the filter is calculated directly.
+   realT m_table_dx {0};   ///< The spacing of the table in x.
+   realT m_table_xmax {0}; ///< The maximum value of x in the table, above which the filter is 1.
+   
    //realT m_alpha {eleven_thirds<realT>()}; ///< The power-law index, 11/3 for Kolmogorov
    
 public:   
@@ -159,6 +168,29 @@ public:
      */
    void D(realT nd /**< [in] the new diameter in m */);
    
+   ///Get the value of m_useTable
+   /**
+     * \returns the current value of m_useTable
+     */ 
+   bool useTable();
+   
+   ///Set the value of m_useTable
+   /** If true, the table is calculated immediately, and is recalculated whenever the piston or tip/tilt flags or the tolerance are changed. 
+     * The table does not depend on the atmosphere or on D.
+     */ 
+   void useTable( bool ut /**< [in] the new value of m_useTable */);
+   
+   ///Get the value of m_tableTol
+   /**
+     * \returns the current value of m_tableTol
+     */ 
+   realT tableTol();
+   
+   ///Set the value of m_tableTol
+   /**
+     */ 
+   void tableTol( realT tt /**< [in] the new value of m_tableTol */);
+   
    ///Get the value of the PSD index alpha.
    /**
      * \returns the current value of m_alpha, the PSD index.
@@ -182,6 +214,19 @@ public:
                      realT sec_zeta    ///< [in] is the secant of the zenith distance.
                    );
    
+   ///Get the value of the PSD at a vector of spatial frequencies and a zenith distance.
+   /** The parameters which do not depend on k are only calculated once.
+     * 
+     * \returns 0 on success
+     * \returns -1 if an error occurs.
+     */ 
+   template< class psdParamsT >
+   int operator()( std::vector<realT> & psd,     ///< [out] the von Karman PSD at each spatial frequency.  Resized to match k.
+                   psdParamsT & par,             ///< [in] gives the PSD parameters.
+                   const std::vector<realT> & k, ///< [in] the spatial frequencies in m^-1.
+                   realT sec_zeta                ///< [in] is the secant of the zenith distance.
+                 );
+   
    /// Get the value of the PSD at spatial frequency k and wavelength lambda, and a zenith distance, with a WFS at a different wavelength
    /**
      * 
@@ -208,6 +253,28 @@ public:
    template<typename iosT>
    iosT & dumpPSD(iosT & ios);
 
+protected:
+   
+   ///Calculate the piston and tip/tilt filter directly.
+   /**
+     * \returns \f$ 1 - P_{piston}(x) - P_{tiptilt}(x) \f$ according to the flags.
+     */
+   realT filter( realT x /**< [in] the argument, \f$ x = \pi k D \f$ */);
+   
+   ///Calculate the piston and tip/tilt filter, interpolating from the table if it is in use.
+   /**
+     * \returns \f$ 1 - P_{piston}(x) - P_{tiptilt}(x) \f$ according to the flags.
+     */
+   realT filterInterp( realT x /**< [in] the argument, \f$ x = \pi k D \f$ */);
+   
+   ///Calculate the filter table.
+   /** The table is uniformly spaced in x, and is interpolated with 4-point Lagrange polynomials. The spacing is halved until the error 
+     * at the midpoint of every interval is less than m_tableTol relative to the filter, and above m_table_xmax the piston and tip/tilt terms are 
+     * bounded by m_tableTol using the asymptotic envelope of the Bessel functions.  Below \f$ x = 1 \f$, where the filter goes to 0 and 
+     * the relative error of the interpolation would grow, the filter is calculated directly.
+     */
+   void makeTable();
+   
 };
 
 template< typename realT>
@@ -237,6 +304,7 @@ template< typename realT>
 void vonKarmanSpectrum<realT>::subPiston( bool sp /* [in] is the new value of m_subPiston */)
 {
    m_subPiston = sp;
+   if(m_useTable) makeTable();
 }
 
 template< typename realT>
@@ -249,6 +317,7 @@ template< typename realT>
 void vonKarmanSpectrum<realT>::subTipTilt(bool st /* [in] the new value of m_subTipTilt */)
 {
    m_subTipTilt = st;
+   if(m_useTable) makeTable();
 }
 
 template< typename realT>
@@ -282,6 +351,35 @@ int vonKarmanSpectrum<realT>::component( int cc /* [in] the new value of m_compo
    return 0;         
 }
 
+template< typename realT>
+bool vonKarmanSpectrum<realT>::useTable()
+{
+   return m_useTable;
+}
+
+template< typename realT>
+void vonKarmanSpectrum<realT>::useTable( bool ut )
+{
+   m_useTable = ut;
+   
+   if(m_useTable) makeTable();
+   else m_filterTable.clear();
+}
+
+template< typename realT>
+realT vonKarmanSpectrum<realT>::tableTol()
+{
+   return m_tableTol;
+}
+
+template< typename realT>
+void vonKarmanSpectrum<realT>::tableTol( realT tt )
+{
+   m_tableTol = tt;
+   
+   if(m_useTable) makeTable();
+}
+
 template< typename realT>
 realT vonKarmanSpectrum<realT>::D()
 {
@@ -315,7 +413,7 @@ realT vonKarmanSpectrum<realT>::operator()( psdParamsT & par, // [in] gives the
       return 0;
    }
    
-   realT Ppiston, Ptiptilt;
+   realT filt = 1;
 
    if( (m_subPiston || m_subTipTilt) )
    {
@@ -324,25 +422,56 @@ realT vonKarmanSpectrum<realT>::operator()( psdParamsT & par, // [in] gives the
          mxError("aoAtmosphere", MXE_PARAMNOTSET, "Diameter D not set for Piston and/or TT subtraction.");
          return -1;
       }
-      if(m_subPiston)
-      {
-         Ppiston = pow(2*math::func::jinc(math::pi<realT>()*k*m_D), 2);
-      }
-      else Ppiston = 0;
+      
+      filt = filterInterp(math::pi<realT>()*k*m_D);
+   }
+   
+   return par.beta()*pow(k*k+k02, -1*par.alpha()/2) * filt*sec_zeta;
+}
 
-      if(m_subTipTilt)
-      {
-         Ptiptilt = pow(4*math::func::jincN(2, math::pi<realT>()*k*m_D), 2);
-      }
-      else Ptiptilt = 0;
+template< typename realT>
+template< class psdParamsT >
+int vonKarmanSpectrum<realT>::operator()( std::vector<realT> & psd,
+                                          psdParamsT & par,
+                                          const std::vector<realT> & k,
+                                          realT sec_zeta
+                                        )
+{
+   psd.resize(k.size());
+   
+   realT k02;
+   
+   if(par.L_0(0) > 0)
+   {
+      k02 = (1)/(par.L_0(0)*par.L_0(0));
    }
-   else
+   else k02 = 0;
+
+   if( (m_subPiston || m_subTipTilt) && m_D == 0)
+   {
+      mxError("aoAtmosphere", MXE_PARAMNOTSET, "Diameter D not set for Piston and/or TT subtraction.");
+      return -1;
+   }
+   
+   realT beta = par.beta()*sec_zeta;
+   realT alpha2 = -1*par.alpha()/2;
+   realT piD = math::pi<realT>()*m_D;
+   
+   for(size_t n = 0; n < k.size(); ++n)
    {
-      Ppiston = 0;
-      Ptiptilt = 0;
+      if(k02 == 0 && k[n] == 0)
+      {
+         psd[n] = 0;
+         continue;
+      }
+      
+      realT filt = 1;
+      if( (m_subPiston || m_subTipTilt) ) filt = filterInterp(piD*k[n]);
+      
+      psd[n] = beta*pow(k[n]*k[n]+k02, alpha2) * filt;
    }
    
-   return par.beta()*pow(k*k+k02, -1*par.alpha()/2) * (1.0-Ppiston - Ptiptilt)*sec_zeta;
+   return 0;
 }
 
 template< typename realT>
@@ -401,6 +530,102 @@ realT vonKarmanSpectrum<realT>::fittingError(aoAtmosphere<realT> &atm, realT d)
    return (math::pi<realT>() * math::six_fifths<realT>())* constants::a_PSD<realT>()/ pow(atm.r_0(), math::five_thirds<realT>()) * (1./pow( pow(0.5/d,2) + k0, math::five_sixths<realT>()));
 }
 
+template< typename realT>
+realT vonKarmanSpectrum<realT>::filter( realT x )
+{
+   realT Ppiston, Ptiptilt;
+   
+   if(m_subPiston)
+   {
+      Ppiston = pow(2*math::func::jinc(x), 2);
+   }
+   else Ppiston = 0;
+
+   if(m_subTipTilt)
+   {
+      Ptiptilt = pow(4*math::func::jincN(2, x), 2);
+   }
+   else Ptiptilt = 0;
+   
+   return 1.0 - Ppiston - Ptiptilt;
+}
+
+template< typename realT>
+realT vonKarmanSpectrum<realT>::filterInterp( realT x )
+{
+   if(!m_useTable || m_filterTable.size() == 0) return filter(x);
+   
+   x = fabs(x);
+   
+   if(x >= m_table_xmax) return 1;
+   if(x < m_table_x0) return filter(x);
+   
+   realT xi = x/m_table_dx - 1;
+   size_t i = xi;
+   realT t = xi - i;
+   
+   //f[1] is the point at or just below x
+   const realT * f = m_filterTable.data() + i;
+   
+   return -t*(t-1)*(t-2)/6 * f[0] + (t+1)*(t-1)*(t-2)/2 * f[1] - (t+1)*t*(t-2)/2 * f[2] + (t+1)*t*(t-1)/6 * f[3];
+}
+
+template< typename realT>
+void vonKarmanSpectrum<realT>::makeTable()
+{
+   m_filterTable.clear();
+   
+   if(!m_subPiston && !m_subTipTilt) return;
+   
+   //Above xmax the Bessel functions are bounded by their asymptotic envelope, sqrt(2/(pi x)), which we double for margin.
+   realT C = 0;
+   if(m_subPiston) C += 4*4*2/math::pi<realT>();
+   if(m_subTipTilt) C += 16*4*2/math::pi<realT>();
+   
+   realT xmax = pow(C/m_tableTol, static_cast<realT>(1)/3);
+   
+   realT dx = 0.1;
+   
+   std::vector<realT> table;
+   
+   for(int r = 0; r < 20; ++r)
+   {
+      size_t N = xmax/dx + 4;
+      
+      table.resize(N);
+      for(size_t n = 0; n < N; ++n)
+      {
+         table[n] = filter(dx*n);
+      }
+      
+      m_filterTable.swap(table);
+      m_table_x0 = 1 + dx; //the filter goes to 0 below here, so it is calculated directly
+      m_table_dx = dx;
+      m_table_xmax = xmax;
+      
+      bool good = true;
+      for(size_t n = m_table_x0/dx; n < N - 3; ++n)
+      {
+         realT x = dx*(n + 0.5);
+         realT f = filter(x);
+         
+         if( fabs(filterInterp(x) - f) > m_tableTol*f )
+         {
+            good = false;
+            break;
+         }
+      }
+      
+      if(good) return;
+      
+      dx /= 2;
+   }
+   
+   mxError("vonKarmanSpectrum::makeTable", MXE_PARAMNOTSET, "Could not meet tolerance, not using table.");
+   
+   m_filterTable.clear();
+}
+
 template< typename realT>
 template<typename iosT>
 iosT & vonKarmanSpectrum<realT>::dumpPSD(iosT & ios)
@@ -412,6 +637,8 @@ iosT & vonKarmanSpectrum<realT>::dumpPSD(iosT & ios)
    ios << "#    subTipTilt = " << std::boolalpha << m_subTipTilt  << '\n';
    ios << "#    Scintillation = " << std::boolalpha << m_scintillation << '\n';
    ios << "#    Component = " << PSDComponent::compName(m_component) << '\n';
+   ios << "#    useTable = " << std::boolalpha << m_useTable << '\n';
+   if(m_useTable) ios << "#    tableTol = " << m_tableTol << '\n';
    return ios;
 }
    
@@ -690,6 +690,20 @@ public:
                         realT n  ///< [in] is the spatial frequency index in v
                       );
 
+protected:
+   ///Worker function for the optimum exposure time.
+   /** Solves the quartic for the optimum exposure time once the spatial frequency dependent terms are known.
+     * 
+     * \returns the optimum expsoure time.
+     */
+   realT optimumTauWFS_( realT Atmp,   ///< [in] the time delay coefficient, \f$ 2\lambda_0^2 \mathcal{P}(k)/D^2 X(k,\lambda_{wfs}) (2\pi v k)^2 \f$
+                         realT beta_p, ///< [in] the WFS sensitivity at this spatial frequency
+                         realT F,      ///< [in] the photon flux from the guide star
+                         int bbin      ///< [in] the binning factor, or WFS mode index
+                       );
+   
+public:
+
    ///Calculate the optimum actuator spacing.
    /** Finds the value of m_d_opt where the fitting error is less than than the combined time delay and measurement error.
      *
@@ -726,6 +740,53 @@ protected:
      */
    void calcStrehl();
    
+   /** \name Spatial Frequency Grid
+     * The terms needed by the error budget and the contrast maps are calculated once per spatial frequency and stored
+     * in arrays over a rectangular grid of (m,n), so that each term is a simple combination of them.
+     * @{
+     */
+   
+   int m_grid_mMin {0}; ///< The minimum value of m in the grid
+   int m_grid_nMin {0}; ///< The minimum value of n in the grid
+   int m_grid_nm {0};   ///< The number of m values in the grid
+   int m_grid_nn {0};   ///< The number of n values in the grid
+   
+   std::vector<char> m_grid_ctrl; ///< Flag for whether each point is in the controlled region
+   std::vector<realT> m_grid_P;   ///< The PSD, \f$ \mathcal{P}(k)/D^2 (\lambda_0/\lambda_{sci})^2 \f$
+   std::vector<realT> m_grid_X;   ///< The value of X(k, lam_sci, secZ)
+   std::vector<realT> m_grid_Y;   ///< The value of Y(k, lam_sci, secZ)
+   std::vector<realT> m_grid_dX;  ///< The value of dX(k, lam_sci, lam_wfs)
+   std::vector<realT> m_grid_dY;  ///< The value of dY(k, lam_sci, lam_wfs)
+   std::vector<realT> m_grid_XZ;  ///< The value of X_Z(k, lam_wfs, lam_sci, secZ)
+   std::vector<realT> m_grid_meas; ///< The measurement error 
+   std::vector<realT> m_grid_td;  ///< The time delay error
+   
+   ///Calculate the spatial frequency grid.
+   /** The chromatic terms, measurement error, and time delay error are only calculated for points in the controlled region,
+     * the PSD is calculated for all points.  The controlled region is the same as that used by \ref C_.  The points are
+     * calculated in parallel.
+     */
+   void calcGrid( int mMin,      ///< [in] the minimum value of m
+                  int mMax,      ///< [in] the maximum value of m
+                  int nMin,      ///< [in] the minimum value of n
+                  int nMax,      ///< [in] the maximum value of n
+                  bool forMaps,  ///< [in] if true, the controlled region is the whole grid when d_opt is larger than D/2, as in the contrast maps.  Otherwise the controlled region is empty in that case. 
+                  bool doMeas    ///< [in] if true the measurement and time delay errors are calculated.
+                );
+   
+   ///Get the index of a point in the grid
+   /**
+     * \returns the linear index of (m,n) in the grid arrays
+     */
+   size_t gridIdx( int m, ///< [in] the spatial frequency index in u
+                   int n  ///< [in] the spatial frequency index in v
+                 )
+   {
+      return (m - m_grid_mMin)*m_grid_nn + (n - m_grid_nMin);
+   }
+   
+   ///@}
+   
 public:
    ///Get the current value of the total WFE variance.
    /** If no changes, merely returns m_wfeVar.  Calls calcStrehl if there are changes.
@@ -787,6 +848,20 @@ public:
                CfuncT Cfunc ///< [in] the raw contrast function to use for filling in the map. 
              );
    
+   ///Calculate several of the contrast maps in one pass.
+   /** The spatial frequency dependent terms are calculated once for all of the maps, in parallel, and
+     * then combined for each requested term.  The results are the same as the individual \ref C0Map through \ref C7Map
+     * functions, which use this.  The maps must all be allocated to the same size.
+     * 
+     * \note this is the raw PSD, it must be convolved with the PSF for the true contrast.
+     * 
+     * \tparam imageT is an Eigen-like image
+     */ 
+   template<typename imageT>
+   void CMaps( std::vector<imageT *> & maps,  ///< [in/out] pointers to the map images to be filled in, all of the same size.
+               const std::vector<int> & terms ///< [in] the contrast term for each map, 0 for C0 through 7 for C7.
+             );
+   
    ///Calculate the residual variance due to uncorrected phase at a spatial frequency.
    /** Used to calculate contrast \ref C0().
      * 
@@ -1982,6 +2057,26 @@ realT aoSystem<realT, inputSpectT, iosT>::optimumTauWFS( realT m,
       return -1;
    }
 
+   realT k = sqrt(m*m + n*n)/m_D;
+   
+   realT F = Fg();
+
+   if (m_wfsBeta == 0) mxThrowException(err::paramnotset, "aoSystem::beta_p", "The WFS is not assigned."); 
+      
+   realT beta_p = m_wfsBeta->beta_p(m,n,m_D, dact, atm.r_0(m_lam_wfs));
+
+   realT Atmp = 2*pow(atm.lam_0(),2)*psd(atm, k,  m_secZeta)/pow(m_D,2)*(atm.X(k, m_lam_wfs, m_secZeta))*pow(math::two_pi<realT>()*atm.v_wind()*k,2);
+   
+   return optimumTauWFS_(Atmp, beta_p, F, bbin);
+}
+
+template<typename realT, class inputSpectT, typename iosT>
+realT aoSystem<realT, inputSpectT, iosT>::optimumTauWFS_( realT Atmp, 
+                                                          realT beta_p,
+                                                          realT F,
+                                                          int bbin
+                                                        )
+{
    double binfact = 1.0;
    int binidx = 0; //index into WFS configurations
    if( m_bin_npix )
@@ -1996,18 +2091,9 @@ realT aoSystem<realT, inputSpectT, iosT>::optimumTauWFS( realT m,
       }
    }
    
-   realT k = sqrt(m*m + n*n)/m_D;
-   
-   realT F = Fg();
-
-   if (m_wfsBeta == 0) mxThrowException(err::paramnotset, "aoSystem::beta_p", "The WFS is not assigned."); 
-      
-   realT beta_p = m_wfsBeta->beta_p(m,n,m_D, dact, atm.r_0(m_lam_wfs));
-
    //Set up for root finding:
    realT a, b, c, d, e;
    
-   realT Atmp = 2*pow(atm.lam_0(),2)*psd(atm, k,  m_secZeta)/pow(m_D,2)*(atm.X(k, m_lam_wfs, m_secZeta))*pow(math::two_pi<realT>()*atm.v_wind()*k,2);
    realT Dtmp = pow(m_lam_wfs*beta_p/F,2);
    
    a = Atmp;
@@ -2032,8 +2118,6 @@ realT aoSystem<realT, inputSpectT, iosT>::optimumTauWFS( realT m,
    if(tauopt < m_minTauWFS[binidx]) tauopt = m_minTauWFS[binidx];
    
    return tauopt;
-   
-   
 }
 
 template<typename realT, class inputSpectT, typename iosT>
@@ -2164,13 +2248,52 @@ realT aoSystem<realT, inputSpectT, iosT>::ncpError()
 template<typename realT, class inputSpectT, typename iosT>
 void aoSystem<realT, inputSpectT, iosT>::calcStrehl()
 {  
-   m_wfeMeasurement = measurementError();
-   m_wfeTimeDelay = timeDelayError();
-   m_wfeFitting = fittingError();
+   int mn_max = floor(0.5*m_D/d_opt());
+   int mn_grid = std::max(mn_max, m_fit_mn_max);
+   
+   calcGrid(-mn_grid, mn_grid, -mn_grid, mn_grid, false, (mn_max > 0));
+   
+   realT meas = 0, td = 0, fit = 0, chromScint = 0, chromIndex = 0, aniso = 0;
+   
+   #pragma omp parallel for reduction(+:meas,td,fit,chromScint,chromIndex,aniso)
+   for(int m = -mn_grid; m <= mn_grid; ++m)
+   {
+      for(int n = -mn_grid; n <= mn_grid; ++n)
+      {
+         if(n == 0 && m == 0) continue;
+         
+         size_t idx = gridIdx(m,n);
+         
+         if( abs(m) <= m_fit_mn_max && abs(n) <= m_fit_mn_max )
+         {
+            bool inside;
+            if(m_circularLimit) inside = ( m*m + n*n <= mn_max*mn_max);
+            else inside = ( abs(m) <= mn_max && abs(n) <= mn_max);
+            
+            if(!inside) fit += m_grid_P[idx];
+         }
+         
+         if( !m_grid_ctrl[idx] ) continue;
+         
+         if( n < mn_max ) meas += m_grid_meas[idx]; //This matches the historical limits of measurementError()
+         td += m_grid_td[idx];
+         
+         chromScint += m_grid_P[idx]*m_grid_dX[idx];
+         chromIndex += m_grid_P[idx]*m_grid_X[idx];
+         aniso += m_grid_P[idx]*m_grid_XZ[idx];
+      }
+   }
    
-   m_wfeChromScintOPD = chromScintOPDError();
-   m_wfeChromIndex = chromIndexError();
-   m_wfeAnisoOPD = dispAnisoOPDError();
+   realT ni = atm.n_air(m_lam_sci);
+   realT nw = atm.n_air(m_lam_wfs);
+   
+   m_wfeMeasurement = meas;
+   m_wfeTimeDelay = td;
+   m_wfeFitting = fit;
+   
+   m_wfeChromScintOPD = chromScint;
+   m_wfeChromIndex = chromIndex * pow( (ni-nw)/(ni-1), 2);
+   m_wfeAnisoOPD = aniso;
    
    m_wfeNCP = ncpError();
    
@@ -2181,6 +2304,122 @@ void aoSystem<realT, inputSpectT, iosT>::calcStrehl()
    m_specsChanged = false;
 }
 
+template<typename realT, class inputSpectT, typename iosT>
+void aoSystem<realT, inputSpectT, iosT>::calcGrid( int mMin,
+                                                   int mMax,
+                                                   int nMin,
+                                                   int nMax,
+                                                   bool forMaps,
+                                                   bool doMeas
+                                                 )
+{
+   m_grid_mMin = mMin;
+   m_grid_nMin = nMin;
+   m_grid_nm = mMax - mMin + 1;
+   m_grid_nn = nMax - nMin + 1;
+   
+   size_t N = m_grid_nm * m_grid_nn;
+   
+   m_grid_ctrl.assign(N, 0);
+   m_grid_P.assign(N, 0);
+   m_grid_X.assign(N, 0);
+   m_grid_Y.assign(N, 0);
+   m_grid_dX.assign(N, 0);
+   m_grid_dY.assign(N, 0);
+   m_grid_XZ.assign(N, 0);
+   m_grid_meas.assign(N, 0);
+   m_grid_td.assign(N, 0);
+   
+   //Update all of the lazily calculated values before going parallel
+   realT d = d_opt();
+   int b = m_bin_opt;
+   int mn_max = m_D/(2.*d);
+   
+   realT F = 0;
+   realT r0_wfs = 0;
+   bool tauErr = false;
+   
+   if(doMeas)
+   {
+      if (m_wfsBeta == 0) mxThrowException(err::paramnotset, "aoSystem::beta_p", "The WFS is not assigned."); 
+      
+      F = Fg();
+      r0_wfs = atm.r_0(m_lam_wfs);
+      
+      if(m_optTau)
+      {
+         if(m_D == 0)
+         {
+            mxError("aoSystem::calcGrid", MXE_PARAMNOTSET, "Diameter (D) not set.");
+            tauErr = true;
+         }
+         
+         if(m_F0 == 0)
+         {
+            mxError("aoSystem::calcGrid", MXE_PARAMNOTSET, "0-mag photon flux (F0) not set.");
+            tauErr = true;
+         }
+      }
+   }
+   
+   realT twopiv = math::two_pi<realT>()*atm.v_wind();
+   realT lam0 = atm.lam_0();
+   realT D2 = pow(m_D,2);
+   realT lamfac = pow(lam0/m_lam_sci, 2);
+   realT measfac = pow(m_lam_wfs/m_lam_sci, 2);
+   
+   #pragma omp parallel for
+   for(int i = 0; i < m_grid_nm; ++i)
+   {
+      int m = m_grid_mMin + i;
+      
+      for(int j = 0; j < m_grid_nn; ++j)
+      {
+         int n = m_grid_nMin + j;
+         
+         size_t idx = i*m_grid_nn + j;
+         
+         realT k = sqrt(m*m + n*n)/m_D;
+         
+         realT psdk = psd(atm, k, m_secZeta);
+         m_grid_P[idx] = psdk/D2 * lamfac;
+         
+         bool outside;
+         if(m_circularLimit) outside = ( m*m + n*n > mn_max*mn_max);
+         else outside = ( abs(m) > mn_max || abs(n) > mn_max);
+         
+         bool ctrl;
+         if(forMaps) ctrl = !(mn_max > 0 && outside);
+         else ctrl = (mn_max > 0 && !outside);
+         
+         m_grid_ctrl[idx] = ctrl;
+         
+         if(forMaps || ctrl)
+         {
+            realT X_wfs;
+            atm.chromaticTerms( m_grid_X[idx], m_grid_Y[idx], m_grid_dX[idx], m_grid_dY[idx], X_wfs, m_grid_XZ[idx], 
+                                k, m_lam_sci, m_lam_wfs, m_secZeta);
+            
+            if(!ctrl || !doMeas || (m == 0 && n == 0)) continue;
+            
+            realT beta_p = m_wfsBeta->beta_p(m, n, m_D, d, r0_wfs);
+            realT vk2 = pow(twopiv*k,2);
+            
+            realT tau_wfs;
+            if(m_optTau)
+            {
+               if(tauErr) tau_wfs = -1;
+               else tau_wfs = optimumTauWFS_(2*pow(lam0,2)*psdk/D2*X_wfs*vk2, beta_p, F, b);
+            }
+            else tau_wfs = m_tauWFS;
+            
+            m_grid_meas[idx] = pow(beta_p,2)/signal2Noise2(tau_wfs, d, b)*measfac;
+            m_grid_td[idx] = m_grid_P[idx] * sqrt(m_grid_X[idx]) * vk2 * pow(tau_wfs + m_deltaTau,2);
+         }
+      }
+   }
+}
+
 template<typename realT, class inputSpectT, typename iosT>
 realT aoSystem<realT, inputSpectT, iosT>::wfeVar()
 {
@@ -2278,6 +2517,95 @@ void aoSystem<realT, inputSpectT, iosT>::C_Map( imageT & im,
    }
 }
 
+template<typename realT, class inputSpectT, typename iosT>
+template<typename imageT>
+void aoSystem<realT, inputSpectT, iosT>::CMaps( std::vector<imageT *> & maps,
+                                                const std::vector<int> & terms
+                                              )
+{
+   if(maps.size() == 0) return;
+   
+   if(maps.size() != terms.size())
+   {
+      mxThrowException(err::sizeerr, "aoSystem::CMaps", "maps and terms must be the same size");
+   }
+   
+   bool doMeas = false;
+   for(size_t t = 0; t < terms.size(); ++t)
+   {
+      if(terms[t] < 0 || terms[t] > 7) mxThrowException(err::invalidarg, "aoSystem::CMaps", "terms must be 0 through 7");
+      if(terms[t] == 2) doMeas = true;
+   }
+   
+   int dim1 = maps[0]->rows();
+   int dim2 = maps[0]->cols();
+
+   int mc = 0.5*(dim1-1);
+   int nc = 0.5*(dim2-1);
+   
+   realT S = strehl();
+   
+   realT ni = atm.n_air(m_lam_sci);
+   realT nw = atm.n_air(m_lam_wfs);
+   realT fac6 = pow( (ni-nw)/(ni-1), 2);
+   
+   calcGrid(-mc, dim1-1-mc, -nc, dim2-1-nc, true, doMeas);
+   
+   #pragma omp parallel for
+   for(int i=0; i< dim1; ++i)
+   {
+      int m = i - mc;
+      
+      for(int j=0; j< dim2; ++j)
+      {
+         int n = j - nc;
+         
+         size_t idx = gridIdx(m,n);
+         
+         realT P = m_grid_P[idx];
+         bool ctrl = m_grid_ctrl[idx];
+         
+         for(size_t t = 0; t < terms.size(); ++t)
+         {
+            realT var = 0;
+            
+            if(m != 0 || n != 0)
+            {
+               switch(terms[t])
+               {
+                  case 0:
+                     var = P*m_grid_X[idx];
+                     break;
+                  case 1:
+                     var = P*m_grid_Y[idx];
+                     break;
+                  case 2:
+                     if(ctrl) var = m_grid_meas[idx] + m_grid_td[idx];
+                     else var = P*m_grid_X[idx];
+                     break;
+                  case 4:
+                     if(ctrl) var = P*m_grid_dX[idx];
+                     break;
+                  case 5:
+                     if(ctrl) var = P*m_grid_dY[idx];
+                     break;
+                  case 6:
+                     if(ctrl) var = P*m_grid_X[idx]*fac6;
+                     break;
+                  case 7:
+                     if(ctrl) var = P*m_grid_XZ[idx];
+                     break;
+                  default:
+                     var = 0;
+               }
+            }
+            
+            (*maps[t])(i,j) = var/S;
+         }
+      }
+   }
+}
+
 template<typename realT, class inputSpectT, typename iosT>
 realT aoSystem<realT, inputSpectT, iosT>::C0var( realT m, 
                                            realT n
@@ -2301,7 +2629,8 @@ template<typename realT, class inputSpectT, typename iosT>
 template<typename imageT>
 void aoSystem<realT, inputSpectT, iosT>::C0Map( imageT & im )
 {
-   C_Map(im, &aoSystem<realT, inputSpectT, iosT>::C0);
+   std::vector<imageT *> maps({&im});
+   CMaps(maps, {0});
 }
 
 template<typename realT, class inputSpectT, typename iosT>
@@ -2327,7 +2656,8 @@ template<typename realT, class inputSpectT, typename iosT>
 template<typename imageT>
 void aoSystem<realT, inputSpectT, iosT>::C1Map( imageT & im )
 {
-   C_Map(im, &aoSystem<realT, inputSpectT, iosT>::C1);
+   std::vector<imageT *> maps({&im});
+   CMaps(maps, {1});
 }
 
 template<typename realT, class inputSpectT, typename iosT>
@@ -2351,7 +2681,8 @@ template<typename realT, class inputSpectT, typename iosT>
 template<typename imageT>
 void aoSystem<realT, inputSpectT, iosT>::C2Map( imageT & im )
 {
-   C_Map(im, &aoSystem<realT, inputSpectT, iosT>::C2);   
+   std::vector<imageT *> maps({&im});
+   CMaps(maps, {2});
 }
 
 template<typename realT, class inputSpectT, typename iosT>
@@ -2375,7 +2706,8 @@ template<typename realT, class inputSpectT, typename iosT>
 template<typename imageT>
 void aoSystem<realT, inputSpectT, iosT>::C3Map( imageT & im )
 {
-   C_Map(im, &aoSystem<realT, inputSpectT, iosT>::C3);   
+   std::vector<imageT *> maps({&im});
+   CMaps(maps, {3});
 }
 
 template<typename realT, class inputSpectT, typename iosT>
@@ -2403,7 +2735,8 @@ template<typename realT, class inputSpectT, typename iosT>
 template<typename imageT>
 void aoSystem<realT, inputSpectT, iosT>::C4Map( imageT & im )
 {
-   C_Map(im, &aoSystem<realT, inputSpectT, iosT>::C4);   
+   std::vector<imageT *> maps({&im});
+   CMaps(maps, {4});
 }
 
 template<typename realT, class inputSpectT, typename iosT>
@@ -2431,7 +2764,8 @@ template<typename realT, class inputSpectT, typename iosT>
 template<typename imageT>
 void aoSystem<realT, inputSpectT, iosT>::C5Map( imageT & im )
 {
-   C_Map(im, &aoSystem<realT, inputSpectT, iosT>::C5);   
+   std::vector<imageT *> maps({&im});
+   CMaps(maps, {5});
 }
 
 template<typename realT, class inputSpectT, typename iosT>
@@ -2459,7 +2793,8 @@ template<typename realT, class inputSpectT, typename iosT>
 template<typename imageT>
 void aoSystem<realT, inputSpectT, iosT>::C6Map( imageT & im )
 {
-   C_Map(im, &aoSystem<realT, inputSpectT, iosT>::C6);   
+   std::vector<imageT *> maps({&im});
+   CMaps(maps, {6});
 }
 
 template<typename realT, class inputSpectT, typename iosT>
@@ -2485,7 +2820,8 @@ template<typename realT, class inputSpectT, typename iosT>
 template<typename imageT>
 void aoSystem<realT, inputSpectT, iosT>::C7Map( imageT & im )
 {
-   C_Map(im, &aoSystem<realT, inputSpectT, iosT>::C7);   
+   std::vector<imageT *> maps({&im});
+   CMaps(maps, {7});
 }
 
 template<typename realT, class inputSpectT, typename iosT>
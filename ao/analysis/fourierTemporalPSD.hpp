@@ -31,6 +31,11 @@
 
 #include <iostream>
 #include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <algorithm>
+#include <tuple>
 
 #include <sys/stat.h>
 
@@ -80,6 +85,92 @@ namespace analysis
 
 #endif
 
+namespace impl
+{
+
+///Owner of a GSL integration workspace which is freed on destruction.
+struct ftPSDWorkspace
+{
+   gsl_integration_workspace * m_w {nullptr}; ///< The workspace, allocated to WSZ.
+
+   ftPSDWorkspace()
+   {
+      m_w = gsl_integration_workspace_alloc(WSZ);
+   }
+
+   ~ftPSDWorkspace()
+   {
+      if(m_w) gsl_integration_workspace_free(m_w);
+   }
+
+   ftPSDWorkspace( const ftPSDWorkspace & ) = delete;
+   ftPSDWorkspace & operator=( const ftPSDWorkspace & ) = delete;
+};
+
+///Get the GSL integration workspace for the calling thread.
+/** The workspace is allocated on the first call from each thread, and is reused for all subsequent integrations
+  * on that thread.  It is freed when the thread exits.
+  */
+inline gsl_integration_workspace * threadWorkspace()
+{
+   static thread_local ftPSDWorkspace w;
+   return w.m_w;
+}
+
+///Mix a value into a 64-bit hash.
+template<typename T>
+void hashCombine( uint64_t & h, ///< [in/out] the hash to update
+                  const T & v   ///< [in] the value to mix in, hashed by its bytes
+                )
+{
+   unsigned char b[sizeof(T)];
+   memcpy(b, &v, sizeof(T));
+
+   //FNV-1a
+   for(size_t i=0; i < sizeof(T); ++i)
+   {
+      h ^= b[i];
+      h *= 1099511628211ULL;
+   }
+}
+
+///Key for the fourierTemporalPSD memo cache.
+template<typename realT>
+struct ftPSDMemoKey
+{
+   uint64_t m_ctx {0}; ///< Hash of the system and atmosphere parameters which the integral depends on
+   realT m_m {0};      ///< The spatial frequency m index
+   realT m_n {0};      ///< The spatial frequency n index
+   int m_p {0};        ///< The mode parity
+   realT m_v {0};      ///< The layer wind speed
+   realT m_dir {0};    ///< The layer wind direction
+   realT m_f {0};      ///< The temporal frequency
+
+   bool operator==( const ftPSDMemoKey & k ) const
+   {
+      return m_ctx == k.m_ctx && m_m == k.m_m && m_n == k.m_n && m_p == k.m_p && m_v == k.m_v && m_dir == k.m_dir && m_f == k.m_f;
+   }
+};
+
+///Hash function for ftPSDMemoKey.
+template<typename realT>
+struct ftPSDMemoHash
+{
+   size_t operator()( const ftPSDMemoKey<realT> & k ) const
+   {
+      uint64_t h = k.m_ctx;
+      hashCombine(h, k.m_m);
+      hashCombine(h, k.m_n);
+      hashCombine(h, k.m_p);
+      hashCombine(h, k.m_v);
+      hashCombine(h, k.m_dir);
+      hashCombine(h, k.m_f);
+      return h;
+   }
+};
+
+} //namespace impl
+
 enum basis : unsigned int { basic, ///< The basic sine and cosine Fourier modes
                             modified, ///< The modified Fourier basis from \cite males_guyon_2017
                             projected_basic,
@@ -135,6 +226,8 @@ struct fourierTemporalPSD
    ///Worskspace for the gsl integrators, allocated to WSZ if constructed as worker (with allocate == true).
    gsl_integration_workspace * _w;
 
+   bool m_ownW {false}; ///< Flag indicating that _w was allocated by this instance, and should be freed on destruction.
+
    realT _absTol; ///< The absolute tolerance to use in the GSL integrator
    realT _relTol; ///< The relative tolerance to use in the GSL integrator
 
@@ -150,6 +243,15 @@ struct fourierTemporalPSD
   std::vector<realT> ms;
   std::vector<realT> ns;
 
+   bool m_adaptive {false}; ///< Flag controlling whether frequency-adaptive evaluation is used in singleLayerPSD.  Default is false.
+   int m_adaptiveStep {8}; ///< The initial spacing, in frequency samples, of the directly integrated points in adaptive mode.
+   realT m_adaptiveTol {1e-3}; ///< The relative tolerance of the interpolation in adaptive mode.
+
+   bool m_useMemo {false}; ///< Flag controlling whether integrated values are memoized.  Default is false.
+
+   ///The memo cache of integrated values, not including the 2/v_wind scale.
+   std::unordered_map<impl::ftPSDMemoKey<realT>, realT, impl::ftPSDMemoHash<realT>> m_memo;
+
    void initProjection()
    {
       Jps.resize(m_modeCoeffs.cols());
@@ -223,6 +325,94 @@ public:
 
    ///@}
 
+   /** \name Frequency-Adaptive Evaluation
+     * In adaptive mode singleLayerPSD integrates directly only every adaptiveStep() frequency samples.  Each interval is then bisected:
+     * the midpoint is integrated and compared to the interpolation (log-log where possible) of the endpoints.  If they agree to
+     * within adaptiveTol() the interval is filled by interpolation, otherwise both halves are refined further.  This concentrates
+     * the integrations near the V-dot-k peaks and other features of the PSD, and interpolates the smooth regions.
+     * @{
+     */
+
+   ///Set whether or not adaptive evaluation is used
+   void adaptive( bool ad /**< [in] the new value of the adaptive flag */);
+
+   ///Get whether or not adaptive evaluation is used
+   /**
+     * \returns the current value of m_adaptive
+     */
+   bool adaptive();
+
+   ///Set the initial sample spacing used in adaptive mode
+   void adaptiveStep( int as /**< [in] the new initial spacing, in samples.  Must be >= 2.*/);
+
+   ///Get the initial sample spacing used in adaptive mode
+   /**
+     * \returns the current value of m_adaptiveStep
+     */
+   int adaptiveStep();
+
+   ///Set the relative interpolation tolerance used in adaptive mode
+   void adaptiveTol( realT at /**< [in] the new relative tolerance */);
+
+   ///Get the relative interpolation tolerance used in adaptive mode
+   /**
+     * \returns the current value of m_adaptiveTol
+     */
+   realT adaptiveTol();
+
+   ///@}
+
+   /** \name Memoization
+     * If enabled, each integrated value is stored in a cache keyed on the spatial frequency, parity, layer wind speed and direction,
+     * temporal frequency, and a hash of the other inputs to the integrand (basis, tolerances, D, wavelengths, zenith angle,
+     * spatial filter, r_0, L_0, lam_0, the PSD power law and filter settings including the filter table, and the layer heights and strengths if scintillation is included).
+     * Layer strength does not otherwise enter, so changing only the Cn2 profile re-uses the cache.  Calculations for a projected basis are not memoized.
+     *
+     * The cache persists for the lifetime of this object, and can be saved to and loaded from disk.
+     * @{
+     */
+
+   ///Set whether or not integrated values are memoized
+   void useMemo( bool um /**< [in] the new value of the memo flag */);
+
+   ///Get whether or not integrated values are memoized
+   /**
+     * \returns the current value of m_useMemo
+     */
+   bool useMemo();
+
+   ///Clear the memo cache
+   void clearMemo();
+
+   ///Get the number of values in the memo cache
+   /**
+     * \returns the size of m_memo
+     */
+   size_t memoSize();
+
+   ///Write the memo cache to a binary file
+   /**
+     * \returns 0 on success
+     * \returns -1 on error
+     */
+   int saveMemo( const std::string & fname /**< [in] the path of the file to write */);
+
+   ///Add the contents of a binary file to the memo cache
+   /** The file must have been written by saveMemo on a machine with the same binary representation.
+     *
+     * \returns 0 on success
+     * \returns -1 on error
+     */
+   int loadMemo( const std::string & fname /**< [in] the path of the file to read */);
+
+protected:
+   ///Calculate the hash of the inputs to the integrand not included explicitly in the memo key.
+   uint64_t memoContext();
+
+   ///@}
+
+public:
+
    ///Determine the frequency of the highest V-dot-k peak
    /**
      * \param m the spatial frequency u index
@@ -408,13 +598,14 @@ fourierTemporalPSD<realT, aosysT>::fourierTemporalPSD(bool allocate)
    if(allocate)
    {
       _w = gsl_integration_workspace_alloc (WSZ);
+      m_ownW = true;
    }
 }
 
 template<typename realT, typename aosysT>
 fourierTemporalPSD<realT, aosysT>::~fourierTemporalPSD()
 {
-   if(_w)
+   if(_w && m_ownW)
    {
       gsl_integration_workspace_free (_w);
    }
@@ -454,6 +645,210 @@ realT fourierTemporalPSD<realT, aosysT>::relTol()
    return _relTol;
 }
 
+template<typename realT, typename aosysT>
+void fourierTemporalPSD<realT, aosysT>::adaptive(bool ad)
+{
+   m_adaptive = ad;
+}
+
+template<typename realT, typename aosysT>
+bool fourierTemporalPSD<realT, aosysT>::adaptive()
+{
+   return m_adaptive;
+}
+
+template<typename realT, typename aosysT>
+void fourierTemporalPSD<realT, aosysT>::adaptiveStep(int as)
+{
+   if(as < 2) as = 2;
+   m_adaptiveStep = as;
+}
+
+template<typename realT, typename aosysT>
+int fourierTemporalPSD<realT, aosysT>::adaptiveStep()
+{
+   return m_adaptiveStep;
+}
+
+template<typename realT, typename aosysT>
+void fourierTemporalPSD<realT, aosysT>::adaptiveTol(realT at)
+{
+   m_adaptiveTol = at;
+}
+
+template<typename realT, typename aosysT>
+realT fourierTemporalPSD<realT, aosysT>::adaptiveTol()
+{
+   return m_adaptiveTol;
+}
+
+template<typename realT, typename aosysT>
+void fourierTemporalPSD<realT, aosysT>::useMemo(bool um)
+{
+   m_useMemo = um;
+}
+
+template<typename realT, typename aosysT>
+bool fourierTemporalPSD<realT, aosysT>::useMemo()
+{
+   return m_useMemo;
+}
+
+template<typename realT, typename aosysT>
+void fourierTemporalPSD<realT, aosysT>::clearMemo()
+{
+   m_memo.clear();
+}
+
+template<typename realT, typename aosysT>
+size_t fourierTemporalPSD<realT, aosysT>::memoSize()
+{
+   return m_memo.size();
+}
+
+template<typename realT, typename aosysT>
+int fourierTemporalPSD<realT, aosysT>::saveMemo( const std::string & fname )
+{
+   std::ofstream fout;
+   fout.open(fname, std::ios::binary);
+   if(!fout.good())
+   {
+      mxError("fourierTemporalPSD::saveMemo", MXE_FILEOERR, "Error opening " + fname);
+      return -1;
+   }
+
+   uint64_t N = m_memo.size();
+   fout.write( (char *) &N, sizeof(N));
+
+   //Entries are written in key order, and fields one at a time so that padding in the key does not reach the file,
+   //so that identical memos give identical files.
+   typedef typename decltype(m_memo)::const_iterator memoIterT;
+
+   std::vector<memoIterT> entries;
+   entries.reserve(N);
+   for(auto it = m_memo.cbegin(); it != m_memo.cend(); ++it) entries.push_back(it);
+
+   std::sort(entries.begin(), entries.end(), [](const memoIterT & a, const memoIterT & b)
+   {
+      const impl::ftPSDMemoKey<realT> & ka = a->first;
+      const impl::ftPSDMemoKey<realT> & kb = b->first;
+      return std::tie(ka.m_ctx, ka.m_m, ka.m_n, ka.m_p, ka.m_v, ka.m_dir, ka.m_f) < std::tie(kb.m_ctx, kb.m_m, kb.m_n, kb.m_p, kb.m_v, kb.m_dir, kb.m_f);
+   });
+
+   for(size_t i = 0; i < entries.size(); ++i)
+   {
+      auto it = entries[i];
+      const impl::ftPSDMemoKey<realT> & key = it->first;
+      int32_t p = key.m_p;
+
+      fout.write( (char *) &key.m_ctx, sizeof(key.m_ctx));
+      fout.write( (char *) &key.m_m, sizeof(key.m_m));
+      fout.write( (char *) &key.m_n, sizeof(key.m_n));
+      fout.write( (char *) &p, sizeof(p));
+      fout.write( (char *) &key.m_v, sizeof(key.m_v));
+      fout.write( (char *) &key.m_dir, sizeof(key.m_dir));
+      fout.write( (char *) &key.m_f, sizeof(key.m_f));
+      fout.write( (char *) &it->second, sizeof(it->second));
+   }
+
+   if(!fout.good())
+   {
+      mxError("fourierTemporalPSD::saveMemo", MXE_FILEWERR, "Error writing " + fname);
+      return -1;
+   }
+
+   fout.close();
+
+   return 0;
+}
+
+template<typename realT, typename aosysT>
+int fourierTemporalPSD<realT, aosysT>::loadMemo( const std::string & fname )
+{
+   std::ifstream fin;
+   fin.open(fname, std::ios::binary);
+   if(!fin.good())
+   {
+      mxError("fourierTemporalPSD::loadMemo", MXE_FILEOERR, "Error opening " + fname);
+      return -1;
+   }
+
+   uint64_t N = 0;
+   fin.read( (char *) &N, sizeof(N));
+
+   impl::ftPSDMemoKey<realT> key;
+   int32_t p;
+   realT val;
+   for(uint64_t i=0; i < N; ++i)
+   {
+      fin.read( (char *) &key.m_ctx, sizeof(key.m_ctx));
+      fin.read( (char *) &key.m_m, sizeof(key.m_m));
+      fin.read( (char *) &key.m_n, sizeof(key.m_n));
+      fin.read( (char *) &p, sizeof(p));
+      fin.read( (char *) &key.m_v, sizeof(key.m_v));
+      fin.read( (char *) &key.m_dir, sizeof(key.m_dir));
+      fin.read( (char *) &key.m_f, sizeof(key.m_f));
+      fin.read( (char *) &val, sizeof(val));
+      key.m_p = p;
+
+      if(!fin.good())
+      {
+         mxError("fourierTemporalPSD::loadMemo", MXE_FILERERR, "Error reading " + fname);
+         return -1;
+      }
+
+      m_memo[key] = val;
+   }
+
+   fin.close();
+
+   return 0;
+}
+
+template<typename realT, typename aosysT>
+uint64_t fourierTemporalPSD<realT, aosysT>::memoContext()
+{
+   uint64_t h = 14695981039346656037ULL;
+
+   impl::hashCombine(h, _useBasis);
+   impl::hashCombine(h, _absTol);
+   impl::hashCombine(h, _relTol);
+
+   impl::hashCombine(h, m_aosys->D());
+   impl::hashCombine(h, m_aosys->secZeta());
+   impl::hashCombine(h, m_aosys->lam_sci());
+   impl::hashCombine(h, m_aosys->lam_wfs());
+   impl::hashCombine(h, m_aosys->spatialFilter_ku());
+   impl::hashCombine(h, m_aosys->spatialFilter_kv());
+
+   impl::hashCombine(h, m_aosys->atm.r_0());
+   impl::hashCombine(h, m_aosys->atm.L_0(0));
+   impl::hashCombine(h, m_aosys->atm.lam_0());
+   impl::hashCombine(h, m_aosys->atm.alpha());
+   impl::hashCombine(h, m_aosys->atm.beta());
+
+   impl::hashCombine(h, m_aosys->psd.subPiston());
+   impl::hashCombine(h, m_aosys->psd.subTipTilt());
+   impl::hashCombine(h, m_aosys->psd.D());
+   impl::hashCombine(h, m_aosys->psd.scintillation());
+   impl::hashCombine(h, m_aosys->psd.component());
+   impl::hashCombine(h, m_aosys->psd.useTable());
+   impl::hashCombine(h, m_aosys->psd.tableTol());
+
+   if(m_aosys->psd.scintillation())
+   {
+      impl::hashCombine(h, m_aosys->atm.h_obs());
+      impl::hashCombine(h, m_aosys->atm.H());
+      for(size_t i=0; i< m_aosys->atm.n_layers(); ++i)
+      {
+         impl::hashCombine(h, m_aosys->atm.layer_z(i));
+         impl::hashCombine(h, m_aosys->atm.layer_Cn2(i));
+      }
+   }
+
+   return h;
+}
+
 template<typename realT, typename aosysT>
 realT fourierTemporalPSD<realT, aosysT>::fastestPeak( int m,
                                                         int n )
@@ -502,8 +897,9 @@ int fourierTemporalPSD<realT, aosysT>::singleLayerPSD( std::vector<realT> &PSD,
    //We'll get the occasional failure to reach tolerance error, just ignore them all for now.
    gsl_set_error_handler_off();
 
-   //Create a local instance so that we're reentrant
-   fourierTemporalPSD<realT, aosysT> params(true);
+   //Create a local instance so that we're reentrant, using this thread's workspace
+   fourierTemporalPSD<realT, aosysT> params;
+   params._w = impl::threadWorkspace();
 
    params.m_aosys = m_aosys;
    params._layer_i = layer_i;
@@ -553,25 +949,123 @@ int fourierTemporalPSD<realT, aosysT>::singleLayerPSD( std::vector<realT> &PSD,
 
    func.params = &params;
 
+   bool memo = m_useMemo && (_useBasis == basis::basic || _useBasis == basis::modified);
 
-   //Here we only calculate up to fmax.
-   size_t i=0;
-   while( freq[i] <= fmax )
+   impl::ftPSDMemoKey<realT> key;
+   if(memo)
    {
-      params.m_f = freq[i];
+      key.m_ctx = memoContext();
+      key.m_m = m;
+      key.m_n = n;
+      key.m_p = p;
+      key.m_v = v_wind;
+      key.m_dir = q_wind;
+   }
+
+   //Integrate (or look up) the PSD at freq[k]
+   auto integrate = [&](size_t k)
+   {
+      if(memo)
+      {
+         key.m_f = freq[k];
+         bool found = false;
+
+         #pragma omp critical(mxAO_fourierTemporalPSD_memo)
+         {
+            auto it = m_memo.find(key);
+            if(it != m_memo.end())
+            {
+               result = it->second;
+               found = true;
+            }
+         }
+
+         if(found)
+         {
+            PSD[k] = scale*result;
+            return;
+         }
+      }
+
+      params.m_f = freq[k];
 
       int ec = gsl_integration_qagi (&func, _absTol, _relTol, WSZ, params._w, &result, &error);
 
       if(ec == GSL_EDIVERGE)
       {
-         std::cerr << "GSL_EDIVERGE:" << p << " " << freq[i] << " " << v_wind << " " << m << " " << n << " " << m_m << " " << m_n << "\n";
+         std::cerr << "GSL_EDIVERGE:" << p << " " << freq[k] << " " << v_wind << " " << m << " " << n << " " << m_m << " " << m_n << "\n";
          std::cerr << "ignoring . . .\n";
       }
 
-      PSD[i] = scale*result;
+      if(memo)
+      {
+         #pragma omp critical(mxAO_fourierTemporalPSD_memo)
+         m_memo[key] = result;
+      }
+
+      PSD[k] = scale*result;
+   };
 
-      ++i;
-      if(i >= freq.size()) break;
+   //Here we only calculate up to fmax.
+   size_t i=0;
+   while( i < freq.size() && freq[i] <= fmax ) ++i;
+
+   if(!m_adaptive || i < 3)
+   {
+      for(size_t k=0; k < i; ++k) integrate(k);
+   }
+   else
+   {
+      //Interpolate PSD[k] from PSD[a] and PSD[b], in log-log if possible
+      auto interp = [&](size_t a, size_t b, size_t k)
+      {
+         if(freq[a] > 0 && PSD[a] > 0 && PSD[b] > 0)
+         {
+            return PSD[a] * pow(PSD[b]/PSD[a], log(freq[k]/freq[a])/log(freq[b]/freq[a]));
+         }
+         else
+         {
+            return PSD[a] + (PSD[b]-PSD[a])*(freq[k]-freq[a])/(freq[b]-freq[a]);
+         }
+      };
+
+      std::vector<std::pair<size_t,size_t>> intervals;
+
+      size_t step = m_adaptiveStep;
+      size_t a = 0;
+      integrate(a);
+      while(a < i-1)
+      {
+         size_t b = a + step;
+         if(b > i-1) b = i-1;
+         integrate(b);
+         intervals.push_back({a,b});
+         a = b;
+      }
+
+      while(intervals.size() > 0)
+      {
+         a = intervals.back().first;
+         size_t b = intervals.back().second;
+         intervals.pop_back();
+
+         if(b - a < 2) continue;
+
+         size_t c = (a + b)/2;
+         realT pc = interp(a, b, c);
+         integrate(c);
+
+         if( fabs(pc - PSD[c]) <= m_adaptiveTol*fabs(PSD[c]) )
+         {
+            for(size_t k=a+1; k < c; ++k) PSD[k] = interp(a, c, k);
+            for(size_t k=c+1; k < b; ++k) PSD[k] = interp(c, b, k);
+         }
+         else
+         {
+            intervals.push_back({c,b});
+            intervals.push_back({a,c});
+         }
+      }
    }
 
    //Now fill in from fmax to the actual max frequency with a -(alpha+2) power law.
@@ -725,6 +1219,9 @@ void fourierTemporalPSD<realT, aosysT>::makePSDGrid( const std::string & dir,
    fout << "#    absTol " << _absTol << '\n';
    fout << "#    relTol " << _relTol << '\n';
    fout << "#    useBasis " << _useBasis << '\n';
+   fout << "#    adaptive " << std::boolalpha << m_adaptive << '\n';
+   fout << "#    adaptiveStep " << m_adaptiveStep << '\n';
+   fout << "#    adaptiveTol " << m_adaptiveTol << '\n';
    fout << "#    makePSDGrid call:\n";
    fout << "#       mnMax = " << mnMax << '\n';
    fout << "#       dFreq = " << dFreq << '\n';
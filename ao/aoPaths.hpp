@@ -8,6 +8,8 @@
 #ifndef __aoPaths_hpp__
 #define __aoPaths_hpp__
 
+#include <cstdio>
+
 #include "../sys/environment.hpp"
 
 #include "../ioutils/fileUtils.hpp"
@@ -70,6 +72,37 @@ namespace basis
 
       return path;
    }
+
+   ///The path for a cached generated basis
+   /** Generated bases are cached so they can be reused by any named basis.  The cache is keyed by the type of the basis,
+     * the linear size of the maps, the number of degrees of freedom, and the rotation angle.
+     *
+     * \param[in] basisType the type of the basis, e.g. "modf" or "zernike"
+     * \param[in] dim the linear size of the maps
+     * \param[in] N the number of degrees of freedom
+     * \param[in] ang the rotation angle of the basis, in degrees
+     * \param[in] create [optional] create the directory if it noes not exist.
+     *
+     * \returns the path to the FITS file containing the cached basis.
+     *
+     * \ingroup mxAO_paths
+     */
+   std::string cache(const std::string & basisType, int dim, int N, double ang, bool create = false)
+   {
+      std::string path = mx::sys::getEnv("MX_AO_DATADIR");
+
+      path += "/basis/cache";
+
+      if(create)
+      {
+         ioutils::createDirectories(path);
+      }
+
+      char key[256];
+      snprintf(key, sizeof(key), "/%s_%d_%d_%0.4f.fits", basisType.c_str(), dim, N, ang);
+
+      return path + key;
+   }
 } //namespace basis
 
 //--------------------------------------------------------------------------------
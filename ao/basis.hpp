@@ -79,6 +79,9 @@ void applyPupil2Basis( eigenCube<realT> & modes,
 
 /** \def MXAO_ORTHO_METHOD_SGS
   * \brief Constant to specify using the stabilized Gramm Schmidt (SGS) orthogonalization procedure.
+  *
+  * The SGS basis is calculated with a blocked QR decomposition, see sigproc::gramSchmidtSpectrum.  Pixels which are
+  * zero in every mode, e.g. outside the pupil, are not used.
   */ 
 #define MXAO_ORTHO_METHOD_SGS 0
 
@@ -8,6 +8,8 @@
 #ifndef __fourierBasis_hpp__
 #define __fourierBasis_hpp__
 
+#include <sys/stat.h>
+
 #include "../sigproc/fourierModes.hpp"
 #include "../improc/eigenCube.hpp"
 #include "../ioutils/fits/fitsFile.hpp"
@@ -20,10 +22,14 @@ namespace AO
 {
    
 ///Make the modified Fourier basis
-/** 
+/** The generated basis is cached, see mx::AO::path::basis::cache, and a cached basis of the same size, N, and angle is
+  * reused rather than regenerated.
+  *
   * \param [in] basisName the name of the basis (not including the mx::AO path)
   * \param [in] dim the linear size of the maps, that is they will be dimxdim in size.
   * \param [in] N is the number of degrees of freedom.  Number of modes will be (N+1)(N+1) - 1.
+  * \param [in] ang the rotation angle of the basis, in degrees.
+  * \param [in] useCache [optional] if false the basis is always generated, and is not cached.
   *
   * \tparam realT the real numeric type for calculations
   */  
@@ -31,15 +37,24 @@ template<typename realT>
 void makeModfBasis( const std::string & basisName,
                     int dim,
                     int N,
-                    realT ang
+                    realT ang,
+                    bool useCache = true
                   )
 {
    mx::improc::eigenCube<realT> modes;
 
-   mx::sigproc::makeFourierBasis_Rect( modes, dim, N, MX_FOURIER_MODIFIED, ang);
-
    fits::fitsFile<realT> ff;
-   
+
+   std::string cName = mx::AO::path::basis::cache("modf", dim, N, ang, useCache);
+
+   struct stat st;
+   if( !useCache || stat(cName.c_str(), &st) != 0 || ff.read(modes, cName) < 0 || modes.rows() != dim || modes.cols() != dim )
+   {
+      mx::sigproc::makeFourierBasis_Rect( modes, dim, N, MX_FOURIER_MODIFIED, ang);
+
+      if(useCache) ff.write(cName, modes);
+   }
+
    std::string fName = mx::AO::path::basis::modes(basisName, true);
       
    ff.write(fName, modes);
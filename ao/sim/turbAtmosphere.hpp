@@ -291,24 +291,23 @@ int turbAtmosphere<realT>::genLayers()
       sigproc::frequencyGrid(freq, _pupD/_wfSz);
       
       psub.resize(scrnSz, scrnSz);
+      psub.setConstant(1);
       
-      for(size_t ii =0; ii < scrnSz; ++ii)
+      if(_subPiston || _subTipTilt)
       {
-         for(size_t jj=0; jj < scrnSz; ++jj)
+         arrayT x = math::pi<realT>() * _pupD * freq;
+         arrayT ji(scrnSz, scrnSz);
+         
+         if(_subPiston)
          {
-            realT Ppiston = 0;
-            realT Ptiptilt = 0;
-            if(_subPiston)
-            {
-               Ppiston = pow(2*math::func::jinc(math::pi<realT>() * freq(ii,jj) * _pupD), 2);
-            }
-
-            if(_subTipTilt)
-            {
-               Ptiptilt = pow(4*math::func::jincN(2,math::pi<realT>() * freq(ii,jj) * _pupD), 2);
-            }
+            math::func::jincFast(ji.data(), x.data(), x.size());
+            psub -= (2*ji).square();
+         }
 
-            psub(ii,jj) = (1 - Ppiston - Ptiptilt);
+         if(_subTipTilt)
+         {
+            math::func::jincNFast(2, ji.data(), x.data(), x.size());
+            psub -= (4*ji).square();
          }
       }
 
@@ -8,8 +8,13 @@
 #ifndef __zernikeBasis_hpp__
 #define __zernikeBasis_hpp__
 
+#include <sys/stat.h>
+
 #include "../sigproc/zernike.hpp"
-#include "../improc/fitsFile.hpp"
+#include "../improc/eigenCube.hpp"
+#include "../ioutils/fits/fitsFile.hpp"
+
+#include "aoPaths.hpp"
 
 
 namespace mx
@@ -19,10 +24,14 @@ namespace AO
 {
    
 ///Make the Zernike basis
-/** 
+/** The raw polynomials are cached, see mx::AO::path::basis::cache, and a cached set of the same size and N is reused
+  * rather than regenerated.
+  *
   * \param [in] basisName the name of the basis (not including the mx::AO path)
+  * \param [in] pupilName the name of the pupil which the modes are multiplied by and normalized over
   * \param [in] dim the linear size of the maps, that is they will be dimxdim in size.
-  * \param [in] N is the number of degrees of freedom.  Number of modes will be (N+1)(N+1) - 1.
+  * \param [in] N is the number of modes, starting with tip (j=2).
+  * \param [in] useCache [optional] if false the polynomials are always generated, and are not cached.
   *
   * \tparam realT the real numeric type for calculations
   */  
@@ -30,17 +39,28 @@ template<typename realT>
 void makeZernikeBasis( const std::string & basisName,
                        const std::string & pupilName,
                        int dim,
-                       int N )
+                       int N,
+                       bool useCache = true
+                     )
 {
    improc::eigenCube<realT> rawModes;
 
-   rawModes.resize(dim, dim, N);
-   zernikeBasis( rawModes);
+   fits::fitsFile<realT> ff;
+
+   std::string cName = mx::AO::path::basis::cache("zernike", dim, N, 0, useCache);
+
+   struct stat st;
+   if( !useCache || stat(cName.c_str(), &st) != 0 || ff.read(rawModes, cName) < 0 || rawModes.rows() != dim || rawModes.planes() != N )
+   {
+      rawModes.resize(dim, dim, N);
+      sigproc::zernikeBasis<improc::eigenCube<realT>, double>( rawModes);
+
+      if(useCache) ff.write(cName, rawModes);
+   }
 
    std::string pupilFName = mx::AO::path::pupil::pupilFile(pupilName);
    Eigen::Array<realT, -1, -1> pupil;
    
-   mx::improc::fitsFile<realT> ff;
    ff.read(pupil, pupilFName);
    
    realT psum = pupil.sum();
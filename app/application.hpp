@@ -27,7 +27,13 @@
 #define app_application_hpp
 
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "appConfigurator.hpp"
+#include "sweep.hpp"
+#include "../ioutils/stringUtils.hpp"
 #include "../ioutils/textTable.hpp"
 
 namespace mx
@@ -92,6 +98,23 @@ namespace app
   * A standard help message is produced when requested by the `-h`/`--help` option.  This behavior can be changed
   * by overriding the \ref help method.
   *
+  * \section mxApp_sweep Parameter Sweeps
+  * An application can run a sweep over its own config targets within one process.  To enable this, set
+  * m_allowSweep = true in the derived constructor and override \ref newSweepJob() to return a new instance of the
+  * derived class.  The sweep is then requested with one or more `--sweep` options, e.g.
+  * \verbatim
+  $ myApp --sweep="nAct=16:64:16;method=fast,slow" --sweepThreads=4 --sweepOutput=results.dat
+  \endverbatim
+  * See \ref parseSweepSpec() for the syntax.  The application configures itself as usual, calls \ref setupSweep()
+  * once, and then runs one job per combination of values, several at a time.  Each job is a new instance which is
+  * configured from the same sources plus the swept values (which take precedence over the command line), and then its
+  * execute() is called.  A job records its outputs with \ref sweepResult(), and these are written along with the
+  * status and execute() time of each job as one table.
+  *
+  * Configuration and destruction of jobs is serialized, but execute() runs concurrently in the jobs, so anything
+  * it does which is not thread safe (e.g. FFTW planning) must be protected.  Expensive read-only setup which all jobs
+  * can share, such as loading data, belongs in setupSweep(), with the jobs reaching it through \ref sweepParent().
+  *
   * \ingroup mxApp
   */
 class application
@@ -129,6 +152,16 @@ protected:
    int m_argc; ///< Store argc for later use. E.g. in reReadConfig().
    char ** m_argv; ///< Store argv for later use. E.g. in reReadConfig().
 
+   bool m_allowSweep {false}; ///< Flag controlling whether parameter sweeps are available.  Set in derived constructor.
+
+   std::vector<std::string> m_sweepSpecs; ///< The sweep specifications, one per use of `--sweep`.
+   int m_sweepThreads {0}; ///< The number of jobs to run at once.  If < 1, omp_get_max_threads() is used.
+   std::string m_sweepOutput; ///< The file to write the sweep results table to.  If empty, std::cout is used.
+
+   const application * m_sweepParent {nullptr}; ///< In a sweep job, the application running the sweep.  Otherwise nullptr.
+   std::vector<std::pair<std::string, std::string>> m_sweepSettings; ///< In a sweep job, the config targets and values to apply.
+   std::vector<std::pair<std::string, std::string>> m_sweepResults; ///< In a sweep job, the results recorded by sweepResult().
+
 public:
    //application();
 
@@ -271,11 +304,75 @@ protected:
 
    ///@}
 
-};
+   /** \name Parameter Sweeps
+     * See \ref mxApp_sweep.
+     * @{
+     */
+
+   ///Set up the sweep options in a standard way.
+   /** This adds "--sweep", "--sweepThreads", and "--sweepOutput" as options, in section "sweep" of the config files.
+     * Only called if m_allowSweep is true.
+     */
+   virtual void setupStandardSweep();
+
+   ///Loads the values of the sweep options.
+   /** See also \ref setupStandardSweep().
+     */
+   virtual void loadStandardSweep();
+
+   ///Create a new job for a sweep.
+   /** Derived classes which set m_allowSweep must override this, normally as `return new derived_class;`.
+     * The application takes ownership of the result.
+     *
+     * \returns a new application on success
+     * \returns nullptr on error, which is what the default version returns
+     */
+   virtual application * newSweepJob();
+
+   ///Perform any setup shared by all jobs of a sweep.
+   /** Called once after configuration, before any jobs are created.  Whatever is set up here should only be read by
+     * the jobs.
+     *
+     * \returns 0 on success
+     * \returns -1 on error, which stops the sweep
+     */
+   virtual int setupSweep();
 
+   ///Run a sweep.
+   /** Called by \ref main() in place of execute() if any sweep specifications were configured.
+     *
+     * \returns 0 if the sweep ran, whatever the status of the jobs
+     * \returns -1 on error
+     */
+   int sweep();
 
+   ///Get the application running the sweep.
+   /**
+     * \returns the application which created this job, or nullptr if this is not a sweep job
+     */
+   const application * sweepParent() const;
 
+   ///Record a result of a sweep job.
+   /** Results are written to the sweep table, in a column called \p name.  Has no effect outside of a sweep.
+     */
+   template<typename typeT>
+   void sweepResult( const std::string & name, ///< [in] the name of the result
+                     const typeT & value       ///< [in] the value of the result
+                   );
+
+   ///@}
+
+};
+
+template<typename typeT>
+void application::sweepResult( const std::string & name,
+                               const typeT & value
+                             )
+{
+   if(m_sweepParent == nullptr) return;
 
+   m_sweepResults.push_back(std::make_pair(name, ioutils::convertToString(value)));
+}
 
 } //namespace app
 } //namespace mx
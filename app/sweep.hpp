@@ -0,0 +1,103 @@
+/** \file sweep.hpp
+  * \author Jared R. Males
+  * \brief Parameter sweeps over application configuration targets
+  *
+  * \ingroup mxApp_files
+  */
+
+//***********************************************************************//
+// Copyright 2023 Jared R. Males (jaredmales@gmail.com)
+//
+// This file is part of mxlib.
+//
+// mxlib is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// mxlib is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with mxlib.  If not, see <http://www.gnu.org/licenses/>.
+//***********************************************************************//
+
+#ifndef app_sweep_hpp
+#define app_sweep_hpp
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mx
+{
+namespace app
+{
+
+/// One dimension of a parameter sweep: a config target and the values it takes.
+/**
+  * \ingroup mxApp
+  */
+struct sweepParam
+{
+   std::string m_name;                ///< The name of the config target
+   std::vector<std::string> m_values; ///< The values, as they would be given on the command line
+};
+
+/// One job of a parameter sweep.
+/**
+  * \ingroup mxApp
+  */
+struct sweepJob
+{
+   std::vector<std::pair<std::string, std::string>> m_settings; ///< The config target names and values for this job
+   int m_status {0};  ///< The return value of the job's execute(), or -1 if the job could not be set up
+   double m_time {0}; ///< The wall time taken by the job [s]
+   std::vector<std::pair<std::string, std::string>> m_results; ///< The results recorded by the job, as name and value
+};
+
+/// Parse a sweep specification.
+/** A specification is one or more entries separated by ';', each of which is either a list or a range:
+  * \verbatim
+  name=v1,v2,v3
+  name=start:stop:step
+  \endverbatim
+  * A range includes stop if it is reached to within a small tolerance.  Range values are formatted as integers if
+  * start, stop and step are all integers.  Repeated names are an error.
+  *
+  * \returns 0 on success
+  * \returns -1 on error
+  *
+  * \ingroup mxApp
+  */
+int parseSweepSpec( std::vector<sweepParam> & params, ///< [in/out] the sweep dimensions, new ones are appended
+                    const std::string & spec          ///< [in] the specification
+                  );
+
+/// Expand sweep dimensions into the full set of jobs.
+/** The jobs are the outer product of the dimensions, with the first dimension varying slowest.
+  *
+  * \ingroup mxApp
+  */
+void expandSweep( std::vector<sweepJob> & jobs,              ///< [out] the jobs
+                  const std::vector<sweepParam> & params     ///< [in] the sweep dimensions
+                );
+
+/// Write the results of a sweep as a table.
+/** The table has one row per job, with columns for the job number, status, time, each swept parameter, and each result
+  * name recorded by any job.  Missing results are written as "-".  The header lines start with '#', so the table can
+  * be read with ioutils::readColumns.  Whitespace within values is replaced with '_'.
+  *
+  * \ingroup mxApp
+  */
+void writeSweepTable( std::ostream & out,                 ///< [out] the stream to write to
+                      const std::vector<sweepJob> & jobs  ///< [in] the completed jobs
+                    );
+
+} //namespace app
+} //namespace mx
+
+#endif //app_sweep_hpp
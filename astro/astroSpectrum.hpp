@@ -16,6 +16,7 @@
 #include "../math/gslInterpolation.hpp"
 #include "constants.hpp"
 #include "units.hpp"
+#include "spectrumCache.hpp"
 
 namespace mx
 {
@@ -382,6 +383,23 @@ struct astroSpectrum : public baseSpectrum<typename _spectrumT::units::realT>
       return 0; ///\returns 0 on success.
    }
 
+   ///Load the spectrum from a cache and interpolate it onto a wavelength scale.
+   /** The spectrum is looked up in the cache by spectrumT::fileName(_params).  If it is not present, the spectrum is read from
+     * disk with \ref setSpectrum(gridT &).
+     *
+     * \overload
+     */
+   template<typename gridT>
+   int setSpectrum( gridT & lambda,                 ///< [in] the wavelength grid
+                    spectrumCache<realT> & cache    ///< [in] the cache of spectra, which memoizes the interpolation onto lambda
+                  )
+   {
+      std::string name = spectrumT::fileName(_params);
+
+      if(!cache.has(name)) return setSpectrum(lambda);
+
+      return cache.resample(this->_spectrum, name, lambda); ///\returns the result of spectrumCache::resample when the spectrum is cached.
+   }
 
 };
 
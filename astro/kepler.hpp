@@ -11,6 +11,7 @@
 #include <iostream>
 #include <cmath>
 #include <cstdlib>
+#include <vector>
 
 
 #include "units.hpp"
@@ -33,6 +34,11 @@ namespace astro
 #define KEPLER_ITMAX (1000)
 #endif
 
+#ifndef KEPLER_BATCH_ITS
+///The default number of Danby iterations used by the batch solver for the Kepler problem
+#define KEPLER_BATCH_ITS (2)
+#endif
+
 
 
 
@@ -174,9 +180,215 @@ long solve_kepler( realT & E, ///< [out] is the eccentric anomaly
    
 }
 
+///A table of eccentric anomaly solutions used to start the batch Kepler solver.
+/** Tabulates E(e, M) for elliptical orbits on a regular grid of e in [0,1] and of x = (M/pi)^(1/3) in [0,1], using the symmetry E(2pi-M) = 2pi - E(M)
+  * for the other half of the orbit.  The cube-root grid follows E ~ (6M)^(1/3) near pericenter for e close to 1. The starting value is
+  * found by bilinear interpolation, which is accurate enough that a fixed small number of Danby iterations converges to machine precision.
+  *
+  * \tparam realT is the type used for arithmetic
+  *
+  * \ingroup kepler
+  */
+template<typename realT>
+class keplerStarterTable
+{
+protected:
+   size_t m_Ne {0}; ///< The number of points in the eccentricity grid
+   size_t m_Nx {0}; ///< The number of points in the (M/pi)^(1/3) grid
+   realT m_de {0};  ///< The eccentricity grid spacing
+   realT m_dx {0};  ///< The (M/pi)^(1/3) grid spacing
+
+   std::vector<realT> m_E; ///< The table, with x the fastest varying index.
+
+public:
+
+   ///Default c'tor, sets up a 65 x 257 table.
+   keplerStarterTable();
+
+   ///Constructor which sets up the table with the specified size.
+   keplerStarterTable( size_t Ne, ///< [in] the number of points in the eccentricity grid, must be >= 2
+                       size_t Nx  ///< [in] the number of points in the mean anomaly grid, must be >= 2
+                     );
+
+   ///Calculate the table.
+   void setup( size_t Ne, ///< [in] the number of points in the eccentricity grid, must be >= 2
+               size_t Nx  ///< [in] the number of points in the mean anomaly grid, must be >= 2
+             );
+
+   ///Get the starting estimate of the eccentric anomaly
+   /**
+     * \returns the interpolated value of E
+     */
+   realT operator()( realT e, ///< [in] the eccentricity, 0 <= e <= 1
+                     realT M  ///< [in] the mean anomaly, 0 <= M < 2pi
+                   ) const;
+};
+
+template<typename realT>
+keplerStarterTable<realT>::keplerStarterTable()
+{
+   setup(65, 257);
+}
+
+template<typename realT>
+keplerStarterTable<realT>::keplerStarterTable( size_t Ne,
+                                               size_t Nx
+                                             )
+{
+   setup(Ne, Nx);
+}
+
+template<typename realT>
+void keplerStarterTable<realT>::setup( size_t Ne,
+                                       size_t Nx
+                                     )
+{
+   const realT pi = static_cast<realT>(3.14159265358979323846264338327950288);
+
+   if(Ne < 2) Ne = 2;
+   if(Nx < 2) Nx = 2;
+
+   m_Ne = Ne;
+   m_Nx = Nx;
+   m_de = static_cast<realT>(1)/(m_Ne-1);
+   m_dx = static_cast<realT>(1)/(m_Nx-1);
+
+   m_E.resize(m_Ne*m_Nx);
+
+   realT E, D;
+   for(size_t i = 0; i < m_Ne; ++i)
+   {
+      realT e = i*m_de;
+
+      m_E[i*m_Nx] = 0;
+      for(size_t j = 1; j < m_Nx; ++j)
+      {
+         realT x = j*m_dx;
+         realT M = pi*x*x*x;
+
+         //If itmax is exceeded the last iterate is still a good starter, so the return value is ignored.
+         solve_kepler_danby(E, D, e, M, static_cast<realT>(1e-14), KEPLER_ITMAX);
+         m_E[i*m_Nx + j] = E;
+      }
+   }
+}
+
+template<typename realT>
+realT keplerStarterTable<realT>::operator()( realT e,
+                                             realT M
+                                           ) const
+{
+   const realT pi = static_cast<realT>(3.14159265358979323846264338327950288);
+
+   realT sgn = 1;
+   realT off = 0;
+   if(M > pi)
+   {
+      M = 2*pi - M;
+      sgn = -1;
+      off = 2*pi;
+   }
 
+   //M can round to just outside [0,pi], e.g. from M - 2pi*floor(M/2pi), which must not wrap the index
+   if(M < 0) M = 0;
+   else if(M > pi) M = pi;
 
+   realT xe = e/m_de;
+   realT xM = std::cbrt(M/pi)/m_dx;
 
+   size_t i = xe;
+   size_t j = xM;
+   if(i > m_Ne-2) i = m_Ne-2;
+   if(j > m_Nx-2) j = m_Nx-2;
+
+   realT te = xe - i;
+   realT tM = xM - j;
+
+   const realT * E0 = m_E.data() + i*m_Nx + j;
+   const realT * E1 = E0 + m_Nx;
+
+   realT E = (1-te)*((1-tM)*E0[0] + tM*E0[1]) + te*((1-tM)*E1[0] + tM*E1[1]);
+
+   return off + sgn*E;
+}
+
+///Solve Kepler's equation for a batch of elliptical orbits.
+/** Starts from the starter table, and then applies a fixed number of Danby iterations without convergence tests, so that the loop
+  * can be vectorized.  The sine and cosine of E are only evaluated once per point, and are updated between iterations using
+  * the angle-addition formulas with series for the small correction.  Entries with e < 0 or e >= 1 are solved with \ref solve_kepler.
+  *
+  * \tparam realT is the type used for arithmetic
+  *
+  * \ingroup kepler
+  */
+template<typename realT>
+void solve_kepler_batch( realT * E,                             ///< [out] the eccentric anomalies, must be allocated to N
+                         const realT * e,                       ///< [in] the eccentricities
+                         const realT * M,                       ///< [in] the mean anomalies
+                         size_t N,                              ///< [in] the number of points
+                         const keplerStarterTable<realT> & tab, ///< [in] the starter table
+                         int nIts = KEPLER_BATCH_ITS            ///< [in] [optional] the number of Danby iterations
+                       )
+{
+   const realT two_pi = static_cast<realT>(6.28318530717958647692528676655900577);
+
+   //The starting values, offset by the same multiple of 2pi as M
+   for(size_t k = 0; k < N; ++k)
+   {
+      realT off = two_pi*std::floor(M[k]/two_pi);
+      realT ek = e[k];
+      if(ek >= 1 || ek < 0) ek = 0;
+
+      E[k] = off + tab(ek, M[k] - off);
+   }
+
+   #pragma omp simd
+   for(size_t k = 0; k < N; ++k)
+   {
+      realT ek = e[k];
+      ek = (ek >= 1 || ek < 0) ? 0 : ek;
+
+      realT Mk = M[k];
+      realT Ei = E[k];
+      realT sinE = sin(Ei);
+      realT cosE = cos(Ei);
+
+      for(int it = 0; it < nIts; ++it)
+      {
+         realT fi = Ei - ek*sinE - Mk;
+         realT fi1 = 1 - ek*cosE;
+         realT fi2 = ek*sinE;
+         realT fi3 = ek*cosE;
+
+         realT di1 = -fi/fi1;
+         realT di2 = -fi/(fi1 + static_cast<realT>(0.5)*di1*fi2);
+         realT di3 = -fi/(fi1 + static_cast<realT>(0.5)*di2*fi2 + di2*di2*fi3/6);
+
+         Ei += di3;
+
+         //Update sin(E) and cos(E) for the correction
+         realT d2 = di3*di3;
+         realT sd = di3*(1 - d2/6*(1 - d2/20*(1 - d2/42*(1 - d2/72))));
+         realT cd = 1 - d2/2*(1 - d2/12*(1 - d2/30*(1 - d2/56)));
+
+         realT s = sinE*cd + cosE*sd;
+         cosE = cosE*cd - sinE*sd;
+         sinE = s;
+      }
+
+      E[k] = Ei;
+   }
+
+   //Fix up any non-elliptical orbits
+   for(size_t k = 0; k < N; ++k)
+   {
+      if(e[k] >= 1 || e[k] < 0)
+      {
+         realT D;
+         solve_kepler(E[k], D, e[k], M[k]);
+      }
+   }
+}
 
 #if 0
 
@@ -8,6 +8,8 @@
 #ifndef mx_astro_orbitUtils_hpp
 #define mx_astro_orbitUtils_hpp
 
+#include <vector>
+
 #include "../math/constants.hpp"
 #include "kepler.hpp"
 
@@ -316,6 +318,193 @@ int orbitCartesian2DPhi( vectorT &x, ///< [out] the projected x positions of the
 
 
 
+///A population of orbits, stored as a structure of arrays.
+/** Each orbit is specified by the Keplerian elements used by \ref orbitCartesianWork.  The elements are stored in
+  * separate contiguous vectors so that they can be processed in batches by \ref orbitCartesianPopulation.
+  *
+  * \tparam realT is the type used for arithmetic
+  *
+  * \ingroup orbits
+  */
+template<typename realT>
+struct orbitPopulation
+{
+   std::vector<realT> m_a;  ///< The semi-major axes.
+   std::vector<realT> m_P;  ///< The orbital periods.
+   std::vector<realT> m_e;  ///< The eccentricities.
+   std::vector<realT> m_t0; ///< The times of pericenter passage.
+   std::vector<realT> m_i;  ///< The inclinations [radians].
+   std::vector<realT> m_w;  ///< The arguments of pericenter [radians].
+   std::vector<realT> m_W;  ///< The longitudes of the ascending node [radians].
+
+   ///Resize all of the element vectors.
+   void resize( size_t N /**< [in] the new number of orbits */)
+   {
+      m_a.resize(N);
+      m_P.resize(N);
+      m_e.resize(N);
+      m_t0.resize(N);
+      m_i.resize(N);
+      m_w.resize(N);
+      m_W.resize(N);
+   }
+
+   ///Get the number of orbits.
+   /**
+     * \returns the size of the element vectors
+     */
+   size_t size() const
+   {
+      return m_a.size();
+   }
+};
+
+#ifndef MX_ASTRO_ORBIT_BATCH
+///The number of orbit-epoch points processed together by orbitCartesianPopulation.
+#define MX_ASTRO_ORBIT_BATCH (512)
+#endif
+
+///Calculate various quantities for a population of orbits at a set of times.
+/** This is the batch version of \ref orbitCartesianWork.  Only those quantities with non-null pointers are calculated.
+  * The outputs are stored orbit-major, that is the value for orbit k at time t[j] is stored at index k*Nt + j, and each must
+  * be allocated to at least pop.size()*Nt.
+  *
+  * The orbit-epoch points are processed in blocks of MX_ASTRO_ORBIT_BATCH, split across threads with OpenMP.  Kepler's equation is solved with
+  * \ref solve_kepler_batch, and the true anomaly enters only through its sine and cosine, except when f is requested.
+  *
+  * \tparam realT the type in which to perform calculations.
+  *
+  * \retval -1 if any orbit has e < 0 or e == 1.
+  * \retval 0 on success.
+  *
+  * \ingroup orbits
+  */
+template<typename realT>
+int orbitCartesianPopulation( realT * x,                           ///< [out] [optional] If not NULL, will be the projected x positions of the orbits.
+                              realT * y,                           ///< [out] [optional] If not NULL, will be the projected y positions of the orbits.
+                              realT * z,                           ///< [out] [optional] If not NULL, will be the projected z positions of the orbits.
+                              realT * r,                           ///< [out] [optional] If not NULL, will be the separations of the orbits.
+                              realT * rProj,                       ///< [out] [optional] If not NULL, will be the projected separations of the orbits.
+                              realT * f,                           ///< [out] [optional] If not NULL, will be the true anomalies of the orbits.
+                              realT * cos_alf,                     ///< [out] [optional] If not NULL, will be the cosine of the phase angle of the orbits.
+                              realT * phi,                         ///< [out] [optional] If not NULL, will be the Lambertian phase function.
+                              const realT * t,                     ///< [in] the times at which to calculate the positions
+                              const size_t Nt,                     ///< [in] the number of points contained in t
+                              const orbitPopulation<realT> & pop,  ///< [in] the orbits
+                              const keplerStarterTable<realT> * tab = nullptr ///< [in] [optional] the starter table for the Kepler solver.  If NULL, a default table is used.
+                            )
+{
+   for(size_t k = 0; k < pop.size(); ++k)
+   {
+      if(pop.m_e[k] < 0.0)
+      {
+         std::cerr << "e < 0 in orbitCartesianPopulation\n";
+         return -1;
+      }
+
+      if(pop.m_e[k] == 1.0)
+      {
+         std::cerr << "e = 1 in orbitCartesianPopulation, which is not currently handled.\n";
+         return -1;
+      }
+   }
+
+   if(tab == nullptr)
+   {
+      static const keplerStarterTable<realT> defTab;
+      tab = &defTab;
+   }
+
+   size_t Ntot = pop.size()*Nt;
+   size_t Nb = (Ntot + MX_ASTRO_ORBIT_BATCH - 1)/MX_ASTRO_ORBIT_BATCH;
+
+   //The orientation of each orbit, calculated once
+   std::vector<realT> cos_i(pop.size()), sin_i(pop.size()), cos_W(pop.size()), sin_W(pop.size()), cos_w(pop.size()), sin_w(pop.size());
+
+   #pragma omp parallel
+   {
+      #pragma omp for schedule(static)
+      for(size_t k = 0; k < pop.size(); ++k)
+      {
+         cos_i[k] = cos(pop.m_i[k]);
+         sin_i[k] = sin(pop.m_i[k]);
+         cos_W[k] = cos(pop.m_W[k]);
+         sin_W[k] = sin(pop.m_W[k]);
+         cos_w[k] = cos(pop.m_w[k]);
+         sin_w[k] = sin(pop.m_w[k]);
+      }
+
+      std::vector<realT> M(MX_ASTRO_ORBIT_BATCH);
+      std::vector<realT> e(MX_ASTRO_ORBIT_BATCH);
+      std::vector<realT> E(MX_ASTRO_ORBIT_BATCH);
+
+      #pragma omp for schedule(static)
+      for(size_t b = 0; b < Nb; ++b)
+      {
+         size_t n0 = b*MX_ASTRO_ORBIT_BATCH;
+         size_t nb = Ntot - n0;
+         if(nb > MX_ASTRO_ORBIT_BATCH) nb = MX_ASTRO_ORBIT_BATCH;
+
+         for(size_t n = 0; n < nb; ++n)
+         {
+            size_t k = (n0+n)/Nt;
+            size_t j = (n0+n) - k*Nt;
+
+            M[n] = orbitMeanAnol(t[j], pop.m_t0[k], pop.m_P[k]);
+            e[n] = pop.m_e[k];
+         }
+
+         solve_kepler_batch(E.data(), e.data(), M.data(), nb, *tab);
+
+         for(size_t n = 0; n < nb; ++n)
+         {
+            size_t k = (n0+n)/Nt;
+
+            realT _e = e[n];
+            realT _a = pop.m_a[k];
+            realT _r, cos_f, sin_f;
+
+            if(_e > 1.0)
+            {
+               realT _f = 2.0*std::atan(std::sqrt((_e+1.0)/(_e-1.0))*std::tanh(E[n]/2.0));
+               _r = _a*(1.0-_e*std::cosh(E[n]));
+               cos_f = cos(_f);
+               sin_f = sin(_f);
+               if(f) f[n0+n] = _f;
+            }
+            else
+            {
+               realT cos_E = cos(E[n]);
+               realT sin_E = sin(E[n]);
+               realT ecE = 1.0 - _e*cos_E;
+
+               _r = _a*ecE;
+               cos_f = (cos_E - _e)/ecE;
+               sin_f = std::sqrt(1.0 - _e*_e)*sin_E/ecE;
+               if(f) f[n0+n] = std::atan2(sin_f, cos_f);
+            }
+
+            realT cos_wf = cos_w[k]*cos_f - sin_w[k]*sin_f;
+            realT sin_wf = sin_w[k]*cos_f + cos_w[k]*sin_f;
+
+            realT _x = _r*(cos_W[k]*cos_wf-sin_W[k]*sin_wf*cos_i[k]);
+            realT _y = _r*(sin_W[k]*cos_wf+cos_W[k]*sin_wf*cos_i[k]);
+
+            if(x) x[n0+n] = _x;
+            if(y) y[n0+n] = _y;
+            if(z) z[n0+n] = _r*sin_wf*sin_i[k];
+            if(r) r[n0+n] = _r;
+            if(rProj) rProj[n0+n] = sqrt(_x*_x + _y*_y);
+            if(cos_alf) cos_alf[n0+n] = sin_wf*sin_i[k];
+            if(phi) phi[n0+n] = orbitLambertPhase<realT>(sin_wf*sin_i[k]);
+         }
+      }
+   }
+
+   return 0;
+}
+
+
 } //namespace astro
 } //namespace mx
 
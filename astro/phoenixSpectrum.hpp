@@ -11,6 +11,8 @@
 
 #include "../math/vectorUtils.hpp"
 #include "../ioutils/fileUtils.hpp"
+#include "units.hpp"
+#include "spectrumCache.hpp"
 
 namespace mx
 {
@@ -225,6 +227,28 @@ void rewritePhoenixSpectrumBatch( const std::string & dir,
    }
 }
 
+///Write a spectrumCache file for all rewritten Phoenix spectra in a directory.
+/** The spectra must have been processed with \ref rewritePhoenixSpectrumBatch, so that the wavelength scale is in a separate 'wavelength.dat'
+  * file.  The spectra are indexed by file name, without the directory, which matches astroSpectrum when the PHOENIX_DATADIR environment
+  * variable is set to dir.
+  *
+  * \returns 0 on success
+  * \returns -1 on error
+  *
+  * \ingroup astrophot_spectra
+  */
+template<typename realT>
+int writePhoenixSpectrumCache( const std::string & dir,      ///< [in] the directory containing the spectra
+                               const std::string & cacheFile ///< [in] the path of the cache file to write
+                             )
+{
+   std::vector<std::string> flist = ioutils::getFileNames(dir, "lte", "", ".7");
+
+   for(size_t i=0; i< flist.size(); ++i) flist[i] = ioutils::pathFilename(flist[i]);
+
+   return spectrumCache<realT>::template write<phoenixSpectrum<units::si<realT>>>(cacheFile, flist, dir);
+}
+
 } //namespace astro
 } //namespace mx
 
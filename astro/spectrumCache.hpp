@@ -0,0 +1,564 @@
+/** \file spectrumCache.hpp
+  * \author Jared R. Males
+  * \brief A binary cache for libraries of astronomical spectra.
+  * \ingroup astrophot
+  *
+  */
+
+#ifndef mx_astro_spectrumCache_hpp
+#define mx_astro_spectrumCache_hpp
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../mxError.hpp"
+#include "../sys/environment.hpp"
+#include "../ioutils/fileUtils.hpp"
+#include "../math/gslInterpolation.hpp"
+
+namespace mx
+{
+namespace astro
+{
+
+///A binary cache for a library (or grid) of spectra.
+/** A library of spectra is read once using the spectrum type's readSpectrum, converted to the units of the spectrum type, and written to a single
+  * indexed binary file with \ref write.  Spectra are written one at a time as they are read, so only one is held in memory.  The file is then
+  * memory-mapped by \ref open, so that only the index is read up front and each spectrum is paged in from disk the first time it is accessed.
+  *
+  * Spectra are looked up by name, which is the result of spectrumT::fileName(params), i.e. the same name used by \ref astroSpectrum
+  * to find the file.  Resampling onto a wavelength grid is memoized, so that repeated requests for the same spectrum on the same grid
+  * are only interpolated once.
+  *
+  * The file format is:
+  * - an 8 byte magic string, "MXSPCAC2"
+  * - uint64_t sizeof(realT)
+  * - uint64_t number of spectra
+  * - for each spectrum, an index entry of 5 uint64_t: name offset, name length, wavelength offset, spectrum offset, number of points
+  * - the names, not null terminated, padded to 8 bytes
+  * - for each spectrum, the wavelength points (unless the same as those of the previous spectrum) followed by the spectrum points
+  *
+  * A wavelength grid identical to the one of the previous spectrum is not written again, and the index entry points to the earlier copy.  For
+  * a grid such as PHOENIX, where every spectrum has the same wavelengths, the grid is stored once.
+  *
+  * All offsets are in bytes from the beginning of the file.  The file is written in the native byte order.
+  *
+  * \tparam realT is the floating point type of the spectra.
+  *
+  * \ingroup astrophot
+  */
+template<typename realT>
+class spectrumCache
+{
+protected:
+
+   ///An entry in the spectrum index.
+   struct indexEntry
+   {
+      uint64_t m_nameOffset;     ///< Offset to the name
+      uint64_t m_nameLen;        ///< Length of the name
+      uint64_t m_lambdaOffset;   ///< Offset to the wavelength points, which may be shared with other spectra
+      uint64_t m_spectrumOffset; ///< Offset to the spectrum points
+      uint64_t m_N;              ///< Number of points
+   };
+
+   static constexpr size_t m_hdrSize = 8 + 2*sizeof(uint64_t); ///< The size of the file header, before the index
+
+   static constexpr size_t m_entrySize = 5*sizeof(uint64_t); ///< The size of an index entry in the file
+
+   std::string m_fileName; ///< The path to the currently open cache file.
+
+   int m_fd {-1}; ///< File descriptor of the open cache file
+
+   char * m_map {nullptr}; ///< The memory map of the cache file
+
+   size_t m_mapSize {0}; ///< The size of the memory map
+
+   std::unordered_map<std::string, indexEntry> m_index; ///< The index of spectra, keyed on name
+
+   std::unordered_map<std::string, std::vector<realT>> m_resampled; ///< The memoized resampled spectra, keyed on name and grid hash
+
+public:
+
+   ///Default c'tor
+   spectrumCache();
+
+   ///Constructor which opens a cache file
+   explicit spectrumCache( const std::string & fileName /**< [in] the path to the cache file */);
+
+   ///Destructor, closes the cache file
+   ~spectrumCache();
+
+   spectrumCache( const spectrumCache & ) = delete;
+   spectrumCache & operator=( const spectrumCache & ) = delete;
+
+   ///Write a cache file for a list of spectra
+   /** Each spectrum is read with spectrumT::readSpectrum from dataDir + "/" + spectrumT::fileName(params), and converted to the units
+     * of spectrumT::units as in astroSpectrum::setSpectrum.
+     *
+     * \returns 0 on success
+     * \returns -1 on error
+     */
+   template<typename spectrumT>
+   static int write( const std::string & fileName,                                ///< [in] the path of the cache file to write
+                     const std::vector<typename spectrumT::paramsT> & params,     ///< [in] the parameters of each spectrum to include
+                     const std::string & dataDir = ""                             ///< [in] [optional] the directory containing the spectra.  If empty, the spectrum type's environment variable is used.
+                   );
+
+   ///Open a cache file
+   /** Any currently open file is closed first.
+     *
+     * \returns 0 on success
+     * \returns -1 on error
+     */
+   int open( const std::string & fileName /**< [in] the path to the cache file */);
+
+   ///Close the cache file, and clear the index and memoized spectra.
+   void close();
+
+   ///Get the path of the open cache file
+   /**
+     * \returns the current value of m_fileName
+     */
+   std::string fileName();
+
+   ///Get the number of spectra in the cache
+   /**
+     * \returns the size of the index
+     */
+   size_t size();
+
+   ///Get the names of the spectra in the cache
+   /**
+     * \returns a vector of the names in the index
+     */
+   std::vector<std::string> names();
+
+   ///Check if a spectrum is in the cache
+   /**
+     * \returns true if the spectrum is present
+     * \returns false otherwise
+     */
+   bool has( const std::string & name /**< [in] the name of the spectrum */);
+
+   ///Get a pointer to the raw wavelength and spectrum points of a spectrum
+   /** The pointers are into the read-only memory map, and are valid until the cache is closed.
+     *
+     * \returns 0 on success
+     * \returns -1 if the spectrum is not in the cache
+     */
+   int raw( const realT *& lambda,    ///< [out] pointer to the wavelength points
+            const realT *& spectrum,  ///< [out] pointer to the spectrum points
+            size_t & N,               ///< [out] the number of points
+            const std::string & name  ///< [in] the name of the spectrum
+          );
+
+   ///Get a spectrum interpolated onto a wavelength grid
+   /** The result is memoized, so subsequent calls for the same spectrum and grid are a copy.  As in astroSpectrum::setSpectrum,
+     * linear interpolation is used and non-normal values are set to 0.
+     *
+     * \returns 0 on success
+     * \returns -1 on error
+     */
+   int resample( std::vector<realT> & spectrum,     ///< [out] the interpolated spectrum
+                 const std::string & name,          ///< [in] the name of the spectrum
+                 const std::vector<realT> & lambda  ///< [in] the wavelength grid
+               );
+
+   ///Clear the memoized resampled spectra.
+   void clearResampled();
+
+protected:
+   ///Calculate the key for the memoized resampled spectra
+   std::string resampleKey( const std::string & name,         ///< [in] the name of the spectrum
+                            const std::vector<realT> & lambda ///< [in] the wavelength grid
+                          );
+};
+
+template<typename realT>
+spectrumCache<realT>::spectrumCache()
+{
+}
+
+template<typename realT>
+spectrumCache<realT>::spectrumCache( const std::string & fileName )
+{
+   open(fileName);
+}
+
+template<typename realT>
+spectrumCache<realT>::~spectrumCache()
+{
+   close();
+}
+
+template<typename realT>
+template<typename spectrumT>
+int spectrumCache<realT>::write( const std::string & fileName,
+                                 const std::vector<typename spectrumT::paramsT> & params,
+                                 const std::string & dataDir
+                               )
+{
+   typedef typename spectrumT::units units;
+
+   static_assert( std::is_same<realT, typename units::realT>::value, "spectrumCache: realT must match the spectrum type");
+
+   std::string dir = dataDir;
+   if(dir == "" && spectrumT::dataDirEnvVar)
+   {
+      dir = sys::getEnv(spectrumT::dataDirEnvVar);
+   }
+
+   size_t N = params.size();
+
+   //The names are needed up front to lay out the file, but the spectra are read and written one at a time.
+   std::vector<std::string> names(N);
+   std::vector<indexEntry> index(N);
+
+   uint64_t off = m_hdrSize + N*m_entrySize;
+   for(size_t n = 0; n < N; ++n)
+   {
+      names[n] = spectrumT::fileName(params[n]);
+
+      index[n].m_nameOffset = off;
+      index[n].m_nameLen = names[n].size();
+      off += names[n].size();
+   }
+
+   uint64_t namesEnd = off;
+   off = ((off + 7)/8)*8;
+
+   std::ofstream fout;
+   fout.open(fileName, std::ios::binary);
+   if(!fout.good())
+   {
+      mxError("spectrumCache::write", MXE_FILEOERR, "error opening " + fileName);
+      return -1;
+   }
+
+   uint64_t rsz = sizeof(realT);
+   uint64_t nsp = N;
+
+   fout.write("MXSPCAC2", 8);
+   fout.write( (char *) &rsz, sizeof(rsz));
+   fout.write( (char *) &nsp, sizeof(nsp));
+
+   //A placeholder for the index, which is written once the data offsets are known
+   std::vector<char> zeros(N*m_entrySize, 0);
+   fout.write( zeros.data(), zeros.size());
+
+   for(size_t n = 0; n < N; ++n) fout.write( names[n].data(), names[n].size());
+
+   char pad[8] = {0};
+   fout.write( pad, off - namesEnd);
+
+   std::vector<realT> lambda, spectrum;
+   std::vector<realT> lastLambda;
+   uint64_t lastLambdaOffset = 0;
+
+   for(size_t n = 0; n < N; ++n)
+   {
+      std::string path;
+      if(dir == "" && names[n].size() > 0 && names[n][0] == '/') path = names[n];
+      else if(dir == "") path = "./" + names[n];
+      else path = dir + "/" + names[n];
+
+      lambda.clear();
+      spectrum.clear();
+      if( spectrumT::readSpectrum(lambda, spectrum, path, params[n]) < 0)
+      {
+         mxError("spectrumCache::write", MXE_FILERERR, "error reading " + path);
+         return -1;
+      }
+
+      //Unit conversions, as in astroSpectrum::setSpectrum
+      for(size_t i = 0; i < lambda.size(); ++i)
+      {
+         lambda[i] /= spectrumT::wavelengthUnits/(units::length);
+         spectrum[i] /= spectrumT::fluxUnits/(units::energy/(units::time * units::length * units::length * units::length));
+      }
+
+      index[n].m_N = lambda.size();
+
+      if(n > 0 && lambda == lastLambda)
+      {
+         index[n].m_lambdaOffset = lastLambdaOffset;
+      }
+      else
+      {
+         index[n].m_lambdaOffset = off;
+         fout.write( (char *) lambda.data(), lambda.size()*sizeof(realT));
+         off += lambda.size()*sizeof(realT);
+
+         lastLambda.swap(lambda);
+         lastLambdaOffset = index[n].m_lambdaOffset;
+      }
+
+      index[n].m_spectrumOffset = off;
+      fout.write( (char *) spectrum.data(), spectrum.size()*sizeof(realT));
+      off += spectrum.size()*sizeof(realT);
+
+      if(!fout.good())
+      {
+         mxError("spectrumCache::write", MXE_FILEWERR, "error writing " + fileName);
+         return -1;
+      }
+   }
+
+   //Now go back and fill in the index
+   fout.seekp(m_hdrSize);
+   for(size_t n = 0; n < N; ++n)
+   {
+      fout.write( (char *) &index[n].m_nameOffset, sizeof(uint64_t));
+      fout.write( (char *) &index[n].m_nameLen, sizeof(uint64_t));
+      fout.write( (char *) &index[n].m_lambdaOffset, sizeof(uint64_t));
+      fout.write( (char *) &index[n].m_spectrumOffset, sizeof(uint64_t));
+      fout.write( (char *) &index[n].m_N, sizeof(uint64_t));
+   }
+
+   if(!fout.good())
+   {
+      mxError("spectrumCache::write", MXE_FILEWERR, "error writing " + fileName);
+      return -1;
+   }
+
+   fout.close();
+
+   return 0;
+}
+
+template<typename realT>
+int spectrumCache<realT>::open( const std::string & fileName )
+{
+   close();
+
+   m_fd = ::open(fileName.c_str(), O_RDONLY);
+   if(m_fd < 0)
+   {
+      mxError("spectrumCache::open", MXE_FILEOERR, "error opening " + fileName);
+      return -1;
+   }
+
+   off_t fsz = ioutils::fileSize(m_fd);
+
+   if(fsz < static_cast<off_t>(m_hdrSize))
+   {
+      mxError("spectrumCache::open", MXE_FILERERR, fileName + " is too small to be a spectrum cache");
+      close();
+      return -1;
+   }
+
+   m_mapSize = fsz;
+   void * map = mmap(nullptr, m_mapSize, PROT_READ, MAP_PRIVATE, m_fd, 0);
+
+   if(map == MAP_FAILED)
+   {
+      m_map = nullptr;
+      mxPError("spectrumCache::open", errno, "mmap failed for " + fileName);
+      close();
+      return -1;
+   }
+
+   m_map = (char *) map;
+
+   if(strncmp(m_map, "MXSPCAC2", 8) != 0)
+   {
+      mxError("spectrumCache::open", MXE_FILERERR, fileName + " is not a spectrum cache");
+      close();
+      return -1;
+   }
+
+   uint64_t rsz, nsp;
+   memcpy(&rsz, m_map + 8, sizeof(uint64_t));
+   memcpy(&nsp, m_map + 8 + sizeof(uint64_t), sizeof(uint64_t));
+
+   if(rsz != sizeof(realT))
+   {
+      mxError("spectrumCache::open", MXE_SIZEERR, fileName + " was written with a different floating point type");
+      close();
+      return -1;
+   }
+
+   if( m_hdrSize + nsp*m_entrySize > m_mapSize)
+   {
+      mxError("spectrumCache::open", MXE_FILERERR, fileName + " index is truncated");
+      close();
+      return -1;
+   }
+
+   m_index.reserve(nsp);
+   for(size_t n = 0; n < nsp; ++n)
+   {
+      const char * e = m_map + m_hdrSize + n*m_entrySize;
+
+      indexEntry entry;
+      memcpy(&entry.m_nameOffset, e, sizeof(uint64_t));
+      memcpy(&entry.m_nameLen, e + sizeof(uint64_t), sizeof(uint64_t));
+      memcpy(&entry.m_lambdaOffset, e + 2*sizeof(uint64_t), sizeof(uint64_t));
+      memcpy(&entry.m_spectrumOffset, e + 3*sizeof(uint64_t), sizeof(uint64_t));
+      memcpy(&entry.m_N, e + 4*sizeof(uint64_t), sizeof(uint64_t));
+
+      if( entry.m_nameOffset + entry.m_nameLen > m_mapSize || entry.m_lambdaOffset + entry.m_N*sizeof(realT) > m_mapSize ||
+                                                               entry.m_spectrumOffset + entry.m_N*sizeof(realT) > m_mapSize )
+      {
+         mxError("spectrumCache::open", MXE_FILERERR, fileName + " is truncated");
+         close();
+         return -1;
+      }
+
+      m_index[std::string(m_map + entry.m_nameOffset, entry.m_nameLen)] = entry;
+   }
+
+   m_fileName = fileName;
+
+   return 0;
+}
+
+template<typename realT>
+void spectrumCache<realT>::close()
+{
+   if(m_map) munmap(m_map, m_mapSize);
+   m_map = nullptr;
+   m_mapSize = 0;
+
+   if(m_fd >= 0) ::close(m_fd);
+   m_fd = -1;
+
+   m_fileName = "";
+   m_index.clear();
+   m_resampled.clear();
+}
+
+template<typename realT>
+std::string spectrumCache<realT>::fileName()
+{
+   return m_fileName;
+}
+
+template<typename realT>
+size_t spectrumCache<realT>::size()
+{
+   return m_index.size();
+}
+
+template<typename realT>
+std::vector<std::string> spectrumCache<realT>::names()
+{
+   std::vector<std::string> nms;
+   nms.reserve(m_index.size());
+
+   for(auto it = m_index.begin(); it != m_index.end(); ++it) nms.push_back(it->first);
+
+   return nms;
+}
+
+template<typename realT>
+bool spectrumCache<realT>::has( const std::string & name )
+{
+   return (m_index.count(name) > 0);
+}
+
+template<typename realT>
+int spectrumCache<realT>::raw( const realT *& lambda,
+                               const realT *& spectrum,
+                               size_t & N,
+                               const std::string & name
+                             )
+{
+   auto it = m_index.find(name);
+
+   if(it == m_index.end())
+   {
+      mxError("spectrumCache::raw", MXE_PARAMNOTSET, name + " is not in the cache");
+      return -1;
+   }
+
+   N = it->second.m_N;
+   lambda = (const realT *) (m_map + it->second.m_lambdaOffset);
+   spectrum = (const realT *) (m_map + it->second.m_spectrumOffset);
+
+   return 0;
+}
+
+template<typename realT>
+int spectrumCache<realT>::resample( std::vector<realT> & spectrum,
+                                    const std::string & name,
+                                    const std::vector<realT> & lambda
+                                  )
+{
+   std::string key = resampleKey(name, lambda);
+
+   bool found = false;
+
+   #pragma omp critical(mx_astro_spectrumCache)
+   {
+      auto it = m_resampled.find(key);
+      if(it != m_resampled.end())
+      {
+         spectrum = it->second;
+         found = true;
+      }
+   }
+
+   if(found) return 0;
+
+   const realT * rawLambda;
+   const realT * rawSpectrum;
+   size_t N;
+
+   if(raw(rawLambda, rawSpectrum, N, name) < 0) return -1;
+
+   spectrum.resize(lambda.size());
+
+   //gsl_interpolate does not modify its inputs, which are in a read-only map
+   math::gsl_interpolate(::gsl_interp_linear, const_cast<realT *>(rawLambda), const_cast<realT *>(rawSpectrum), N,
+                                              const_cast<realT *>(lambda.data()), spectrum.data(), lambda.size());
+
+   for(size_t i = 0; i < lambda.size(); ++i)
+   {
+      if( !std::isnormal(spectrum[i])) spectrum[i] = 0;
+   }
+
+   #pragma omp critical(mx_astro_spectrumCache)
+   m_resampled[key] = spectrum;
+
+   return 0;
+}
+
+template<typename realT>
+void spectrumCache<realT>::clearResampled()
+{
+   m_resampled.clear();
+}
+
+template<typename realT>
+std::string spectrumCache<realT>::resampleKey( const std::string & name,
+                                               const std::vector<realT> & lambda
+                                             )
+{
+   //FNV-1a hash of the grid
+   uint64_t h = 14695981039346656037ULL;
+
+   const unsigned char * b = (const unsigned char *) lambda.data();
+   for(size_t i = 0; i < lambda.size()*sizeof(realT); ++i)
+   {
+      h ^= b[i];
+      h *= 1099511628211ULL;
+   }
+
+   return name + '\n' + std::to_string(lambda.size()) + '\n' + std::to_string(h);
+}
+
+} //namespace astro
+} //namespace mx
+
+#endif //mx_astro_spectrumCache_hpp
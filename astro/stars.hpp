@@ -12,6 +12,9 @@
 #ifndef mx_astro_stars_hpp
 #define mx_astro_stars_hpp
 
+#include <algorithm>
+#include <unordered_map>
+
 #include "../ioutils/stringUtils.hpp"
 #include "../ioutils/readColumns.hpp"
 
@@ -162,6 +165,26 @@ struct mainSequence
    double m_minSpTfmT; ///< The minimum numeric spectral type for effective Temperature
    double m_maxSpTfmT; ///< The maximum numeric spectral type for effective Temperature
    
+   /** \name Lookup Tables
+     * The sequence sampled on a uniform grid of numeric spectral type, used by the batch queries.  The sequence is
+     * tabulated at multiples of 0.5 in numeric type, so linear interpolation on these tables reproduces the interpolators.
+     * @{
+     */
+   realT m_tab0 {0}; ///< The numeric type of the first table point
+   realT m_tabStep {0.5}; ///< The spacing of the tables in numeric type
+   std::vector<realT> m_tabT; ///< Table of effective temperature
+   std::vector<realT> m_tabRad; ///< Table of radius
+   std::vector<realT> m_tabL; ///< Table of log luminosity
+   std::vector<realT> m_tabMv; ///< Table of absolute V magnitude
+   std::vector<realT> m_tabVRc; ///< Table of V-Rc color
+   std::vector<realT> m_tabVIc; ///< Table of V-Ic color
+   std::vector<realT> m_tabVKs; ///< Table of V-Ks color
+   std::vector<realT> m_tabJH; ///< Table of J-H color
+   std::vector<realT> m_tabHKs; ///< Table of H-Ks color
+   ///@}
+   
+   std::unordered_map<std::string, realT> m_spTypeCache; ///< Cache of parsed spectral type strings
+   
    void findMinMax( std::vector<double> & seq,
                     double & min,
                     double & max,
@@ -238,6 +261,109 @@ struct mainSequence
       interpHKs.setup( m_numTypes, m_H_Kss );
       
       interpSpTfmT.setup( m_TeffsR, m_numTypesR);
+      
+      m_tab0 = m_numTypes[0];
+      makeTable(m_tabT, m_Teffs);
+      makeTable(m_tabRad, m_rads);
+      makeTable(m_tabL, m_logLs);
+      makeTable(m_tabMv, m_Mvs);
+      makeTable(m_tabVRc, m_V_Rcs);
+      makeTable(m_tabVIc, m_V_Ics);
+      makeTable(m_tabVKs, m_V_Kss);
+      makeTable(m_tabJH, m_J_Hs);
+      makeTable(m_tabHKs, m_H_Kss);
+   }
+   
+   /// Linearly resample a column of the sequence onto the uniform table grid
+   void makeTable( std::vector<realT> & tab,       ///< [out] the table
+                   const std::vector<double> & seq ///< [in] the column of the sequence
+                 )
+   {
+      size_t N = (m_numTypes.back() - m_tab0)/m_tabStep + 1.5;
+      tab.resize(N);
+      
+      size_t j = 0;
+      for(size_t n = 0; n < N; ++n)
+      {
+         double x = m_tab0 + n*m_tabStep;
+         while(j < m_numTypes.size()-2 && m_numTypes[j+1] < x) ++j;
+         
+         double t = (x - m_numTypes[j])/(m_numTypes[j+1]-m_numTypes[j]);
+         tab[n] = seq[j] + t*(seq[j+1]-seq[j]);
+      }
+   }
+   
+   /// Interpolate a table for a batch of numeric spectral types
+   void tableLookup( realT * out,                   ///< [out] the interpolated values, -999 where out of range
+                     const realT * numTypes,        ///< [in] the numeric spectral type codes
+                     size_t N,                      ///< [in] the number of points
+                     const std::vector<realT> & tab, ///< [in] the table
+                     double min,                    ///< [in] the minimum valid numeric type
+                     double max                     ///< [in] the maximum valid numeric type
+                   )
+   {
+      const realT * tb = tab.data();
+      realT x0 = m_tab0;
+      realT xN = m_tab0 + (tab.size()-1)*m_tabStep;
+      realT idx = 1.0/m_tabStep;
+      long imax = tab.size() - 2;
+      
+      #pragma omp simd
+      for(size_t k = 0; k < N; ++k)
+      {
+         realT x = numTypes[k];
+         bool valid = (x >= min && x <= max);
+         
+         x = (x < x0) ? x0 : x;
+         x = (x > xN) ? xN : x;
+         
+         realT t = (x - x0)*idx;
+         long i = t;
+         i = (i > imax) ? imax : i;
+         t -= i;
+         
+         realT v = tb[i] + t*(tb[i+1] - tb[i]);
+         out[k] = valid ? v : static_cast<realT>(-999);
+      }
+   }
+   
+   /// Get the numeric spectral type code for a spectral type string, using the cache.
+   /** Parses with \ref mx::astro::numSpType() on the first call for each string.
+     *
+     * \returns the numeric spectral type code
+     */
+   realT numType( const std::string & spType /**< [in] the spectral type in standard format */)
+   {
+      realT num;
+      bool found = false;
+      
+      #pragma omp critical(mx_astro_mainSequence_spTypeCache)
+      {
+         auto it = m_spTypeCache.find(spType);
+         if(it != m_spTypeCache.end())
+         {
+            num = it->second;
+            found = true;
+         }
+      }
+      
+      if(found) return num;
+      
+      num = numSpType(spType);
+      
+      #pragma omp critical(mx_astro_mainSequence_spTypeCache)
+      m_spTypeCache[spType] = num;
+      
+      return num;
+   }
+   
+   /// Get the numeric spectral type codes for a batch of spectral type strings, using the cache.
+   void numTypes( std::vector<realT> & nums,               ///< [out] the numeric spectral type codes
+                  const std::vector<std::string> & spTypes ///< [in] the spectral types in standard format
+                )
+   {
+      nums.resize(spTypes.size());
+      for(size_t k = 0; k < spTypes.size(); ++k) nums[k] = numType(spTypes[k]);
    }
    
    /// Get the interpolated effective temperature
@@ -262,7 +388,7 @@ struct mainSequence
      */ 
    realT Teff( const std::string & spType /**< [in] the spectral type in standard format */)
    {
-      return Teff(  numSpType(spType));
+      return Teff(  numType(spType));
    }
    
    /// Get the interpolated radius
@@ -287,7 +413,7 @@ struct mainSequence
      */ 
    realT radius( const std::string & spType /**< [in] the spectral type in standard format */)
    {
-      return radius(  numSpType(spType));
+      return radius(  numType(spType));
    }
    
    /// Get the interpolated log of luminosity
@@ -312,7 +438,7 @@ struct mainSequence
      */
    realT logL( const std::string & spType /**< [in] the spectral type in standard format */)
    {
-      return logL(  numSpType(spType));
+      return logL(  numType(spType));
    }
    
    /// Get the interpolated absolute V magnitude
@@ -337,7 +463,7 @@ struct mainSequence
      */ 
    realT Mv( const std::string & spType /**< [in] the spectral type in standard format */)
    {
-      return Mv(  numSpType(spType));
+      return Mv(  numType(spType));
    }
    
    /// Get the interpolated absolute V-Rc color
@@ -362,7 +488,7 @@ struct mainSequence
      */ 
    realT V_Rc( const std::string & spType /**< [in] the spectral type in standard format */)
    {
-      return V_Rc(  numSpType(spType));
+      return V_Rc(  numType(spType));
    }
    
    /// Get the interpolated absolute V-Ic color
@@ -387,7 +513,7 @@ struct mainSequence
      */
    realT V_Ic( const std::string & spType /**< [in] the spectral type in standard format */)
    {
-      return V_Ic(  numSpType(spType));
+      return V_Ic(  numType(spType));
    }
    
    /// Get the interpolated absolute V-Ks color
@@ -412,7 +538,7 @@ struct mainSequence
      */ 
    realT V_Ks( const std::string & spType /**< [in] the spectral type in standard format */)
    {
-      return V_Ks(  numSpType(spType));
+      return V_Ks(  numType(spType));
    }
    
    /// Get the interpolated absolute J-H color
@@ -437,7 +563,7 @@ struct mainSequence
      */
    realT J_H( const std::string & spType /**< [in] the spectral type in standard format */)
    {
-      return J_H(  numSpType(spType));
+      return J_H(  numType(spType));
    }
    
    /// Get the interpolated absolute H-Ks color
@@ -462,13 +588,220 @@ struct mainSequence
      */
    realT H_Ks( const std::string & spType /**< [in] the spectral type in standard format */)
    {
-      return H_Ks(  numSpType(spType));/// Get the interpolated absolute H-Ks color
+      return H_Ks(  numType(spType));/// Get the interpolated absolute H-Ks color
    /**
      * \returns the aboslute H-Ks color
      * \returns -999 if the input type code is out of range.
      */
    }
    
+   /// Get the interpolated effective temperatures for a batch of numeric spectral types
+   /** Values are -999 where the input type code is out of range.
+     */
+   void Teff( std::vector<realT> & vals,           ///< [out] the effective temperatures
+            const std::vector<realT> & numTypes  ///< [in] the numeric spectral type codes, see \ref mx::astro::numSpType()
+          )
+   {
+      vals.resize(numTypes.size());
+      tableLookup(vals.data(), numTypes.data(), numTypes.size(), m_tabT, m_minT, m_maxT);
+   }
+   
+   /// Get the interpolated effective temperatures for a batch of spectral types
+   /** Values are -999 where the input type is out of range.
+     */
+   void Teff( std::vector<realT> & vals,                 ///< [out] the effective temperatures
+            const std::vector<std::string> & spTypes   ///< [in] the spectral types in standard format
+          )
+   {
+      std::vector<realT> nums;
+      numTypes(nums, spTypes);
+      Teff(vals, nums);
+   }
+   
+   /// Get the interpolated radii, in Solar units for a batch of numeric spectral types
+   /** Values are -999 where the input type code is out of range.
+     */
+   void radius( std::vector<realT> & vals,           ///< [out] the radii, in Solar units
+            const std::vector<realT> & numTypes  ///< [in] the numeric spectral type codes, see \ref mx::astro::numSpType()
+          )
+   {
+      vals.resize(numTypes.size());
+      tableLookup(vals.data(), numTypes.data(), numTypes.size(), m_tabRad, m_minRad, m_maxRad);
+   }
+   
+   /// Get the interpolated radii, in Solar units for a batch of spectral types
+   /** Values are -999 where the input type is out of range.
+     */
+   void radius( std::vector<realT> & vals,                 ///< [out] the radii, in Solar units
+            const std::vector<std::string> & spTypes   ///< [in] the spectral types in standard format
+          )
+   {
+      std::vector<realT> nums;
+      numTypes(nums, spTypes);
+      radius(vals, nums);
+   }
+   
+   /// Get the interpolated logs of luminosity for a batch of numeric spectral types
+   /** Values are -999 where the input type code is out of range.
+     */
+   void logL( std::vector<realT> & vals,           ///< [out] the logs of luminosity
+            const std::vector<realT> & numTypes  ///< [in] the numeric spectral type codes, see \ref mx::astro::numSpType()
+          )
+   {
+      vals.resize(numTypes.size());
+      tableLookup(vals.data(), numTypes.data(), numTypes.size(), m_tabL, m_minL, m_maxL);
+   }
+   
+   /// Get the interpolated logs of luminosity for a batch of spectral types
+   /** Values are -999 where the input type is out of range.
+     */
+   void logL( std::vector<realT> & vals,                 ///< [out] the logs of luminosity
+            const std::vector<std::string> & spTypes   ///< [in] the spectral types in standard format
+          )
+   {
+      std::vector<realT> nums;
+      numTypes(nums, spTypes);
+      logL(vals, nums);
+   }
+   
+   /// Get the interpolated absolute V magnitudes for a batch of numeric spectral types
+   /** Values are -999 where the input type code is out of range.
+     */
+   void Mv( std::vector<realT> & vals,           ///< [out] the absolute V magnitudes
+            const std::vector<realT> & numTypes  ///< [in] the numeric spectral type codes, see \ref mx::astro::numSpType()
+          )
+   {
+      vals.resize(numTypes.size());
+      tableLookup(vals.data(), numTypes.data(), numTypes.size(), m_tabMv, m_minMv, m_maxMv);
+   }
+   
+   /// Get the interpolated absolute V magnitudes for a batch of spectral types
+   /** Values are -999 where the input type is out of range.
+     */
+   void Mv( std::vector<realT> & vals,                 ///< [out] the absolute V magnitudes
+            const std::vector<std::string> & spTypes   ///< [in] the spectral types in standard format
+          )
+   {
+      std::vector<realT> nums;
+      numTypes(nums, spTypes);
+      Mv(vals, nums);
+   }
+   
+   /// Get the interpolated V-Rc colors for a batch of numeric spectral types
+   /** Values are -999 where the input type code is out of range.
+     */
+   void V_Rc( std::vector<realT> & vals,           ///< [out] the V-Rc colors
+            const std::vector<realT> & numTypes  ///< [in] the numeric spectral type codes, see \ref mx::astro::numSpType()
+          )
+   {
+      vals.resize(numTypes.size());
+      tableLookup(vals.data(), numTypes.data(), numTypes.size(), m_tabVRc, m_minVRc, m_maxVRc);
+   }
+   
+   /// Get the interpolated V-Rc colors for a batch of spectral types
+   /** Values are -999 where the input type is out of range.
+     */
+   void V_Rc( std::vector<realT> & vals,                 ///< [out] the V-Rc colors
+            const std::vector<std::string> & spTypes   ///< [in] the spectral types in standard format
+          )
+   {
+      std::vector<realT> nums;
+      numTypes(nums, spTypes);
+      V_Rc(vals, nums);
+   }
+   
+   /// Get the interpolated V-Ic colors for a batch of numeric spectral types
+   /** Values are -999 where the input type code is out of range.
+     */
+   void V_Ic( std::vector<realT> & vals,           ///< [out] the V-Ic colors
+            const std::vector<realT> & numTypes  ///< [in] the numeric spectral type codes, see \ref mx::astro::numSpType()
+          )
+   {
+      vals.resize(numTypes.size());
+      tableLookup(vals.data(), numTypes.data(), numTypes.size(), m_tabVIc, m_minVIc, m_maxVIc);
+   }
+   
+   /// Get the interpolated V-Ic colors for a batch of spectral types
+   /** Values are -999 where the input type is out of range.
+     */
+   void V_Ic( std::vector<realT> & vals,                 ///< [out] the V-Ic colors
+            const std::vector<std::string> & spTypes   ///< [in] the spectral types in standard format
+          )
+   {
+      std::vector<realT> nums;
+      numTypes(nums, spTypes);
+      V_Ic(vals, nums);
+   }
+   
+   /// Get the interpolated V-Ks colors for a batch of numeric spectral types
+   /** Values are -999 where the input type code is out of range.
+     */
+   void V_Ks( std::vector<realT> & vals,           ///< [out] the V-Ks colors
+            const std::vector<realT> & numTypes  ///< [in] the numeric spectral type codes, see \ref mx::astro::numSpType()
+          )
+   {
+      vals.resize(numTypes.size());
+      tableLookup(vals.data(), numTypes.data(), numTypes.size(), m_tabVKs, m_minVKs, m_maxVKs);
+   }
+   
+   /// Get the interpolated V-Ks colors for a batch of spectral types
+   /** Values are -999 where the input type is out of range.
+     */
+   void V_Ks( std::vector<realT> & vals,                 ///< [out] the V-Ks colors
+            const std::vector<std::string> & spTypes   ///< [in] the spectral types in standard format
+          )
+   {
+      std::vector<realT> nums;
+      numTypes(nums, spTypes);
+      V_Ks(vals, nums);
+   }
+   
+   /// Get the interpolated J-H colors for a batch of numeric spectral types
+   /** Values are -999 where the input type code is out of range.
+     */
+   void J_H( std::vector<realT> & vals,           ///< [out] the J-H colors
+            const std::vector<realT> & numTypes  ///< [in] the numeric spectral type codes, see \ref mx::astro::numSpType()
+          )
+   {
+      vals.resize(numTypes.size());
+      tableLookup(vals.data(), numTypes.data(), numTypes.size(), m_tabJH, m_minJH, m_maxJH);
+   }
+   
+   /// Get the interpolated J-H colors for a batch of spectral types
+   /** Values are -999 where the input type is out of range.
+     */
+   void J_H( std::vector<realT> & vals,                 ///< [out] the J-H colors
+            const std::vector<std::string> & spTypes   ///< [in] the spectral types in standard format
+          )
+   {
+      std::vector<realT> nums;
+      numTypes(nums, spTypes);
+      J_H(vals, nums);
+   }
+   
+   /// Get the interpolated H-Ks colors for a batch of numeric spectral types
+   /** Values are -999 where the input type code is out of range.
+     */
+   void H_Ks( std::vector<realT> & vals,           ///< [out] the H-Ks colors
+            const std::vector<realT> & numTypes  ///< [in] the numeric spectral type codes, see \ref mx::astro::numSpType()
+          )
+   {
+      vals.resize(numTypes.size());
+      tableLookup(vals.data(), numTypes.data(), numTypes.size(), m_tabHKs, m_minHKs, m_maxHKs);
+   }
+   
+   /// Get the interpolated H-Ks colors for a batch of spectral types
+   /** Values are -999 where the input type is out of range.
+     */
+   void H_Ks( std::vector<realT> & vals,                 ///< [out] the H-Ks colors
+            const std::vector<std::string> & spTypes   ///< [in] the spectral types in standard format
+          )
+   {
+      std::vector<realT> nums;
+      numTypes(nums, spTypes);
+      H_Ks(vals, nums);
+   }
+   
    realT spTFromTeff( realT Teff )
    {
       if( Teff < m_minSpTfmT || Teff > m_maxSpTfmT)
@@ -479,6 +812,34 @@ struct mainSequence
       return floor(2*interpSpTfmT(Teff)+0.5)/2; //round to nearest 0.5 types.
    }
    
+   /// Get the numeric spectral type for a batch of effective temperatures, rounded to the nearest 0.5 types.
+   /** Values are -999 where the temperature is out of range.
+     */
+   void spTFromTeff( std::vector<realT> & spTs,        ///< [out] the numeric spectral type codes
+                     const std::vector<realT> & Teffs  ///< [in] the effective temperatures
+                   )
+   {
+      spTs.resize(Teffs.size());
+      
+      for(size_t k = 0; k < Teffs.size(); ++k)
+      {
+         realT T = Teffs[k];
+         if( T < m_minSpTfmT || T > m_maxSpTfmT)
+         {
+            spTs[k] = -999;
+            continue;
+         }
+         
+         //m_TeffsR is ascending
+         size_t j = std::upper_bound(m_TeffsR.begin(), m_TeffsR.end(), T) - m_TeffsR.begin();
+         if(j < 1) j = 1;
+         if(j > m_TeffsR.size()-1) j = m_TeffsR.size()-1;
+         
+         realT t = (T - m_TeffsR[j-1])/(m_TeffsR[j]-m_TeffsR[j-1]);
+         spTs[k] = floor(2*(m_numTypesR[j-1] + t*(m_numTypesR[j]-m_numTypesR[j-1]))+0.5)/2;
+      }
+   }
+   
 };
 
 
@@ -0,0 +1,161 @@
+/** \file bench.hpp
+  * \author Jared R. Males
+  * \brief A minimal harness for the mxlib benchmark suite
+  *
+  */
+
+//***********************************************************************//
+// Copyright 2023 Jared R. Males (jaredmales@gmail.com)
+//
+// This file is part of mxlib.
+//
+// mxlib is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// mxlib is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with mxlib.  If not, see <http://www.gnu.org/licenses/>.
+//***********************************************************************//
+
+#ifndef mxlib_bench_hpp
+#define mxlib_bench_hpp
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace mx
+{
+namespace bench
+{
+
+/// The timing results of one benchmark
+struct benchResult
+{
+   std::string m_name;   ///< The benchmark name
+   size_t m_samples {0}; ///< The number of timed samples
+   size_t m_iters {0};   ///< The number of calls per sample
+   double m_median {0};  ///< The median time per call [ns]
+   double m_mean {0};    ///< The mean time per call [ns]
+   double m_min {0};     ///< The minimum time per call [ns]
+   double m_stddev {0};  ///< The standard deviation of the time per call [ns]
+};
+
+/// The state passed to each benchmark function
+/** A benchmark does its setup, then calls run() with the code to be timed.  run() calibrates the number of
+  * calls per sample so that each sample lasts at least m_minSampleTime, and collects m_samples samples.
+  */
+class benchState
+{
+public:
+   size_t m_samples {11};          ///< The number of samples to collect
+   double m_minSampleTime {0.02};  ///< The minimum duration of one sample [s]
+
+   benchResult m_result; ///< The result of the last call to run()
+
+   /// Time a callable
+   template<typename funcT>
+   void run( funcT && func /**< [in] the code to time, called with no arguments */)
+   {
+      typedef std::chrono::steady_clock clockT;
+
+      //Warm up, which also allocates any lazily allocated memory
+      func();
+
+      //Calibrate
+      size_t iters = 1;
+      while(true)
+      {
+         clockT::time_point t0 = clockT::now();
+         for(size_t n = 0; n < iters; ++n) func();
+         double dt = std::chrono::duration<double>(clockT::now() - t0).count();
+
+         if(dt >= m_minSampleTime || iters >= (1ul << 30)) break;
+
+         //Aim 20% past the target to avoid repeated recalibration
+         size_t niters = (dt > 0) ? static_cast<size_t>(1.2 * iters * m_minSampleTime / dt) + 1 : iters * 10;
+         iters = std::max(niters, iters + 1);
+      }
+
+      std::vector<double> times(m_samples);
+
+      for(size_t s = 0; s < m_samples; ++s)
+      {
+         clockT::time_point t0 = clockT::now();
+         for(size_t n = 0; n < iters; ++n) func();
+         times[s] = std::chrono::duration<double, std::nano>(clockT::now() - t0).count() / iters;
+      }
+
+      m_result.m_samples = m_samples;
+      m_result.m_iters = iters;
+
+      double sum = 0;
+      for(size_t s = 0; s < times.size(); ++s) sum += times[s];
+      m_result.m_mean = sum / times.size();
+
+      double ss = 0;
+      for(size_t s = 0; s < times.size(); ++s) ss += pow(times[s] - m_result.m_mean, 2);
+      m_result.m_stddev = (times.size() > 1) ? sqrt(ss / (times.size()-1)) : 0;
+
+      std::sort(times.begin(), times.end());
+      m_result.m_min = times[0];
+      m_result.m_median = (times.size() % 2 == 1) ? times[times.size()/2] : 0.5*(times[times.size()/2-1] + times[times.size()/2]);
+   }
+};
+
+/// The type of a benchmark function
+typedef void (*benchFuncT)( benchState & );
+
+/// A registered benchmark
+struct benchEntry
+{
+   std::string m_name;  ///< The benchmark name, as subsystem.component.case
+   benchFuncT m_func;   ///< The benchmark function
+};
+
+/// Get the list of registered benchmarks
+inline
+std::vector<benchEntry> & registry()
+{
+   static std::vector<benchEntry> reg;
+   return reg;
+}
+
+/// Registers a benchmark on construction
+struct benchRegistrar
+{
+   benchRegistrar( const char * name,
+                   benchFuncT func
+                 )
+   {
+      registry().push_back({name, func});
+   }
+};
+
+} //namespace bench
+} //namespace mx
+
+/// Define and register a benchmark
+/** Usage:
+  * \code
+  * MX_BENCH(improc_myFunc, "improc.myFunc.256x256")
+  * {
+  *    //setup
+  *    state.run([&](){ myFunc(im); });
+  * }
+  * \endcode
+  */
+#define MX_BENCH( id, name ) \
+   static void id ## _bench( mx::bench::benchState & state ); \
+   static mx::bench::benchRegistrar id ## _registrar( name, id ## _bench ); \
+   static void id ## _bench( mx::bench::benchState & state )
+
+#endif //mxlib_bench_hpp
@@ -0,0 +1,121 @@
+/** \file benchCompare.cpp
+  * \author Jared R. Males
+  * \brief Compares two mxlib benchmark results files and flags regressions
+  *
+  * Usage:
+  * \verbatim
+  * benchCompare baseline.txt current.txt [threshold]
+  * \endverbatim
+  *
+  * A benchmark is flagged as a regression if its median time increased by more than threshold (a fraction,
+  * default 0.10), and its minimum time increased by more than half of threshold.  Requiring both makes the
+  * comparison robust against a few noisy samples.  Improvements are flagged with the same rule in reverse.
+  *
+  * \returns 0 if there are no regressions
+  * \returns 1 if any benchmark regressed
+  * \returns -1 on error
+  */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+
+#include "../include/ioutils/readColumns.hpp"
+
+/// The columns of a results file needed for comparison
+struct benchTimes
+{
+   double m_median {0};
+   double m_min {0};
+};
+
+int readResults( std::map<std::string, benchTimes> & res,
+                 const std::string & fname
+               )
+{
+   std::vector<std::string> names;
+   std::vector<double> median, mins;
+   mx::ioutils::skipCol sk;
+
+   if(mx::ioutils::readColumns(fname, names, sk, sk, median, sk, mins) < 0) return -1;
+
+   if(median.size() != names.size() || mins.size() != names.size())
+   {
+      std::cerr << "benchCompare: " << fname << " is not a benchmark results file\n";
+      return -1;
+   }
+
+   for(size_t n = 0; n < names.size(); ++n)
+   {
+      res[names[n]].m_median = median[n];
+      res[names[n]].m_min = mins[n];
+   }
+
+   return 0;
+}
+
+int main( int argc,
+          char ** argv
+        )
+{
+   if(argc < 3 || argc > 4)
+   {
+      std::cerr << "usage: " << argv[0] << " baseline.txt current.txt [threshold]\n";
+      return -1;
+   }
+
+   double thresh = 0.10;
+   if(argc == 4) thresh = atof(argv[3]);
+
+   std::map<std::string, benchTimes> base, curr;
+
+   if(readResults(base, argv[1]) < 0) return -1;
+   if(readResults(curr, argv[2]) < 0) return -1;
+
+   int nreg = 0;
+   int nimp = 0;
+
+   printf("%-48s %14s %14s %8s\n", "benchmark", "baseline [ms]", "current [ms]", "ratio");
+
+   for(auto it = curr.begin(); it != curr.end(); ++it)
+   {
+      auto bit = base.find(it->first);
+
+      if(bit == base.end())
+      {
+         printf("%-48s %14s %14.4f %8s  new\n", it->first.c_str(), "-", it->second.m_median/1e6, "-");
+         continue;
+      }
+
+      double ratio = it->second.m_median / bit->second.m_median;
+      double minRatio = it->second.m_min / bit->second.m_min;
+
+      const char * flag = "";
+
+      if(ratio > 1 + thresh && minRatio > 1 + 0.5*thresh)
+      {
+         flag = "  REGRESSION";
+         ++nreg;
+      }
+      else if(ratio < 1.0/(1 + thresh) && minRatio < 1.0/(1 + 0.5*thresh))
+      {
+         flag = "  improved";
+         ++nimp;
+      }
+
+      printf("%-48s %14.4f %14.4f %8.3f%s\n", it->first.c_str(), bit->second.m_median/1e6, it->second.m_median/1e6, ratio, flag);
+   }
+
+   for(auto bit = base.begin(); bit != base.end(); ++bit)
+   {
+      if(curr.count(bit->first) == 0)
+      {
+         printf("%-48s %14.4f %14s %8s  missing\n", bit->first.c_str(), bit->second.m_median/1e6, "-", "-");
+      }
+   }
+
+   printf("\n%d regression(s), %d improvement(s) at threshold %g\n", nreg, nimp, thresh);
+
+   return (nreg > 0) ? 1 : 0;
+}
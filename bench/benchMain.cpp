@@ -0,0 +1,115 @@
+/** \file benchMain.cpp
+  * \author Jared R. Males
+  * \brief Runs the registered mxlib benchmarks and writes a results table
+  *
+  * Usage:
+  * \verbatim
+  * mxlibBench [-l] [-f filter] [-o results.txt] [-s samples] [-t minSampleTime]
+  * \endverbatim
+  * - -l lists the benchmarks and exits
+  * - -f runs only benchmarks whose name contains filter
+  * - -o writes the results to a file instead of stdout
+  * - -s sets the number of samples per benchmark (default 11)
+  * - -t sets the minimum duration of one sample in seconds (default 0.02)
+  *
+  * The results are written as whitespace-delimited columns, with comment lines starting with #, so they can
+  * be read with mx::ioutils::readColumns.  Use benchCompare to compare two results files.
+  */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "bench.hpp"
+#include "../include/mxlib_uncomp_version.h"
+
+int main( int argc,
+          char ** argv
+        )
+{
+   std::string filter;
+   std::string outFile;
+   bool list = false;
+
+   mx::bench::benchState state;
+
+   for(int n = 1; n < argc; ++n)
+   {
+      if(strcmp(argv[n], "-l") == 0) list = true;
+      else if(strcmp(argv[n], "-f") == 0 && n + 1 < argc) filter = argv[++n];
+      else if(strcmp(argv[n], "-o") == 0 && n + 1 < argc) outFile = argv[++n];
+      else if(strcmp(argv[n], "-s") == 0 && n + 1 < argc) state.m_samples = atoi(argv[++n]);
+      else if(strcmp(argv[n], "-t") == 0 && n + 1 < argc) state.m_minSampleTime = atof(argv[++n]);
+      else
+      {
+         std::cerr << "usage: " << argv[0] << " [-l] [-f filter] [-o results.txt] [-s samples] [-t minSampleTime]\n";
+         return -1;
+      }
+   }
+
+   if(state.m_samples < 1) state.m_samples = 1;
+
+   std::vector<mx::bench::benchEntry> & reg = mx::bench::registry();
+
+   std::sort(reg.begin(), reg.end(), [](const mx::bench::benchEntry & a, const mx::bench::benchEntry & b){ return a.m_name < b.m_name; });
+
+   if(list)
+   {
+      for(size_t n = 0; n < reg.size(); ++n) std::cout << reg[n].m_name << "\n";
+      return 0;
+   }
+
+   FILE * fout = stdout;
+   if(outFile != "")
+   {
+      fout = fopen(outFile.c_str(), "w");
+      if(fout == nullptr)
+      {
+         perror(("mxlibBench: opening " + outFile).c_str());
+         return -1;
+      }
+   }
+
+   char tstr[64];
+   time_t tnow = time(nullptr);
+   strftime(tstr, sizeof(tstr), "%Y-%m-%dT%H:%M:%SZ", gmtime(&tnow));
+
+   int nthreads = 1;
+   #ifdef _OPENMP
+   nthreads = omp_get_max_threads();
+   #endif
+
+   fprintf(fout, "# mxlib benchmark results\n");
+   fprintf(fout, "# sha1: %s%s\n", MXLIB_UNCOMP_CURRENT_SHA1, MXLIB_UNCOMP_REPO_MODIFIED ? " (modified)" : "");
+   fprintf(fout, "# date: %s\n", tstr);
+   fprintf(fout, "# threads: %d\n", nthreads);
+   fprintf(fout, "# name samples iters median_ns mean_ns min_ns stddev_ns\n");
+   fflush(fout);
+
+   for(size_t n = 0; n < reg.size(); ++n)
+   {
+      if(filter != "" && reg[n].m_name.find(filter) == std::string::npos) continue;
+
+      std::cerr << reg[n].m_name << " ... " << std::flush;
+
+      state.m_result = mx::bench::benchResult();
+      reg[n].m_func(state);
+
+      const mx::bench::benchResult & r = state.m_result;
+
+      fprintf(fout, "%s %zu %zu %.6g %.6g %.6g %.6g\n", reg[n].m_name.c_str(), r.m_samples, r.m_iters, r.m_median, r.m_mean, r.m_min, r.m_stddev);
+      fflush(fout);
+
+      std::cerr << r.m_median/1e6 << " ms\n";
+   }
+
+   if(fout != stdout) fclose(fout);
+
+   return 0;
+}
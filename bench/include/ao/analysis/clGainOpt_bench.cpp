@@ -0,0 +1,43 @@
+/** \file clGainOpt_bench.cpp
+ */
+#include "../../../bench.hpp"
+
+#include "../../../../include/ao/analysis/clGainOpt.hpp"
+
+/// Maximum stable gain search for a leaky integrator with 2000 frequencies
+MX_BENCH( ao_clGainOpt_maxStableGain, "ao.clGainOpt.maxStableGain.2000" )
+{
+   std::vector<double> f(2000);
+   for(size_t n = 0; n < f.size(); ++n) f[n] = (n+1) * 0.5 / f.size() * 1000.;
+
+   state.run([&]()
+   {
+      mx::AO::analysis::clGainOpt<double> go(1./1000., 1.5/1000.);
+      go.setLeakyIntegrator(0.999);
+      go.f(f);
+      double g = go.maxStableGain();
+      static_cast<void>(g);
+   });
+}
+
+/// Optimum gain for a power-law error PSD and white noise with 2000 frequencies
+MX_BENCH( ao_clGainOpt_optGainOpenLoop, "ao.clGainOpt.optGainOpenLoop.2000" )
+{
+   std::vector<double> f(2000), psdErr(2000), psdNoise(2000);
+   for(size_t n = 0; n < f.size(); ++n)
+   {
+      f[n] = (n+1) * 0.5 / f.size() * 1000.;
+      psdErr[n] = pow(f[n], -2.);
+      psdNoise[n] = 1e-6;
+   }
+
+   state.run([&]()
+   {
+      mx::AO::analysis::clGainOpt<double> go(1./1000., 1.5/1000.);
+      go.setLeakyIntegrator(0.999);
+      go.f(f);
+      double var;
+      double g = go.optGainOpenLoop(var, psdErr, psdNoise);
+      static_cast<void>(g);
+   });
+}
@@ -0,0 +1,79 @@
+/** \file KLIPreduction_bench.cpp
+ */
+#include "../../bench.hpp"
+
+#include <cstdlib>
+#include <unistd.h>
+
+#include "../../../include/improc/ADIDerotator.hpp"
+#include "../../../include/improc/KLIPreduction.hpp"
+
+/// KLIP on a synthetic ADI sequence of 100 128x128 frames
+/** The frames contain a static speckle pattern plus a fainter varying one, and a companion which rotates with
+  * the parallactic angle.  They are written to a temporary directory once.  The files are loaded on the
+  * warm-up call, so the timed calls measure the reduction: mean subtraction, covariance, KL modes, PSF
+  * subtraction, derotation and combination.
+  */
+MX_BENCH( improc_KLIPreduction_adi, "improc.KLIPreduction.adi.100x128x128" )
+{
+   typedef float realT;
+
+   char tmpl[] = "/tmp/mxlib_bench_klip_XXXXXX";
+   if(mkdtemp(tmpl) == nullptr) return;
+   std::string dir = tmpl;
+
+   int N = 100;
+   int sz = 128;
+
+   std::srand(1);
+   mx::improc::eigenImage<realT> stat(sz, sz), var(sz, sz), im(sz, sz);
+   stat.setRandom();
+
+   for(int n = 0; n < N; ++n)
+   {
+      realT q = -30.0 + 60.0 * n / (N - 1); //degrees
+
+      var.setRandom();
+
+      realT cx = 0.5*(sz-1) + 20*cos(mx::math::dtor(q));
+      realT cy = 0.5*(sz-1) + 20*sin(mx::math::dtor(q));
+
+      for(int i = 0; i < sz; ++i)
+      {
+         for(int j = 0; j < sz; ++j)
+         {
+            realT r2 = pow(i - 0.5*(sz-1), 2) + pow(j - 0.5*(sz-1), 2);
+            realT c2 = pow(i - cx, 2) + pow(j - cy, 2);
+            im(i,j) = 1000*exp(-r2/(2*9.)) + 10*exp(-r2/400.)*(stat(i,j) + 0.1*var(i,j)) + 5*exp(-c2/(2*2.));
+         }
+      }
+
+      mx::fits::fitsHeader head;
+      head.append("ROTOFF", q, "parallactic angle");
+
+      mx::fits::fitsFile<realT> ff;
+      ff.write(dir + "/frame_" + std::to_string(1000 + n) + ".fits", im, head);
+   }
+
+   //The worker writes its covariance matrix to the working directory
+   char cwd[4096];
+   if(getcwd(cwd, sizeof(cwd)) == nullptr) return;
+   if(chdir(dir.c_str()) != 0) return;
+
+   {
+      mx::improc::KLIPreduction<realT, mx::improc::ADIDerotator<realT>, float> klip(dir, "frame_", ".fits");
+
+      klip.m_derotF.angleKeyword("ROTOFF");
+      klip.m_derotF.m_angleScale = 1;
+      klip.m_MJDKeyword = "";
+      klip.m_doWriteFinim = 0;
+      klip.m_Nmodes = {5, 10, 20};
+
+      state.run([&](){ klip.regions(0, 40, 0, 0); });
+   }
+
+   if(chdir(cwd) != 0) std::cerr << "KLIPreduction_bench: could not return to " << cwd << "\n";
+
+   std::string cmd = "rm -rf " + dir;
+   if(system(cmd.c_str()) != 0) std::cerr << "KLIPreduction_bench: could not remove " << dir << "\n";
+}
@@ -0,0 +1,29 @@
+/** \file eigenCube_bench.cpp
+ */
+#include "../../bench.hpp"
+
+#include "../../../include/improc/eigenCube.hpp"
+
+/// Mean combination of a 128x128x100 cube
+MX_BENCH( improc_eigenCube_mean, "improc.eigenCube.mean.128x128x100" )
+{
+   std::srand(1);
+   mx::improc::eigenCube<float> cube(128, 128, 100);
+   cube.cube().setRandom();
+
+   mx::improc::eigenImage<float> im;
+
+   state.run([&](){ cube.mean(im); });
+}
+
+/// Median combination of a 128x128x100 cube
+MX_BENCH( improc_eigenCube_median, "improc.eigenCube.median.128x128x100" )
+{
+   std::srand(1);
+   mx::improc::eigenCube<float> cube(128, 128, 100);
+   cube.cube().setRandom();
+
+   mx::improc::eigenImage<float> im;
+
+   state.run([&](){ cube.median(im); });
+}
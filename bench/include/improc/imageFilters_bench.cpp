@@ -0,0 +1,18 @@
+/** \file imageFilters_bench.cpp
+ */
+#include "../../bench.hpp"
+
+#include "../../../include/improc/eigenImage.hpp"
+#include "../../../include/improc/imageFilters.hpp"
+
+/// Gaussian smoothing of a 256x256 image with a FWHM=4 pixel kernel
+MX_BENCH( improc_filterImage_gauss, "improc.filterImage.gauss4.256x256" )
+{
+   std::srand(1);
+   mx::improc::eigenImage<float> im(256, 256), fim;
+   im.setRandom();
+
+   mx::improc::gaussKernel<mx::improc::eigenImage<float>, 2> gk(4);
+
+   state.run([&](){ mx::improc::filterImage(fim, im, gk); });
+}
@@ -0,0 +1,26 @@
+/** \file imageTransforms_bench.cpp
+ */
+#include "../../bench.hpp"
+
+#include "../../../include/improc/eigenImage.hpp"
+#include "../../../include/improc/imageTransforms.hpp"
+
+/// Cubic convolution rotation of a 256x256 image
+MX_BENCH( improc_imageRotate_cubic, "improc.imageRotate.cubic.256x256" )
+{
+   std::srand(1);
+   mx::improc::eigenImage<float> im(256, 256), rim(256, 256);
+   im.setRandom();
+
+   state.run([&](){ mx::improc::imageRotate(rim, im, 0.3f, mx::improc::cubicConvolTransform<float>()); });
+}
+
+/// Bilinear rotation of a 256x256 image
+MX_BENCH( improc_imageRotate_bilinear, "improc.imageRotate.bilinear.256x256" )
+{
+   std::srand(1);
+   mx::improc::eigenImage<float> im(256, 256), rim(256, 256);
+   im.setRandom();
+
+   state.run([&](){ mx::improc::imageRotate(rim, im, 0.3f, mx::improc::bilinearTransform<float>()); });
+}
@@ -0,0 +1,45 @@
+/** \file fitsFile_bench.cpp
+ */
+#include "../../../bench.hpp"
+
+#include <unistd.h>
+
+#include "../../../../include/ioutils/fits/fitsFile.hpp"
+
+/// Writing a 1024x1024 float image to FITS
+MX_BENCH( ioutils_fitsFile_write, "ioutils.fitsFile.write.1024x1024" )
+{
+   std::srand(1);
+   mx::improc::eigenImage<float> im(1024, 1024);
+   im.setRandom();
+
+   std::string fname = "/tmp/mxlib_bench_fitsFile_" + std::to_string(getpid()) + ".fits";
+
+   mx::fits::fitsFile<float> ff;
+
+   state.run([&](){ ff.write(fname, im); });
+
+   unlink(fname.c_str());
+}
+
+/// Reading a 1024x1024 float image and its header from FITS
+MX_BENCH( ioutils_fitsFile_read, "ioutils.fitsFile.read.1024x1024" )
+{
+   std::srand(1);
+   mx::improc::eigenImage<float> im(1024, 1024);
+   im.setRandom();
+
+   std::string fname = "/tmp/mxlib_bench_fitsFile_" + std::to_string(getpid()) + ".fits";
+
+   mx::fits::fitsFile<float> ff;
+   ff.write(fname, im);
+
+   state.run([&]()
+   {
+      mx::fits::fitsFile<float> fr;
+      mx::fits::fitsHeader head;
+      fr.read(im, head, fname);
+   });
+
+   unlink(fname.c_str());
+}
@@ -0,0 +1,69 @@
+/** \file psdFilter_bench.cpp
+ */
+#include "../../bench.hpp"
+
+#include "../../../include/sigproc/psdFilter.hpp"
+
+/// Filtering a 256x256 white noise field to a power-law PSD
+MX_BENCH( sigproc_psdFilter_2D, "sigproc.psdFilter.filter.256x256" )
+{
+   typedef mx::sigproc::psdFilter<double, 2> psdFilterT;
+
+   Eigen::Array<double, -1, -1> psd(256, 256);
+   for(int i = 0; i < psd.rows(); ++i)
+   {
+      for(int j = 0; j < psd.cols(); ++j)
+      {
+         double ki = (i < psd.rows()/2) ? i : i - psd.rows();
+         double kj = (j < psd.cols()/2) ? j : j - psd.cols();
+         psd(i,j) = 1.0/pow(1.0 + ki*ki + kj*kj, 11./6.);
+      }
+   }
+
+   psdFilterT psdF;
+   psdF.psd(psd, 1.0, 1.0);
+
+   std::srand(1);
+   psdFilterT::realArrayT noise0(256, 256), noise(256, 256);
+   noise0.setRandom();
+
+   state.run([&]()
+   {
+      noise = noise0;
+      psdF(noise);
+   });
+}
+
+/// Filtering a 1024x64x64 white noise cube to a power-law PSD
+MX_BENCH( sigproc_psdFilter_3D, "sigproc.psdFilter.filter.64x64x256" )
+{
+   typedef mx::sigproc::psdFilter<float, 3> psdFilterT;
+
+   psdFilterT::realArrayT psd(64, 64, 256);
+   for(int i = 0; i < psd.rows(); ++i)
+   {
+      for(int j = 0; j < psd.cols(); ++j)
+      {
+         for(int k = 0; k < psd.planes(); ++k)
+         {
+            float ki = (i < psd.rows()/2) ? i : i - psd.rows();
+            float kj = (j < psd.cols()/2) ? j : j - psd.cols();
+            float f = (k < psd.planes()/2) ? k : k - psd.planes();
+            psd.image(k)(i,j) = 1.0/pow(1.0 + ki*ki + kj*kj + f*f, 11./6.);
+         }
+      }
+   }
+
+   psdFilterT psdF;
+   psdF.psd(psd, 1.0, 1.0, 1.0);
+
+   std::srand(1);
+   psdFilterT::realArrayT noise0(64, 64, 256), noise(64, 64, 256);
+   noise0.cube().setRandom();
+
+   state.run([&]()
+   {
+      noise.cube() = noise0.cube();
+      psdF(noise);
+   });
+}
@@ -0,0 +1,57 @@
+/** \file fraunhoferPropagator_bench.cpp
+ */
+#include "../../bench.hpp"
+
+#include "../../../include/wfp/fraunhoferPropagator.hpp"
+
+/// Pupil to focal plane propagation of a 256x256 wavefront
+MX_BENCH( wfp_fraunhoferPropagator_p2f, "wfp.fraunhoferPropagator.pupilToFocal.256x256" )
+{
+   typedef Eigen::Array<std::complex<float>, -1, -1> wavefrontT;
+
+   mx::wfp::fraunhoferPropagator<wavefrontT> fp;
+   fp.setWavefrontSizePixels(256);
+
+   wavefrontT pupil0(256, 256), pupil(256, 256), focal(256, 256);
+
+   pupil0.setZero();
+   for(int i = 0; i < 256; ++i)
+   {
+      for(int j = 0; j < 256; ++j)
+      {
+         if( (i-127.5)*(i-127.5) + (j-127.5)*(j-127.5) < 64*64) pupil0(i,j) = std::polar(1.0f, 0.1f*sinf(0.05f*i));
+      }
+   }
+
+   state.run([&]()
+   {
+      pupil = pupil0;
+      fp.propagatePupilToFocal(focal, pupil);
+   });
+}
+
+/// Round trip pupil to focal to pupil propagation of a 512x512 wavefront
+MX_BENCH( wfp_fraunhoferPropagator_roundTrip, "wfp.fraunhoferPropagator.roundTrip.512x512" )
+{
+   typedef Eigen::Array<std::complex<double>, -1, -1> wavefrontT;
+
+   mx::wfp::fraunhoferPropagator<wavefrontT> fp;
+   fp.setWavefrontSizePixels(512);
+
+   wavefrontT pupil(512, 512), focal(512, 512);
+
+   pupil.setZero();
+   for(int i = 0; i < 512; ++i)
+   {
+      for(int j = 0; j < 512; ++j)
+      {
+         if( (i-255.5)*(i-255.5) + (j-255.5)*(j-255.5) < 128*128) pupil(i,j) = 1;
+      }
+   }
+
+   state.run([&]()
+   {
+      fp.propagatePupilToFocal(focal, pupil);
+      fp.propagateFocalToPupil(pupil, focal);
+   });
+}
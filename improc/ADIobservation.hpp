@@ -14,6 +14,8 @@
 #include "../ioutils/fits/fitsHeader.hpp"
 
 #include "imagePads.hpp"
+#include "imageRotator.hpp"
+#include "fakeInjector.hpp"
 
 
 
@@ -104,6 +106,8 @@ struct ADIobservation : public HCIobservation<_realT>
    
    bool m_postMedSub {false};
    
+   int m_derotMethod {imageRotator<realT>::cubicConvol}; ///< The derotation method, a member of imageRotator::methods.
+   
    ADIobservation();
    
    ADIobservation( const std::string &dir,     ///< [in] the directory to search.
@@ -134,6 +138,13 @@ struct ADIobservation : public HCIobservation<_realT>
    ///Post target read actions, including fake injection
    virtual int postReadFiles();
    
+   ///Whether postReadFiles changes the target images.
+   /**
+     * \returns true if fakes will be injected
+     * \returns false otherwise
+     */
+   virtual bool postReadModifiesImages();
+   
    ///Post target coadd actions.
    /** Here updates derotation for new average values.
      */
@@ -178,8 +189,12 @@ struct ADIobservation : public HCIobservation<_realT>
    realT m_RDIFluxScale {1}; ///< Flux scaling to apply to fake planets injected in RDI.  Would depend on the assumed spectrum in SDI.
    realT m_RDISepScale {1}; ///< Scaling to apply to fake planet separation in RDI.  Would be ratio of wavelengths for SDI.
 
+   int m_fakeStampSize {0}; ///< If > 0, the fake PSF is cut to a square stamp of this size about the image center before injection.  Otherwise the non-zero pixels of the PSF are used.
    
    ///Inect the fake plants
+   /** Only the support of the PSF is shifted and added, see \ref fakeInjector.  The PSFs are read and prepared
+     * first, and then the images are processed in parallel, with all planets injected into an image in one pass.
+     */
    int injectFake( eigenCube<realT> & ims,              ///< [in/out] the image cube in which to inject the fakes.
                    std::vector<std::string> & fileList, ///< [in] a list of file paths used for per-image fake PSFs.  If empty, then m_fakeFileName is used.
                    derotFunctObj & derotF,
@@ -203,7 +218,20 @@ struct ADIobservation : public HCIobservation<_realT>
    
    void stdFitsHeader(fits::fitsHeader * head);
    
+   /** \name Mask Rotation
+     * @{
+     */
+   realT m_maskAngleTol {0}; ///< The tolerance [rad] within which derotation angles share a rotated mask.  Angles are rounded to multiples of this.  If 0, only identical angles share a mask.
+
+   std::string m_maskCubeFile; ///< If not empty, the full mask cube is written to this FITS file by makeMaskCube.
+
+   ///Make the mask cube by rotating the mask to each derotation angle.
+   /** Angles are quantized by m_maskAngleTol and the mask is rotated once per distinct angle, in parallel.  The images
+     * sharing an angle share the bit-packed rotated mask in m_maskCube.  Each rotated mask is packed as soon as it is
+     * made, so the unpacked masks are never all held at once.
+     */
    virtual void makeMaskCube();
+   ///@}
    
    ///De-rotate the PSF subtracted images
    void derotate();
@@ -289,6 +317,12 @@ int ADIobservation<_realT, _derotFunctObj>::postReadFiles()
    return 0;
 }
 
+template<typename _realT, class _derotFunctObj>
+bool ADIobservation<_realT, _derotFunctObj>::postReadModifiesImages()
+{
+   return (m_fakeFileName != ""  && !this->m_skipPreProcess);
+}
+
 template<typename _realT, class _derotFunctObj>
 int ADIobservation<_realT, _derotFunctObj>::postCoadd()
 {
@@ -370,6 +404,12 @@ int ADIobservation<_realT, _derotFunctObj>::readPSFSub( const std::string & dir,
       std::cerr << "postMedSub: " << m_postMedSub << "\n";
    }
    
+   if(fh.count("DEROTMTH") != 0)
+   {
+      m_derotMethod = fh["DEROTMTH"].Int();
+      std::cerr << "derotMethod: " << m_derotMethod << "\n";
+   }
+   
    if(fh.count("FAKEFILE") != 0)
    {
       m_fakeFileName = fh["FAKEFILE"].String();
@@ -382,6 +422,12 @@ int ADIobservation<_realT, _derotFunctObj>::readPSFSub( const std::string & dir,
       std::cerr << "fakeScaleFileName: " << m_fakeScaleFileName << "\n";
    }
    
+   if(fh.count("FAKESTMP") != 0)
+   {
+      m_fakeStampSize = fh["FAKESTMP"].Int();
+      std::cerr << "fakeStampSize: " << m_fakeStampSize << "\n";
+   }
+   
    if(fh.count("FAKESEP") != 0)
    {
       ioutils::parseStringVector(m_fakeSep, fh["FAKESEP"].String(), ",");
@@ -480,30 +526,51 @@ int ADIobservation<_realT, _derotFunctObj>::injectFake( eigenCube<realT> & ims,
       }
    } //if(fakeScaleFileName != "")
       
+   //One injector for HCI::single, or one per image for HCI::list
+   std::vector<fakeInjector<realT>> injectors;
+
    if(m_fakeMethod == HCI::single)
    {
       if( ff.read( fakePSF, m_fakeFileName ) < 0) return -1;
+
+      injectors.resize(1);
+      injectors[0].setPSF(fakePSF, ims.rows(), ims.cols(), m_fakeStampSize);
    }
 
    if(m_fakeMethod == HCI::list)
    {
       if( ioutils::readColumns(m_fakeFileName, fakeFiles) < 0) return -1;
-   }
-   
-   for(int i=0; i<ims.planes(); ++i)
-   {
-      if(m_fakeMethod == HCI::list)
+
+      injectors.resize(ims.planes());
+      for(int i=0; i<ims.planes(); ++i)
       {
-         ff.read(fakePSF, fakeFiles[i]);
+         if( ff.read(fakePSF, fakeFiles[i]) < 0) return -1;
+         injectors[i].setPSF(fakePSF, ims.rows(), ims.cols(), m_fakeStampSize);
       }
+   }
+
+   size_t nFakes = m_fakeSep.size();
 
-      for(size_t j=0;j<m_fakeSep.size(); ++j)
+   #pragma omp parallel
+   {
+      std::vector<realT> dx(nFakes), dy(nFakes), amp(nFakes);
+
+      #pragma omp for
+      for(int i=0; i<ims.planes(); ++i)
       {
-         if( injectFake(fakePSF, ims, i, derotF.derotAngle(i), m_fakePA[j], m_fakeSep[j], m_fakeContrast[j], fakeScale[j], RDIFluxScale, RDISepScale) < 0) return -1;
+         for(size_t j=0;j<nFakes; ++j)
+         {
+            realT ang = math::dtor(-1*m_fakePA[j]) + derotF.derotAngle(i);
+
+            dx[j] = m_fakeSep[j] * RDISepScale * sin(ang);
+            dy[j] = m_fakeSep[j] * RDISepScale * cos(ang);
+            amp[j] = fakeScale[i]*RDIFluxScale*m_fakeContrast[j];
+         }
+
+         injectors[(m_fakeMethod == HCI::list) ? i : 0].inject(ims.image(i).data(), dx, dy, amp);
       }
    }
    
-   
    t_fake_end = sys::get_curr_time();
    
    return 0;
@@ -524,33 +591,10 @@ int ADIobservation<_realT, _derotFunctObj>::injectFake( eigenImageT & fakePSF,
                                                       )
 {
 
-   //Check for correct sizing
-   if( (fakePSF.rows() < ims.rows() && fakePSF.cols() >= ims.cols()) || 
-                        (fakePSF.rows() >= ims.rows() && fakePSF.cols() < ims.cols()))
-   {
-      mxThrowException(err::sizeerr, "ADIobservation::injectFake", "fake PSF has different dimensions and can't be sized properly");
-   }
-   
-   //Check if fake needs to be padded out
-   if(fakePSF.rows() < ims.rows() && fakePSF.cols() < ims.cols())
-   {
-      eigenImageT pfake(ims.rows(), ims.cols());
-      padImage(pfake, fakePSF, 0.5*(ims.rows()-fakePSF.rows()), 0);
-      fakePSF = pfake;
-   }
-   
-   //Check if fake needs to be cut down
-   if(fakePSF.rows() > ims.rows() && fakePSF.cols() > ims.cols())
-   {
-      eigenImageT cfake(ims.rows(), ims.cols());
-      cutPaddedImage(cfake, fakePSF, 0.5*(fakePSF.rows() - ims.rows()));
-      fakePSF = cfake;
-   }
+   fakeInjector<realT> injector;
+   injector.setPSF(fakePSF, ims.rows(), ims.cols(), m_fakeStampSize);
 
    /*** Now shift to the separation and PA, scale, apply contrast, and inject ***/
-   //allocate shifted fake psf
-   eigenImageT shiftFake(fakePSF.rows(), fakePSF.cols());
-   
    realT ang, dx, dy;
 
    ang = math::dtor(-1*PA) + derotAngle;
@@ -558,9 +602,7 @@ int ADIobservation<_realT, _derotFunctObj>::injectFake( eigenImageT & fakePSF,
    dx = sep * RDISepScale * sin(ang);
    dy = sep * RDISepScale * cos(ang);
                
-   imageShift(shiftFake, fakePSF, dx, dy, cubicConvolTransform<realT>());
-   
-   ims.image(image_i) = ims.image(image_i) + shiftFake*scale*RDIFluxScale*contrast;
+   injector.inject(ims.image(image_i).data(), dx, dy, scale*RDIFluxScale*contrast);
 
    return 0;
    
@@ -575,22 +617,55 @@ void ADIobservation<_realT, _derotFunctObj>::makeMaskCube()
       exit(-1);
    }
    
+   //Find the distinct quantized angles, and the angle of each image
+   std::vector<realT> angles;
+   std::vector<int> angleNo(this->m_Nims);
+   std::map<realT, int> angleMap;
+
+   for(int i=0; i< this->m_Nims; ++i)
+   {
+      realT q = m_derotF.derotAngle(i);
+      if(m_maskAngleTol > 0) q = m_maskAngleTol * std::round(q/m_maskAngleTol);
+
+      typename std::map<realT, int>::iterator it = angleMap.find(q);
+      if(it == angleMap.end())
+      {
+         it = angleMap.insert(std::make_pair(q, (int) angles.size())).first;
+         angles.push_back(q);
+      }
+
+      angleNo[i] = it->second;
+   }
+
    this->m_maskCube.resize( this->m_Nrows, this->m_Ncols, this->m_Nims);
-   
+   this->m_maskCube.addMasks(angles.size());
+
+   //Rotate once per angle, packing each mask as soon as it is rotated so only one float mask per thread is held
    #pragma omp parallel
    {
       eigenImageT rm;
-      
+
       #pragma omp for
-      for(int i=0; i< this->m_Nims; ++i)
+      for(size_t n=0; n < angles.size(); ++n)
       {
-         rotateMask( rm, this->m_mask, m_derotF.derotAngle(i));
-         this->m_maskCube.image(i) = rm;
+         rotateMask( rm, this->m_mask, angles[n]);
+         this->m_maskCube.fillMask(n, rm);
       }
    }
-   
-   fits::fitsFile<realT> ff; 
-   ff.write("maskCube.fits", this->m_maskCube);
+
+   for(int i=0; i< this->m_Nims; ++i)
+   {
+      this->m_maskCube.setMask(i, angleNo[i]);
+   }
+
+   if(m_maskCubeFile != "")
+   {
+      eigenCube<realT> maskCube;
+      this->m_maskCube.cube(maskCube);
+
+      fits::fitsFile<realT> ff; 
+      ff.write(m_maskCubeFile, maskCube);
+   }
 }
 
 template<typename _realT, class _derotFunctObj>
@@ -598,21 +673,26 @@ void ADIobservation<_realT, _derotFunctObj>::derotate()
 {
    t_derotate_begin = sys::get_curr_time();
    
-   for(size_t n=0; n<this->m_psfsub.size(); ++n)
+   if(this->m_psfsub.size() > 0)
    {
+      //Each plane has the same angle in every reduction, so plan once and rotate them all.
+      int rows = this->m_psfsub[0].rows();
+      int cols = this->m_psfsub[0].cols();
+      int planes = this->m_psfsub[0].planes();
+
       #pragma omp parallel
       {
-         eigenImageT rotim;
+         imageRotator<realT> rotator(m_derotMethod);
          realT derot;
 
          #pragma omp for
-         for(int i=0; i<this->m_psfsub[n].planes();++i)
+         for(int i=0; i<planes;++i)
          {
             derot = m_derotF.derotAngle(i);
             if(derot != 0) 
             {
-               imageRotate(rotim, this->m_psfsub[n].image(i), derot, cubicConvolTransform<realT>());
-               this->m_psfsub[n].image(i) = rotim;
+               rotator.plan(rows, cols, derot);
+               rotator.rotate(this->m_psfsub, i);
             }
          }
       }
@@ -635,12 +715,19 @@ void ADIobservation<_realT, _derotFunctObj>::stdFitsHeader( fits::fitsHeader * h
 
    head->append("POSTMEDS", m_postMedSub, "median subtraction after processing");
    
+   head->append("DEROTMTH", m_derotMethod, "derotation method");
+
+   head->append("MASKATOL", m_maskAngleTol, "angle tolerance [rad] for sharing rotated masks");
+   
    if(m_fakeFileName != "")
    head->append("FAKEFILE", m_fakeFileName, "name of fake planet PSF file");
    
    if(m_fakeScaleFileName != "")
    head->append("FAKESCFL", m_fakeScaleFileName, "name of fake planet scale file name");
 
+   if(m_fakeStampSize > 0)
+   head->append("FAKESTMP", m_fakeStampSize, "size of fake planet PSF stamp");
+
    std::stringstream str;
    
    if(m_fakeSep.size() > 0)
@@ -16,6 +16,8 @@
 
 #include <sys/stat.h>
 
+#include <omp.h>
+
 #include "../mxlib.hpp"
 
 #include "../mxException.hpp"
@@ -27,7 +29,9 @@
 
 #include "eigenImage.hpp"
 #include "eigenCube.hpp"
+#include "bitMaskCube.hpp"
 #include "imageFilters.hpp"
+#include "radprofPlan.hpp"
 #include "imageMasks.hpp"
 #include "imageTransforms.hpp"
 #include "imageUtils.hpp"
@@ -446,10 +450,15 @@ struct HCIobservation
    
    eigenImageT m_mask; ///< The mask
    
-   eigenCube<realT> m_maskCube; ///< A cube of masks, one for each input image, which may be modified versions (e.g. rotated) of mask.
+   bitMaskCube m_maskCube; ///< The masks for each input image, which may be modified versions (e.g. rotated) of mask.  Images with the same mask share it.
    
    ///Read the mask file, resizing to imSize if needed.
+   /** Calls \ref loadMask and then \ref makeMaskCube.
+     */
    void readMask();
+
+   ///Read the mask file into m_mask, resizing to imSize if needed, without making the mask cube.
+   void loadMask();
    
    ///Populate the mask cube which is used for post-processing.  Derived classes can do this as appropriate, e.g. by rotating the mask.
    virtual void makeMaskCube();
@@ -506,9 +515,75 @@ public:
    /// If true, then we stop after pre-processing.
    bool m_preProcess_only {false};
 
+   /// If true, each image is pre-processed as soon as it is read, overlapping the processing with file I/O.
+   /** This is only done if pre-processing would otherwise immediately follow reading, that is if m_preProcess_beforeCoadd
+     * is true or there is no coadding, and if \ref postReadModifiesImages is false.  Otherwise the images are
+     * pre-processed after reading as usual.
+     */
+   bool m_preProcess_onLoad {false};
+
    ///Do the pre-processing
+   /** All enabled steps are applied to one image before moving on to the next, with the images processed in parallel.
+     */
    void preProcess( eigenCube<realT> & ims /**< [in] the image cube, should be either m_tgtIms or m_refIms */);
 
+protected:
+
+   ///Working memory for pre-processing a single image.  One of these is used by each thread.
+   struct preProcessScratch
+   {
+      eigenImageT fim; ///< The filtered image for the unsharp masks
+      std::vector<realT> prof; ///< The radial profile
+      std::vector<realT> work; ///< Working memory for the median radial profile
+   };
+
+   radprofPlan<realT> m_preProcess_radprof; ///< The radial profile binning, planned once per image size in preProcessSetup
+
+   ///Prepare for pre-processing images of a given size.
+   void preProcessSetup( int rows, ///< [in] the number of rows in the images
+                         int cols  ///< [in] the number of columns in the images
+                       );
+
+   ///Apply all enabled pre-processing steps to a single image.
+   /** 
+     * \ref preProcessSetup must be called first.
+     */
+   template<typename imageT>
+   void preProcessImage( imageT & im,                 ///< [in/out] the image to pre-process
+                         preProcessScratch & scratch  ///< [in/out] the working memory for this thread
+                       );
+
+   ///Determine whether the images can be pre-processed as they are read.
+   /** See \ref m_preProcess_onLoad.
+     *
+     * \returns true if pre-processing should be done on load
+     * \returns false otherwise
+     */
+   bool preProcessOnLoad();
+
+   ///Read a list of files into a cube, zeroing NaNs and optionally pre-processing each image as it is read.
+   /** The images are processed in parallel while the remaining files are read.
+     *
+     * \returns 0 on success
+     * \returns -1 on error
+     */
+   int loadImages( fits::fitsFile<realT> & f,               ///< [in] the fits file, with the read size already set
+                   eigenCube<realT> & ims,                   ///< [out] the cube, already sized to hold all the images
+                   std::vector<fits::fitsHeader> & heads,    ///< [in/out] the headers, one per image
+                   const std::vector<std::string> & flist,   ///< [in] the list of files to read
+                   bool preProc                              ///< [in] if true, the images are pre-processed as they are read
+                 );
+
+   ///Whether postReadFiles() changes the target images.
+   /** If it does then the images can not be pre-processed as they are read.  Derived classes which modify the
+     * images in postReadFiles should override this.
+     *
+     * \returns false in this base class
+     */
+   virtual bool postReadModifiesImages();
+
+public:
+
    ///@}
 
    /** \name Image Combination
@@ -647,12 +722,6 @@ public:
    double t_preproc_begin  {0};
    double t_preproc_end  {0};
 
-   double t_azusm_begin  {0};
-   double t_azusm_end  {0};
-
-   double t_gaussusm_begin  {0};
-   double t_gaussusm_end  {0};
-
 
    double t_combo_begin  {0};
    double t_combo_end  {0};
@@ -859,7 +928,12 @@ int HCIobservation<_realT>::readFiles()
 
    t_load_begin = sys::get_curr_time();
 
-   f.read(m_tgtIms.data(), m_heads, m_fileList);
+   bool ppOnLoad = (preProcessOnLoad() && !postReadModifiesImages());
+
+   //The mask is needed to pre-process on load.  The mask cube is made after the post-read actions.
+   if(ppOnLoad) loadMask();
+
+   if( loadImages(f, m_tgtIms, m_heads, m_fileList, ppOnLoad) < 0) return -1;
 
    f.setReadSize();
 
@@ -893,22 +967,22 @@ int HCIobservation<_realT>::readFiles()
 
    std::cerr << "loading complete\n";
    
-   std::cerr << "zero-ing NaNs\n";
-   zeroNaNCube(m_tgtIms);
-   std::cerr << "done\n";
-   
    /*** Now do the post-read actions ***/
    if( postReadFiles() < 0) return -1;
 
    /*** Read in the mask if present ***/
-   readMask();
+   if(ppOnLoad)
+   {
+      if(m_maskFile != "") makeMaskCube();
+   }
+   else readMask();
    
 
    /*** Now begin processing ***/
    if(!m_skipPreProcess)
    {
       /*** Now do any pre-processing ***/
-      if(m_preProcess_beforeCoadd) preProcess(m_tgtIms);
+      if(m_preProcess_beforeCoadd && !ppOnLoad) preProcess(m_tgtIms);
 
       if(m_coaddCombineMethod != HCI::noCombine)
       {
@@ -935,7 +1009,7 @@ int HCIobservation<_realT>::readFiles()
       }
 
       /*** Now do any pre-processing if not done already***/
-      if(!m_preProcess_beforeCoadd) preProcess(m_tgtIms);
+      if(!m_preProcess_beforeCoadd && !ppOnLoad) preProcess(m_tgtIms);
 
       outputPreProcessed();
    }
@@ -1051,7 +1125,11 @@ int HCIobservation<_realT>::readRDIFiles()
 
    t_load_begin = sys::get_curr_time();
 
-   f.read(m_refIms.data(), m_RDIheads, m_RDIfileList);
+   bool ppOnLoad = preProcessOnLoad();
+
+   if(ppOnLoad) loadMask();
+
+   if( loadImages(f, m_refIms, m_RDIheads, m_RDIfileList, ppOnLoad) < 0) return -1;
 
    f.setReadSize();
 
@@ -1079,10 +1157,6 @@ int HCIobservation<_realT>::readRDIFiles()
 
    std::cerr << "loading complete\n";
    
-   std::cerr << "zero-ing NaNs\n";
-   zeroNaNCube(m_refIms);
-   std::cerr << "Done.\n";
-   
    /*** Now do the post-read actions ***/
    if( postRDIReadFiles() < 0) return -1;
 
@@ -1090,7 +1164,7 @@ int HCIobservation<_realT>::readRDIFiles()
    if(!m_skipPreProcess)
    {
       /*** Now do any pre-processing ***/
-      if(m_preProcess_beforeCoadd) preProcess(m_refIms);
+      if(m_preProcess_beforeCoadd && !ppOnLoad) preProcess(m_refIms);
 
       if(m_coaddCombineMethod != HCI::noCombine)
       {
@@ -1106,7 +1180,7 @@ int HCIobservation<_realT>::readRDIFiles()
       }
 
       /*** Now do any pre-processing if not done already***/
-      if(!m_preProcess_beforeCoadd) preProcess(m_refIms);
+      if(!m_preProcess_beforeCoadd && !ppOnLoad) preProcess(m_refIms);
 
       //outputRDIPreProcessed();
    }
@@ -1347,22 +1421,30 @@ void HCIobservation<_realT>::readMask()
    /*** Load the mask ***/
    if( m_maskFile != "")
    {
-      std::cerr << "creating mask cube\n";
-      fits::fitsFile<realT> ff;
-      ff.read(m_mask, m_maskFile);
-      
-      ///\todo here re-size mask if needed to match imSize
-      if(m_mask.rows() > m_imSize || m_mask.cols() > m_imSize)
-      {
-         eigenImageT tmask = m_mask.block( (int)(0.5*(m_mask.rows()-1) - 0.5*(m_imSize-1)), (int)(0.5*(m_mask.rows()-1) - 0.5*(m_imSize-1)), m_imSize, m_imSize);
-         m_mask = tmask;
-      }
+      loadMask();
       
+      std::cerr << "creating mask cube\n";
       makeMaskCube();
    }
 
 }
 
+template<typename _realT>
+void HCIobservation<_realT>::loadMask()
+{
+   if( m_maskFile == "") return;
+   
+   fits::fitsFile<realT> ff;
+   ff.read(m_mask, m_maskFile);
+      
+   ///\todo here re-size mask if needed to match imSize
+   if(m_mask.rows() > m_imSize || m_mask.cols() > m_imSize)
+   {
+      eigenImageT tmask = m_mask.block( (int)(0.5*(m_mask.rows()-1) - 0.5*(m_imSize-1)), (int)(0.5*(m_mask.rows()-1) - 0.5*(m_imSize-1)), m_imSize, m_imSize);
+      m_mask = tmask;
+   }
+}
+
 template<typename _realT>
 void HCIobservation<_realT>::makeMaskCube()
 {
@@ -1371,12 +1453,9 @@ void HCIobservation<_realT>::makeMaskCube()
       std::cerr << "\nMask is not the same size as images.\n\n";
       exit(-1);
    }
+   //Every image uses mask 0
    m_maskCube.resize( m_Nrows, m_Ncols, m_Nims);
-   
-   for(int i=0; i< m_Nims; ++i)
-   {
-      m_maskCube.image(i) = m_mask;
-   }
+   m_maskCube.addMask(m_mask);
 
 }
 
@@ -1385,104 +1464,140 @@ void HCIobservation<_realT>::preProcess( eigenCube<realT> & ims )
 {
    t_preproc_begin = sys::get_curr_time();
 
-   //The mask is applied first, and then after each subsequent P.P. step.
-   if( m_maskFile != "" && m_preProcess_mask)
+   std::cerr << "Pre-processing . . .\n";
+
+   preProcessSetup(ims.rows(), ims.cols());
+
+   //Each image goes through all of the steps while it is in cache
+   #pragma omp parallel
    {
-      std::cerr << "Masking . . .\n";
-      #pragma omp parallel for
+      preProcessScratch scratch;
+
+      #pragma omp for
       for(int i=0;i<ims.planes(); ++i)
       {
-         ims.image(i) *= m_mask;
+         typename eigenCube<realT>::imageRef im = ims.image(i);
+         preProcessImage(im, scratch);
       }
-      std::cerr << "Done\n";
    }
 
-   if( m_preProcess_subradprof )
+   std::cerr << "Done\n";
+
+   t_preproc_end = sys::get_curr_time();
+   
+} //void HCIobservation<_realT>::preProcess()
+
+template<typename _realT>
+void HCIobservation<_realT>::preProcessSetup( int rows,
+                                              int cols
+                                            )
+{
+   //The binning is the same for every image, so plan it once
+   if( m_preProcess_subradprof && (m_preProcess_radprof.rows() != rows || m_preProcess_radprof.cols() != cols) )
    {
-      std::cerr << "subtracting radial profile . . .\n";
-      eigenImageT rp;
+      m_preProcess_radprof.plan(rows, cols);
+   }
+}
 
-      for(int i=0;i<ims.planes(); ++i)
-      {
-         Eigen::Map<Eigen::Array<realT, Eigen::Dynamic, Eigen::Dynamic> > imRef(ims.image(i));
-         radprofim(rp, imRef, true);
-      }
+template<typename _realT>
+template<typename imageT>
+void HCIobservation<_realT>::preProcessImage( imageT & im,
+                                              preProcessScratch & scratch
+                                            )
+{
+   //The mask is applied first, and then after each subsequent P.P. step.
+   bool mask = (m_maskFile != "" && m_preProcess_mask);
 
-      std::cerr << "done\n";
+   if(mask) im *= m_mask;
 
-      if( m_maskFile != "" && m_preProcess_mask)
-      {
-         std::cerr << "Masking . . .\n";
-         #pragma omp parallel for
-         for(int i=0;i<ims.planes(); ++i)
-         {
-            ims.image(i) *= m_mask;
-         }
-         std::cerr << "Done\n";
-      }
+   if( m_preProcess_subradprof )
+   {
+      m_preProcess_radprof.subtract(im, false, scratch.prof, scratch.work);
+
+      if(mask) im *= m_mask;
    }
 
    if( m_preProcess_gaussUSM_fwhm > 0 && m_preProcess_mask)
    {
-      std::cerr << "Applying Gauss USM . . .\n";
-      t_gaussusm_begin = sys::get_curr_time();
+      filterImage(scratch.fim, im, gaussKernel<eigenImage<_realT>,2>(m_preProcess_gaussUSM_fwhm), 0.5*(im.cols()-1) - m_preProcess_gaussUSM_fwhm*4);
+      im -= scratch.fim;
 
-      #pragma omp parallel for
-      for(int i=0;i<ims.planes(); ++i)
-      {
-         eigenImageT fim, im;
-         im = ims.image(i);
-         filterImage(fim, im, gaussKernel<eigenImage<_realT>,2>(m_preProcess_gaussUSM_fwhm), 0.5*(ims.cols()-1) - m_preProcess_gaussUSM_fwhm*4);
-         im = (im-fim);
-         ims.image(i) = im;
-      }
+      if( m_maskFile != "") im *= m_mask;
+   }
 
-      if( m_maskFile != "")
-      {
-         std::cerr << "Masking . . .\n";
-         #pragma omp parallel for
-         for(int i=0;i<ims.planes(); ++i)
-         {
-            ims.image(i) *= m_mask;
-         }
+   if( m_preProcess_azUSM_azW && m_preProcess_azUSM_radW )
+   {
+      filterImage(scratch.fim, im, azBoxKernel<eigenImage<realT>>(m_preProcess_azUSM_radW, m_preProcess_azUSM_azW), 0.5*(im.cols()-1) - m_preProcess_azUSM_radW);
+      im -= scratch.fim;
 
-      }
-      t_gaussusm_end = sys::get_curr_time();
-      std::cerr << "Done\n";
+      if(mask) im *= m_mask;
    }
+}
 
-   if( m_preProcess_azUSM_azW && m_preProcess_azUSM_radW )
+template<typename _realT>
+bool HCIobservation<_realT>::preProcessOnLoad()
+{
+   if(!m_preProcess_onLoad || m_skipPreProcess) return false;
+
+   //Pre-processing after coadding has to wait for all the images
+   if(!m_preProcess_beforeCoadd && m_coaddCombineMethod != HCI::noCombine) return false;
+
+   return true;
+}
+
+template<typename _realT>
+int HCIobservation<_realT>::loadImages( fits::fitsFile<realT> & f,
+                                        eigenCube<realT> & ims,
+                                        std::vector<fits::fitsHeader> & heads,
+                                        const std::vector<std::string> & flist,
+                                        bool preProc
+                                      )
+{
+   if(preProc)
    {
-      std::cerr << "Applying azimuthal USM . . .\n";
-      t_azusm_begin = sys::get_curr_time();
-      #pragma omp parallel for
-      for(int i=0;i<ims.planes(); ++i)
-      {
-         eigenImageT fim, im;
-         im = ims.image(i);
-         filterImage(fim, im, azBoxKernel<eigenImage<realT>>(m_preProcess_azUSM_radW, m_preProcess_azUSM_azW), 0.5*(ims.cols()-1) - m_preProcess_azUSM_radW);
-         im = (im-fim);
-         ims.image(i) = im;
-      }
+      std::cerr << "Pre-processing on load . . .\n";
+      t_preproc_begin = sys::get_curr_time();
+      preProcessSetup(ims.rows(), ims.cols());
+   }
 
-      if( m_maskFile != "" && m_preProcess_mask)
+   std::vector<preProcessScratch> scratch(omp_get_max_threads());
+
+   //Each image is handed off as a task as soon as it is read.  This object must outlive the tasks.
+   auto onFrame = [this, preProc, &scratch]( size_t i, realT * frame, long rows, long cols )
+   {
+      static_cast<void>(i);
+
+      #pragma omp task firstprivate(frame, rows, cols)
       {
-         std::cerr << "Masking . . .\n";
-         #pragma omp parallel for
-         for(int i=0;i<ims.planes(); ++i)
-         {
-            ims.image(i) *= m_mask;
-         }
+         zeroNaNs(frame, rows*cols);
+
+         Eigen::Map<eigenImageT> im(frame, rows, cols);
 
+         if(preProc) preProcessImage(im, scratch[omp_get_thread_num()]);
       }
+   };
 
-      t_azusm_end = sys::get_curr_time();
-      std::cerr  << "Done\n";
+   int rv = 0;
+
+   //One thread reads the files while the others process the images already read.
+   #pragma omp parallel
+   {
+      #pragma omp single
+      {
+         rv = f.read(ims.data(), heads, flist, onFrame);
+      }
    }
 
-   t_preproc_end = sys::get_curr_time();
-   
-} //void HCIobservation<_realT>::preProcess()
+   if(preProc) t_preproc_end = sys::get_curr_time();
+
+   return rv;
+}
+
+template<typename _realT>
+bool HCIobservation<_realT>::postReadModifiesImages()
+{
+   return false;
+}
 
 template<typename _realT>
 int HCIobservation<_realT>::readWeights()
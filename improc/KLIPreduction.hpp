@@ -290,8 +290,6 @@ namespace mx
             printf("    Fake Injection: %f sec\n", this->t_fake_end - this->t_fake_begin);
             printf("    Coadding: %f sec\n", this->t_coadd_end - this->t_coadd_begin);
             printf("    Preprocessing: %f sec\n", this->t_preproc_end - this->t_preproc_begin);
-            printf("      Az USM: %f sec\n", this->t_azusm_end - this->t_azusm_begin);
-            printf("      Gauss USM: %f sec\n", this->t_gaussusm_end - this->t_gaussusm_begin);
             printf("    KLIP algorithm: %f elapsed real sec\n", this->t_worker_end - this->t_worker_begin);
             double klip_cpu = this->t_eigenv + this->t_klim + this->t_psf;
             printf("      EigenDecomposition %f cpu sec (%f%%)\n", this->t_eigenv, this->t_eigenv / klip_cpu * 100);
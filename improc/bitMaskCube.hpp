@@ -0,0 +1,348 @@
+/** \file bitMaskCube.hpp
+  * \brief A compact cube of 1/0 masks, storing each distinct mask once as bits.
+  * \ingroup image_processing_files
+  * \author Jared R. Males (jaredmales@gmail.com)
+  *
+  */
+
+//***********************************************************************//
+// Copyright 2023 Jared R. Males (jaredmales@gmail.com)
+//
+// This file is part of mxlib.
+//
+// mxlib is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// mxlib is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with mxlib.  If not, see <http://www.gnu.org/licenses/>.
+//***********************************************************************//
+
+#ifndef bitMaskCube_hpp
+#define bitMaskCube_hpp
+
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "../mxException.hpp"
+
+namespace mx
+{
+namespace improc
+{
+
+/// A cube of 1/0 masks, one per plane, in which planes with the same mask share its storage.
+/** Each distinct mask is stored once, packed 64 pixels to a word in column-major order, and each plane holds the index
+  * of its mask.  For an ADI sequence where the masks are rotated, and many frames have nearly the same angle, this is
+  * far smaller than an eigenCube of the masks.
+  *
+  * The pixel() member has the same interface as eigenCube::pixel for reading mask values, so a bitMaskCube can be
+  * passed as the mask to eigenCube::mean and eigenCube::sigmaMean.
+  *
+  * Example:
+  * \code
+  * bitMaskCube masks(rows, cols, planes);
+  * int m0 = masks.addMask(mask0); //pixels equal to 1 are good
+  * int m1 = masks.addMask(mask1);
+  * for(int k=0; k < planes; ++k) masks.setMask(k, (k % 2) ? m1 : m0);
+  * \endcode
+  *
+  * When the masks are made in parallel, reserve them with addMasks and then pack each one with fillMask as soon as
+  * it is made, so that only the packed masks are held in memory:
+  * \code
+  * int m0 = masks.addMasks(nAngles);
+  * #pragma omp parallel for
+  * for(int n=0; n < nAngles; ++n)
+  * {
+  *    eigenImage<float> rm;
+  *    rotateMask(rm, mask, angles[n]);
+  *    masks.fillMask(m0 + n, rm);
+  * }
+  *
+  * ims.mean(mim, masks);
+  * \endcode
+  *
+  * \ingroup image_processing
+  *
+  * \test Scenario: Using a bit-packed mask cube \ref tests_improc_bitMaskCube "[test doc]"
+  */
+class bitMaskCube
+{
+public:
+   typedef Eigen::Index Index; ///< The index type
+
+   /// Read access to the mask values of one pixel in every plane
+   class pixelT
+   {
+      const bitMaskCube * m_masks; ///< The mask cube
+      size_t m_word;               ///< The word of the pixel within each mask
+      uint64_t m_bit;              ///< The bit of the pixel within its word
+
+   public:
+      /// Constructor
+      pixelT( const bitMaskCube * masks, ///< [in] the mask cube
+              Index i,                   ///< [in] the row of the pixel
+              Index j                    ///< [in] the column of the pixel
+            );
+
+      /// Get the mask value of the pixel in a plane
+      /** The second argument is ignored, and is present for compatibility with eigenCube::pixel.
+        *
+        * \returns 1 if the pixel is good in plane k
+        * \returns 0 otherwise
+        */
+      int operator()( Index k,    ///< [in] the plane
+                      Index = 0
+                    ) const
+      {
+         return (m_masks->m_bits[m_masks->m_index[k]*m_masks->m_words + m_word] & m_bit) != 0;
+      }
+   };
+
+protected:
+
+   Index m_rows {0}; ///< The number of rows in each mask
+   Index m_cols {0}; ///< The number of columns in each mask
+
+   size_t m_words {0}; ///< The number of 64 bit words per mask
+
+   std::vector<uint64_t> m_bits; ///< The distinct masks, each m_words long
+
+   std::vector<int> m_index; ///< The mask index of each plane
+
+public:
+
+   /// Default c'tor
+   bitMaskCube();
+
+   /// Constructor which sizes the cube.
+   /** See resize().
+     */
+   bitMaskCube( Index rows,  ///< [in] the number of rows in each mask
+                Index cols,  ///< [in] the number of columns in each mask
+                Index planes ///< [in] the number of planes
+              );
+
+   /// Size the cube, removing any masks.
+   /** Every plane is assigned mask 0, so at least one mask must be added before the cube is used.
+     */
+   void resize( Index rows,  ///< [in] the number of rows in each mask
+                Index cols,  ///< [in] the number of columns in each mask
+                Index planes ///< [in] the number of planes
+              );
+
+   /// Get the number of rows
+   /**
+     * \returns the number of rows in each mask
+     */
+   Index rows() const;
+
+   /// Get the number of columns
+   /**
+     * \returns the number of columns in each mask
+     */
+   Index cols() const;
+
+   /// Get the number of planes
+   /**
+     * \returns the number of planes
+     */
+   Index planes() const;
+
+   /// Get the number of distinct masks
+   /**
+     * \returns the number of masks which have been added
+     */
+   int nMasks() const;
+
+   /// Add a distinct mask
+   /** Pixels equal to 1 are set as good, all others as bad.
+     *
+     * \returns the index of the new mask, for use with setMask.
+     *
+     * \throws mx::err::sizeerr if the mask is not rows() x cols()
+     */
+   template<typename imageT>
+   int addMask( const imageT & mask /**< [in] the 1/0 mask image */);
+
+   /// Add distinct masks with every pixel bad, to be filled in later with fillMask.
+   /** Masks must not be added while other threads are filling masks, since the storage may move.
+     *
+     * \returns the index of the first new mask, the others follow it in order.
+     */
+   int addMasks( int N /**< [in] the number of masks to add */);
+
+   /// Set the pixels of an existing mask
+   /** Pixels equal to 1 are set as good, all others as bad.  Each mask has its own words, so different masks can be
+     * filled by different threads at the same time.
+     *
+     * \throws mx::err::sizeerr if the mask is not rows() x cols()
+     * \throws mx::err::invalidarg if the mask index is out of range
+     */
+   template<typename imageT>
+   void fillMask( int maskNo,          ///< [in] the index of the mask, as returned by addMask or addMasks
+                  const imageT & mask  ///< [in] the 1/0 mask image
+                );
+
+   /// Assign a mask to a plane
+   /**
+     * \throws mx::err::invalidarg if the plane or mask index is out of range
+     */
+   void setMask( Index k,   ///< [in] the plane
+                 int maskNo ///< [in] the index of the mask, as returned by addMask
+               );
+
+   /// Get the mask index of a plane
+   /**
+     * \returns the index of the mask assigned to plane k
+     */
+   int maskIndex( Index k /**< [in] the plane */) const;
+
+   /// Get the mask value of a pixel
+   /**
+     * \returns true if the pixel is good
+     * \returns false otherwise
+     */
+   bool good( Index i, ///< [in] the row
+              Index j, ///< [in] the column
+              Index k  ///< [in] the plane
+            ) const;
+
+   /// Get read access to the mask values of a pixel in every plane
+   /**
+     * \returns an object which returns the mask value in plane k from operator()(k, 0)
+     */
+   pixelT pixel( Index i, ///< [in] the row
+                 Index j  ///< [in] the column
+               ) const;
+
+   /// Unpack the mask of one plane as a 1/0 image
+   template<typename imageT>
+   void image( imageT & im, ///< [out] the mask image.  Is resized.
+               Index k      ///< [in] the plane
+             ) const;
+
+   /// Unpack the masks of every plane as a 1/0 cube
+   template<typename cubeT>
+   void cube( cubeT & cu /**< [out] the mask cube, e.g. an eigenCube.  Is resized. */) const;
+};
+
+inline
+bitMaskCube::pixelT::pixelT( const bitMaskCube * masks,
+                             Index i,
+                             Index j
+                           ) : m_masks(masks)
+{
+   size_t p = i + j*masks->m_rows;
+
+   m_word = p / 64;
+   m_bit = static_cast<uint64_t>(1) << (p % 64);
+}
+
+inline
+bool bitMaskCube::good( Index i,
+                        Index j,
+                        Index k
+                      ) const
+{
+   return pixel(i,j)(k);
+}
+
+inline
+bitMaskCube::pixelT bitMaskCube::pixel( Index i,
+                                        Index j
+                                      ) const
+{
+   return pixelT(this, i, j);
+}
+
+template<typename imageT>
+int bitMaskCube::addMask( const imageT & mask )
+{
+   if(mask.rows() != m_rows || mask.cols() != m_cols)
+   {
+      mxThrowException(err::sizeerr, "bitMaskCube::addMask", "mask is not the size of the cube");
+   }
+
+   int maskNo = addMasks(1);
+
+   fillMask(maskNo, mask);
+
+   return maskNo;
+}
+
+template<typename imageT>
+void bitMaskCube::fillMask( int maskNo,
+                            const imageT & mask
+                          )
+{
+   if(mask.rows() != m_rows || mask.cols() != m_cols)
+   {
+      mxThrowException(err::sizeerr, "bitMaskCube::fillMask", "mask is not the size of the cube");
+   }
+
+   if(maskNo < 0 || maskNo >= nMasks())
+   {
+      mxThrowException(err::invalidarg, "bitMaskCube::fillMask", "mask index out of range");
+   }
+
+   uint64_t * bits = m_bits.data() + maskNo*m_words;
+
+   for(size_t w = 0; w < m_words; ++w) bits[w] = 0;
+
+   for(Index j = 0; j < m_cols; ++j)
+   {
+      for(Index i = 0; i < m_rows; ++i)
+      {
+         if(mask(i,j) == 1)
+         {
+            size_t p = i + j*m_rows;
+            bits[p/64] |= static_cast<uint64_t>(1) << (p % 64);
+         }
+      }
+   }
+}
+
+template<typename imageT>
+void bitMaskCube::image( imageT & im,
+                         Index k
+                       ) const
+{
+   im.resize(m_rows, m_cols);
+
+   const uint64_t * bits = m_bits.data() + m_index[k]*m_words;
+
+   for(Index j = 0; j < m_cols; ++j)
+   {
+      for(Index i = 0; i < m_rows; ++i)
+      {
+         size_t p = i + j*m_rows;
+         im(i,j) = (bits[p/64] >> (p % 64)) & 1;
+      }
+   }
+}
+
+template<typename cubeT>
+void bitMaskCube::cube( cubeT & cu ) const
+{
+   cu.resize(m_rows, m_cols, planes());
+
+   for(Index k = 0; k < planes(); ++k)
+   {
+      auto im = cu.image(k);
+      image(im, k);
+   }
+}
+
+} //namespace improc
+} //namespace mx
+
+#endif //bitMaskCube_hpp
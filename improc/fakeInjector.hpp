@@ -0,0 +1,340 @@
+/** \file fakeInjector.hpp
+  * \brief A class to inject shifted copies of a compact PSF into images.
+  * \ingroup image_processing_files
+  * \author Jared R. Males (jaredmales@gmail.com)
+  *
+  */
+
+//***********************************************************************//
+// Copyright 2023 Jared R. Males (jaredmales@gmail.com)
+//
+// This file is part of mxlib.
+//
+// mxlib is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// mxlib is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with mxlib.  If not, see <http://www.gnu.org/licenses/>.
+//***********************************************************************//
+
+#ifndef fakeInjector_hpp
+#define fakeInjector_hpp
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "../mxException.hpp"
+
+#include "eigenImage.hpp"
+#include "imageTransforms.hpp"
+
+namespace mx
+{
+namespace improc
+{
+
+/// Inject sub-pixel shifted copies of a PSF into images, working only on the support of the PSF.
+/** The PSF is centered in the images the same way as padImage or cutPaddedImage would, and then only the bounding box
+  * of its non-zero pixels (optionally limited to a stamp about the center) is kept.  Each injection shifts this stamp
+  * with the same cubic convolution interpolation as \ref imageShift with \ref cubicConvolTransform, so an object at
+  * the center moves to (center + dx, center + dy).  The kernel is separable, so it is calculated once per injection as
+  * two 4 point vectors and applied as a pass along rows followed by a pass along columns of the stamp.
+  *
+  * The result matches adding the output of imageShift to the image, except that imageShift sets pixels within a few
+  * pixels of the image edge to 0 while here the PSF is treated as 0 outside its stamp.
+  *
+  * The inject methods are const, so one fakeInjector can be used by many threads.
+  *
+  * \tparam _realT the real floating point type of the images.
+  *
+  * \ingroup image_transforms
+  *
+  * \test Scenario: Injecting fakes from a stamp \ref tests_improc_fakeInjector "[test doc]"
+  */
+template<typename _realT>
+class fakeInjector
+{
+public:
+   typedef _realT realT; ///< The real floating point type
+
+   typedef eigenImage<realT> imageT; ///< The image type used for the stamp
+
+protected:
+
+   int m_rows {0}; ///< The number of rows in the images
+   int m_cols {0}; ///< The number of columns in the images
+
+   realT m_cubic {-0.5}; ///< The cubic convolution kernel parameter, see \ref cubicConvolTransform.
+
+   imageT m_stamp; ///< The PSF support, padded by 3 zero pixels on each side so interpolation needs no bounds checks
+
+   int m_r0 {0}; ///< The image row of the first row of m_stamp
+   int m_c0 {0}; ///< The image column of the first column of m_stamp
+
+public:
+
+   /// Get the number of rows in the images
+   /**
+     * \returns the current value of m_rows
+     */
+   int rows() const;
+
+   /// Get the number of columns in the images
+   /**
+     * \returns the current value of m_cols
+     */
+   int cols() const;
+
+   /// Get the cubic convolution kernel parameter
+   /**
+     * \returns the current value of m_cubic
+     */
+   realT cubic() const;
+
+   /// Set the cubic convolution kernel parameter
+   void cubic( realT c /**< [in] the new kernel parameter*/);
+
+   /// Get the padded PSF stamp
+   /**
+     * \returns a const reference to m_stamp
+     */
+   const imageT & stamp() const;
+
+   /// Set the PSF to inject into images of a given size.
+   /** The PSF must be either smaller or larger than the images in both dimensions, or the same size.
+     *
+     * \returns 0 on success
+     *
+     * \throws mx::err::sizeerr if the PSF is smaller than the images in one dimension and larger in the other.
+     */
+   int setPSF( const imageT & psf, ///< [in] the PSF, centered
+               int rows,           ///< [in] the number of rows in the images
+               int cols,           ///< [in] the number of columns in the images
+               int stampSize = 0   ///< [in] [optional] if > 0, the PSF is cut to a stampSize x stampSize box about the image center
+             );
+
+   /// Inject one shifted and scaled copy of the PSF into an image
+   void inject( realT * im, ///< [in/out] a column-major rows() x cols() image, e.g. ims.image(n).data()
+                realT dx,   ///< [in] the shift in the row direction
+                realT dy,   ///< [in] the shift in the column direction
+                realT amp   ///< [in] the amplitude by which to multiply the PSF
+              ) const;
+
+   /// Inject several shifted and scaled copies of the PSF into an image
+   void inject( realT * im,                     ///< [in/out] a column-major rows() x cols() image, e.g. ims.image(n).data()
+                const std::vector<realT> & dx,  ///< [in] the shifts in the row direction
+                const std::vector<realT> & dy,  ///< [in] the shifts in the column direction, same size as dx
+                const std::vector<realT> & amp  ///< [in] the amplitudes by which to multiply the PSF, same size as dx
+              ) const;
+
+protected:
+
+   /// Calculate the 4 point kernel, and the integer offset of the source, for a shift
+   void kernel( realT w[4], ///< [out] the kernel weights for source pixels base-1 through base+2
+                int & sh,   ///< [out] the offset of base from the output pixel
+                realT d     ///< [in] the shift
+              ) const;
+};
+
+template<typename realT>
+int fakeInjector<realT>::rows() const
+{
+   return m_rows;
+}
+
+template<typename realT>
+int fakeInjector<realT>::cols() const
+{
+   return m_cols;
+}
+
+template<typename realT>
+realT fakeInjector<realT>::cubic() const
+{
+   return m_cubic;
+}
+
+template<typename realT>
+void fakeInjector<realT>::cubic( realT c )
+{
+   m_cubic = c;
+}
+
+template<typename realT>
+const typename fakeInjector<realT>::imageT & fakeInjector<realT>::stamp() const
+{
+   return m_stamp;
+}
+
+template<typename realT>
+int fakeInjector<realT>::setPSF( const imageT & psf,
+                                 int rows,
+                                 int cols,
+                                 int stampSize
+                               )
+{
+   if( (psf.rows() < rows && psf.cols() >= cols) || (psf.rows() >= rows && psf.cols() < cols))
+   {
+      mxThrowException(err::sizeerr, "fakeInjector::setPSF", "fake PSF has different dimensions and can't be sized properly");
+   }
+
+   m_rows = rows;
+   m_cols = cols;
+
+   //Offset of the PSF in the image, as padImage or cutPaddedImage would place it
+   int offR, offC;
+   if(psf.rows() < rows) offR = 0.5*(rows - psf.rows());
+   else offR = -static_cast<int>(0.5*(psf.rows() - rows));
+
+   if(psf.cols() < cols) offC = 0.5*(cols - psf.cols());
+   else offC = -static_cast<int>(0.5*(psf.cols() - cols));
+
+   //The region of the PSF which can be used, in PSF coordinates
+   int rmin = std::max(0, -offR);
+   int rmax = std::min<int>(psf.rows(), rows - offR);
+   int cmin = std::max(0, -offC);
+   int cmax = std::min<int>(psf.cols(), cols - offC);
+
+   if(stampSize > 0)
+   {
+      rmin = std::max<int>(rmin, 0.5*(rows - stampSize) - offR);
+      rmax = std::min<int>(rmax, 0.5*(rows - stampSize) + stampSize - offR);
+      cmin = std::max<int>(cmin, 0.5*(cols - stampSize) - offC);
+      cmax = std::min<int>(cmax, 0.5*(cols - stampSize) + stampSize - offC);
+   }
+
+   //Find the bounding box of the non-zero pixels
+   int r0 = rmax, r1 = rmin - 1, c0 = cmax, c1 = cmin - 1;
+   for(int c = cmin; c < cmax; ++c)
+   {
+      for(int r = rmin; r < rmax; ++r)
+      {
+         if(psf(r,c) != 0)
+         {
+            r0 = std::min(r0, r);
+            r1 = std::max(r1, r);
+            c0 = std::min(c0, c);
+            c1 = std::max(c1, c);
+         }
+      }
+   }
+
+   if(r1 < r0)
+   {
+      m_stamp.resize(0,0);
+      return 0;
+   }
+
+   m_stamp.setZero(r1 - r0 + 7, c1 - c0 + 7);
+   m_stamp.block(3, 3, r1 - r0 + 1, c1 - c0 + 1) = psf.block(r0, c0, r1 - r0 + 1, c1 - c0 + 1);
+
+   m_r0 = r0 + offR - 3;
+   m_c0 = c0 + offC - 3;
+
+   return 0;
+}
+
+template<typename realT>
+void fakeInjector<realT>::kernel( realT w[4],
+                                  int & sh,
+                                  realT d
+                                ) const
+{
+   //The output pixel i takes the value of the source at i - d = i + sh + f
+   sh = std::floor(-d);
+   realT f = -d - sh;
+
+   cubicConvolTransform<realT> trans(m_cubic);
+
+   w[0] = trans.cubicConvolKernel(1 + f);
+   w[1] = trans.cubicConvolKernel(f);
+   w[2] = trans.cubicConvolKernel(1 - f);
+   w[3] = trans.cubicConvolKernel(2 - f);
+}
+
+template<typename realT>
+void fakeInjector<realT>::inject( realT * im,
+                                  realT dx,
+                                  realT dy,
+                                  realT amp
+                                ) const
+{
+   if(m_stamp.rows() == 0) return;
+
+   realT wr[4], wc[4];
+   int shR, shC;
+
+   kernel(wr, shR, dx);
+   kernel(wc, shC, dy);
+
+   int sr = m_stamp.rows();
+   int sc = m_stamp.cols();
+
+   //Output pixels which can have a source tap on the unpadded stamp.  All taps of these are inside the padded stamp.
+   int i0 = std::max(0, m_r0 + 1 - shR);
+   int i1 = std::min(m_rows, m_r0 + sr - 2 - shR);
+   int j0 = std::max(0, m_c0 + 1 - shC);
+   int j1 = std::min(m_cols, m_c0 + sc - 2 - shC);
+
+   if(i1 <= i0 || j1 <= j0) return;
+
+   int ni = i1 - i0;
+
+   //First pass: interpolate along rows for every stamp column
+   std::vector<realT> tmp(ni*sc);
+
+   for(int c = 0; c < sc; ++c)
+   {
+      const realT * s = m_stamp.data() + c*sr + (i0 + shR - 1 - m_r0);
+      realT * t = tmp.data() + c*ni;
+
+      for(int i = 0; i < ni; ++i)
+      {
+         t[i] = wr[0]*s[i] + wr[1]*s[i+1] + wr[2]*s[i+2] + wr[3]*s[i+3];
+      }
+   }
+
+   //Second pass: interpolate along columns and add to the image
+   for(int j = j0; j < j1; ++j)
+   {
+      int c = j + shC - 1 - m_c0;
+
+      const realT * t0 = tmp.data() + c*ni;
+      const realT * t1 = t0 + ni;
+      const realT * t2 = t1 + ni;
+      const realT * t3 = t2 + ni;
+
+      realT * o = im + j*m_rows + i0;
+
+      for(int i = 0; i < ni; ++i)
+      {
+         o[i] += amp*(wc[0]*t0[i] + wc[1]*t1[i] + wc[2]*t2[i] + wc[3]*t3[i]);
+      }
+   }
+}
+
+template<typename realT>
+void fakeInjector<realT>::inject( realT * im,
+                                  const std::vector<realT> & dx,
+                                  const std::vector<realT> & dy,
+                                  const std::vector<realT> & amp
+                                ) const
+{
+   for(size_t n = 0; n < dx.size(); ++n)
+   {
+      inject(im, dx[n], dy[n], amp[n]);
+   }
+}
+
+} //namespace improc
+} //namespace mx
+
+#endif //fakeInjector_hpp
@@ -0,0 +1,629 @@
+/** \file imageRotator.hpp
+  * \brief A class to rotate many images by the same angle.
+  * \ingroup image_processing_files
+  * \author Jared R. Males (jaredmales@gmail.com)
+  *
+  */
+
+//***********************************************************************//
+// Copyright 2022 Jared R. Males (jaredmales@gmail.com)
+//
+// This file is part of mxlib.
+//
+// mxlib is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// mxlib is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with mxlib.  If not, see <http://www.gnu.org/licenses/>.
+//***********************************************************************//
+
+#ifndef imageRotator_hpp
+#define imageRotator_hpp
+
+#include <vector>
+#include <complex>
+#include <cmath>
+
+#include "../mxException.hpp"
+#include "../math/constants.hpp"
+#include "../math/fft/fft.hpp"
+
+#include "eigenImage.hpp"
+#include "eigenCube.hpp"
+#include "imageTransforms.hpp"
+
+namespace mx
+{
+namespace improc
+{
+
+/// Rotate images by a fixed angle, reusing the interpolation geometry for many images.
+/** Two methods are provided:
+  *
+  * - cubicConvol (the default): the same cubic convolution interpolation as \ref imageRotate with \ref cubicConvolTransform,
+  *   with identical results.  In \ref plan the source pixel and the separable x and y kernel weights are calculated for
+  *   every output pixel in branch-free loops which the compiler can vectorize (for 0 <= x < 1 the 4 kernel
+  *   arguments each fall in a known branch of the kernel).  Each call to \ref rotate is then a 4x4 weighted gather
+  *   per pixel, with no kernel evaluation.
+  * - fftShear: rotation by three successive shears, each applied as a sub-pixel shift of every line with the FFT.  The
+  *   angle is first reduced to [-45,45] degrees by exact 90 degree rotations.  This is flux conserving and does not smooth
+  *   the image, but costs 3 pairs of FFTs per line.  Requires square images.
+  *
+  * In both methods output pixels whose source position is outside the input image are set to 0.
+  *
+  * The rotation is c.c.w. by the angle given to \ref plan, with the same convention as \ref imageRotate.
+  * An imageRotator holds working memory so a separate object should be used by each thread.
+  *
+  * \tparam _realT the real floating point type of the images.
+  *
+  * \ingroup image_transforms
+  */
+template<typename _realT>
+class imageRotator
+{
+public:
+   typedef _realT realT; ///< The real floating point type
+
+   typedef std::complex<realT> complexT; ///< The complex floating point type
+
+   typedef eigenImage<realT> imageT; ///< The image type used for working memory
+
+   typedef Eigen::Array<complexT, Eigen::Dynamic, 1> lineT; ///< The line type used for the FFT shears
+
+   /// The rotation methods
+   enum methods { cubicConvol, ///< Cubic convolution interpolation, identical to \ref imageRotate
+                  fftShear     ///< Three shears applied with the FFT
+                };
+
+protected:
+
+   int m_method {cubicConvol}; ///< The rotation method
+
+   realT m_cubic {-0.5}; ///< The cubic convolution kernel parameter, see \ref cubicConvolTransform.
+
+   int m_rows {0}; ///< The number of rows in the planned geometry
+   int m_cols {0}; ///< The number of columns in the planned geometry
+
+   realT m_dq {0}; ///< The planned rotation angle [rad]
+
+   imageT m_rotim; ///< Working memory for rotating cube planes in place
+
+   /** \name Cubic Convolution Plan
+     * @{
+     */
+   std::vector<int> m_srcIdx; ///< Linear index of the lower-left pixel of the 4x4 source block for each output pixel, -1 if outside
+
+   imageT m_wx; ///< The x kernel weights, one column per kernel point
+
+   imageT m_wy; ///< The y kernel weights, one column per kernel point
+   ///@}
+
+   /** \name FFT Shear Plan
+     * @{
+     */
+   int m_n90 {0}; ///< The number of 90 degree c.c.w. rotations applied before the shears
+
+   realT m_shearX {0}; ///< The x shear, tan(q/2) of the remainder angle
+
+   realT m_shearY {0}; ///< The y shear, -sin(q) of the remainder angle
+
+   realT m_cq {1}; ///< cos of the full angle, for the output bounds
+
+   realT m_sq {0}; ///< sin of the full angle, for the output bounds
+
+   int m_padSz {0}; ///< The zero padded length of each line
+
+   lineT m_line; ///< Working memory for a line
+
+   lineT m_lineFT; ///< Working memory for the FT of a line
+
+   imageT m_work; ///< Working memory for intermediate shears
+
+   math::fft::fftT<complexT, complexT, 1, 0> m_fft_fwd; ///< FFT object for the forward transform.
+
+   math::fft::fftT<complexT, complexT, 1, 0> m_fft_back; ///< FFT object for the backward transform.
+   ///@}
+
+public:
+
+   /// Default c'tor
+   imageRotator();
+
+   /// Constructor setting the method
+   explicit imageRotator( int meth /**< [in] the rotation method, a member of \ref methods*/);
+
+   /// Get the rotation method
+   /**
+     * \returns the current value of m_method
+     */
+   int method() const;
+
+   /// Set the rotation method
+   /** This invalidates the current plan.
+     */
+   void method( int meth /**< [in] the new rotation method, a member of \ref methods */);
+
+   /// Get the cubic convolution kernel parameter
+   /**
+     * \returns the current value of m_cubic
+     */
+   realT cubic() const;
+
+   /// Set the cubic convolution kernel parameter
+   /** This invalidates the current plan.
+     */
+   void cubic( realT c /**< [in] the new kernel parameter*/);
+
+   /// Get the planned angle
+   /**
+     * \returns the current value of m_dq
+     */
+   realT angle() const;
+
+   /// Plan the rotation of images of a given size by a given angle.
+   /**
+     * \returns 0 on success
+     *
+     * \throws mx::err::sizeerr if the method is fftShear and the image is not square.
+     */
+   int plan( int rows, ///< [in] the number of rows in the images
+             int cols, ///< [in] the number of columns in the images
+             realT dq  ///< [in] the angle, in radians, by which to rotate in the c.c.w. direction
+           );
+
+   /// Rotate an image using the current plan.
+   /** The output must not be the same as the input.
+     *
+     * \throws mx::err::sizeerr if the input is not the planned size
+     */
+   template<typename outT, typename inT>
+   void rotate( outT & rotim,   ///< [out] the rotated image. Is resized.
+                const inT & im  ///< [in] the image to rotate
+              );
+
+   /// Rotate the same plane of each cube in a vector in place using the current plan.
+   /** This is used to derotate each of several reductions of the same data, which share the rotation angle of each plane.
+     */
+   void rotate( std::vector<eigenCube<realT>> & cubes, ///< [in/out] the cubes, on output the plane has been rotated in each.
+                int plane                              ///< [in] the plane to rotate
+              );
+
+protected:
+
+   /// Plan a cubic convolution rotation
+   void planCubic();
+
+   /// Plan an FFT shear rotation
+   void planFFTShear();
+
+   /// Apply the cubic convolution rotation
+   template<typename outT, typename inT>
+   void rotateCubic( outT & rotim,
+                     const inT & im
+                   );
+
+   /// Apply the FFT shear rotation
+   template<typename outT, typename inT>
+   void rotateFFTShear( outT & rotim,
+                        const inT & im
+                      );
+
+   /// Shift a line by a sub-pixel amount using the FFT.
+   /** On entry the first N points of m_line contain the line, zero padded to m_padSz.
+     * On exit the first N points contain the shifted line, where the new value at x is the old value at x + dx.
+     */
+   void shiftLine( int N,
+                   realT dx
+                 );
+};
+
+template<typename realT>
+imageRotator<realT>::imageRotator()
+{
+}
+
+template<typename realT>
+imageRotator<realT>::imageRotator( int meth )
+{
+   method(meth);
+}
+
+template<typename realT>
+int imageRotator<realT>::method() const
+{
+   return m_method;
+}
+
+template<typename realT>
+void imageRotator<realT>::method( int meth )
+{
+   if(meth != cubicConvol && meth != fftShear)
+   {
+      mxThrowException(err::invalidarg, "imageRotator::method", "invalid rotation method");
+   }
+
+   m_method = meth;
+   m_rows = 0;
+   m_cols = 0;
+}
+
+template<typename realT>
+realT imageRotator<realT>::cubic() const
+{
+   return m_cubic;
+}
+
+template<typename realT>
+void imageRotator<realT>::cubic( realT c )
+{
+   m_cubic = c;
+   m_rows = 0;
+   m_cols = 0;
+}
+
+template<typename realT>
+realT imageRotator<realT>::angle() const
+{
+   return m_dq;
+}
+
+template<typename realT>
+int imageRotator<realT>::plan( int rows,
+                               int cols,
+                               realT dq
+                             )
+{
+   if(m_method == fftShear && rows != cols)
+   {
+      mxThrowException(err::sizeerr, "imageRotator::plan", "fftShear rotation requires square images");
+   }
+
+   if(rows == m_rows && cols == m_cols && dq == m_dq)
+   {
+      return 0;
+   }
+
+   m_rows = rows;
+   m_cols = cols;
+   m_dq = dq;
+
+   if(m_method == fftShear)
+   {
+      planFFTShear();
+   }
+   else
+   {
+      planCubic();
+   }
+
+   return 0;
+}
+
+template<typename realT>
+void imageRotator<realT>::planCubic()
+{
+   const int lbuff = cubicConvolTransform<realT>::lbuff;
+   const int width = cubicConvolTransform<realT>::width;
+
+   int Nrows = m_rows;
+   int Ncols = m_cols;
+
+   realT cosq = cos(m_dq);
+   realT sinq = sin(m_dq);
+
+   // The geometric image center
+   realT xcen = 0.5 * (Nrows - 1.);
+   realT ycen = 0.5 * (Ncols - 1.);
+
+   int xulim = Nrows - width + lbuff;
+   int yulim = Ncols - width + lbuff;
+
+   realT xc_x_cosq = xcen * cosq + ycen * sinq;
+   realT xc_x_sinq = xcen * sinq - ycen * cosq;
+
+   realT a = m_cubic;
+
+   m_srcIdx.resize(Nrows*Ncols);
+   m_wx.resize(Nrows*Ncols, width);
+   m_wy.resize(Nrows*Ncols, width);
+
+   int * srcIdx = m_srcIdx.data();
+   realT * wx0 = m_wx.col(0).data();
+   realT * wx1 = m_wx.col(1).data();
+   realT * wx2 = m_wx.col(2).data();
+   realT * wx3 = m_wx.col(3).data();
+   realT * wy0 = m_wy.col(0).data();
+   realT * wy1 = m_wy.col(1).data();
+   realT * wy2 = m_wy.col(2).data();
+   realT * wy3 = m_wy.col(3).data();
+
+   //Output pixels are stored in column-major order to match the Eigen storage of the output image
+   for(int j = 0; j < Ncols; ++j)
+   {
+      realT j_x_sinq = j * sinq - xc_x_cosq;
+      realT j_x_cosq = j * cosq + xc_x_sinq;
+
+      int off = j*Nrows;
+
+      #pragma omp simd
+      for(int i = 0; i < Nrows; ++i)
+      {
+         // This is the rotation matrix of imageRotate:
+         // x0 =  (i-xcen)*cosq + (j-ycen)*sinq;
+         // y0 = -(i-xcen)*sinq + (j-ycen)*cosq;
+         realT x0 = i * cosq + j_x_sinq;
+         realT y0 = -i * sinq + j_x_cosq;
+
+         int i0 = x0 + xcen;
+         int j0 = y0 + ycen;
+
+         bool inside = !(i0 <= lbuff || i0 >= xulim || j0 <= lbuff || j0 >= yulim);
+
+         realT x = x0 + xcen - i0;
+         realT y = y0 + ycen - j0;
+
+         // For 0 <= x < 1, 1+x and 2-x are in [1,2), x and 1-x are in [0,1].
+         realT d = 1 + x;
+         wx0[off+i] = a*d*d*d - 5*a*d*d + 8*a*d - 4*a;
+         d = x;
+         wx1[off+i] = (a+2)*d*d*d - (a+3)*d*d + 1;
+         d = 1 - x;
+         wx2[off+i] = (a+2)*d*d*d - (a+3)*d*d + 1;
+         d = 2 - x;
+         wx3[off+i] = a*d*d*d - 5*a*d*d + 8*a*d - 4*a;
+
+         d = 1 + y;
+         wy0[off+i] = a*d*d*d - 5*a*d*d + 8*a*d - 4*a;
+         d = y;
+         wy1[off+i] = (a+2)*d*d*d - (a+3)*d*d + 1;
+         d = 1 - y;
+         wy2[off+i] = (a+2)*d*d*d - (a+3)*d*d + 1;
+         d = 2 - y;
+         wy3[off+i] = a*d*d*d - 5*a*d*d + 8*a*d - 4*a;
+
+         srcIdx[off+i] = inside ? (i0 - lbuff) + (j0 - lbuff)*Nrows : -1;
+      }
+   }
+}
+
+template<typename realT>
+void imageRotator<realT>::planFFTShear()
+{
+   realT q = m_dq;
+
+   m_cq = cos(q);
+   m_sq = sin(q);
+
+   //Reduce to [-45,45] with exact 90 degree rotations
+   m_n90 = std::lround(q / math::half_pi<realT>());
+   q -= m_n90*math::half_pi<realT>();
+   m_n90 %= 4;
+   if(m_n90 < 0) m_n90 += 4;
+
+   m_shearX = tan(0.5*q);
+   m_shearY = -sin(q);
+
+   //Zero pad to avoid wrapping, shifts are never larger than 0.5*N
+   m_padSz = 2*m_rows;
+
+   m_line.resize(m_padSz);
+   m_lineFT.resize(m_padSz);
+   m_work.resize(m_rows, m_cols);
+
+   #pragma omp critical
+   {
+      m_fft_fwd.plan(m_padSz, MXFFT_FORWARD, false);
+      m_fft_back.plan(m_padSz, MXFFT_BACKWARD, false);
+   }
+}
+
+template<typename realT>
+template<typename outT, typename inT>
+void imageRotator<realT>::rotate( outT & rotim,
+                                  const inT & im
+                                )
+{
+   if(im.rows() != m_rows || im.cols() != m_cols)
+   {
+      mxThrowException(err::sizeerr, "imageRotator::rotate", "image is not the planned size");
+   }
+
+   rotim.resize(m_rows, m_cols);
+
+   if(m_method == fftShear)
+   {
+      rotateFFTShear(rotim, im);
+   }
+   else
+   {
+      rotateCubic(rotim, im);
+   }
+}
+
+template<typename realT>
+void imageRotator<realT>::rotate( std::vector<eigenCube<realT>> & cubes,
+                                  int plane
+                                )
+{
+   for(size_t n = 0; n < cubes.size(); ++n)
+   {
+      rotate(m_rotim, cubes[n].image(plane));
+      cubes[n].image(plane) = m_rotim;
+   }
+}
+
+template<typename realT>
+template<typename outT, typename inT>
+void imageRotator<realT>::rotateCubic( outT & rotim,
+                                       const inT & im
+                                     )
+{
+   int Nrows = m_rows;
+   int Npix = m_rows*m_cols;
+
+   const int * srcIdx = m_srcIdx.data();
+   const realT * wx0 = m_wx.col(0).data();
+   const realT * wx1 = m_wx.col(1).data();
+   const realT * wx2 = m_wx.col(2).data();
+   const realT * wx3 = m_wx.col(3).data();
+   const realT * wy0 = m_wy.col(0).data();
+   const realT * wy1 = m_wy.col(1).data();
+   const realT * wy2 = m_wy.col(2).data();
+   const realT * wy3 = m_wy.col(3).data();
+
+   //Use a contiguous copy if the input is not a plain column-major image
+   imageT imc;
+   const realT * imd;
+   if(im.innerStride() == 1 && im.outerStride() == Nrows)
+   {
+      imd = im.data();
+   }
+   else
+   {
+      imc = im;
+      imd = imc.data();
+   }
+
+   realT * out = rotim.data();
+
+   #pragma omp simd
+   for(int k = 0; k < Npix; ++k)
+   {
+      int s = srcIdx[k];
+
+      //Test first, the 4x4 block of a pixel outside the image may not be inside the buffer
+      if(s < 0)
+      {
+         out[k] = 0;
+      }
+      else
+      {
+         const realT * c0 = imd + s;
+         const realT * c1 = c0 + Nrows;
+         const realT * c2 = c1 + Nrows;
+         const realT * c3 = c2 + Nrows;
+
+         realT v = wy0[k]*(wx0[k]*c0[0] + wx1[k]*c0[1] + wx2[k]*c0[2] + wx3[k]*c0[3]);
+         v += wy1[k]*(wx0[k]*c1[0] + wx1[k]*c1[1] + wx2[k]*c1[2] + wx3[k]*c1[3]);
+         v += wy2[k]*(wx0[k]*c2[0] + wx1[k]*c2[1] + wx2[k]*c2[2] + wx3[k]*c2[3]);
+         v += wy3[k]*(wx0[k]*c3[0] + wx1[k]*c3[1] + wx2[k]*c3[2] + wx3[k]*c3[3]);
+
+         out[k] = v;
+      }
+   }
+}
+
+template<typename realT>
+void imageRotator<realT>::shiftLine( int N,
+                                     realT dx
+                                   )
+{
+   for(int k = N; k < m_padSz; ++k) m_line(k) = 0;
+
+   m_fft_fwd(m_lineFT.data(), m_line.data());
+
+   //new(x) = old(x + dx) is a phase ramp of exp(+2 pi i k dx / M)
+   realT ph = math::two_pi<realT>() * dx / m_padSz;
+   realT norm = 1.0/m_padSz;
+
+   int half = m_padSz/2;
+   for(int k = 0; k < m_padSz; ++k)
+   {
+      int kk = (k < half) ? k : k - m_padSz;
+      m_lineFT(k) *= std::polar(norm, ph*kk);
+   }
+
+   //The Nyquist term (m_padSz is even) must be real for a real shift
+   m_lineFT(half) *= std::cos(ph*half) / std::polar<realT>(1, -ph*half);
+
+   m_fft_back(m_line.data(), m_lineFT.data());
+}
+
+template<typename realT>
+template<typename outT, typename inT>
+void imageRotator<realT>::rotateFFTShear( outT & rotim,
+                                          const inT & im
+                                        )
+{
+   int N = m_rows;
+   realT cen = 0.5*(N-1);
+
+   //First the exact 90 degree rotations, out(i,j) = in(R90^n (i,j))
+   for(int j = 0; j < N; ++j)
+   {
+      for(int i = 0; i < N; ++i)
+      {
+         switch(m_n90)
+         {
+            case 1:
+               m_work(i,j) = im(j, N-1-i);
+               break;
+            case 2:
+               m_work(i,j) = im(N-1-i, N-1-j);
+               break;
+            case 3:
+               m_work(i,j) = im(N-1-j, i);
+               break;
+            default:
+               m_work(i,j) = im(i,j);
+         }
+      }
+   }
+
+   //R(q) = Sx(t) Sy(-s) Sx(t), applied as out(p) = in(Sx Sy Sx p)
+
+   //x shear: f1(x,y) = in(x + t*(y-cen), y), shifts each column along x
+   for(int j = 0; j < N; ++j)
+   {
+      for(int i = 0; i < N; ++i) m_line(i) = m_work(i,j);
+      shiftLine(N, m_shearX*(j-cen));
+      for(int i = 0; i < N; ++i) m_work(i,j) = m_line(i).real();
+   }
+
+   //y shear: f2(x,y) = f1(x, y - s*(x-cen)), shifts each row along y
+   for(int i = 0; i < N; ++i)
+   {
+      for(int j = 0; j < N; ++j) m_line(j) = m_work(i,j);
+      shiftLine(N, m_shearY*(i-cen));
+      for(int j = 0; j < N; ++j) m_work(i,j) = m_line(j).real();
+   }
+
+   //x shear again
+   for(int j = 0; j < N; ++j)
+   {
+      for(int i = 0; i < N; ++i) m_line(i) = m_work(i,j);
+      shiftLine(N, m_shearX*(j-cen));
+      for(int i = 0; i < N; ++i) m_work(i,j) = m_line(i).real();
+   }
+
+   //Zero the pixels whose source is outside the input image
+   for(int j = 0; j < N; ++j)
+   {
+      for(int i = 0; i < N; ++i)
+      {
+         realT x0 = (i-cen)*m_cq + (j-cen)*m_sq + cen;
+         realT y0 = -(i-cen)*m_sq + (j-cen)*m_cq + cen;
+
+         if(x0 < 0 || x0 > N-1 || y0 < 0 || y0 > N-1)
+         {
+            rotim(i,j) = 0;
+         }
+         else
+         {
+            rotim(i,j) = m_work(i,j);
+         }
+      }
+   }
+}
+
+} //namespace improc
+} //namespace mx
+
+#endif //imageRotator_hpp
@@ -28,6 +28,10 @@
 #define improc_imageUtils_hpp
 
 
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
 #include "imageTransforms.hpp"
 
 namespace mx
@@ -57,39 +61,64 @@ int reflectImageCoords( int & x1, ///< [out] the reflected x coordinate
    return 0;
 }
 
-/// Zero any NaNs in an image
+#ifndef MX_IMPROC_IMAGEUTILS_OMP_MIN
+///The minimum number of pixels for which the image utilities use multiple threads.
+/** Below this the overhead of starting threads exceeds the benefit.
+  */
+#define MX_IMPROC_IMAGEUTILS_OMP_MIN (1048576)
+#endif
+
+/// Zero any NaNs, infinities, and subnormal values in an image
+/** Any pixel for which std::isnormal would be false is set to 0.  The test is done without
+  * branches so the inner loop vectorizes, and large images are processed in parallel.
+  */
 template<class imageT>
 void zeroNaNs( imageT & im /**< [in/out] image which will have any NaN pixels set to zero */)
 {
+   typedef typename imageT::Scalar dataT;
+
+   const dataT lo = std::numeric_limits<dataT>::min();
+   const dataT hi = std::numeric_limits<dataT>::max();
+
+   #pragma omp parallel for if(im.rows()*im.cols() >= MX_IMPROC_IMAGEUTILS_OMP_MIN)
    for(int c=0; c< im.cols(); ++c)
    {
+      #pragma omp simd
       for(int r=0; r< im.rows(); ++r)
       {
-         if( !std::isnormal( im(r,c) ) )
-         {
-            im(r,c) = 0;
-         }
+         dataT a = std::abs(im(r,c));
+         im(r,c) = (a >= lo && a <= hi) ? im(r,c) : 0;
       }
    }
 }
 
+/// Zero any NaNs, infinities, and subnormal values in a contiguous buffer
+/** Any value for which std::isnormal would be false is set to 0.  The buffer is processed in parallel, with 
+  * vectorized inner loops.
+  */
+template<typename dataT>
+void zeroNaNs( dataT * data, ///< [in/out] the buffer which will have any NaN values set to zero
+               size_t N      ///< [in] the number of values in the buffer
+             )
+{
+   const dataT lo = std::numeric_limits<dataT>::min();
+   const dataT hi = std::numeric_limits<dataT>::max();
+
+   #pragma omp parallel for simd if(N >= MX_IMPROC_IMAGEUTILS_OMP_MIN)
+   for(size_t n = 0; n < N; ++n)
+   {
+      dataT a = std::abs(data[n]);
+      data[n] = (a >= lo && a <= hi) ? data[n] : 0;
+   }
+}
+
 /// Zero any NaNs in an image cube
+/** Operates on the contiguous cube data with \ref zeroNaNs(dataT*, size_t).
+  */
 template<class cubeT>
 void zeroNaNCube( cubeT & imc /**< [in/out] cube which will have any NaN pixels set to zero */)
 {
-   for(int p=0; p< imc.planes(); ++p) 
-   {
-      for(int c=0; c< imc.cols(); ++c)
-      {
-         for(int r=0; r< imc.rows(); ++r)
-         {
-            if( !std::isnormal( imc.image(p)(r,c) ) )
-            {
-               imc.image(p)(r,c) = 0;
-            }
-         }
-      }
-   }
+   zeroNaNs(imc.data(), ((size_t) imc.rows())*imc.cols()*imc.planes());
 }
 
 /// Calculate the mean value of an image
@@ -102,8 +131,10 @@ typename imageT::Scalar imageMean(imageT & im /**< [in] the image of which to ca
 {
    typename imageT::Scalar m = 0;
    
+   #pragma omp parallel for reduction(+:m) if(im.rows()*im.cols() >= MX_IMPROC_IMAGEUTILS_OMP_MIN)
    for(int c=0;c<im.cols();++c)
    {
+      #pragma omp simd reduction(+:m)
       for(int r=0;r<im.rows();++r)
       {
          m += im(r,c);
@@ -127,11 +158,14 @@ typename imageT::Scalar imageVariance( imageT & im,                 ///< [in] th
 {
    typename imageT::Scalar v = 0;
    
+   #pragma omp parallel for reduction(+:v) if(im.rows()*im.cols() >= MX_IMPROC_IMAGEUTILS_OMP_MIN)
    for(int c=0;c<im.cols();++c)
    {
+      #pragma omp simd reduction(+:v)
       for(int r=0;r<im.rows();++r)
       {
-         v += pow(im(r,c)-mean,2);
+         typename imageT::Scalar d = im(r,c)-mean;
+         v += d*d;
       }
    }
    
@@ -140,6 +174,173 @@ typename imageT::Scalar imageVariance( imageT & im,                 ///< [in] th
    return v;
 }
 
+/// Statistics of the values in an image or cube
+/** Calculated by \ref bufferStats and related functions.
+  */
+template<typename realT>
+struct imageStats
+{
+   size_t n {0};       ///< The number of values included
+   realT mean {0};     ///< The mean of the included values
+   realT variance {0}; ///< The variance of the included values about the mean, normalized by n
+   realT min {0};      ///< The minimum included value
+   realT max {0};      ///< The maximum included value
+};
+
+namespace impl
+{
+
+/// Implementation of the buffer statistics, optionally zeroing NaNs and applying a mask in the same pass
+/** The sums are accumulated relative to the first value in the buffer, which preserves precision in the 
+  * variance without requiring a second pass.  The count is kept as an integer and the sums in at least double
+  * precision, so that the result does not depend on statT or on the number of threads for large buffers.
+  */
+template<bool scrub, bool masked, typename statT, typename dataT, typename maskT>
+void bufferStats( imageStats<statT> & stats,
+                  dataT * data,
+                  size_t N,
+                  const maskT * mask
+                )
+{
+   typedef typename std::conditional<(sizeof(statT) > sizeof(double)), statT, double>::type accumT;
+
+   const dataT lo = std::numeric_limits<dataT>::min();
+   const dataT hi = std::numeric_limits<dataT>::max();
+
+   stats = imageStats<statT>();
+   
+   if(N == 0) return;
+
+   accumT K = data[0];
+   if(scrub)
+   {
+      dataT a = std::abs(data[0]);
+      K = (a >= lo && a <= hi) ? data[0] : 0;
+   }
+
+   accumT sum = 0;
+   accumT sum2 = 0;
+   size_t cnt = 0;
+   statT mn = std::numeric_limits<statT>::max();
+   statT mx = std::numeric_limits<statT>::lowest();
+
+   #pragma omp parallel for simd reduction(+:sum,sum2,cnt) reduction(min:mn) reduction(max:mx) if(N >= MX_IMPROC_IMAGEUTILS_OMP_MIN)
+   for(size_t n = 0; n < N; ++n)
+   {
+      dataT x = data[n];
+      
+      if(scrub)
+      {
+         dataT a = std::abs(x);
+         x = (a >= lo && a <= hi) ? x : 0;
+         data[n] = x;
+      }
+
+      size_t w = 1;
+      if(masked) w = (mask[n] == 1);
+
+      accumT d = w*(x - K);
+      sum += d;
+      sum2 += d*d;
+      cnt += w;
+      
+      mn = std::min(mn, (w > 0) ? (statT) x : std::numeric_limits<statT>::max());
+      mx = std::max(mx, (w > 0) ? (statT) x : std::numeric_limits<statT>::lowest());
+   }
+
+   if(cnt == 0) return;
+
+   accumT mean = sum/cnt;
+   accumT var = sum2/cnt - mean*mean;
+
+   stats.n = cnt;
+   stats.mean = K + mean;
+   stats.variance = (var < 0) ? 0 : var;
+   stats.min = mn;
+   stats.max = mx;
+}
+
+} //namespace impl
+
+/// Calculate the statistics of a contiguous buffer
+/** The buffer is processed in parallel with vectorized inner loops.  The data should not contain NaNs, see \ref zeroNaNsStats.
+  */
+template<typename statT, typename dataT>
+void bufferStats( imageStats<statT> & stats, ///< [out] the statistics of the buffer
+                  const dataT * data,        ///< [in] the buffer
+                  size_t N                   ///< [in] the number of values in the buffer
+                )
+{
+   impl::bufferStats<false, false>(stats, const_cast<dataT *>(data), N, (const dataT *) nullptr);
+}
+
+/// Calculate the statistics of the values in a contiguous buffer selected by a mask
+/** Only values where the mask is 1 are included.
+  */
+template<typename statT, typename dataT, typename maskT>
+void bufferStats( imageStats<statT> & stats, ///< [out] the statistics of the values where mask is 1
+                  const dataT * data,        ///< [in] the buffer
+                  const maskT * mask,        ///< [in] the 1/0 mask, the same size as the buffer
+                  size_t N                   ///< [in] the number of values in the buffer
+                )
+{
+   impl::bufferStats<false, true>(stats, const_cast<dataT *>(data), N, mask);
+}
+
+/// Zero any NaNs in a contiguous buffer and calculate its statistics in a single pass
+/** The result is the same as calling \ref zeroNaNs(dataT*, size_t) and then \ref bufferStats, but the data is only 
+  * read once.
+  */
+template<typename statT, typename dataT>
+void zeroNaNsStats( imageStats<statT> & stats, ///< [out] the statistics of the buffer after zeroing NaNs
+                    dataT * data,              ///< [in/out] the buffer which will have any NaN values set to zero
+                    size_t N                   ///< [in] the number of values in the buffer
+                  )
+{
+   impl::bufferStats<true, false>(stats, data, N, (const dataT *) nullptr);
+}
+
+/// Zero any NaNs in a contiguous buffer and calculate the statistics of the values selected by a mask in a single pass
+/** All NaNs are zeroed, but only values where the mask is 1 are included in the statistics.
+  */
+template<typename statT, typename dataT, typename maskT>
+void zeroNaNsStats( imageStats<statT> & stats, ///< [out] the statistics of the values where mask is 1 after zeroing NaNs
+                    dataT * data,              ///< [in/out] the buffer which will have any NaN values set to zero
+                    const maskT * mask,        ///< [in] the 1/0 mask, the same size as the buffer
+                    size_t N                   ///< [in] the number of values in the buffer
+                  )
+{
+   impl::bufferStats<true, true>(stats, data, N, mask);
+}
+
+/// Calculate the statistics of an image cube
+template<typename statT, class cubeT>
+void cubeStats( imageStats<statT> & stats, ///< [out] the statistics of the cube
+                const cubeT & imc          ///< [in] the cube
+              )
+{
+   bufferStats(stats, imc.data(), ((size_t) imc.rows())*imc.cols()*imc.planes());
+}
+
+/// Calculate the statistics of the pixels in an image cube selected by a mask cube
+template<typename statT, class cubeT, class maskCubeT>
+void cubeStats( imageStats<statT> & stats, ///< [out] the statistics of the pixels where the mask is 1
+                const cubeT & imc,         ///< [in] the cube
+                const maskCubeT & maskc    ///< [in] the 1/0 mask cube, the same size as imc
+              )
+{
+   bufferStats(stats, imc.data(), maskc.data(), ((size_t) imc.rows())*imc.cols()*imc.planes());
+}
+
+/// Zero any NaNs in an image cube and calculate its statistics in a single pass
+template<typename statT, class cubeT>
+void zeroNaNCube( cubeT & imc,              ///< [in/out] cube which will have any NaN pixels set to zero
+                  imageStats<statT> & stats ///< [out] the statistics of the cube after zeroing NaNs
+                )
+{
+   zeroNaNsStats(stats, imc.data(), ((size_t) imc.rows())*imc.cols()*imc.planes());
+}
+
 template<typename imageT>
 int imageCenterOfLight( typename imageT::Scalar & x,
                         typename imageT::Scalar & y,
@@ -27,7 +27,13 @@
 #ifndef imageXCorrFFT_hpp
 #define imageXCorrFFT_hpp
 
+#include <vector>
+#include <memory>
+
+#include <omp.h>
+
 #include "../mxError.hpp"
+#include "../math/constants.hpp"
 #include "../math/fft/fft.hpp"
 #include "../math/fit/fitGaussian.hpp"
 
@@ -46,6 +52,13 @@ namespace improc
   * to shift the input image by the negative of the shifts, it will align with the 
   * reference.
   * 
+  * The sub-pixel peak is found either by fitting a 2D Gaussian to the cross-correlation, or by evaluating 
+  * the cross-correlation on an upsampled grid around the peak with a matrix-multiply DFT (Guizar-Sicairos et al, 2008, 
+  * Opt. Lett. 33, 156).  With the DFT method and a non-zero maxLag, the initial integer peak is also found with the 
+  * matrix-multiply DFT over lags up to maxLag, so the full inverse FFT is not needed.
+  * 
+  * Whole cubes can be registered with \ref registerCube, which processes the images in parallel.
+  * 
   * \todo This needs to be brought up to the same standard as imageXCorrFFT.  Perhaps folded in as an alternative method?
   *
   * \tparam _ccImT is the Eigen-like array type used for image processing.  See typedefs.
@@ -68,6 +81,11 @@ public:
    
    typedef Eigen::Array<complexT, Eigen::Dynamic, Eigen::Dynamic> complexArrayT; ///< Complex eigen array type with Scalar==complexT
    
+   /// The methods for finding the sub-pixel peak of the cross-correlation
+   enum peakMethods { gaussFit,    ///< Fit a 2D Gaussian to the cross-correlation around the peak
+                      dftUpsample  ///< Find the peak on an upsampled grid calculated by matrix-multiply DFT
+                    };
+   
 protected:
    
    int m_rows {0};
@@ -87,12 +105,23 @@ protected:
    
    math::fft::fftT< complexT, realT,2,0> m_fft_back; ///< FFT object for the backward transfsorm.
    
+   complexArrayT m_dftRowKern; ///< The row kernel for the matrix-multiply DFT.
+   
+   complexArrayT m_dftColKern; ///< The column kernel for the matrix-multiply DFT.
+   
+   complexArrayT m_dftWork; ///< Working memory for the matrix-multiply DFT.
+   
+   realArrayT m_dftIm; ///< The cross-correlation evaluated by the matrix-multiply DFT.
+   
    ///@}
    
    math::fit::fitGaussian2D<mx::math::fit::gaussian2D_gen_fitter<Scalar>> m_fitter;
    
    int m_maxLag {0}; ///< The maximum lag to consider in the initial cross-correlation.  
    
+   int m_peakMethod {gaussFit}; ///< The method used to find the sub-pixel peak.  See \ref peakMethods.
+   
+   int m_upsample {100}; ///< The upsampling factor used by the dftUpsample peak method.
    
 public:
    
@@ -111,6 +140,26 @@ public:
    /// Set the maximum lag
    void maxLag( int ml /**< [in] the new maximum lag */);
    
+   /// Get the current peak method
+   /**
+     * \returns the current value of m_peakMethod
+     */
+   int peakMethod();
+   
+   /// Set the peak method
+   void peakMethod( int pm /**< [in] the new peak method, a member of \ref peakMethods */);
+   
+   /// Get the current upsampling factor
+   /**
+     * \returns the current value of m_upsample
+     */
+   int upsample();
+   
+   /// Set the upsampling factor used by the dftUpsample peak method
+   /** The peak is located to a precision of 1/upsample pixels.
+     */
+   void upsample( int us /**< [in] the new upsampling factor */);
+   
    /// Set the size of the cross-correlation images.
    /** This resizes all working memory and conducts fftw planning.
      *
@@ -131,7 +180,24 @@ public:
    
 protected:
 
-
+   /// Evaluate the cross-correlation on a grid of points using a matrix-multiply DFT.
+   /** Uses the cross-power spectrum in m_ftWork, and fills in m_dftIm with the W x W grid starting 
+     * at (x0, y0) with spacing step.  Coordinates are those of the inverse FFT of m_ftWork.
+     */
+   void dftWindow( realT x0,   ///< [in] the first x coordinate
+                   realT y0,   ///< [in] the first y coordinate
+                   int W,      ///< [in] the number of points in each direction
+                   realT step  ///< [in] the spacing of the points, in pixels
+                 );
+   
+   /// Find the peak of the cross-correlation using the cross-power spectrum in m_ftWork
+   /**
+     * \returns 0 on success
+     * \returns -1 on error
+     */ 
+   int findPeak( Scalar & xShift, ///< [out] the x shift of im w.r.t. im0, in pixels
+                 Scalar & yShift  ///< [out] the y shift of im w.r.t. im0, in pixels
+               );
       
 public:
    
@@ -157,6 +223,32 @@ public:
                    im0T & im0,      ///< [in] the reference image
                    imT & im         ///< [in] the image to cross-correlate with the reference
                  );
+   
+   /// Find the shifts of every image in a cube w.r.t. the reference
+   /** The images are processed in parallel, with one set of FFT plans and working memory per thread.
+     * The reference must have been set with \ref setReference.
+     * 
+     * \returns 0 on success
+     * \returns -1 on error
+     */ 
+   template<class cubeT>
+   int registerCube( std::vector<Scalar> & xShifts, ///< [out] the x shift of each image w.r.t. the reference.  Is resized.
+                     std::vector<Scalar> & yShifts, ///< [out] the y shift of each image w.r.t. the reference.  Is resized.
+                     const cubeT & ims              ///< [in] the cube of images to register
+                   );
+   
+   /// Find the shifts of every image in a cube w.r.t. the reference, and shift the images to align with it
+   /** The images are shifted with cubic convolution interpolation.
+     * 
+     * \returns 0 on success
+     * \returns -1 on error
+     */ 
+   template<class cubeT, class outCubeT>
+   int registerCube( std::vector<Scalar> & xShifts, ///< [out] the x shift of each image w.r.t. the reference.  Is resized.
+                     std::vector<Scalar> & yShifts, ///< [out] the y shift of each image w.r.t. the reference.  Is resized.
+                     outCubeT & shifted,            ///< [out] the images shifted to align with the reference.  Is resized.
+                     const cubeT & ims              ///< [in] the cube of images to register
+                   );
 };
 
 template< class ccImT>
@@ -182,6 +274,30 @@ void imageXCorrFFT<ccImT>::maxLag( int ml )
    m_maxLag = ml;
 }
 
+template< class ccImT>
+int imageXCorrFFT<ccImT>::peakMethod()
+{
+   return m_peakMethod;
+}
+
+template< class ccImT>
+void imageXCorrFFT<ccImT>::peakMethod( int pm )
+{
+   m_peakMethod = pm;
+}
+
+template< class ccImT>
+int imageXCorrFFT<ccImT>::upsample()
+{
+   return m_upsample;
+}
+
+template< class ccImT>
+void imageXCorrFFT<ccImT>::upsample( int us )
+{
+   m_upsample = us;
+}
+
 template< class ccImT>
 int imageXCorrFFT<ccImT>::resize( int nrows,
                                   int ncols
@@ -255,12 +371,6 @@ int imageXCorrFFT<ccImT>::operator()( Scalar & xShift,
       return -1;
    }
    
-   int maxLag = m_maxLag;
-   if(maxLag == 0) 
-   {
-      maxLag = 0.25*m_rows-1;
-   }
-   
    realT m = imageMean(im);
    realT v = imageVariance(im, m);
    m_ccIm = (im - m)/sqrt(v);
@@ -270,6 +380,110 @@ int imageXCorrFFT<ccImT>::operator()( Scalar & xShift,
    //So this is the FT of the cross-correlation:
    m_ftWork *= m_ftIm0;
    
+   return findPeak(xShift, yShift);
+}
+
+template< class ccImT>
+void imageXCorrFFT<ccImT>::dftWindow( realT x0,
+                                      realT y0,
+                                      int W,
+                                      realT step
+                                    )
+{
+   //The rows are the half-dimension of the r2c transform, so each term stands in for its conjugate too
+   int Nk = m_ftWork.rows();
+   
+   m_dftRowKern.resize(W, Nk);
+   for(int k=0; k < Nk; ++k)
+   {
+      realT wt = 2;
+      if(k == 0 || 2*k == m_rows) wt = 1;
+      
+      for(int i=0; i < W; ++i)
+      {
+         m_dftRowKern(i,k) = std::polar<realT>(wt, math::two_pi<realT>()*k*(x0 + i*step)/m_rows);
+      }
+   }
+   
+   //The columns are the full dimension, use the signed frequency so fractional points interpolate
+   m_dftColKern.resize(m_cols, W);
+   for(int l=0; l < m_cols; ++l)
+   {
+      int lf = l;
+      if(2*l > m_cols) lf = l - m_cols;
+      
+      for(int j=0; j < W; ++j)
+      {
+         realT ph = math::two_pi<realT>()*lf*(y0 + j*step)/m_cols;
+         
+         if(2*l == m_cols) m_dftColKern(l,j) = complexT(cos(ph), 0); //Nyquist: average of +/- frequencies
+         else m_dftColKern(l,j) = std::polar<realT>(1, ph);
+      }
+   }
+   
+   m_dftWork = (m_dftRowKern.matrix() * m_ftWork.matrix()).array();
+   m_dftWork = (m_dftWork.matrix() * m_dftColKern.matrix()).array();
+   
+   m_dftIm = m_dftWork.real();
+}
+
+template< class ccImT>
+int imageXCorrFFT<ccImT>::findPeak( Scalar & xShift,
+                                    Scalar & yShift
+                                  )
+{
+   int maxLag = m_maxLag;
+   if(maxLag == 0) 
+   {
+      maxLag = 0.25*m_rows-1;
+   }
+   
+   if(m_peakMethod == dftUpsample)
+   {
+      int xLag0, yLag0;
+      
+      if(m_maxLag > 0)
+      {
+         //Only the lags up to maxLag are calculated
+         int x0 = (int)(0.5*m_rows) - m_maxLag;
+         int y0 = (int)(0.5*m_cols) - m_maxLag;
+         
+         dftWindow(x0, y0, 2*m_maxLag+1, 1);
+         m_dftIm.maxCoeff(&xLag0, &yLag0);
+         xLag0 += x0;
+         yLag0 += y0;
+      }
+      else
+      {
+         m_fft_back(m_ccIm.data(), m_ftWork.data());
+         m_ccIm.maxCoeff(&xLag0, &yLag0);
+      }
+      
+      realT xPk = xLag0;
+      realT yPk = yLag0;
+      
+      if(m_upsample > 1)
+      {
+         //Search +/- 0.75 pixels around the integer peak
+         int W = ceil(1.5*m_upsample);
+         realT step = 1.0/m_upsample;
+         realT hw = 0.5*(W-1)*step;
+         
+         dftWindow(xLag0 - hw, yLag0 - hw, W, step);
+         
+         int i, j;
+         m_dftIm.maxCoeff(&i, &j);
+         
+         xPk = xLag0 - hw + i*step;
+         yPk = yLag0 - hw + j*step;
+      }
+      
+      xShift = xPk - (int)(0.5*m_rows);
+      yShift = yPk - (int)(0.5*m_cols);
+      
+      return 0;
+   }
+   
    m_fft_back(m_ccIm.data(), m_ftWork.data());
    
 #if 1
@@ -290,7 +504,7 @@ int imageXCorrFFT<ccImT>::operator()( Scalar & xShift,
    std::cerr << "magnifying\n";
    realT xsc = 0.01;
    realT ysc = 0.01;
-   imT imW;
+   ccImT imW;
    imageMaxInterp(xShift, yShift, xsc, ysc, imW, m_ccIm);
 
    xShift -= (int)(0.5*m_rows);
@@ -313,6 +527,85 @@ int imageXCorrFFT<ccImT>::operator()( Scalar & xShift,
    return operator()(xShift, yShift, im);
    
 }
+
+template< class ccImT>
+template< class cubeT>
+int imageXCorrFFT<ccImT>::registerCube( std::vector<Scalar> & xShifts,
+                                        std::vector<Scalar> & yShifts,
+                                        const cubeT & ims
+                                      )
+{
+   if( ims.rows() != m_rows || ims.cols() != m_cols )
+   {
+      mxError("imageXCorrFFT::registerCube", MXE_SIZEERR, "images must be same size as reference");
+      return -1;
+   }
+   
+   xShifts.resize(ims.planes());
+   yShifts.resize(ims.planes());
+   
+   //Each thread gets its own plans and working memory.  These are planned and destroyed outside the
+   //parallel region since fftw planning is not thread safe.
+   int nTh = omp_get_max_threads();
+   if(nTh > ims.planes()) nTh = ims.planes();
+   if(nTh < 1) nTh = 1;
+   
+   std::vector<std::unique_ptr<imageXCorrFFT>> workers(nTh);
+   for(int n=0; n < nTh; ++n)
+   {
+      workers[n].reset(new imageXCorrFFT(m_maxLag));
+      workers[n]->m_peakMethod = m_peakMethod;
+      workers[n]->m_upsample = m_upsample;
+      workers[n]->resize(m_rows, m_cols);
+      workers[n]->m_ftIm0 = m_ftIm0;
+   }
+   
+   int rv = 0;
+   
+   #pragma omp parallel num_threads(nTh)
+   {
+      imageXCorrFFT & worker = *workers[omp_get_thread_num()];
+      
+      #pragma omp for
+      for(int i=0; i < ims.planes(); ++i)
+      {
+         if( worker(xShifts[i], yShifts[i], ims.image(i)) < 0 )
+         {
+            #pragma omp atomic write
+            rv = -1;
+         }
+      }
+   }
+   
+   return rv;
+}
+
+template< class ccImT>
+template< class cubeT, class outCubeT>
+int imageXCorrFFT<ccImT>::registerCube( std::vector<Scalar> & xShifts,
+                                        std::vector<Scalar> & yShifts,
+                                        outCubeT & shifted,
+                                        const cubeT & ims
+                                      )
+{
+   if( registerCube(xShifts, yShifts, ims) < 0) return -1;
+   
+   shifted.resize(ims.rows(), ims.cols(), ims.planes());
+   
+   #pragma omp parallel
+   {
+      realArrayT shim;
+      
+      #pragma omp for
+      for(int i=0; i < ims.planes(); ++i)
+      {
+         imageShift(shim, ims.image(i), -xShifts[i], -yShifts[i], cubicConvolTransform<realT>());
+         shifted.image(i) = shim;
+      }
+   }
+   
+   return 0;
+}
    
 } //improc
 } //mx 
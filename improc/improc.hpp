@@ -3,8 +3,10 @@
 #include "eigenImage.hpp"
 #include "eigenCube.hpp"
 #include "imageFilters.hpp"
+#include "radprofPlan.hpp"
 #include "imageMasks.hpp"
 #include "imagePads.hpp"
+#include "imageRotator.hpp"
 #include "imageTransforms.hpp"
 #include "imageUtils.hpp"
 #include "imageXCorrDiscrete.hpp"
@@ -0,0 +1,674 @@
+/** \file radprofPlan.hpp
+  * \brief A class to repeatedly calculate radial profiles for a fixed geometry.
+  * \ingroup image_processing_files
+  * \author Jared R. Males (jaredmales@gmail.com)
+  *
+  */
+
+//***********************************************************************//
+// Copyright 2022 Jared R. Males (jaredmales@gmail.com)
+//
+// This file is part of mxlib.
+//
+// mxlib is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// mxlib is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with mxlib.  If not, see <http://www.gnu.org/licenses/>.
+//***********************************************************************//
+
+#ifndef radprofPlan_hpp
+#define radprofPlan_hpp
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "../mxException.hpp"
+
+#include "eigenImage.hpp"
+#include "eigenCube.hpp"
+#include "imageMasks.hpp"
+
+namespace mx
+{
+namespace improc
+{
+
+/// Radial profile calculations for a fixed image geometry.
+/** The radius binning of \ref radprof and the interpolation of \ref radprofim only depend on
+  * the radius image and the mask, so for a cube of images they are the same for every plane.
+  * This class does that work once in \ref plan, storing for each 1 pixel wide annulus the list of linear
+  * pixel indices it contains, and for each pixel the bracketing profile points and interpolation weight.
+  * The profile of each image is then calculated by gathering the pixels of each annulus, with
+  * no sorting (the median uses std::nth_element on the annulus values only).
+  *
+  * The binning is identical to \ref radprof: annuli are \p dr wide starting at the minimum radius in the mask,
+  * and a pixel exactly on a boundary is placed in the inner annulus.  Annuli which contain no pixels
+  * are skipped.  Outside the range of annulus radii the profile image takes the value of the nearest
+  * annulus, rather than being undefined.
+  *
+  * The cube versions process the planes in parallel with OpenMP, using per-thread working memory.
+  *
+  * Example:
+  * \code
+  * radprofPlan<float> rpp;
+  * rpp.plan(ims.rows(), ims.cols());
+  * rpp.subtract(ims); //subtracts the median radial profile from each plane
+  * \endcode
+  *
+  * \tparam _realT the real floating point type of the images and profiles.
+  *
+  * \ingroup rad_prof
+  */
+template<typename _realT>
+class radprofPlan
+{
+public:
+   typedef _realT realT; ///< The real floating point type
+
+   typedef eigenImage<realT> imageT; ///< The image type used for radius and mask images
+
+protected:
+
+   int m_rows {0}; ///< The number of rows in the planned geometry
+   int m_cols {0}; ///< The number of columns in the planned geometry
+
+   std::vector<realT> m_rad; ///< The mid-point radius of each non-empty annulus
+
+   std::vector<size_t> m_binStart; ///< Offsets into m_pixIdx of the first pixel in each annulus.  Size is nBins()+1.
+
+   std::vector<size_t> m_pixIdx; ///< Linear pixel indices of all included pixels, grouped by annulus
+
+   size_t m_maxBinSize {0}; ///< The largest number of pixels in any annulus, sets the size of working memory.
+
+   std::vector<size_t> m_outIdx; ///< Linear pixel indices of the pixels in the profile image
+
+   std::vector<size_t> m_interpBin; ///< For each pixel in m_outIdx, the lower annulus for the interpolation
+
+   std::vector<realT> m_interpWt; ///< For each pixel in m_outIdx, the weight of the upper annulus in the interpolation
+
+public:
+
+   /// Default c'tor
+   radprofPlan();
+
+   /// Constructor which plans using a centered radius image and no mask
+   /** See \ref plan(int, int, realT).
+     */
+   radprofPlan( int rows,   ///< [in] the number of rows in the images
+                int cols,   ///< [in] the number of columns in the images
+                realT dr = 1 ///< [in] [optional] the width of each annulus
+              );
+
+   /// Constructor which plans using the provided radius image and mask.
+   /** See \ref plan(const eigenImT1 &, const eigenImT2 *, realT, realT).
+     */
+   template<typename eigenImT1, typename eigenImT2>
+   radprofPlan( const eigenImT1 & radim, ///< [in] image of radius values per pixel
+                const eigenImT2 * mask,  ///< [in] 1/0 mask, only pixels with a value of 1 are included. Can be nullptr.
+                realT dr = 1,            ///< [in] [optional] the width of each annulus
+                realT minr = 0           ///< [in] [optional] the minimum radius.  If 0 the minimum radius in the mask is used.
+              );
+
+   /// Plan the profile calculations for a radius image and mask.
+   /**
+     * \returns 0 on success
+     *
+     * \throws mx::err::sizeerr if the mask and radius image are not the same size
+     * \throws mx::err::invalidarg if dr is not positive or the mask excludes all pixels
+     */
+   template<typename eigenImT1, typename eigenImT2>
+   int plan( const eigenImT1 & radim, ///< [in] image of radius values per pixel
+             const eigenImT2 * mask,  ///< [in] 1/0 mask, only pixels with a value of 1 are included. Can be nullptr.
+             realT dr = 1,            ///< [in] [optional] the width of each annulus
+             realT minr = 0           ///< [in] [optional] the minimum radius.  If 0 the minimum radius in the mask is used.
+           );
+
+   /// Plan the profile calculations using a centered radius image and no mask.
+   /** The radius image is calculated with \ref radiusImage, as in the \ref radprofim overload without a radius image.
+     *
+     * \returns 0 on success
+     */
+   int plan( int rows,   ///< [in] the number of rows in the images
+             int cols,   ///< [in] the number of columns in the images
+             realT dr = 1 ///< [in] [optional] the width of each annulus
+           );
+
+   /// Get the number of rows in the planned geometry
+   /**
+     * \returns the current value of m_rows
+     */
+   int rows() const;
+
+   /// Get the number of columns in the planned geometry
+   /**
+     * \returns the current value of m_cols
+     */
+   int cols() const;
+
+   /// Get the number of (non-empty) annuli in the profile
+   /**
+     * \returns the size of m_rad
+     */
+   size_t nBins() const;
+
+   /// Get the mid-point radius of each annulus
+   /**
+     * \returns a const reference to m_rad
+     */
+   const std::vector<realT> & radius() const;
+
+   /// Get the size of the working memory needed by the median profile
+   /**
+     * \returns the current value of m_maxBinSize
+     */
+   size_t workSize() const;
+
+   /// Calculate the radial profile of an image.
+   /** This version uses the provided working memory, which is resized if needed.
+     *
+     * \throws mx::err::sizeerr if the image is not the planned size
+     */
+   template<typename eigenImT>
+   void profile( std::vector<realT> & prof, ///< [out] the mean or median value in each annulus. Is resized to nBins().
+                 const eigenImT & im,       ///< [in] the image of which to calculate the profile
+                 bool mean,                 ///< [in] if true the mean is used, otherwise the median.
+                 std::vector<realT> & work  ///< [in/out] working memory for the median
+               ) const;
+
+   /// Calculate the radial profile of an image.
+   /**
+     * \overload
+     */
+   template<typename eigenImT>
+   void profile( std::vector<realT> & prof, ///< [out] the mean or median value in each annulus. Is resized to nBins().
+                 const eigenImT & im,       ///< [in] the image of which to calculate the profile
+                 bool mean = false          ///< [in] [optional] if true the mean is used, otherwise the median (default).
+               ) const;
+
+   /// Form the radial profile image from a profile.
+   /** Pixels excluded by the mask are set to 0.
+     *
+     * \throws mx::err::sizeerr if the profile is not the planned size
+     */
+   template<typename radprofT>
+   void profileImage( radprofT & radprofIm,            ///< [out] the radial profile image.  This will be resized.
+                      const std::vector<realT> & prof  ///< [in] a profile calculated with \ref profile
+                    ) const;
+
+   /// Form the radial profile image of an image, and optionally subtract it from the input
+   /** This is equivalent to \ref radprofim.
+     */
+   template<typename radprofT, typename eigenImT>
+   void profileImage( radprofT & radprofIm, ///< [out] the radial profile image.  This will be resized.
+                      eigenImT & im,        ///< [in/out] the image to form the profile of.
+                      bool subtract,        ///< [in] if true, then on ouput im will have had its radial profile subtracted.
+                      bool mean = false     ///< [in] [optional] if true the mean is used, otherwise the median (default).
+                    ) const;
+
+   /// Subtract the radial profile from an image in place.
+   /** Pixels excluded by the mask are not changed.  This version uses the provided working memory.
+     */
+   template<typename eigenImT>
+   void subtract( eigenImT & im,              ///< [in/out] the image, on output has had its radial profile subtracted.
+                  bool mean,                  ///< [in] if true the mean is used, otherwise the median.
+                  std::vector<realT> & prof,  ///< [in/out] working memory for the profile
+                  std::vector<realT> & work   ///< [in/out] working memory for the median
+                ) const;
+
+   /// Calculate the radial profile of each plane of a cube.
+   /** The planes are processed in parallel.
+     */
+   template<typename cubeT>
+   void profiles( imageT & profs,     ///< [out] the profiles, one column per plane.  Is resized to nBins() x ims.planes().
+                  const cubeT & ims,  ///< [in] the cube of images
+                  bool mean = false   ///< [in] [optional] if true the mean is used, otherwise the median (default).
+                ) const;
+
+   /// Subtract the radial profile from each plane of a cube in place.
+   /** The planes are processed in parallel.
+     */
+   template<typename dataT>
+   void subtract( eigenCube<dataT> & ims, ///< [in/out] the cube of images, on output each plane has had its radial profile subtracted.
+                  bool mean = false       ///< [in] [optional] if true the mean is used, otherwise the median (default).
+                ) const;
+
+protected:
+
+   /// Check that an image matches the planned size
+   template<typename eigenImT>
+   void checkSize( const eigenImT & im ) const;
+
+   /// Calculate the profile value from the pixel values of one annulus
+   template<typename eigenImT>
+   realT binValue( const eigenImT & im,
+                   size_t b,
+                   bool mean,
+                   std::vector<realT> & work
+                 ) const;
+};
+
+template<typename realT>
+radprofPlan<realT>::radprofPlan()
+{
+}
+
+template<typename realT>
+radprofPlan<realT>::radprofPlan( int rows,
+                                 int cols,
+                                 realT dr
+                               )
+{
+   plan(rows, cols, dr);
+}
+
+template<typename realT>
+template<typename eigenImT1, typename eigenImT2>
+radprofPlan<realT>::radprofPlan( const eigenImT1 & radim,
+                                 const eigenImT2 * mask,
+                                 realT dr,
+                                 realT minr
+                               )
+{
+   plan(radim, mask, dr, minr);
+}
+
+template<typename realT>
+template<typename eigenImT1, typename eigenImT2>
+int radprofPlan<realT>::plan( const eigenImT1 & radim,
+                              const eigenImT2 * mask,
+                              realT dr,
+                              realT minr
+                            )
+{
+   if(mask)
+   {
+      if(mask->rows() != radim.rows() || mask->cols() != radim.cols())
+      {
+         mxThrowException(err::sizeerr, "radprofPlan::plan", "mask and radius image must be same size");
+      }
+   }
+
+   if(dr <= 0)
+   {
+      mxThrowException(err::invalidarg, "radprofPlan::plan", "dr must be positive");
+   }
+
+   m_rows = radim.rows();
+   m_cols = radim.cols();
+
+   size_t npix = m_rows*m_cols;
+
+   //Find the radius range of the included pixels
+   realT mnr = std::numeric_limits<realT>::max();
+   realT mxr = std::numeric_limits<realT>::lowest();
+   size_t nincl = 0;
+
+   for(size_t i = 0; i < npix; ++i)
+   {
+      if(mask)
+      {
+         if((*mask)(i) == 0) continue;
+      }
+
+      realT r = radim(i);
+      if(r < mnr) mnr = r;
+      if(r > mxr) mxr = r;
+      ++nincl;
+   }
+
+   if(nincl == 0)
+   {
+      mxThrowException(err::invalidarg, "radprofPlan::plan", "mask excludes all pixels");
+   }
+
+   if(minr == 0) minr = mnr;
+
+   //Annulus b covers (minr + b*dr, minr + (b+1)*dr], and the last one ends below the maximum radius (as in radprof)
+   size_t nAnn = 0;
+   while(minr + (nAnn+1)*dr < mxr) ++nAnn;
+
+   //Assign pixels to annuli, counting first so the index lists are contiguous.
+   std::vector<long> pixAnn(npix, -1);
+   std::vector<size_t> counts(nAnn, 0);
+
+   for(size_t i = 0; i < npix; ++i)
+   {
+      if(mask)
+      {
+         if((*mask)(i) == 0) continue;
+      }
+
+      realT r = radim(i);
+      if(r < minr) continue;
+
+      long b = static_cast<long>(std::ceil((r - minr)/dr)) - 1;
+      if(b < 0) b = 0;
+      if(b >= (long) nAnn) continue;
+
+      pixAnn[i] = b;
+      ++counts[b];
+   }
+
+   //Drop empty annuli, mapping old annulus numbers to the compacted bins.
+   std::vector<long> annBin(nAnn, -1);
+   m_rad.clear();
+   m_binStart.clear();
+   m_binStart.push_back(0);
+   m_maxBinSize = 0;
+
+   for(size_t b = 0; b < nAnn; ++b)
+   {
+      if(counts[b] == 0) continue;
+
+      annBin[b] = m_rad.size();
+      m_rad.push_back(minr + (b + 0.5)*dr);
+      m_binStart.push_back(m_binStart.back() + counts[b]);
+      if(counts[b] > m_maxBinSize) m_maxBinSize = counts[b];
+   }
+
+   m_pixIdx.resize(m_binStart.back());
+   std::vector<size_t> fill(m_binStart.begin(), m_binStart.end()-1);
+
+   for(size_t i = 0; i < npix; ++i)
+   {
+      if(pixAnn[i] < 0) continue;
+      m_pixIdx[ fill[annBin[pixAnn[i]]]++ ] = i;
+   }
+
+   //Now the linear interpolation for the profile image
+   m_outIdx.clear();
+   m_interpBin.clear();
+   m_interpWt.clear();
+
+   if(m_rad.size() == 0)
+   {
+      return 0;
+   }
+
+   for(size_t i = 0; i < npix; ++i)
+   {
+      if(mask)
+      {
+         if((*mask)(i) == 0) continue;
+      }
+
+      realT r = radim(i);
+
+      size_t b;
+      realT w;
+
+      if(r <= m_rad.front() || m_rad.size() == 1)
+      {
+         b = 0;
+         w = 0;
+      }
+      else if(r >= m_rad.back())
+      {
+         b = m_rad.size() - 2;
+         w = 1;
+      }
+      else
+      {
+         b = std::upper_bound(m_rad.begin(), m_rad.end(), r) - m_rad.begin() - 1;
+         w = (r - m_rad[b])/(m_rad[b+1] - m_rad[b]);
+      }
+
+      m_outIdx.push_back(i);
+      m_interpBin.push_back(b);
+      m_interpWt.push_back(w);
+   }
+
+   return 0;
+}
+
+template<typename realT>
+int radprofPlan<realT>::plan( int rows,
+                              int cols,
+                              realT dr
+                            )
+{
+   imageT radim;
+   radim.resize(rows, cols);
+
+   radiusImage(radim);
+
+   return plan(radim, (imageT *) nullptr, dr);
+}
+
+template<typename realT>
+int radprofPlan<realT>::rows() const
+{
+   return m_rows;
+}
+
+template<typename realT>
+int radprofPlan<realT>::cols() const
+{
+   return m_cols;
+}
+
+template<typename realT>
+size_t radprofPlan<realT>::nBins() const
+{
+   return m_rad.size();
+}
+
+template<typename realT>
+const std::vector<realT> & radprofPlan<realT>::radius() const
+{
+   return m_rad;
+}
+
+template<typename realT>
+size_t radprofPlan<realT>::workSize() const
+{
+   return m_maxBinSize;
+}
+
+template<typename realT>
+template<typename eigenImT>
+void radprofPlan<realT>::checkSize( const eigenImT & im ) const
+{
+   if(im.rows() != m_rows || im.cols() != m_cols)
+   {
+      mxThrowException(err::sizeerr, "radprofPlan", "image is not the planned size");
+   }
+}
+
+template<typename realT>
+template<typename eigenImT>
+realT radprofPlan<realT>::binValue( const eigenImT & im,
+                                    size_t b,
+                                    bool mean,
+                                    std::vector<realT> & work
+                                  ) const
+{
+   const size_t * idx = m_pixIdx.data() + m_binStart[b];
+   size_t N = m_binStart[b+1] - m_binStart[b];
+
+   if(mean)
+   {
+      realT sum = 0;
+      for(size_t n = 0; n < N; ++n)
+      {
+         sum += im(idx[n]);
+      }
+      return sum/N;
+   }
+
+   for(size_t n = 0; n < N; ++n)
+   {
+      work[n] = im(idx[n]);
+   }
+
+   size_t h = 0.5*N;
+   std::nth_element(work.begin(), work.begin() + h, work.begin() + N);
+
+   realT med = work[h];
+
+   //Average two points if even number of points
+   if(N % 2 == 0)
+   {
+      med = 0.5*(med + *std::max_element(work.begin(), work.begin() + h));
+   }
+
+   return med;
+}
+
+template<typename realT>
+template<typename eigenImT>
+void radprofPlan<realT>::profile( std::vector<realT> & prof,
+                                  const eigenImT & im,
+                                  bool mean,
+                                  std::vector<realT> & work
+                                ) const
+{
+   checkSize(im);
+
+   prof.resize(m_rad.size());
+   if(work.size() < m_maxBinSize) work.resize(m_maxBinSize);
+
+   for(size_t b = 0; b < m_rad.size(); ++b)
+   {
+      prof[b] = binValue(im, b, mean, work);
+   }
+}
+
+template<typename realT>
+template<typename eigenImT>
+void radprofPlan<realT>::profile( std::vector<realT> & prof,
+                                  const eigenImT & im,
+                                  bool mean
+                                ) const
+{
+   std::vector<realT> work;
+   profile(prof, im, mean, work);
+}
+
+template<typename realT>
+template<typename radprofT>
+void radprofPlan<realT>::profileImage( radprofT & radprofIm,
+                                       const std::vector<realT> & prof
+                                     ) const
+{
+   if(prof.size() != m_rad.size())
+   {
+      mxThrowException(err::sizeerr, "radprofPlan::profileImage", "profile is not the planned size");
+   }
+
+   radprofIm.resize(m_rows, m_cols);
+   radprofIm.setZero();
+
+   if(prof.size() == 1)
+   {
+      for(size_t n = 0; n < m_outIdx.size(); ++n) radprofIm(m_outIdx[n]) = prof[0];
+      return;
+   }
+
+   for(size_t n = 0; n < m_outIdx.size(); ++n)
+   {
+      size_t b = m_interpBin[n];
+      realT w = m_interpWt[n];
+      radprofIm(m_outIdx[n]) = (1-w)*prof[b] + w*prof[b+1];
+   }
+}
+
+template<typename realT>
+template<typename radprofT, typename eigenImT>
+void radprofPlan<realT>::profileImage( radprofT & radprofIm,
+                                       eigenImT & im,
+                                       bool subtract,
+                                       bool mean
+                                     ) const
+{
+   std::vector<realT> prof;
+   profile(prof, im, mean);
+   profileImage(radprofIm, prof);
+
+   if(subtract) im -= radprofIm;
+}
+
+template<typename realT>
+template<typename eigenImT>
+void radprofPlan<realT>::subtract( eigenImT & im,
+                                   bool mean,
+                                   std::vector<realT> & prof,
+                                   std::vector<realT> & work
+                                 ) const
+{
+   profile(prof, im, mean, work);
+
+   if(prof.size() == 0) return;
+
+   if(prof.size() == 1)
+   {
+      for(size_t n = 0; n < m_outIdx.size(); ++n) im(m_outIdx[n]) -= prof[0];
+      return;
+   }
+
+   for(size_t n = 0; n < m_outIdx.size(); ++n)
+   {
+      size_t b = m_interpBin[n];
+      realT w = m_interpWt[n];
+      im(m_outIdx[n]) -= (1-w)*prof[b] + w*prof[b+1];
+   }
+}
+
+template<typename realT>
+template<typename cubeT>
+void radprofPlan<realT>::profiles( imageT & profs,
+                                   const cubeT & ims,
+                                   bool mean
+                                 ) const
+{
+   profs.resize(m_rad.size(), ims.planes());
+
+   #pragma omp parallel
+   {
+      std::vector<realT> prof;
+      std::vector<realT> work(m_maxBinSize);
+
+      #pragma omp for
+      for(int p = 0; p < ims.planes(); ++p)
+      {
+         profile(prof, ims.image(p), mean, work);
+
+         for(size_t b = 0; b < prof.size(); ++b) profs(b,p) = prof[b];
+      }
+   }
+}
+
+template<typename realT>
+template<typename dataT>
+void radprofPlan<realT>::subtract( eigenCube<dataT> & ims,
+                                   bool mean
+                                 ) const
+{
+   #pragma omp parallel
+   {
+      std::vector<realT> prof;
+      std::vector<realT> work(m_maxBinSize);
+
+      #pragma omp for
+      for(int p = 0; p < ims.planes(); ++p)
+      {
+         typename eigenCube<dataT>::imageRef im = ims.image(p);
+         subtract(im, mean, prof, work);
+      }
+   }
+}
+
+} //namespace improc
+} //namespace mx
+
+#endif //radprofPlan_hpp
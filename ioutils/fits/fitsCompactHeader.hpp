@@ -0,0 +1,214 @@
+/** \file fitsCompactHeader.hpp
+  * \brief Declares and defines a class to hold a read-only FITS header in compact form
+  * \ingroup fits_processing_files
+  * \author Jared R. Males (jaredmales@gmail.com)
+  *
+  */
+
+//***********************************************************************//
+// Copyright 2015-2022 Jared R. Males (jaredmales@gmail.com)
+//
+// This file is part of mxlib.
+//
+// mxlib is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// mxlib is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with mxlib.  If not, see <http://www.gnu.org/licenses/>.
+//***********************************************************************//
+
+#ifndef ioutils_fits__fitsCompactHeader_hpp
+#define ioutils_fits__fitsCompactHeader_hpp
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../../mxException.hpp"
+#include "fitsHeaderCard.hpp"
+#include "fitsHeader.hpp"
+
+namespace mx
+{
+namespace fits
+{
+
+/// Class to hold a complete FITS header in a compact, read-only form
+/** A fitsHeader allocates a list node, a map node, and a std::stringstream for every card.  For large numbers of
+  * headers, e.g. one per frame in a long sequence, this costs more than the images themselves.  This class instead
+  * parses the raw header (a sequence of 80 character records, as stored in the 2880 byte header blocks) in one pass
+  * into a single character arena holding the keyword, value, and comment of each card back-to-back, an array of
+  * 8 byte card references, and an open-addressing keyword index.
+  *
+  * Values are kept as the strings found in the file, and are only converted to a type when requested, using the
+  * same conversions as fitsHeaderCard.  Use toHeader() to get a full fitsHeader for editing or writing.
+  *
+  * \ingroup fits_processing
+  */
+class fitsCompactHeader
+{
+
+public:
+
+   /// The location of one card within the arena
+   struct cardRef
+   {
+      uint32_t m_off;    ///< The offset of the keyword in the arena.  The value and comment follow it.
+      uint8_t m_keyLen;  ///< The length of the keyword
+      uint8_t m_valLen;  ///< The length of the value string
+      uint8_t m_comLen;  ///< The length of the comment
+      uint8_t m_kind;    ///< The kind of card, one of cardValue, cardComment, or cardHistory
+   };
+
+   static constexpr uint8_t cardValue {0};   ///< A keyword=value card, or a keyword with no value
+   static constexpr uint8_t cardComment {1}; ///< A COMMENT card
+   static constexpr uint8_t cardHistory {2}; ///< A HISTORY card
+
+protected:
+
+   /// The keywords, values, and comments of all cards, stored contiguously.
+   std::string m_arena;
+
+   /// The card references, in header order.
+   std::vector<cardRef> m_cards;
+
+   /// The keyword index.
+   /** Holds 1 + the index of the first card with each keyword, with 0 marking an empty slot.  The size is a power of 2.
+     */
+   std::vector<uint32_t> m_index;
+
+   /// Hash a keyword for the index
+   static uint32_t hash( const char * kw, ///< [in] the keyword
+                         size_t len       ///< [in] the length of the keyword
+                       );
+
+   /// Append one 80 character record to the arena and the card references
+   void parseRecord( const char * rec /**< [in] the record, which must be at least 80 characters*/);
+
+   /// Build the keyword index from the card references
+   void makeIndex();
+
+public:
+
+   /// Default c'tor
+   fitsCompactHeader();
+
+   /// Construct by parsing a raw header
+   /** \throws mx::err::invalidarg if the header is not valid
+     */
+   fitsCompactHeader( const char * hdr, ///< [in] the raw header, a sequence of 80 character records
+                      size_t len        ///< [in] the length of hdr
+                    );
+
+   /// Parse a raw header
+   /** The records are read until an END card is found, or \p len characters have been read.  Any previous contents
+     * are cleared.
+     *
+     * \returns 0 on success
+     * \returns -1 on error, if len is not a multiple of 80.
+     */
+   int parse( const char * hdr, ///< [in] the raw header, a sequence of 80 character records
+              size_t len        ///< [in] the length of hdr
+            );
+
+   /// Clear all cards from the header
+   void clear();
+
+   /// Test whether the header is empty.
+   bool empty() const;
+
+   /// Get the number of cards in the header.
+   size_t size() const;
+
+   /// Get the number of bytes used by the header storage
+   size_t memSize() const;
+
+   /// Find the first card with a keyword
+   /** \returns the index of the card
+     * \returns -1 if not found
+     */
+   long find( const std::string & keyword /**< [in] the keyword to look up*/) const;
+
+   /// Get number of cards with a given keyword
+   size_t count( const std::string & keyword /**< [in] the keyword to look up*/) const;
+
+   /// Get the keyword of a card
+   std::string keyword( size_t n /**< [in] the index of the card*/) const;
+
+   /// Get the value string of a card, as found in the file
+   std::string valueStr( size_t n /**< [in] the index of the card*/) const;
+
+   /// Get the comment of a card
+   std::string comment( size_t n /**< [in] the index of the card*/) const;
+
+   /// Get a card as a fitsHeaderCard
+   /** The card is constructed exactly as fitsFile::readHeader would, so conversions behave the same.
+     */
+   fitsHeaderCard card( size_t n /**< [in] the index of the card*/) const;
+
+   /// Get the first card with a keyword as a fitsHeaderCard
+   /** \throws mx::err::invalidarg if the keyword is not in the header
+     */
+   fitsHeaderCard operator[]( const std::string & keyword /**< [in] the keyword to look up*/) const;
+
+   /// Get the value of a card converted to typeT
+   /**
+     * \returns the value converted to typeT
+     *
+     * \throws mx::err::invalidarg if the keyword is not in the header, or if the value can't be converted to typeT
+     */
+   template<typename typeT>
+   typeT value( const std::string & keyword /**< [in] the keyword to look up*/) const;
+
+   /// Append all cards to a full fitsHeader
+   void toHeader( fitsHeader & head /**< [out] the header to append to*/) const;
+
+};  // fitsCompactHeader
+
+template<typename typeT>
+typeT fitsCompactHeader::value( const std::string & keyword ) const
+{
+   return operator[](keyword).value<typeT>();
+}
+
+/** \addtogroup fits_utils
+  * @{
+  */
+
+///Convert the values in a std::vector of \ref fitsCompactHeader "compact fits headers" into a std::vector of values.
+/** Resizes the vector of the appropriate type.
+  *
+  * \tparam dataT is the type of the header value
+  *
+  * \param[out] v will contain the converted values
+  * \param[in] heads contains the headers
+  * \param[in] keyw contains the keyword designating which value to convert
+  *
+  */
+template<typename dataT>
+void headersToValues( std::vector<dataT> & v,
+                      const std::vector<fitsCompactHeader> & heads,
+                      const std::string &keyw
+                    )
+{
+   v.resize(heads.size());
+
+   for(size_t i=0;i<heads.size(); ++i)
+   {
+      v[i] = heads[i].value<dataT>(keyw);
+   }
+}
+
+///@}
+
+} //namespace fits
+} //namespace mx
+
+#endif //ioutils_fits__fitsCompactHeader_hpp
@@ -34,6 +34,7 @@
 
 #include "fitsUtils.hpp"
 #include "fitsHeader.hpp"
+#include "fitsCompactHeader.hpp"
 
 namespace mx
 {
@@ -222,6 +223,21 @@ public:
              const std::vector<std::string> & flist  ///< [in] The list of files to read.
            );
 
+   ///Read data from a vector of files into an image cube with individual headers, processing each image as it is read
+   /** The function is called as `frameFunc(i, frame, rows, cols)` immediately after the i-th image and its header
+     * have been read, where `frame` points to the image in `im`.  This allows per-image processing to start while the
+     * remaining files are still being read.
+     *
+     * \returns 0 on success
+     * \returns -1 on error
+     */
+   template<typename frameFuncT>
+   int read( dataT * im, ///< [out] An allocated array large enough to hold all the images
+             std::vector<fitsHeader> &heads, ///< [in/out] The vector of fits headers, allocated to contain one per image.
+             const std::vector<std::string> & flist,  ///< [in] The list of files to read.
+             frameFuncT && frameFunc ///< [in] function called with (size_t, dataT *, long, long) after each image is read
+           );
+
 
    ///@}
 
@@ -368,6 +384,24 @@ public:
                    const std::vector<std::string> & flist ///< [in] A list of files, each of which is passed to \ref fileName
                  );
 
+   ///Read the complete header from the fits file into a compact header.
+   /** The raw header records are obtained in one call and parsed in a single pass, see fitsCompactHeader.
+     * Any previous contents of head are replaced.
+     *
+     * \returns 0 on success
+     * \returns -1 on error
+     */
+   int readHeader(fitsCompactHeader &head /**< [out] a fitsCompactHeader object */);
+
+   /// Read the complete headers from a list of FITS files into compact headers.
+   /**
+     * \returns 0 on success
+     * \returns -1 on error
+     */
+   int readHeader( std::vector<fitsCompactHeader> & heads, ///< [out] A vector of fitsCompactHeader objects to read into, resized to match flist.
+                   const std::vector<std::string> & flist ///< [in] A list of files, each of which is passed to \ref fileName
+                 );
+
    ///@}
 
    /** \name Writing Basic Arrays
@@ -864,6 +898,41 @@ int fitsFile<dataT>::read( dataT * im,
    return 0;
 }
 
+template<typename dataT>
+template<typename frameFuncT>
+int fitsFile<dataT>::read( dataT * im,
+                           std::vector<fitsHeader> &heads,
+                           const std::vector<std::string> & flist,
+                           frameFuncT && frameFunc
+                         )
+{
+   if(flist.size() == 0)
+   {
+      mxError("fitsFile", MXE_PARAMNOTSET, "Empty file list");
+      return -1;
+   }
+
+   long sz0 =0, sz1=0;
+
+   for(size_t i=0;i<flist.size(); ++i)
+   {
+      if( fileName(flist[i], 1) < 0 ) return -1;
+
+      dataT * frame = im + i*sz0*sz1;
+
+      if( read(frame) < 0 ) return -1;
+
+      if( readHeader(heads[i]) < 0 ) return  -1;
+
+      sz0 = getSize(0);
+      sz1 = getSize(1);
+
+      frameFunc(i, frame, sz0, sz1);
+   }
+
+   return 0;
+}
+
 
 /************************************************************/
 /***                      Eigen Arrays                    ***/
@@ -1267,6 +1336,63 @@ int fitsFile<dataT>::readHeader( std::vector<fitsHeader> & heads,
    return 0;
 }
 
+template<typename dataT>
+int fitsFile<dataT>::readHeader(fitsCompactHeader & head)
+{
+   int fstatus = 0;
+
+   if(!m_isOpen)
+   {
+      open();
+   }
+
+   char * hdr = nullptr;
+   int nkeys = 0;
+
+   //Returns all records, including END, as one string
+   fits_hdr2str(m_fptr, 0, nullptr, 0, &hdr, &nkeys, &fstatus);
+
+   if (fstatus)
+   {
+      std::string explan = "Error reading header from file";
+      fitsErrText( explan, m_fileName, fstatus);
+      mxError( "fitsFile", MXE_FILERERR, explan);
+
+      if(hdr) fits_free_memory(hdr, &fstatus);
+
+      return -1;
+   }
+
+   int rv = head.parse(hdr, strlen(hdr));
+
+   fits_free_memory(hdr, &fstatus);
+
+   if(rv < 0)
+   {
+      mxError( "fitsFile", MXE_FILERERR, "Invalid header in " + m_fileName);
+      return -1;
+   }
+
+   return 0;
+}
+
+template<typename dataT>
+int fitsFile<dataT>::readHeader( std::vector<fitsCompactHeader> & heads,
+                                 const std::vector<std::string> & flist
+                               )
+{
+   heads.resize(flist.size());
+
+   for(size_t i=0; i< flist.size(); ++i)
+   {
+      fileName(flist[i], 1);
+
+      if( readHeader( heads[i]) < 0) return -1;
+   }
+
+   return 0;
+}
+
 
 template<typename dataT>
 int fitsFile<dataT>::write( const dataT * im,
@@ -9,5 +9,6 @@
 #include "fits/fitsFile.hpp"
 #include "fits/fitsHeaderCard.hpp"
 #include "fits/fitsHeader.hpp"
+#include "fits/fitsCompactHeader.hpp"
 #include "fits/fitsUtils.hpp"
 
@@ -29,7 +29,23 @@
 #include <fstream>
 #include <string>
 #include <cstring>
+#include <cstdlib>
 #include <iostream>
+#include <iterator>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "../mxlib.hpp"
 #include "../mxError.hpp"
@@ -38,11 +54,43 @@
 
 #define MX_READCOL_MISSINGVALSTR "-99"
 
+#ifndef MX_READCOL_CHUNKSIZE
+/// The minimum number of bytes parsed by each thread in readColumns
+#define MX_READCOL_CHUNKSIZE (1048576)
+#endif
+
+#ifndef MX_READCOL_BLOCKSIZE
+/// The default number of bytes mapped at one time by readColumnsStream
+#define MX_READCOL_BLOCKSIZE (268435456)
+#endif
+
 namespace mx
 {
 namespace ioutils
 {
 
+///A dummy class to allow mx::readColumns to skip a column(s) in a file without requiring memory allocation.
+/** The alternative is to use dummy vectors, which result in excess memory allocations and deallocations.
+  * Usage:
+  \code
+  std::vector<T> col1, col5;
+  skipCol sk;
+  readColumns("filename.txt", col1, sk, sk, sk, col5); //This results in only columns 1 and 5 being stored.
+  \endcode
+  *
+  * \ingroup asciiutils
+  */
+struct skipCol
+{
+   typedef std::string value_type; ///< value_type is defined as std::string so that no conversions take place.
+
+   template<typename T>
+   void push_back( const T & arg )
+   {
+      return;
+   }
+};
+
 template<char delim=' ', char eol='\n'>
 void readcol(char * sin, int sz)
 {
@@ -103,6 +151,364 @@ void readcol(char * sin, int sz, arrT & array, arrTs &... arrays)
 
 
 
+namespace impl
+{
+
+/// Convert a field of a text table to the value_type of a column
+/** The default uses convertFromString, the numeric types are specialized below to avoid the std::string.
+  */
+template<typename T>
+struct readColConvert
+{
+   static T convert( const char * b, ///< [in] the beginning of the field
+                     const char * e  ///< [in] one past the end of the field
+                   )
+   {
+      return convertFromString<T>(std::string(b, e));
+   }
+};
+
+/// Null terminate a field in a stack buffer and pass it to a C conversion function
+template<typename T, typename convT>
+T readColNumeric( const char * b, ///< [in] the beginning of the field
+                  const char * e, ///< [in] one past the end of the field
+                  convT conv      ///< [in] the conversion function, taking a null-terminated char *
+                )
+{
+   size_t n = e - b;
+
+   if(n < 64)
+   {
+      char buf[64];
+      memcpy(buf, b, n);
+      buf[n] = '\0';
+      return conv(buf);
+   }
+
+   std::string str(b, e);
+   return conv(str.c_str());
+}
+
+template<>
+struct readColConvert<std::string>
+{
+   static std::string convert( const char * b, const char * e )
+   {
+      return std::string(b, e);
+   }
+};
+
+template<>
+struct readColConvert<int>
+{
+   static int convert( const char * b, const char * e )
+   {
+      return readColNumeric<int>(b, e, [](const char * s){ return atoi(s); });
+   }
+};
+
+template<>
+struct readColConvert<unsigned int>
+{
+   static unsigned int convert( const char * b, const char * e )
+   {
+      return readColNumeric<unsigned int>(b, e, [](const char * s){ return (unsigned int) strtoul(s, 0, 0); });
+   }
+};
+
+template<>
+struct readColConvert<long>
+{
+   static long convert( const char * b, const char * e )
+   {
+      return readColNumeric<long>(b, e, [](const char * s){ return strtol(s, 0, 0); });
+   }
+};
+
+template<>
+struct readColConvert<unsigned long>
+{
+   static unsigned long convert( const char * b, const char * e )
+   {
+      return readColNumeric<unsigned long>(b, e, [](const char * s){ return strtoul(s, 0, 0); });
+   }
+};
+
+template<>
+struct readColConvert<long long>
+{
+   static long long convert( const char * b, const char * e )
+   {
+      return readColNumeric<long long>(b, e, [](const char * s){ return strtoll(s, 0, 0); });
+   }
+};
+
+template<>
+struct readColConvert<unsigned long long>
+{
+   static unsigned long long convert( const char * b, const char * e )
+   {
+      return readColNumeric<unsigned long long>(b, e, [](const char * s){ return strtoull(s, 0, 0); });
+   }
+};
+
+template<>
+struct readColConvert<float>
+{
+   static float convert( const char * b, const char * e )
+   {
+   #if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+      //from_chars does not accept everything strtof does, so it must consume the whole field
+      float v;
+      std::from_chars_result res = std::from_chars(b, e, v);
+      if(res.ec == std::errc() && res.ptr == e) return v;
+   #endif
+      return readColNumeric<float>(b, e, [](const char * s){ return strtof(s, 0); });
+   }
+};
+
+template<>
+struct readColConvert<double>
+{
+   static double convert( const char * b, const char * e )
+   {
+   #if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+      double v;
+      std::from_chars_result res = std::from_chars(b, e, v);
+      if(res.ec == std::errc() && res.ptr == e) return v;
+   #endif
+      return readColNumeric<double>(b, e, [](const char * s){ return strtod(s, 0); });
+   }
+};
+
+template<>
+struct readColConvert<long double>
+{
+   static long double convert( const char * b, const char * e )
+   {
+      return readColNumeric<long double>(b, e, [](const char * s){ return strtold(s, 0); });
+   }
+};
+
+/// The per-chunk storage used for a column while parsing in parallel
+template<typename arrT>
+struct readColStorage
+{
+   typedef std::vector<typename arrT::value_type> type;
+};
+
+template<>
+struct readColStorage<skipCol>
+{
+   typedef skipCol type;
+};
+
+/// Convert a field and append it to a column
+template<typename arrT>
+void readColPush( arrT & array,   ///< [out] the column
+                  const char * b, ///< [in] the beginning of the field
+                  const char * e  ///< [in] one past the end of the field
+                )
+{
+   array.push_back(readColConvert<typename arrT::value_type>::convert(b, e));
+}
+
+/// Skipped columns are not converted at all
+inline
+void readColPush( skipCol & array,
+                  const char * b,
+                  const char * e
+                )
+{
+   static_cast<void>(array);
+   static_cast<void>(b);
+   static_cast<void>(e);
+}
+
+template<char delim, char eol>
+void readColLine( const char * p,
+                  const char * le
+                )
+{
+   static_cast<void>(p);
+   static_cast<void>(le);
+}
+
+/// Parse one line into the columns
+/** This reproduces the tokenization of readcol, without copying the line.
+  */
+template<char delim, char eol, typename arrT, typename... arrTs>
+void readColLine( const char * p,  ///< [in] the current position in the line, nullptr once the end of line has been consumed.
+                  const char * le, ///< [in] the end of the line, after removing the eol and any comment.
+                  arrT & array,    ///< [out] the column to populate from this field
+                  arrTs &... arrays ///< [out] the remaining columns
+                )
+{
+   if(p == nullptr) return;
+
+   //Eat white space
+   while(p < le && isspace( (unsigned char) *p) && *p != eol) ++p;
+
+   //If there's nothing here, we still need to populate the vector
+   if(p == le)
+   {
+      readColPush(array, p, p);
+      return;
+   }
+
+   const char * fe = static_cast<const char *>(memchr(p, delim, le-p));
+   if(fe == nullptr) fe = le;
+
+   if(fe == p)
+   {
+      static const char missing[] = MX_READCOL_MISSINGVALSTR;
+      readColPush(array, missing, missing + sizeof(missing) - 1);
+   }
+   else
+   {
+      readColPush(array, p, fe);
+   }
+
+   readColLine<delim,eol>( (fe == le) ? nullptr : fe + 1, le, arrays...);
+}
+
+/// Parse a range of complete lines into a tuple of columns
+template<char delim, char comment, char eol, typename tupleT, size_t... I>
+void readColChunk( const char * b, ///< [in] the beginning of the range, which must be the start of a line
+                   const char * e, ///< [in] one past the end of the range
+                   tupleT & cols,  ///< [out] the columns
+                   std::index_sequence<I...>
+                 )
+{
+   while(b < e)
+   {
+      const char * le = static_cast<const char *>(memchr(b, eol, e-b));
+      const char * next;
+
+      if(le == nullptr)
+      {
+         le = e;
+         next = e;
+      }
+      else
+      {
+         next = le + 1;
+      }
+
+      //Find start of comment and end line at that point.
+      const char * ce = static_cast<const char *>(memchr(b, comment, le-b));
+      if(ce != nullptr) le = ce;
+
+      if(le > b) readColLine<delim,eol>(b, le, std::get<I>(cols)...);
+
+      b = next;
+   }
+}
+
+/// Move the contents of a chunk column onto the end of the output column
+template<typename arrT, typename bufT>
+void readColAppend( arrT & array,
+                    bufT & buf
+                  )
+{
+   for(size_t n = 0; n < buf.size(); ++n) array.push_back(std::move(buf[n]));
+}
+
+template<typename T, typename allocT>
+void readColAppend( std::vector<T, allocT> & array,
+                    std::vector<T> & buf
+                  )
+{
+   array.insert(array.end(), std::make_move_iterator(buf.begin()), std::make_move_iterator(buf.end()));
+}
+
+inline
+void readColAppend( skipCol & array,
+                    skipCol & buf
+                  )
+{
+   static_cast<void>(array);
+   static_cast<void>(buf);
+}
+
+template<typename tupleT, size_t... I, typename... arrTs>
+void readColAppendAll( tupleT & cols,
+                       std::index_sequence<I...>,
+                       arrTs &... arrays
+                     )
+{
+   int dummy[] = {0, (readColAppend(arrays, std::get<I>(cols)), 0)...};
+   static_cast<void>(dummy);
+}
+
+/// Clear a column before a block is read by readColumnsStream
+template<typename arrT>
+void readColClear( arrT & array )
+{
+   array.clear();
+}
+
+inline
+void readColClear( skipCol & array )
+{
+   static_cast<void>(array);
+}
+
+/// Parse a buffer of text into columns
+/** The buffer is split at line boundaries into chunks of at least MX_READCOL_CHUNKSIZE bytes,
+  * which are parsed in parallel and then appended to the columns in file order.
+  */
+template<char delim, char comment, char eol, typename... arrTs>
+void readColParse( const char * b, ///< [in] the beginning of the buffer
+                   const char * e, ///< [in] one past the end of the buffer
+                   arrTs &... arrays ///< [out] the columns
+                 )
+{
+   size_t sz = e - b;
+   size_t nChunks = sz / MX_READCOL_CHUNKSIZE;
+
+   if(nChunks < 2)
+   {
+      std::tuple<arrTs &...> cols(arrays...);
+      readColChunk<delim,comment,eol>(b, e, cols, std::index_sequence_for<arrTs...>());
+      return;
+   }
+
+   std::vector<const char *> starts(nChunks+1);
+   starts[0] = b;
+   starts[nChunks] = e;
+
+   for(size_t n = 1; n < nChunks; ++n)
+   {
+      const char * s = b + n*(sz/nChunks);
+
+      if(s <= starts[n-1])
+      {
+         starts[n] = starts[n-1];
+         continue;
+      }
+
+      const char * le = static_cast<const char *>(memchr(s, eol, e-s));
+      starts[n] = (le == nullptr) ? e : le + 1;
+   }
+
+   std::vector<std::tuple<typename readColStorage<arrTs>::type...>> chunks(nChunks);
+
+   #pragma omp parallel for schedule(dynamic)
+   for(size_t n = 0; n < nChunks; ++n)
+   {
+      readColChunk<delim,comment,eol>(starts[n], starts[n+1], chunks[n], std::index_sequence_for<arrTs...>());
+   }
+
+   for(size_t n = 0; n < nChunks; ++n)
+   {
+      readColAppendAll(chunks[n], std::index_sequence_for<arrTs...>(), arrays...);
+      chunks[n] = std::tuple<typename readColStorage<arrTs>::type...>(); //release as we go
+   }
+}
+
+} //namespace impl
+
 ///Read in columns from a text file
 /** This function opens a file containing data formatted in columns and reads in the data row by row.
   * The data are stored in std::vectors, which should not be pre-allocated (though they could be reserve()-ed).
@@ -126,13 +532,15 @@ void readcol(char * sin, int sz, arrT & array, arrTs &... arrays)
   *
   * Columns can be skipped using mx::ioutils::skipCol.
   *
+  * Regular files are memory mapped, and files larger than 2*MX_READCOL_CHUNKSIZE are parsed in parallel
+  * using OpenMP.  There is no limit on line length.  Lines which are empty, or contain only a comment,
+  * are skipped.  For files too large to hold the columns in memory, see readColumnsStream.
+  *
   * \tparam delim is the character separating columns,  by default this is space.
   * \tparam comment is the character starting a comment.  by default this is #
   * \tparam eol is the end of line character.  by default this is \n
   * \tparam arrTs a variadic list of array types. this is not specified by the user.
   *
-  * \todo lineSize should be configurable
-  * 
   * \ingroup asciiutils
   */
 template<char delim=' ', char comment='#', char eol='\n', typename... arrTs>
@@ -142,120 +550,184 @@ int readColumns( const std::string & fname, ///< [in] is the file name to read f
 {
    //open file
    errno = 0;
-   std::ifstream fin;
-   fin.open(fname);
+   int fd = ::open(fname.c_str(), O_RDONLY);
 
-   if(!fin.good())
+   if(fd < 0)
    {
-      if(errno != 0)
-      {
-         mxPError("readColumns", errno, "Occurred while opening " + fname + " for reading.");
-      }
-      else
-      {
-         mxError("readColumns", MXE_FILEOERR, "Occurred while opening " + fname + " for reading.");
-      }
+      mxPError("readColumns", errno, "Occurred while opening " + fname + " for reading.");
       return -1;
    }
 
-   int lineSize = 4096;
-   char * line = new char[lineSize];
+   struct stat st;
+   if(fstat(fd, &st) < 0)
+   {
+      mxPError("readColumns", errno, "Occurred while reading from " + fname + ".");
+      ::close(fd);
+      return -1;
+   }
 
-   while(fin.good())
+   if(S_ISREG(st.st_mode))
    {
-      //Save one space for adding eol
-      fin.getline(line, lineSize-1, eol);
+      size_t sz = st.st_size;
 
-      int i=0;
-      int l = strlen(line);
+      if(sz > 0)
+      {
+         void * map = mmap(nullptr, sz, PROT_READ, MAP_PRIVATE, fd, 0);
 
-      if(l <= 0) break;
+         if(map == MAP_FAILED)
+         {
+            mxPError("readColumns", errno, "Occurred while reading from " + fname + ".");
+            ::close(fd);
+            return -1;
+         }
 
-      //std::cerr << line << "\n";
+         impl::readColParse<delim,comment,eol>(static_cast<const char *>(map), static_cast<const char *>(map) + sz, arrays...);
 
-      //Find start of comment and end line at that point.
-      while(line[i] != comment )
-      {
-         ++i;
-         if( i == l ) break;
+         munmap(map, sz);
       }
+   }
+   else
+   {
+      //Pipes and the like can't be mapped, so read them in.
+      std::string buf;
+      char rbuf[65536];
+      ssize_t nrd;
+
+      while( (nrd = ::read(fd, rbuf, sizeof(rbuf))) > 0) buf.append(rbuf, nrd);
 
-      if(i <= l-1)
+      if(nrd < 0)
       {
-         line[i] = '\0';
+         mxPError("readColumns", errno, "Occurred while reading from " + fname + ".");
+         ::close(fd);
+         return -1;
       }
 
-      l = strlen(line);
+      impl::readColParse<delim,comment,eol>(buf.data(), buf.data() + buf.size(), arrays...);
+   }
 
-      if(l == 0) continue;
+   if(::close(fd) < 0)
+   {
+      mxPError("readColumns", errno, "Occurred while closing " + fname + ".");
+      return -1;
+   }
 
-      //Make sure line ends with eol
-      line[l] = eol;
-      ++l;
-      line[l] = '\0';
+   return 0;
+}
 
-      readcol<delim,eol>(line, strlen(line), arrays...);
-   }
+///Read in columns from a large text file one block at a time
+/** The file is memory mapped a block at a time, each block is parsed into the columns as in readColumns, and
+  * then \p process is called.  The columns are cleared before each block, so only one block's worth of data
+  * is ever held in memory.  Blocks end on a line boundary, and are expanded if a single line is longer than
+  * \p blockSize.
+  *
+  * Example:
+  * \code
+  * std::vector<double> t, x;
+  * double sum = 0;
+  *
+  * readColumnsStream("big_log.txt", MX_READCOL_BLOCKSIZE, [&](){ for(auto & v : x) sum += v; return 0; }, t, x);
+  * \endcode
+  *
+  * \returns 0 on success, including if \p process stops the read early.
+  * \returns -1 on an error.
+  *
+  * \tparam delim is the character separating columns,  by default this is space.
+  * \tparam comment is the character starting a comment.  by default this is #
+  * \tparam eol is the end of line character.  by default this is \n
+  * \tparam funcT the type of the callable, with signature int(). this is not specified by the user.
+  * \tparam arrTs a variadic list of array types. this is not specified by the user.
+  *
+  * \ingroup asciiutils
+  */
+template<char delim=' ', char comment='#', char eol='\n', typename funcT, typename... arrTs>
+int readColumnsStream( const std::string & fname, ///< [in] is the file name to read from
+                       size_t blockSize,          ///< [in] the number of bytes to map and parse at a time.  If 0, MX_READCOL_BLOCKSIZE is used.
+                       funcT && process,          ///< [in] called after each block is read. Returns 0 to continue, non-zero to stop reading.
+                       arrTs &... arrays          ///< [out] a variadic list of std::vectors, cleared before each block.
+                     )
+{
+   if(blockSize == 0) blockSize = MX_READCOL_BLOCKSIZE;
 
-   delete[] line;
+   errno = 0;
+   int fd = ::open(fname.c_str(), O_RDONLY);
 
-   //getline will have set fail if there was no new line on the last line.
-   if(fin.bad() && !fin.fail())
+   if(fd < 0)
    {
-      if(errno != 0)
-      {
-         mxPError("readColumns", errno, "Occurred while reading from " + fname + ".");
-      }
-      else
-      {
-         mxError("readColumns", MXE_FILERERR, "Occurred while reading from " + fname + ".");
-      }
+      mxPError("readColumnsStream", errno, "Occurred while opening " + fname + " for reading.");
+      return -1;
+   }
+
+   struct stat st;
+   if(fstat(fd, &st) < 0)
+   {
+      mxPError("readColumnsStream", errno, "Occurred while reading from " + fname + ".");
+      ::close(fd);
       return -1;
    }
 
-   fin.clear(); //Clear the fail bit which may have been set by getline
-   fin.close();
+   size_t fsz = st.st_size;
+   size_t pgsz = sysconf(_SC_PAGESIZE);
+
+   size_t off = 0;
+   size_t len = blockSize;
 
-   if(fin.fail())
+   while(off < fsz)
    {
-      if(errno != 0)
+      //mmap offsets must be page aligned
+      size_t aoff = off - (off % pgsz);
+      size_t msz = (off - aoff) + len;
+      if(aoff + msz > fsz) msz = fsz - aoff;
+
+      void * map = mmap(nullptr, msz, PROT_READ, MAP_PRIVATE, fd, aoff);
+
+      if(map == MAP_FAILED)
       {
-         mxPError("readColumns", errno, "Occurred while closing " + fname + ".");
+         mxPError("readColumnsStream", errno, "Occurred while reading from " + fname + ".");
+         ::close(fd);
+         return -1;
       }
-      else
+
+      const char * b = static_cast<const char *>(map) + (off - aoff);
+      const char * e = static_cast<const char *>(map) + msz;
+
+      //Unless this is the end of the file, stop at the last complete line
+      if(aoff + msz < fsz)
       {
-         mxError("readColumns", MXE_FILECERR, "Occurred while closing " + fname + ".");
+         const char * le = e;
+         while(le > b && *(le-1) != eol) --le;
+
+         if(le == b)
+         {
+            //No complete line in this block, try again with a bigger one
+            munmap(map, msz);
+            len *= 2;
+            continue;
+         }
+
+         e = le;
       }
-      return -1;
-   }
 
+      int dummy[] = {0, (impl::readColClear(arrays), 0)...};
+      static_cast<void>(dummy);
 
+      impl::readColParse<delim,comment,eol>(b, e, arrays...);
 
-   return 0;
-}
+      off += (e - b);
+      len = blockSize;
 
-///A dummy class to allow mx::readColumns to skip a column(s) in a file without requiring memory allocation.
-/** The alternative is to use dummy vectors, which result in excess memory allocations and deallocations.
-  * Usage:
-  \code
-  std::vector<T> col1, col5;
-  skipCol sk;
-  readColumns("filename.txt", col1, sk, sk, sk, col5); //This results in only columns 1 and 5 being stored.
-  \endcode
-  *
-  * \ingroup asciiutils
-  */
-struct skipCol
-{
-   typedef std::string value_type; ///< value_type is defined as std::string so that no conversions take place.
+      munmap(map, msz);
 
-   template<typename T>
-   void push_back( const T & arg )
+      if(process() != 0) break;
+   }
+
+   if(::close(fd) < 0)
    {
-      return;
+      mxPError("readColumnsStream", errno, "Occurred while closing " + fname + ".");
+      return -1;
    }
-};
 
+   return 0;
+}
 
 } //namespace ioutils
 } //namespace mx
@@ -0,0 +1,793 @@
+/** \file shmImageStream.hpp
+  * \author Jared R. Males (jaredmales@gmail.com)
+  * \brief A shared memory ring buffer of images, with a single producer and multiple consumers
+  * \ingroup IPC_sharedmem
+  * \ingroup IPC
+  *
+*/
+
+//***********************************************************************//
+// Copyright 2023 Jared R. Males (jaredmales@gmail.com)
+//
+// This file is part of mxlib.
+//
+// mxlib is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// mxlib is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with mxlib.  If not, see <http://www.gnu.org/licenses/>.
+//***********************************************************************//
+
+#ifndef ipc_shmImageStream_hpp
+#define ipc_shmImageStream_hpp
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <new>
+
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "../mxError.hpp"
+#include "../meta/typeDescription.hpp"
+#include "../improc/eigenImage.hpp"
+
+#include "sharedMemSegment.hpp"
+
+/** \addtogroup IPC_sharedmem
+  * @{
+  */
+
+///The magic number identifying an mxlib image stream ("MXIS")
+#define MX_IPC_SHMIM_MAGIC (0x4d584953)
+
+///The version of the image stream layout
+#define MX_IPC_SHMIM_VERSION (1)
+
+///The alignment, in bytes, of the stream header and of each slot
+#define MX_IPC_SHMIM_ALIGN (64)
+
+///@}
+
+namespace mx
+{
+namespace ipc
+{
+
+/** \addtogroup IPC_sharedmem
+  * @{
+  */
+
+static_assert( ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "shmImageStream requires address-free atomics");
+
+/// The header at the start of a shared memory image stream
+/** This is created by the producer.  Everything except the counters is constant after creation.
+  */
+struct shmImageStreamHeader
+{
+   uint32_t m_magic;       ///< Always MX_IPC_SHMIM_MAGIC
+   uint32_t m_version;     ///< The layout version, MX_IPC_SHMIM_VERSION
+   int32_t m_typeCode;     ///< The meta::typeDescription code of the pixel type
+   uint32_t m_typeSize;    ///< The size of one pixel [bytes]
+   uint64_t m_rows;        ///< The number of rows in each image
+   uint64_t m_cols;        ///< The number of columns in each image
+   uint64_t m_nSlots;      ///< The number of images in the ring buffer
+   uint64_t m_slotSize;    ///< The size of one slot, including its header [bytes]
+   uint64_t m_slotOffset;  ///< The offset of the first slot from the start of this header [bytes]
+
+   alignas(MX_IPC_SHMIM_ALIGN) std::atomic<uint64_t> m_frameCount; ///< The number of frames published.  The latest frame is m_frameCount-1.
+   std::atomic<uint32_t> m_futex;    ///< Incremented after each frame is published, consumers wait on this.
+   std::atomic<uint32_t> m_nWaiters; ///< The number of consumers waiting on m_futex
+};
+
+/// The header of one slot in a shared memory image stream
+/** The sequence number works as a seqlock: it is 2*frame+1 while frame is being written, and 2*frame+2 once it is
+  * complete.  A consumer reads it before and after accessing the image, and the image is valid only if it did not
+  * change.
+  */
+struct shmImageSlotHeader
+{
+   alignas(MX_IPC_SHMIM_ALIGN) std::atomic<uint64_t> m_seq; ///< The sequence number of this slot
+   int64_t m_tv_sec;  ///< The seconds part of the time the frame was published
+   int64_t m_tv_nsec; ///< The nanoseconds part of the time the frame was published
+};
+
+namespace impl
+{
+
+/// Round up to a multiple of MX_IPC_SHMIM_ALIGN
+inline
+uint64_t shmImageAlign( uint64_t sz )
+{
+   return ((sz + MX_IPC_SHMIM_ALIGN - 1)/MX_IPC_SHMIM_ALIGN)*MX_IPC_SHMIM_ALIGN;
+}
+
+/// Wait on a futex in shared memory, while its value is val
+/**
+  * \returns 0 on wake-up, or if the value had already changed
+  * \returns 1 on timeout
+  */
+inline
+int shmImageFutexWait( std::atomic<uint32_t> * fut, ///< [in] the futex
+                       uint32_t val,                ///< [in] the value to wait on
+                       double timeout               ///< [in] the timeout [s].  If < 0, waits forever.
+                     )
+{
+   timespec ts;
+   timespec * tsp = nullptr;
+
+   if(timeout >= 0)
+   {
+      ts.tv_sec = static_cast<time_t>(timeout);
+      ts.tv_nsec = static_cast<long>((timeout - ts.tv_sec)*1e9);
+      tsp = &ts;
+   }
+
+   //Not FUTEX_PRIVATE, since the futex is shared between processes
+   if(syscall(SYS_futex, reinterpret_cast<uint32_t *>(fut), FUTEX_WAIT, val, tsp, nullptr, 0) < 0)
+   {
+      if(errno == ETIMEDOUT) return 1;
+   }
+
+   return 0;
+}
+
+/// Wake all waiters on a futex in shared memory
+inline
+void shmImageFutexWake( std::atomic<uint32_t> * fut /**< [in] the futex */)
+{
+   syscall(SYS_futex, reinterpret_cast<uint32_t *>(fut), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+} //namespace impl
+
+/// Publishes images to a shared memory ring buffer
+/** The producer creates the segment, and then for each frame either writes into the next slot in place:
+  * \code
+  * shmImageProducer<float> prod;
+  * prod.create(nullptr, 4242, 128, 128, 8);
+  *
+  * auto im = prod.beginFrame();
+  * im = ...; //fill in the image
+  * prod.publish();
+  * \endcode
+  * or copies an existing image with write().  Publishing never blocks, and a consumer which falls more than
+  * nSlots-1 frames behind loses the older frames.
+  *
+  * There must be only one producer per stream.
+  *
+  * \tparam dataT the pixel type
+  */
+template<typename dataT>
+class shmImageProducer
+{
+public:
+
+   typedef improc::eigenImage<dataT> imageT;
+
+protected:
+
+   sharedMemSegment m_seg;
+
+   shmImageStreamHeader * m_header {nullptr};
+
+   char * m_slots {nullptr};
+
+   bool m_writing {false}; ///< True between beginFrame() and publish()
+
+   shmImageSlotHeader * slot( uint64_t frame )
+   {
+      return reinterpret_cast<shmImageSlotHeader *>(m_slots + (frame % m_header->m_nSlots)*m_header->m_slotSize);
+   }
+
+public:
+
+   shmImageProducer();
+
+   /// Destructor, detaches from the segment but does not remove it
+   ~shmImageProducer();
+
+   /// Create the stream
+   /** Creates (or re-creates) the segment and initializes the header and slots.
+     *
+     * \returns 0 on success
+     * \returns -1 on error
+     */
+   int create( const char * path, ///< [in] the path for ftok.  If nullptr, id is used as the key.
+               int id,            ///< [in] the id for ftok, or the key
+               uint64_t rows,     ///< [in] the number of rows in each image
+               uint64_t cols,     ///< [in] the number of columns in each image
+               uint64_t nSlots    ///< [in] the number of images in the ring buffer, at least 2
+             );
+
+   /// Detach from the segment
+   /**
+     * \returns 0 on success
+     * \returns -1 on error
+     */
+   int detach();
+
+   /// Mark the segment for removal once all processes have detached
+   /**
+     * \returns 0 on success
+     * \returns -1 on error
+     */
+   int remove();
+
+   /// Get the number of rows
+   uint64_t rows();
+
+   /// Get the number of columns
+   uint64_t cols();
+
+   /// Get the number of slots
+   uint64_t nSlots();
+
+   /// Get the number of frames published
+   uint64_t frameCount();
+
+   /// Start writing the next frame in place
+   /** Consumers will not read the slot until publish() is called.
+     *
+     * \returns a map of the slot for the next frame
+     */
+   Eigen::Map<imageT> beginFrame();
+
+   /// Publish the frame started with beginFrame() and wake the consumers
+   /**
+     * \returns 0 on success
+     * \returns -1 on error
+     */
+   int publish();
+
+   /// Copy an image into the next slot and publish it
+   /**
+     * \returns 0 on success
+     * \returns -1 on error
+     */
+   template<typename eigenT>
+   int write( const eigenT & im /**< [in] the image, must be rows() x cols() */);
+};
+
+template<typename dataT>
+shmImageProducer<dataT>::shmImageProducer()
+{
+   m_seg.initialize();
+}
+
+template<typename dataT>
+shmImageProducer<dataT>::~shmImageProducer()
+{
+   detach();
+}
+
+template<typename dataT>
+int shmImageProducer<dataT>::create( const char * path,
+                                     int id,
+                                     uint64_t rows,
+                                     uint64_t cols,
+                                     uint64_t nSlots
+                                   )
+{
+   if(nSlots < 2)
+   {
+      mxError("shmImageProducer::create", MXE_INVALIDARG, "nSlots must be at least 2");
+      return -1;
+   }
+
+   detach();
+
+   m_seg.initialize();
+   m_seg.setKey(path, id);
+
+   //The segment begins with the address block from sharedMemSegment
+   uint64_t hdrOffset = impl::shmImageAlign(sizeof(uintptr_t));
+   uint64_t slotOffset = impl::shmImageAlign(sizeof(shmImageStreamHeader));
+   uint64_t slotSize = impl::shmImageAlign(sizeof(shmImageSlotHeader)) + impl::shmImageAlign(rows*cols*sizeof(dataT));
+
+   if(m_seg.create(hdrOffset - sizeof(uintptr_t) + slotOffset + nSlots*slotSize) < 0)
+   {
+      mxError("shmImageProducer::create", MXE_ALLOCERR, "could not create shared memory segment");
+      return -1;
+   }
+
+   char * base = static_cast<char *>(m_seg.addr) + hdrOffset;
+
+   m_header = new (base) shmImageStreamHeader;
+   m_slots = base + slotOffset;
+
+   m_header->m_typeCode = meta::typeDescription<dataT>::code();
+   m_header->m_typeSize = sizeof(dataT);
+   m_header->m_rows = rows;
+   m_header->m_cols = cols;
+   m_header->m_nSlots = nSlots;
+   m_header->m_slotSize = slotSize;
+   m_header->m_slotOffset = slotOffset;
+   m_header->m_frameCount.store(0);
+   m_header->m_futex.store(0);
+   m_header->m_nWaiters.store(0);
+
+   for(uint64_t n = 0; n < nSlots; ++n)
+   {
+      shmImageSlotHeader * sl = new (m_slots + n*slotSize) shmImageSlotHeader;
+      sl->m_seq.store(0);
+      sl->m_tv_sec = 0;
+      sl->m_tv_nsec = 0;
+   }
+
+   m_writing = false;
+
+   //Consumers check these last
+   m_header->m_version = MX_IPC_SHMIM_VERSION;
+   std::atomic_thread_fence(std::memory_order_release);
+   m_header->m_magic = MX_IPC_SHMIM_MAGIC;
+
+   return 0;
+}
+
+template<typename dataT>
+int shmImageProducer<dataT>::detach()
+{
+   if(m_header == nullptr) return 0;
+
+   m_header = nullptr;
+   m_slots = nullptr;
+
+   return m_seg.detach();
+}
+
+template<typename dataT>
+int shmImageProducer<dataT>::remove()
+{
+   if(shmctl(m_seg.shmemid, IPC_RMID, 0) < 0)
+   {
+      mxError("shmImageProducer::remove", MXE_FREEERR, "could not remove shared memory segment");
+      return -1;
+   }
+
+   return 0;
+}
+
+template<typename dataT>
+uint64_t shmImageProducer<dataT>::rows()
+{
+   return m_header->m_rows;
+}
+
+template<typename dataT>
+uint64_t shmImageProducer<dataT>::cols()
+{
+   return m_header->m_cols;
+}
+
+template<typename dataT>
+uint64_t shmImageProducer<dataT>::nSlots()
+{
+   return m_header->m_nSlots;
+}
+
+template<typename dataT>
+uint64_t shmImageProducer<dataT>::frameCount()
+{
+   return m_header->m_frameCount.load(std::memory_order_acquire);
+}
+
+template<typename dataT>
+Eigen::Map<typename shmImageProducer<dataT>::imageT> shmImageProducer<dataT>::beginFrame()
+{
+   uint64_t frame = m_header->m_frameCount.load(std::memory_order_relaxed);
+
+   shmImageSlotHeader * sl = slot(frame);
+
+   if(!m_writing)
+   {
+      //Mark the slot as being written before touching the data
+      sl->m_seq.store(2*frame + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      m_writing = true;
+   }
+
+   dataT * data = reinterpret_cast<dataT *>(reinterpret_cast<char *>(sl) + impl::shmImageAlign(sizeof(shmImageSlotHeader)));
+
+   return Eigen::Map<imageT>(data, m_header->m_rows, m_header->m_cols);
+}
+
+template<typename dataT>
+int shmImageProducer<dataT>::publish()
+{
+   if(!m_writing)
+   {
+      mxError("shmImageProducer::publish", MXE_PARAMNOTSET, "beginFrame was not called");
+      return -1;
+   }
+
+   uint64_t frame = m_header->m_frameCount.load(std::memory_order_relaxed);
+
+   shmImageSlotHeader * sl = slot(frame);
+
+   timespec ts;
+   clock_gettime(CLOCK_REALTIME, &ts);
+   sl->m_tv_sec = ts.tv_sec;
+   sl->m_tv_nsec = ts.tv_nsec;
+
+   sl->m_seq.store(2*frame + 2, std::memory_order_release);
+
+   m_header->m_frameCount.store(frame + 1);
+   m_header->m_futex.fetch_add(1);
+
+   if(m_header->m_nWaiters.load() > 0) impl::shmImageFutexWake(&m_header->m_futex);
+
+   m_writing = false;
+
+   return 0;
+}
+
+template<typename dataT>
+template<typename eigenT>
+int shmImageProducer<dataT>::write( const eigenT & im )
+{
+   if((uint64_t) im.rows() != m_header->m_rows || (uint64_t) im.cols() != m_header->m_cols)
+   {
+      mxError("shmImageProducer::write", MXE_SIZEERR, "image is not the size of the stream");
+      return -1;
+   }
+
+   beginFrame() = im.template cast<dataT>();
+
+   return publish();
+}
+
+/// Reads images from a shared memory ring buffer
+/** Any number of consumers may attach to a stream.  Each keeps track of the next frame it has not read, and
+  * next() waits for it:
+  * \code
+  * shmImageConsumer<float> cons;
+  * cons.attach(nullptr, 4242);
+  *
+  * uint64_t frame;
+  * while(cons.next(frame, 1.0) == 0)
+  * {
+  *    auto im = cons.map(frame); //no copy
+  *    ... //process im
+  *    if(!cons.valid(frame)) ... //the producer overwrote the slot while it was in use, discard the result
+  * }
+  * \endcode
+  * Use copy() instead of map() when the processing is slow compared to the frame rate.
+  *
+  * \tparam dataT the pixel type, which must match the producer's
+  */
+template<typename dataT>
+class shmImageConsumer
+{
+public:
+
+   typedef improc::eigenImage<dataT> imageT;
+
+protected:
+
+   sharedMemSegment m_seg;
+
+   shmImageStreamHeader * m_header {nullptr};
+
+   char * m_slots {nullptr};
+
+   uint64_t m_nextFrame {0}; ///< The next frame to be returned by next()
+
+   uint64_t m_dropped {0}; ///< The number of frames skipped because they were overwritten before being read
+
+   shmImageSlotHeader * slot( uint64_t frame )
+   {
+      return reinterpret_cast<shmImageSlotHeader *>(m_slots + (frame % m_header->m_nSlots)*m_header->m_slotSize);
+   }
+
+   dataT * slotData( uint64_t frame )
+   {
+      return reinterpret_cast<dataT *>(reinterpret_cast<char *>(slot(frame)) + impl::shmImageAlign(sizeof(shmImageSlotHeader)));
+   }
+
+public:
+
+   shmImageConsumer();
+
+   /// Destructor, detaches from the segment
+   ~shmImageConsumer();
+
+   /// Attach to an existing stream
+   /** After attaching, next() starts with the latest frame.
+     *
+     * \returns 0 on success
+     * \returns -1 on error, including a type mismatch
+     */
+   int attach( const char * path, ///< [in] the path for ftok.  If nullptr, id is used as the key.
+               int id             ///< [in] the id for ftok, or the key
+             );
+
+   /// Detach from the segment
+   /**
+     * \returns 0 on success
+     * \returns -1 on error
+     */
+   int detach();
+
+   /// Get the number of rows
+   uint64_t rows();
+
+   /// Get the number of columns
+   uint64_t cols();
+
+   /// Get the number of slots
+   uint64_t nSlots();
+
+   /// Get the number of frames published
+   uint64_t frameCount();
+
+   /// Get the number of frames skipped by next() because they were overwritten
+   uint64_t dropped();
+
+   /// Wait for the next unread frame
+   /** If the consumer has fallen behind so that the next unread frame may have been overwritten, it skips
+     * ahead to the oldest frame still safely in the buffer and counts the skipped frames in dropped().
+     *
+     * \returns 0 if a frame is available
+     * \returns 1 on timeout
+     */
+   int next( uint64_t & frame, ///< [out] the frame number to read
+             double timeout    ///< [in] the timeout [s].  If < 0, waits forever.
+           );
+
+   /// Wait for more than count frames to be published
+   /**
+     * \returns 0 once frameCount() > count
+     * \returns 1 on timeout
+     */
+   int wait( uint64_t count, ///< [in] the frame count to wait past
+             double timeout  ///< [in] the timeout [s].  If < 0, waits forever.
+           );
+
+   /// Check whether a frame is in the buffer and complete
+   /** Call this after using a map() to check that the producer did not overwrite the frame during use.
+     *
+     * \returns true if the frame is complete and has not been overwritten
+     */
+   bool valid( uint64_t frame /**< [in] the frame number*/);
+
+   /// Get a map of a frame in the buffer, without copying
+   /** The map remains valid until the producer wraps around to the slot again, which can be checked with valid().
+     *
+     * \returns a map of the frame's slot
+     */
+   Eigen::Map<const imageT> map( uint64_t frame /**< [in] the frame number*/);
+
+   /// Copy a frame out of the buffer
+   /**
+     * \returns 0 on success
+     * \returns -1 if the frame is not complete or was overwritten
+     */
+   int copy( imageT & im,   ///< [out] the image, resized if needed
+             uint64_t frame ///< [in] the frame number
+           );
+
+   /// Get the time at which a frame was published
+   /**
+     * \returns 0 on success
+     * \returns -1 if the frame is not complete or was overwritten
+     */
+   int frameTime( timespec & ts,  ///< [out] the publication time
+                  uint64_t frame  ///< [in] the frame number
+                );
+};
+
+template<typename dataT>
+shmImageConsumer<dataT>::shmImageConsumer()
+{
+   m_seg.initialize();
+}
+
+template<typename dataT>
+shmImageConsumer<dataT>::~shmImageConsumer()
+{
+   detach();
+}
+
+template<typename dataT>
+int shmImageConsumer<dataT>::attach( const char * path,
+                                     int id
+                                   )
+{
+   detach();
+
+   m_seg.initialize();
+   m_seg.setKey(path, id);
+
+   //Slots are addressed by offset, so the segment does not need to be at the producer's address
+   if(m_seg.attach(true) < 0)
+   {
+      mxError("shmImageConsumer::attach", MXE_NOTFOUND, "could not attach to shared memory segment");
+      return -1;
+   }
+
+   char * base = static_cast<char *>(m_seg.addr) + impl::shmImageAlign(sizeof(uintptr_t));
+
+   shmImageStreamHeader * header = reinterpret_cast<shmImageStreamHeader *>(base);
+
+   if(header->m_magic != MX_IPC_SHMIM_MAGIC || header->m_version != MX_IPC_SHMIM_VERSION)
+   {
+      mxError("shmImageConsumer::attach", MXE_INVALIDARG, "segment is not an mxlib image stream");
+      m_seg.detach();
+      return -1;
+   }
+
+   std::atomic_thread_fence(std::memory_order_acquire);
+
+   if(header->m_typeCode != meta::typeDescription<dataT>::code() || header->m_typeSize != sizeof(dataT))
+   {
+      mxError("shmImageConsumer::attach", MXE_INVALIDARG, std::string("stream type does not match ") + meta::typeDescription<dataT>::name());
+      m_seg.detach();
+      return -1;
+   }
+
+   m_header = header;
+   m_slots = base + header->m_slotOffset;
+
+   uint64_t count = frameCount();
+   m_nextFrame = (count > 0) ? count - 1 : 0;
+   m_dropped = 0;
+
+   return 0;
+}
+
+template<typename dataT>
+int shmImageConsumer<dataT>::detach()
+{
+   if(m_header == nullptr) return 0;
+
+   m_header = nullptr;
+   m_slots = nullptr;
+
+   return m_seg.detach();
+}
+
+template<typename dataT>
+uint64_t shmImageConsumer<dataT>::rows()
+{
+   return m_header->m_rows;
+}
+
+template<typename dataT>
+uint64_t shmImageConsumer<dataT>::cols()
+{
+   return m_header->m_cols;
+}
+
+template<typename dataT>
+uint64_t shmImageConsumer<dataT>::nSlots()
+{
+   return m_header->m_nSlots;
+}
+
+template<typename dataT>
+uint64_t shmImageConsumer<dataT>::frameCount()
+{
+   return m_header->m_frameCount.load(std::memory_order_acquire);
+}
+
+template<typename dataT>
+uint64_t shmImageConsumer<dataT>::dropped()
+{
+   return m_dropped;
+}
+
+template<typename dataT>
+int shmImageConsumer<dataT>::wait( uint64_t count,
+                                   double timeout
+                                 )
+{
+   timespec t0;
+   if(timeout > 0) clock_gettime(CLOCK_MONOTONIC, &t0);
+
+   while(true)
+   {
+      //Read the futex before the counter, so a frame published in between changes the futex and ends the wait
+      uint32_t fut = m_header->m_futex.load();
+
+      if(m_header->m_frameCount.load() > count) return 0;
+
+      double remaining = timeout;
+      if(timeout > 0)
+      {
+         timespec t1;
+         clock_gettime(CLOCK_MONOTONIC, &t1);
+         remaining = timeout - ((t1.tv_sec - t0.tv_sec) + 1e-9*(t1.tv_nsec - t0.tv_nsec));
+         if(remaining <= 0) return 1;
+      }
+      else if(timeout == 0) return 1;
+
+      m_header->m_nWaiters.fetch_add(1);
+      int rv = impl::shmImageFutexWait(&m_header->m_futex, fut, remaining);
+      m_header->m_nWaiters.fetch_sub(1);
+
+      if(rv == 1 && m_header->m_frameCount.load() <= count) return 1;
+   }
+}
+
+template<typename dataT>
+int shmImageConsumer<dataT>::next( uint64_t & frame,
+                                   double timeout
+                                 )
+{
+   if(wait(m_nextFrame, timeout) != 0) return 1;
+
+   uint64_t count = m_header->m_frameCount.load();
+
+   //The slot of frame count-nSlots is the one the producer writes next, so it is not safe to start there
+   if(count >= m_header->m_nSlots && m_nextFrame < count - m_header->m_nSlots + 1)
+   {
+      uint64_t oldest = count - m_header->m_nSlots + 1;
+      m_dropped += oldest - m_nextFrame;
+      m_nextFrame = oldest;
+   }
+
+   frame = m_nextFrame;
+   ++m_nextFrame;
+
+   return 0;
+}
+
+template<typename dataT>
+bool shmImageConsumer<dataT>::valid( uint64_t frame )
+{
+   std::atomic_thread_fence(std::memory_order_acquire);
+   return slot(frame)->m_seq.load(std::memory_order_relaxed) == 2*frame + 2;
+}
+
+template<typename dataT>
+Eigen::Map<const typename shmImageConsumer<dataT>::imageT> shmImageConsumer<dataT>::map( uint64_t frame )
+{
+   return Eigen::Map<const imageT>(slotData(frame), m_header->m_rows, m_header->m_cols);
+}
+
+template<typename dataT>
+int shmImageConsumer<dataT>::copy( imageT & im,
+                                   uint64_t frame
+                                 )
+{
+   if(slot(frame)->m_seq.load(std::memory_order_acquire) != 2*frame + 2) return -1;
+
+   im.resize(m_header->m_rows, m_header->m_cols);
+   memcpy(im.data(), slotData(frame), m_header->m_rows*m_header->m_cols*sizeof(dataT));
+
+   return valid(frame) ? 0 : -1;
+}
+
+template<typename dataT>
+int shmImageConsumer<dataT>::frameTime( timespec & ts,
+                                        uint64_t frame
+                                      )
+{
+   shmImageSlotHeader * sl = slot(frame);
+
+   if(sl->m_seq.load(std::memory_order_acquire) != 2*frame + 2) return -1;
+
+   ts.tv_sec = sl->m_tv_sec;
+   ts.tv_nsec = sl->m_tv_nsec;
+
+   return valid(frame) ? 0 : -1;
+}
+
+/// @}
+
+} //namespace ipc
+} //namespace mx
+
+#endif //ipc_shmImageStream_hpp
@@ -495,6 +495,43 @@ template<>
 void fftw_free<complexQT>( complexQT * p);
 #endif
 
+//************ Alignment ************************//
+
+///Call to fftw_alignment_of, with type cast.
+/** Plans are made with fftw_malloc-ed memory, so a different array can only be passed to an existing plan if this 
+  * returns 0 for it.
+  * 
+  * \param p is a pointer to the array.
+  */ 
+template<typename realT>
+int fftw_alignment_of( const realT * p);
+
+template<>
+int fftw_alignment_of<float>( const float * p);
+
+template<>
+int fftw_alignment_of<complexFT>( const complexFT * p);
+
+template<>
+int fftw_alignment_of<double>( const double * p);
+
+template<>
+int fftw_alignment_of<complexDT>( const complexDT * p);
+
+template<>
+int fftw_alignment_of<long double>( const long double * p);
+
+template<>
+int fftw_alignment_of<complexLT>( const complexLT * p);
+
+#ifdef HASQUAD
+template<>
+int fftw_alignment_of<__float128>( const __float128 * p);
+
+template<>
+int fftw_alignment_of<complexQT>( const complexQT * p);
+#endif
+
 ///@} fftw_template_alloc
 
 /** \defgroup fftw_template_plans Planning 
@@ -671,6 +708,169 @@ fftwTypeSpec<complexQT, __float128>::planT fftw_plan_dft<complexQT, __float128>(
                                                                                );
 #endif
 
+/// Create a plan for many contiguous transforms of the same size, using the advanced interface
+/** The transforms are packed with stride 1, with transform k of the input starting at in + k*idist 
+  * and of the output at out + k*odist.
+  * 
+  * \param n is a vector of ints containing the size of each dimension of one transform.
+  * \param howmany the number of transforms
+  * \param in is the input data
+  * \param idist the distance between the starts of consecutive input arrays
+  * \param out is the output data
+  * \param odist the distance between the starts of consecutive output arrays
+  * \param sign is the sign of the transform, ignored for real transforms
+  * \param flags other fftw flags
+  *
+  * \returns an fftw plan for the types specified.
+  * 
+  * \tparam inputDataT the data type of the input array
+  * \tparam outputDataT the data type of the output array
+  */ 
+template<typename inputDataT, typename outputDataT>
+typename fftwTypeSpec<inputDataT,outputDataT>::planT fftw_plan_many_dft( std::vector<int> n,
+                                                                         int howmany,
+                                                                         inputDataT * in, 
+                                                                         int idist,
+                                                                         outputDataT * out,
+                                                                         int odist,
+                                                                         int sign,
+                                                                         unsigned flags 
+                                                                       );
+
+template<>
+fftwTypeSpec<complexFT, complexFT>::planT fftw_plan_many_dft<complexFT, complexFT>( std::vector<int> n,
+                                                                                    int howmany,
+                                                                                    complexFT * in,
+                                                                                    int idist,
+                                                                                    complexFT * out,
+                                                                                    int odist,
+                                                                                    int sign,
+                                                                                    unsigned flags
+                                                                                  );
+
+template<>
+fftwTypeSpec<float, complexFT>::planT fftw_plan_many_dft<float, complexFT>( std::vector<int> n,
+                                                                            int howmany,
+                                                                            float * in,
+                                                                            int idist,
+                                                                            complexFT * out,
+                                                                            int odist,
+                                                                            int sign,
+                                                                            unsigned flags
+                                                                          );
+
+template<>
+fftwTypeSpec<complexFT, float>::planT fftw_plan_many_dft<complexFT, float>( std::vector<int> n,
+                                                                            int howmany,
+                                                                            complexFT * in,
+                                                                            int idist,
+                                                                            float * out,
+                                                                            int odist,
+                                                                            int sign,
+                                                                            unsigned flags
+                                                                          );
+
+template<>
+fftwTypeSpec<complexDT, complexDT>::planT fftw_plan_many_dft<complexDT, complexDT>( std::vector<int> n,
+                                                                                    int howmany,
+                                                                                    complexDT * in,
+                                                                                    int idist,
+                                                                                    complexDT * out,
+                                                                                    int odist,
+                                                                                    int sign,
+                                                                                    unsigned flags
+                                                                                  );
+
+template<>
+fftwTypeSpec<double, complexDT>::planT fftw_plan_many_dft<double, complexDT>( std::vector<int> n,
+                                                                              int howmany,
+                                                                              double * in,
+                                                                              int idist,
+                                                                              complexDT * out,
+                                                                              int odist,
+                                                                              int sign,
+                                                                              unsigned flags
+                                                                            );
+
+template<>
+fftwTypeSpec<complexDT, double>::planT fftw_plan_many_dft<complexDT, double>( std::vector<int> n,
+                                                                              int howmany,
+                                                                              complexDT * in,
+                                                                              int idist,
+                                                                              double * out,
+                                                                              int odist,
+                                                                              int sign,
+                                                                              unsigned flags
+                                                                            );
+
+template<>
+fftwTypeSpec<complexLT, complexLT>::planT fftw_plan_many_dft<complexLT, complexLT>( std::vector<int> n,
+                                                                                    int howmany,
+                                                                                    complexLT * in,
+                                                                                    int idist,
+                                                                                    complexLT * out,
+                                                                                    int odist,
+                                                                                    int sign,
+                                                                                    unsigned flags
+                                                                                  );
+
+template<>
+fftwTypeSpec<long double, complexLT>::planT fftw_plan_many_dft<long double, complexLT>( std::vector<int> n,
+                                                                                        int howmany,
+                                                                                        long double * in,
+                                                                                        int idist,
+                                                                                        complexLT * out,
+                                                                                        int odist,
+                                                                                        int sign,
+                                                                                        unsigned flags
+                                                                                      );
+
+template<>
+fftwTypeSpec<complexLT, long double>::planT fftw_plan_many_dft<complexLT, long double>( std::vector<int> n,
+                                                                                        int howmany,
+                                                                                        complexLT * in,
+                                                                                        int idist,
+                                                                                        long double * out,
+                                                                                        int odist,
+                                                                                        int sign,
+                                                                                        unsigned flags
+                                                                                      );
+
+#ifdef HASQUAD
+template<>
+fftwTypeSpec<complexQT, complexQT>::planT fftw_plan_many_dft<complexQT, complexQT>( std::vector<int> n,
+                                                                                    int howmany,
+                                                                                    complexQT * in,
+                                                                                    int idist,
+                                                                                    complexQT * out,
+                                                                                    int odist,
+                                                                                    int sign,
+                                                                                    unsigned flags
+                                                                                  );
+
+template<>
+fftwTypeSpec<__float128, complexQT>::planT fftw_plan_many_dft<__float128, complexQT>( std::vector<int> n,
+                                                                                      int howmany,
+                                                                                      __float128 * in,
+                                                                                      int idist,
+                                                                                      complexQT * out,
+                                                                                      int odist,
+                                                                                      int sign,
+                                                                                      unsigned flags
+                                                                                    );
+
+template<>
+fftwTypeSpec<complexQT, __float128>::planT fftw_plan_many_dft<complexQT, __float128>( std::vector<int> n,
+                                                                                      int howmany,
+                                                                                      complexQT * in,
+                                                                                      int idist,
+                                                                                      __float128 * out,
+                                                                                      int odist,
+                                                                                      int sign,
+                                                                                      unsigned flags
+                                                                                    );
+#endif
+
 /********* Cleanup *************/
 
 ///Cleanup persistent planner data.
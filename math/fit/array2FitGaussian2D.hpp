@@ -168,12 +168,14 @@ template<typename realT>
 void array2FitGaussian2D<realT>::setSymmetric()
 {
    m_maxNparams = 5;
+   m_nparams = 5;
 }
 
 template<typename realT>
 void array2FitGaussian2D<realT>::setGeneral()
 {
    m_maxNparams = 7;
+   m_nparams = 7;
 }
 
 template<typename realT>
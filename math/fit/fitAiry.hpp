@@ -232,21 +232,100 @@ struct array2FitAiry
    realT ps {0}; ///< is the ratio of the circular central obscuration diameter to the diameter.
 };
 
+namespace impl
+{
+
+/// Fill in the Jacobian of the obstructed Airy pattern fitters
+/** The parameters are A0, A, x0, y0, and optionally ps and eps, in the order used by the airy2D_obs_fitter
+  * family.  Uses \f$ d(Ji(x))/dx = -Ji_2(x) \f$, and the derivatives with respect to x0, y0, and ps share one
+  * radial derivative per pixel.
+  *
+  * \ingroup airy_peak_fit
+  */
+template<typename realT>
+void airy2D_jacf( realT * p,            ///< [in] the parameters
+                  realT * jac,          ///< [out] the n x m row-major Jacobian
+                  int m,                ///< [in] the number of parameters, 4, 5, or 6
+                  array2FitAiry<realT> * arr ///< [in] the data array, with ps and cenObs used if not fit
+                )
+{
+   realT A = p[1];
+   realT x0 = p[2];
+   realT y0 = p[3];
+   realT ps = (m > 4) ? p[4] : arr->ps;
+   realT eps = (m > 5) ? p[5] : arr->cenObs;
+   
+   realT e2 = eps*eps;
+   realT N = static_cast<realT>(1)/pow(static_cast<realT>(1) - e2, 2);
+   
+   size_t idx_dat = 0;
+   
+   for(size_t i=0; i<arr->nx; ++i)
+   {
+      realT dx = i-x0;
+      
+      for(size_t j=0; j<arr->ny; ++j)
+      {
+         realT dy = j-y0;
+         realT rho = sqrt(dx*dx + dy*dy);
+         realT u = pi<realT>()*rho*ps;
+         
+         realT ji = func::jinc(u);
+         realT jie = func::jinc(eps*u);
+         realT g = 2*ji - 2*e2*jie;
+         
+         //Derivative of the pattern with respect to radius in lambda/D
+         realT dPdr = 2*N*g*pi<realT>()*(-2*func::jincN(2,u) + 2*e2*eps*func::jincN(2,eps*u));
+         
+         realT * jrow = jac + idx_dat*m;
+         
+         jrow[0] = 1;
+         jrow[1] = N*g*g;
+         
+         if(rho > 0)
+         {
+            jrow[2] = -A*dPdr*ps*dx/rho;
+            jrow[3] = -A*dPdr*ps*dy/rho;
+         }
+         else
+         {
+            jrow[2] = 0;
+            jrow[3] = 0;
+         }
+         
+         if(m > 4) jrow[4] = A*dPdr*rho;
+         
+         if(m > 5)
+         {
+            realT dgde = -4*eps*jie + 2*e2*u*func::jincN(2,eps*u);
+            jrow[5] = A*( 4*eps*N/(static_cast<realT>(1)-e2)*g*g + 2*N*g*dgde );
+         }
+         
+         ++idx_dat;
+      }
+   }
+}
+
+} //namespace impl
+
 ///\ref levmarInterface fitter structure for the centrally obscured Airy pattern.
 /**
   * Platescale and central obscuration are fixed.
   * 
   * \ingroup airy_peak_fit
   *
+  * \test Scenario: Verify the analytic Jacobians of the 2D fitters \ref tests_math_fit_jacobians "[test doc]"
   */
 template<typename _realT>
 struct airy2D_obs_fitter
 {
    typedef _realT realT;
    
+   typedef bool hasJacobian;
+   
    static const int nparams = 4;
    
-   static void func(realT *p, realT *hx, int m, int n, void *adata)
+   static void func(realT *p, realT *hx, int m __attribute__((unused)), int n __attribute__((unused)), void *adata)
    {
       array2FitAiry<realT> * arr = (array2FitAiry<realT> *) adata;
    
@@ -261,16 +340,12 @@ struct airy2D_obs_fitter
         p[3] = y0
       */
       
-      realT r;
-      
-      for(int i=0;i<arr->nx; i++)
+      for(size_t i=0;i<arr->nx; i++)
       {
-         for(int j=0;j<arr->ny;j++)
+         for(size_t j=0;j<arr->ny;j++)
          { 
             idx_mat = i+j*arr->nx;
    
-            r = sqrt( pow( i-p[2],2) + pow(j-p[3],2));
-            
             hx[idx_dat] = func::airyPattern( static_cast<realT>(i), static_cast<realT>(j), p[0], p[1], p[2], p[3], arr->ps, arr->cenObs)  - arr->data[idx_mat];
             
             //hx[idx_dat] *= fabs(arr->data[idx_mat]);
@@ -280,6 +355,11 @@ struct airy2D_obs_fitter
       }
    }
    
+   /// The Jacobian of func, in the row-major n x m layout expected by levmar.
+   static void jacf(realT *p, realT *jac, int m, int n __attribute__((unused)), void *adata)
+   {
+      impl::airy2D_jacf(p, jac, m, (array2FitAiry<realT> *) adata);
+   }
 
 };
 
@@ -288,15 +368,18 @@ struct airy2D_obs_fitter
   * 
   * \ingroup airy_peak_fit
   *
+  * \test Scenario: Verify the analytic Jacobians of the 2D fitters \ref tests_math_fit_jacobians "[test doc]"
   */
 template<typename _realT>
 struct airy2D_obs_fitter_ps
 {
    typedef _realT realT;
    
+   typedef bool hasJacobian;
+   
    static const int nparams = 5;
    
-   static void func(realT *p, realT *hx, int m, int n, void *adata)
+   static void func(realT *p, realT *hx, int m __attribute__((unused)), int n __attribute__((unused)), void *adata)
    {
       array2FitAiry<realT> * arr = (array2FitAiry<realT> *) adata;
    
@@ -312,16 +395,12 @@ struct airy2D_obs_fitter_ps
         p[4] = ps [(lam/D)/pix]
       */
       
-      realT r;
-      
-      for(int i=0;i<arr->nx; i++)
+      for(size_t i=0;i<arr->nx; i++)
       {
-         for(int j=0;j<arr->ny;j++)
+         for(size_t j=0;j<arr->ny;j++)
          { 
             idx_mat = i+j*arr->nx;
    
-            r = sqrt( pow( i-p[2],2) + pow(j-p[3],2));
-            
             hx[idx_dat] = func::airyPattern( static_cast<realT>(i), static_cast<realT>(j), p[0], p[1], p[2], p[3], p[4], arr->cenObs)  - arr->data[idx_mat];
             
             //hx[idx_dat] *= fabs( pow(arr->data[idx_mat],2));
@@ -331,6 +410,11 @@ struct airy2D_obs_fitter_ps
       }
    }
    
+   /// The Jacobian of func, in the row-major n x m layout expected by levmar.
+   static void jacf(realT *p, realT *jac, int m, int n __attribute__((unused)), void *adata)
+   {
+      impl::airy2D_jacf(p, jac, m, (array2FitAiry<realT> *) adata);
+   }
 
 };
 
@@ -338,15 +422,18 @@ struct airy2D_obs_fitter_ps
 ///\ref levmarInterface fitter structure for the obstructed Airy pattern, including fitting platescale and central obscuration.
 /** \ingroup airy_peak_fit
   *
+  * \test Scenario: Verify the analytic Jacobians of the 2D fitters \ref tests_math_fit_jacobians "[test doc]"
   */
 template<typename _realT>
 struct airy2D_obs_fitter_ps_eps
 {
    typedef _realT realT;
    
+   typedef bool hasJacobian;
+   
    static const int nparams = 6;
    
-   static void func(realT *p, realT *hx, int m, int n, void *adata)
+   static void func(realT *p, realT *hx, int m __attribute__((unused)), int n __attribute__((unused)), void *adata)
    {
       array2FitAiry<realT> * arr = (array2FitAiry<realT> *) adata;
    
@@ -365,9 +452,9 @@ struct airy2D_obs_fitter_ps_eps
       
       //realT r;
       
-      for(int i=0;i<arr->nx; ++i)
+      for(size_t i=0;i<arr->nx; ++i)
       {
-         for(int j=0;j<arr->ny; ++j)
+         for(size_t j=0;j<arr->ny; ++j)
          { 
             idx_mat = i+j*arr->nx;
    
@@ -382,6 +469,11 @@ struct airy2D_obs_fitter_ps_eps
       }
    }
    
+   /// The Jacobian of func, in the row-major n x m layout expected by levmar.
+   static void jacf(realT *p, realT *jac, int m, int n __attribute__((unused)), void *adata)
+   {
+      impl::airy2D_jacf(p, jac, m, (array2FitAiry<realT> *) adata);
+   }
 
 };
 
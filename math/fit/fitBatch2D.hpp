@@ -0,0 +1,258 @@
+/** \file fitBatch2D.hpp
+ * \author Jared R. Males
+ * \brief Fitting a 2D model to many small stamps in parallel.
+ * \ingroup fitting_files
+ *
+ */
+
+//***********************************************************************//
+// Copyright 2023 Jared R. Males (jaredmales@gmail.com)
+//
+// This file is part of mxlib.
+//
+// mxlib is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// mxlib is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with mxlib.  If not, see <http://www.gnu.org/licenses/>.
+//***********************************************************************//
+
+#ifndef math_fit_fitBatch2D_hpp
+#define math_fit_fitBatch2D_hpp
+
+#include <memory>
+#include <vector>
+
+#include <omp.h>
+
+#include "../../mxError.hpp"
+#include "../../improc/eigenImage.hpp"
+#include "../../improc/eigenCube.hpp"
+
+namespace mx
+{
+namespace math
+{
+namespace fit
+{
+
+/// Fit a 2D model to each plane of a cube of stamps, in parallel.
+/** Each thread owns one fitter, which is reused for every stamp that thread fits.  The levmar work and covariance
+  * arrays are therefore allocated once per thread, rather than once per fit.
+  *
+  * Parameters are exchanged in the same form as the fitter's setGuess and accessors, e.g. for fitGaussian2Dgen the
+  * columns hold (G0, G, x0, y0, sigma_x, sigma_y, theta), omitting any fixed parameters.
+  *
+  * Example:
+  * \code
+  * fitBatch2D<fitGaussian2Dsym<double>> batch;
+  * batch.configure( [](fitGaussian2Dsym<double> & f){ f.setFixed(true, false, false, false, false); } );
+  *
+  * mx::improc::eigenImage<double> params(batch.nParams(), stamps.planes()); //fill in the guesses
+  * batch.fit(params, stamps); //params now holds the results
+  * \endcode
+  *
+  * \tparam fitT a 2D fitter class such as fitGaussian2D, fitMoffat2D, or fitAiry2D, which has setArray(data, nx, ny)
+  *
+  * \ingroup peak_fit
+  *
+  * \test Scenario: Fitting a batch of stamps \ref tests_math_fit_fitBatch2D "[test doc]"
+  */
+template<class fitT>
+class fitBatch2D
+{
+public:
+
+   typedef typename fitT::realT realT;
+
+protected:
+
+   std::vector<std::unique_ptr<fitT>> m_fitters; ///< One fitter per thread.
+
+public:
+
+   /// Default c'tor, creates one fitter per available thread.
+   fitBatch2D();
+
+   /// Constructor setting the number of threads.
+   explicit fitBatch2D( int nThreads /**< [in] the number of threads, and so fitters, to use */);
+
+   /// Set the number of threads.
+   /** This creates new fitters, so any configuration must be repeated.
+     */
+   void nThreads( int nThreads /**< [in] the number of threads, and so fitters, to use.  If < 1, omp_get_max_threads() is used. */);
+
+   /// Get the number of threads.
+   /**
+     * \returns the number of per-thread fitters
+     */
+   int nThreads();
+
+   /// Get the number of parameters being fit
+   /**
+     * \returns the number of free parameters of the fitters
+     */
+   int nParams();
+
+   /// Access one of the per-thread fitters
+   /**
+     * \returns a reference to the n-th fitter
+     */
+   fitT & fitter( int n /**< [in] the fitter number */);
+
+   /// Apply the same configuration to every per-thread fitter.
+   /** Use this to call setFixed, set_itmax, set_opts, etc.
+     */
+   template<typename configT>
+   void configure( configT && config /**< [in] a callable which accepts a fitT & */);
+
+   /// Fit each stamp
+   /**
+     * \returns 0 if every stamp was fit
+     * \returns -1 on an error, or if any fit failed
+     */
+   int fit( improc::eigenImage<realT> & params, ///< [in/out] nParams() x planes.  On input the initial guesses, on output the results.
+            improc::eigenCube<realT> & stamps   ///< [in] the stamps to fit, one per plane
+          );
+
+   /// Fit each stamp, also returning the status and the levmar termination reason for each fit
+   /** A failed fit does not stop the batch.  Its parameters are still copied to params, and its status is set so
+     * it can be found afterwards.
+     *
+     * \returns 0 if every stamp was fit
+     * \returns -1 on an error, or if any fit failed
+     */
+   int fit( improc::eigenImage<realT> & params, ///< [in/out] nParams() x planes.  On input the initial guesses, on output the results.
+            std::vector<int> & status,          ///< [out] the return value of fitT::fit() for each stamp, 0 on success and -1 if the fit failed
+            std::vector<int> & reasons,         ///< [out] the levmar reason code for each stamp, see levmarInterface::get_reason_code
+            improc::eigenCube<realT> & stamps   ///< [in] the stamps to fit, one per plane
+          );
+};
+
+template<class fitT>
+fitBatch2D<fitT>::fitBatch2D()
+{
+   nThreads(0);
+}
+
+template<class fitT>
+fitBatch2D<fitT>::fitBatch2D( int nTh )
+{
+   nThreads(nTh);
+}
+
+template<class fitT>
+void fitBatch2D<fitT>::nThreads( int nTh )
+{
+   if(nTh < 1) nTh = omp_get_max_threads();
+   if(nTh < 1) nTh = 1;
+
+   m_fitters.resize(nTh);
+
+   for(int n=0; n < nTh; ++n)
+   {
+      m_fitters[n].reset(new fitT);
+   }
+}
+
+template<class fitT>
+int fitBatch2D<fitT>::nThreads()
+{
+   return m_fitters.size();
+}
+
+template<class fitT>
+int fitBatch2D<fitT>::nParams()
+{
+   return m_fitters[0]->nParams();
+}
+
+template<class fitT>
+fitT & fitBatch2D<fitT>::fitter( int n )
+{
+   return *m_fitters[n];
+}
+
+template<class fitT>
+template<typename configT>
+void fitBatch2D<fitT>::configure( configT && config )
+{
+   for(size_t n=0; n < m_fitters.size(); ++n)
+   {
+      config(*m_fitters[n]);
+   }
+}
+
+template<class fitT>
+int fitBatch2D<fitT>::fit( improc::eigenImage<realT> & params,
+                           improc::eigenCube<realT> & stamps
+                         )
+{
+   std::vector<int> status, reasons;
+   return fit(params, status, reasons, stamps);
+}
+
+template<class fitT>
+int fitBatch2D<fitT>::fit( improc::eigenImage<realT> & params,
+                           std::vector<int> & status,
+                           std::vector<int> & reasons,
+                           improc::eigenCube<realT> & stamps
+                         )
+{
+   int np = nParams();
+
+   if(params.rows() != np || params.cols() != stamps.planes())
+   {
+      mxError("fitBatch2D::fit", MXE_SIZEERR, "params must be nParams() x stamps.planes()");
+      return -1;
+   }
+
+   status.resize(stamps.planes());
+   reasons.resize(stamps.planes());
+
+   int nTh = m_fitters.size();
+   if(nTh > stamps.planes()) nTh = stamps.planes();
+   if(nTh < 1) return 0;
+
+   size_t stampSz = stamps.rows()*stamps.cols();
+
+   #pragma omp parallel num_threads(nTh)
+   {
+      fitT & fitter = *m_fitters[omp_get_thread_num()];
+
+      //Small stamps take similar but not identical times, so hand them out in chunks.
+      #pragma omp for schedule(dynamic, 4)
+      for(int s=0; s < stamps.planes(); ++s)
+      {
+         fitter.setArray(stamps.data() + s*stampSz, stamps.rows(), stamps.cols());
+         fitter.set_params(params.col(s).data());
+
+         status[s] = fitter.fit();
+
+         realT * p = fitter.get_params();
+         for(int k=0; k < np; ++k) params(k,s) = p[k];
+
+         reasons[s] = fitter.get_reason_code();
+      }
+   }
+
+   for(size_t s=0; s < status.size(); ++s)
+   {
+      if(status[s] != 0) return -1;
+   }
+
+   return 0;
+}
+
+} //namespace fit
+} //namespace math
+} //namespace mx
+
+#endif //math_fit_fitBatch2D_hpp
@@ -399,12 +399,12 @@ public:
       fitterT fitter;
       fitter.paramNormalizer(&arr, this->p, 1);
       
-      levmarInterface<fitterT>::fit();
+      int rv = levmarInterface<fitterT>::fit();
       
       fitter.paramNormalizer(&arr, this->p, -1);
       fitter.paramNormalizer(&arr, this->init_p, -1); //The normalized version is stored, so fix it before possible output.
       
-      return 0;
+      return rv;
    }
      
    ///Get the current value of G0, the constant.
@@ -475,32 +475,52 @@ public:
 
 
 ///\ref levmarInterface fitter structure for the symmetric Gaussian.
-/** \ingroup gaussian_peak_fit
+/** Provides the analytic Jacobian, so levmar_der is used.  The exponential is evaluated once per pixel and
+  * shared by all of the derivatives.
+  *
+  * \ingroup gaussian_peak_fit
   *
   * \test Scenario: Verify direction and accuracy of various image shifts \ref tests_improc_imageTransforms_imageShift "[test doc]"
+  * \test Scenario: Verify the analytic Jacobians of the 2D fitters \ref tests_math_fit_jacobians "[test doc]"
   */
 template<typename _realT>
 struct gaussian2D_sym_fitter
 {
    typedef _realT realT;
    
+   typedef bool hasJacobian;
+   
    static const int maxNparams = 5;
    
    static void func(realT *p, realT *hx, int m __attribute__((unused)), int n __attribute__((unused)), void *adata)
    {
-      array2Fit<realT> * arr = (array2Fit<realT> *) adata;
+      array2FitGaussian2D<realT> * arr = (array2FitGaussian2D<realT> *) adata;
    
       size_t idx_mat, idx_dat;
 
+      realT G0 = arr->G0(p);
+      realT G = arr->G(p);
+      realT x0 = arr->x0(p);
+      realT y0 = arr->y0(p);
+      realT sigma = arr->sigma(p);
+      
+      realT a = static_cast<realT>(0.5)/(sigma*sigma);
+      
       idx_dat = 0;
    
       for(unsigned int j=0;j<arr->ny; j++)
       {
+         realT dy2 = (j-y0)*(j-y0);
+         
          for(unsigned int i=0;i<arr->nx;i++)
          { 
             idx_mat = i+j*arr->nx;
    
-            hx[idx_dat] = func::gaussian2D<realT>(i,j,p[0],p[1], p[2], p[3], p[4]) - arr->data[idx_mat];
+            if(arr->mask != nullptr && arr->mask[idx_mat] == 0) continue;
+            
+            realT dx = i-x0;
+            
+            hx[idx_dat] = G0 + G*exp( -a*(dx*dx + dy2) ) - arr->data[idx_mat];
             
             idx_dat++;
          }
@@ -508,6 +528,51 @@ struct gaussian2D_sym_fitter
       
    }
    
+   /// The Jacobian of func, in the row-major n x m layout expected by levmar.
+   static void jacf(realT *p, realT *jac, int m, int n __attribute__((unused)), void *adata)
+   {
+      array2FitGaussian2D<realT> * arr = (array2FitGaussian2D<realT> *) adata;
+   
+      size_t idx_mat, idx_dat;
+
+      realT G = arr->G(p);
+      realT x0 = arr->x0(p);
+      realT y0 = arr->y0(p);
+      realT sigma = arr->sigma(p);
+      
+      realT s2 = sigma*sigma;
+      realT a = static_cast<realT>(0.5)/s2;
+      
+      idx_dat = 0;
+   
+      for(unsigned int j=0;j<arr->ny; j++)
+      {
+         realT dy = j-y0;
+         
+         for(unsigned int i=0;i<arr->nx;i++)
+         { 
+            idx_mat = i+j*arr->nx;
+   
+            if(arr->mask != nullptr && arr->mask[idx_mat] == 0) continue;
+            
+            realT dx = i-x0;
+            realT r2 = dx*dx + dy*dy;
+            realT e = exp( -a*r2 );
+            realT Ge = G*e/s2;
+            
+            realT * jrow = jac + idx_dat*m;
+            
+            if(arr->m_G0_idx >= 0) jrow[arr->m_G0_idx] = 1;
+            if(arr->m_G_idx >= 0) jrow[arr->m_G_idx] = e;
+            if(arr->m_x0_idx >= 0) jrow[arr->m_x0_idx] = Ge*dx;
+            if(arr->m_y0_idx >= 0) jrow[arr->m_y0_idx] = Ge*dy;
+            if(arr->m_sigma_idx >= 0) jrow[arr->m_sigma_idx] = Ge*r2/sigma;
+            
+            idx_dat++;
+         }
+      }
+   }
+   
    ///Does nothing in this case.
    void paramNormalizer( array2FitGaussian2D<realT> * arr __attribute__((unused)), 
                          realT * p __attribute__((unused)), 
@@ -519,14 +584,19 @@ struct gaussian2D_sym_fitter
 };
 
 ///\ref levmarInterface fitter structure for the general elliptical Gaussian.
-/** \ingroup gaussian_peak_fit
+/** Provides the analytic Jacobian with respect to (a,b,c), so levmar_der is used.
   *
+  * \ingroup gaussian_peak_fit
+  *
+  * \test Scenario: Verify the analytic Jacobians of the 2D fitters \ref tests_math_fit_jacobians "[test doc]"
   */
 template<typename _realT>
 struct gaussian2D_gen_fitter
 {
    typedef _realT realT;
    
+   typedef bool hasJacobian;
+   
    static const int maxNparams = 7;
    
    static void func(realT *p, realT *hx, int m __attribute__((unused)), int n __attribute__((unused)), void *adata)
@@ -618,6 +688,64 @@ struct gaussian2D_gen_fitter
       
       
    }
+   
+   /// The Jacobian of func, in the row-major n x m layout expected by levmar.
+   /** If {{a b}{b c}} is not positive-definite, func returns a constant, so the Jacobian is zero.
+     */
+   static void jacf(realT *p, realT *jac, int m, int n, void *adata)
+   {
+      array2FitGaussian2D<realT> * arr = (array2FitGaussian2D<realT> *) adata;
+   
+      size_t idx_mat, idx_dat;
+
+      realT G = arr->G(p);
+      realT x0 = arr->x0(p);
+      realT y0 = arr->y0(p);
+      realT a = arr->a(p);
+      realT b = arr->b(p);
+      realT c = arr->c(p);
+      
+      if( a*c - b*b <= 0 || a <= 0 || c <= 0 || a+c <= 2*fabs(b))
+      {
+         for(int k=0; k < n*m; ++k) jac[k] = 0;
+         return;
+      }
+      
+      idx_dat = 0;
+   
+      for(unsigned int j=0;j<arr->ny; ++j)
+      {
+         realT dy = j-y0;
+         
+         for(unsigned int i=0;i<arr->nx; ++i)
+         { 
+            idx_mat = i+j*arr->nx;
+            
+            if(arr->mask != nullptr && arr->mask[idx_mat] == 0) continue;
+            
+            realT dx = i-x0;
+            realT e = exp( static_cast<realT>(-0.5)*( a*dx*dx + 2*b*dx*dy + c*dy*dy) );
+            realT Ge = G*e;
+            
+            realT * jrow = jac + idx_dat*m;
+            
+            if(arr->m_G0_idx >= 0) jrow[arr->m_G0_idx] = 1;
+            if(arr->m_G_idx >= 0) jrow[arr->m_G_idx] = e;
+            if(arr->m_x0_idx >= 0) jrow[arr->m_x0_idx] = Ge*(a*dx + b*dy);
+            if(arr->m_y0_idx >= 0) jrow[arr->m_y0_idx] = Ge*(b*dx + c*dy);
+            
+            //a, b, and c are fixed together
+            if(arr->m_sigma_x_idx >= 0)
+            {
+               jrow[arr->m_sigma_x_idx] = static_cast<realT>(-0.5)*Ge*dx*dx;
+               jrow[arr->m_sigma_y_idx] = -Ge*dx*dy;
+               jrow[arr->m_theta_idx] = static_cast<realT>(-0.5)*Ge*dy*dy;
+            }
+            
+            ++idx_dat;
+         }
+      }
+   }
       
    void paramNormalizer( array2FitGaussian2D<realT> * arr,
                          realT * p, 
@@ -442,17 +442,23 @@ struct array2FitMoffat
 };
 
 ///\ref levmarInterface fitter structure for the symmetric Moffat.
-/** \ingroup moffat_peak_fit
+/** Provides the analytic Jacobian, so levmar_der is used.  The power is evaluated once per pixel and shared
+  * by all of the derivatives.
+  *
+  * \ingroup moffat_peak_fit
   *
+  * \test Scenario: Verify the analytic Jacobians of the 2D fitters \ref tests_math_fit_jacobians "[test doc]"
   */
 template<typename _realT>
 struct moffat2D_sym_fitter
 {
    typedef _realT realT;
    
+   typedef bool hasJacobian;
+   
    static const int nparams = 6;
    
-   static void func(realT *p, realT *hx, int m, int n, void *adata)
+   static void func(realT *p, realT *hx, int m __attribute__((unused)), int n __attribute__((unused)), void *adata)
    {
       array2FitMoffat<realT> * arr = (array2FitMoffat<realT> *) adata;
    
@@ -467,18 +473,69 @@ struct moffat2D_sym_fitter
       realT alpha = arr->alpha(p);
       realT beta = arr->beta(p);
       
-      for(int i=0; i<arr->nx; ++i)
+      realT ia2 = static_cast<realT>(1)/(alpha*alpha);
+      
+      for(size_t i=0; i<arr->nx; ++i)
       {
-         for(int j=0; j<arr->ny; ++j)
+         realT dx2 = (i-x0)*(i-x0);
+         
+         for(size_t j=0; j<arr->ny; ++j)
          { 
             idx_mat = i+j*arr->nx;
    
-            hx[idx_dat] = func::moffat2D<realT>(i,j,I0,I, x0, y0, alpha, beta) - arr->data[idx_mat];
+            realT dy = j-y0;
+            
+            hx[idx_dat] = I0 + I*pow( static_cast<realT>(1) + (dx2 + dy*dy)*ia2, -beta) - arr->data[idx_mat];
             
             ++idx_dat;
          }
       }
-   }   
+   }
+   
+   /// The Jacobian of func, in the row-major n x m layout expected by levmar.
+   static void jacf(realT *p, realT *jac, int m, int n __attribute__((unused)), void *adata)
+   {
+      array2FitMoffat<realT> * arr = (array2FitMoffat<realT> *) adata;
+   
+      size_t idx_dat;
+
+      idx_dat = 0;
+   
+      realT I = arr->I(p);
+      realT x0 = arr->x0(p);
+      realT y0 = arr->y0(p);
+      realT alpha = arr->alpha(p);
+      realT beta = arr->beta(p);
+      
+      realT ia2 = static_cast<realT>(1)/(alpha*alpha);
+      
+      for(size_t i=0; i<arr->nx; ++i)
+      {
+         realT dx = i-x0;
+         
+         for(size_t j=0; j<arr->ny; ++j)
+         { 
+            realT dy = j-y0;
+            realT r2 = dx*dx + dy*dy;
+            realT q = static_cast<realT>(1) + r2*ia2;
+            realT qb = pow(q, -beta);
+            
+            //-2 times the derivative of the profile with respect to r^2
+            realT D = 2*I*beta*qb/q*ia2;
+            
+            realT * jrow = jac + idx_dat*m;
+            
+            if(arr->m_I0_idx >= 0) jrow[arr->m_I0_idx] = 1;
+            if(arr->m_I_idx >= 0) jrow[arr->m_I_idx] = qb;
+            if(arr->m_x0_idx >= 0) jrow[arr->m_x0_idx] = D*dx;
+            if(arr->m_y0_idx >= 0) jrow[arr->m_y0_idx] = D*dy;
+            if(arr->m_alpha_idx >= 0) jrow[arr->m_alpha_idx] = D*r2/alpha;
+            if(arr->m_beta_idx >= 0) jrow[arr->m_beta_idx] = -I*qb*log(q);
+            
+            ++idx_dat;
+         }
+      }
+   }
 };
 
 
@@ -269,6 +269,9 @@ public:
    
    ///Perform the fit
    /** This calls \ref allocate_work, and then dispatches the levmar routine appropriate for fitterT.
+     *
+     * \returns 0 on success
+     * \returns -1 if the levmar routine failed, see \ref get_reason_code
      */
    int fit();
       
@@ -662,10 +665,12 @@ int levmarInterface<fitterT>::fit()
    //Create one of the above functors, which depends on whether fitterT has a Jacobian.
    do_levmar<fitterT> fitter;
    
-   fitter(p,x,m,n,itmax,_opts,info,work,covar,adata);
+   int rv = fitter(p,x,m,n,itmax,_opts,info,work,covar,adata);
    
    deltaT = sys::get_curr_time() - t0;
    
+   if(rv < 0) return -1;
+   
    return 0;
 }
 
@@ -178,6 +178,82 @@ __float128 jincN<int, __float128>( const int & v,
                                  );
 #endif
 
+/** \name Fast Jinc Functions
+  * Fast approximations of the Jinc functions using \ref bessel_j0_fast and \ref bessel_j1_fast, with absolute error less than 
+  * \f$ 2\times 10^{-8} \f$.  For \f$ |x| < 8 \f$ the rational approximation of \f$ J_1(x)/x \f$ is used directly, so there is no special case at 0.
+  * The batch versions are written so that the compiler can vectorize them.
+  * 
+  * \ingroup functions
+  * @{
+  */
+
+/// Fast approximation of the Jinc function
+/**
+  * \returns an approximation of Ji(x)
+  */
+template<typename T> 
+T jincFast( T x /**< [in] the argument */)
+{
+   T ax = std::fabs(x);
+   
+   if(ax < 8) return impl::bessel_j1x_small(x*x);
+   else return impl::bessel_j1_large(ax)/ax;
+}
+
+/// Fast approximation of the JincN function
+/**
+  * \returns an approximation of \f$ Ji_N(x) \f$
+  */
+template<typename T> 
+T jincNFast( int v, ///< [in] the Bessel function order, \f$ v \ge 1 \f$
+             T x    ///< [in] the argument
+           )
+{
+   if(v == 1) return jincFast(x);
+   
+   T ax = std::fabs(x);
+   
+   T j;
+   if(ax <= v) j = std::pow(ax, v-1)*impl::bessel_jnxn_series(v, ax);
+   else j = impl::bessel_jn_recur(v, ax, bessel_j0_fast(ax), bessel_j1_fast(ax))/ax;
+   
+   if(x < 0 && (v % 2) == 0) j = -j; //J_v(x)/x is odd for even v
+   
+   return j;
+}
+
+/// Batch fast approximation of the Jinc function
+template<typename T> 
+void jincFast( T * ji,      ///< [out] the values of Ji(x), must be allocated to size N
+               const T * x, ///< [in] the arguments
+               size_t N     ///< [in] the number of arguments
+             )
+{
+   #pragma omp simd
+   for(size_t n = 0; n < N; ++n)
+   {
+      ji[n] = jincFast(x[n]);
+   }
+}
+
+/// Batch fast approximation of the JincN function
+template<typename T> 
+void jincNFast( int v,       ///< [in] the Bessel function order, \f$ v \ge 1 \f$
+                T * ji,      ///< [out] the values of \f$ Ji_v(x) \f$, must be allocated to size N
+                const T * x, ///< [in] the arguments
+                size_t N     ///< [in] the number of arguments
+              )
+{
+   if(v == 1) return jincFast(ji, x, N);
+   
+   for(size_t n = 0; n < N; ++n)
+   {
+      ji[n] = jincNFast(v, x[n]);
+   }
+}
+
+///@}
+
 } //namespace func 
 } //namespace math
 } //namespace mx
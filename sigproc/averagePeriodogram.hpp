@@ -31,6 +31,13 @@
 
 #include "psdUtils.hpp"
 
+/// The number of samples transformed together when calculating a batch of periodograms.
+/** The segments of each time-series are transformed in groups of this many samples (rounded down
+  * to a whole number of segments) with a single fftw plan.
+  */
+#ifndef MX_AVGPGRAM_BATCHSIZE
+#define MX_AVGPGRAM_BATCHSIZE (262144)
+#endif
 
 namespace mx
 {
@@ -72,6 +79,16 @@ namespace sigproc
   
   \endcode
   * 
+  * Many time-series of the same length, such as the modal coefficients from a simulation, can be processed
+  * in one call.  The segments of each series are transformed in batches with a single fftw plan, and the series 
+  * are distributed over OpenMP threads:
+  \code
+   Eigen::Array<realT,-1,-1> ts = getModalCoefficients(); //One time-series per column
+   
+   Eigen::Array<realT,-1,-1> pgrams;
+   avgPgram(pgrams, ts); //Column n of pgrams is the periodogram of column n of ts
+  \endcode
+  * 
   * \ingroup psds
   */
 template<typename realT>
@@ -109,6 +126,12 @@ protected:
    std::complex<realT> * m_fftWork {nullptr};
    size_t m_fftWorkSize {0};
    
+   typename math::fft::fftwTypeSpec<realT, std::complex<realT>>::planT m_batchPlan {nullptr}; ///< Plan for transforming m_batchSegs segments at once.
+   int m_batchSegs {0}; ///< The number of segments transformed by m_batchPlan.
+   
+   /// Plan the batch transform of nSegs contiguous segments, if not already done.
+   void planBatch( int nSegs /**< [in] the number of segments in each batch*/ );
+   
 public:
    
    /// C'tor which sets up the optimum overlapped periodogram of the timeseries.
@@ -225,6 +248,25 @@ public:
      */ 
    std::vector<realT> operator()(std::vector<realT> & ts /**< [in] the time-series*/ );
    
+   /// Calculate the periodograms of a block of time-series.
+   /** All series have the same length, and are stored contiguously one after the other.  The segments of each
+     * series are transformed in batches, and the series are processed in parallel using OpenMP.  Each periodogram
+     * is normalized to the variance of its series, as for a single time-series.
+     */ 
+   void operator()( realT * pgrams,    ///< [out] a pre-allocated array of size()*nSeries, the periodogram of series n starts at pgrams + n*size()
+                    const realT * ts,  ///< [in] the time-series, series n starts at ts + n*sz
+                    size_t sz,         ///< [in] the length of each time-series
+                    size_t nSeries     ///< [in] the number of time-series
+                  );
+   
+   /// Calculate the periodograms of a block of time-series.
+   /** \overload
+     *
+     */ 
+   void operator()( Eigen::Array<realT, Eigen::Dynamic, Eigen::Dynamic> & pgrams,  ///< [out] resized to size() X ts.cols(), column n is the periodogram of column n of ts
+                    const Eigen::Array<realT, Eigen::Dynamic, Eigen::Dynamic> & ts ///< [in] the time-series, one per column
+                  );
+   
    /// Return the size of the periodogram.
    /** 
      *
@@ -271,6 +313,7 @@ averagePeriodogram<realT>::~averagePeriodogram()
 {
    if(m_tsWork) fftw_free(m_tsWork);
    if(m_fftWork) fftw_free(m_fftWork);
+   if(m_batchPlan) math::fft::fftw_destroy_plan<realT>(m_batchPlan);
 }
 
 template<typename realT>
@@ -323,8 +366,32 @@ int averagePeriodogram<realT>::resize( size_t avgLen,
    
    m_fftWork = math::fft::fftw_malloc<std::complex<realT>>( (m_avgLen/2 + 1) );
    
+   if(m_batchPlan) math::fft::fftw_destroy_plan<realT>(m_batchPlan);
+   m_batchPlan = nullptr;
+   m_batchSegs = 0;
+   
    return 0;
 }
+
+template<typename realT>
+void averagePeriodogram<realT>::planBatch( int nSegs )
+{
+   if(m_batchPlan && m_batchSegs == nSegs) return;
+   
+   if(m_batchPlan) math::fft::fftw_destroy_plan<realT>(m_batchPlan);
+   
+   //Plan with separate memory, same alignment as the working memory used in execution
+   realT * forplan1 = math::fft::fftw_malloc<realT>( nSegs*m_avgLen );
+   std::complex<realT> * forplan2 = math::fft::fftw_malloc<std::complex<realT>>( nSegs*m_size );
+   
+   m_batchPlan = math::fft::fftw_plan_many_dft<realT, std::complex<realT>>( std::vector<int>({(int) m_avgLen}), nSegs, 
+                                                                             forplan1, m_avgLen, forplan2, m_size, 
+                                                                             MXFFT_FORWARD, FFTW_MEASURE );
+   m_batchSegs = nSegs;
+   
+   fftw_free(forplan1);
+   fftw_free(forplan2);
+}
    
 template<typename realT>
 std::vector<realT> & averagePeriodogram<realT>::win()
@@ -424,6 +491,104 @@ std::vector<realT> averagePeriodogram<realT>::operator()(std::vector<realT> & ts
    return pgram;
 }
   
+template<typename realT>
+void averagePeriodogram<realT>::operator()( realT * pgrams,
+                                            const realT * ts,
+                                            size_t sz,
+                                            size_t nSeries
+                                          )
+{
+   if( m_win.size() > 0 && m_win.size() != m_avgLen )
+   {
+      std::cerr << "averagePeriodogram: Window size not correct.\n";
+   }
+
+   int Navg = sz/m_nOver;
+
+   while(Navg*m_nOver + m_avgLen > sz) --Navg;
+
+   if(Navg < 1) Navg = 1; //Always do at least 1!
+
+   int nSegs = std::max<int>(1, MX_AVGPGRAM_BATCHSIZE/m_avgLen);
+   if(nSegs > Navg) nSegs = Navg;
+   
+   //Planning is not thread safe, so it is done here
+   planBatch(nSegs);
+   
+   bool useWin = (m_win.size() == m_avgLen);
+   
+   #pragma omp parallel
+   {
+      realT * tsWork = math::fft::fftw_malloc<realT>( nSegs*m_avgLen );
+      std::complex<realT> * fftWork = math::fft::fftw_malloc<std::complex<realT>>( nSegs*m_size );
+      
+      #pragma omp for schedule(dynamic)
+      for(long s = 0; s < static_cast<long>(nSeries); ++s)
+      {
+         const realT * sts = ts + s*sz;
+         realT * pgram = pgrams + s*m_size;
+         
+         for(size_t j=0;j<m_size;++j) pgram[j] = 0;
+         
+         for(int i0 = 0; i0 < Navg; i0 += nSegs)
+         {
+            //A full batch uses the batch plan, the remainder is done one segment at a time through the first slot
+            int nb = std::min(nSegs, Navg - i0);
+            int nslot = (nb == nSegs) ? nb : 1;
+            
+            for(int b0 = 0; b0 < nb; b0 += nslot)
+            {
+               for(int b = 0; b < nslot; ++b)
+               {
+                  size_t st = (i0 + b0 + b)*m_nOver;
+                  size_t len = std::min(m_avgLen, sz - st); //only less than m_avgLen if sz < m_avgLen
+                  
+                  realT * seg = tsWork + b*m_avgLen;
+                  
+                  if(useWin)
+                  {
+                     for(size_t j=0;j<len;++j) seg[j] = sts[st + j] * m_win[j];
+                  }
+                  else
+                  {
+                     for(size_t j=0;j<len;++j) seg[j] = sts[st + j];
+                  }
+                  
+                  for(size_t j=len;j<m_avgLen;++j) seg[j] = 0;
+               }
+               
+               if(nslot == nSegs) math::fft::fftw_execute_dft<realT, std::complex<realT>>(m_batchPlan, tsWork, fftWork);
+               else m_fft( fftWork, tsWork);
+               
+               for(int b = 0; b < nslot; ++b)
+               {
+                  const std::complex<realT> * ft = fftWork + b*m_size;
+                  for(size_t j=0;j<m_size;++j) pgram[j] += norm(ft[j]);
+               }
+            }
+         }
+         
+         realT pgramVar = psdVar1sided(m_df, pgram, m_size);
+         
+         realT tsVar = mx::math::vectorVariance(sts, sz);
+
+         for(size_t j =0; j< m_size; ++j) pgram[j] *= tsVar/pgramVar; 
+      }
+      
+      fftw_free(tsWork);
+      fftw_free(fftWork);
+   }
+}
+
+template<typename realT>
+void averagePeriodogram<realT>::operator()( Eigen::Array<realT, Eigen::Dynamic, Eigen::Dynamic> & pgrams,
+                                            const Eigen::Array<realT, Eigen::Dynamic, Eigen::Dynamic> & ts
+                                          )
+{
+   pgrams.resize(m_size, ts.cols());
+   operator()( pgrams.data(), ts.data(), ts.rows(), ts.cols());
+}
+
 template<typename realT>
 size_t averagePeriodogram<realT>::size()
 {
@@ -29,99 +29,152 @@
 #ifndef gramSchmidt_hpp
 #define gramSchmidt_hpp
 
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <Eigen/Dense>
+
 namespace mx
 {
    
 namespace sigproc 
 {
-   
+
+namespace impl
+{
+
+///Calculate the triangular factor of the QR decomposition of a basis set, optionally on a window.
+/** Forms the (square-root weighted) basis using only the rows which contribute to the inner products, that is rows with a
+  * non-zero window value, or if no window is given rows with at least one non-zero value.  This is then decomposed with Eigen's
+  * blocked Householder QR, which does most of its work in matrix-matrix products and so uses Eigen's threads.  The signs are
+  * chosen so that the diagonal of R is positive, in which case in * R^-1 is the result of the Gram-Schmidt procedure.
+  *
+  * If there are fewer contributing rows than vectors, the basis is padded with zeros so R is still square, but then it is singular.
+  *
+  * \tparam progress if true, then a progress message is printed
+  * \tparam realT the floating point type of the calculation
+  * \tparam eigenTin is the Eigen array type of the input
+  * \tparam eigenTWin is the Eigen array type of the window
+  */
+template<int progress, typename realT, typename eigenTin, typename eigenTWin>
+void gramSchmidtR( Eigen::Matrix<realT, -1, -1> & R, ///< [out] the upper triangular factor, with positive diagonal
+                   const eigenTin & in,              ///< [in] a basis set, where each column represents one vector.
+                   const eigenTWin * window          ///< [in] the window, or weighting function.  If nullptr, no window is used.
+                 )
+{
+   int nVec = in.cols();
+
+   std::vector<int> rows;
+   rows.reserve(in.rows());
+
+   for(int r=0; r < in.rows(); ++r)
+   {
+      if(window)
+      {
+         if((*window)(r) != 0) rows.push_back(r);
+      }
+      else if( (in.row(r).array() != 0).any() )
+      {
+         rows.push_back(r);
+      }
+   }
+
+   int nRows = rows.size();
+   if(nRows < nVec) nRows = nVec;
+
+   Eigen::Matrix<realT, -1, -1> B(nRows, nVec);
+   B.setZero();
+
+   for(int c=0; c < nVec; ++c)
+   {
+      for(size_t k=0; k < rows.size(); ++k)
+      {
+         if(window) B(k,c) = in(rows[k],c) * sqrt((*window)(rows[k]));
+         else B(k,c) = in(rows[k],c);
+      }
+   }
+
+   if(progress)
+   {
+      std::cout << "QR decomposition of " << nRows << " x " << nVec << "\n";
+   }
+
+   //Decompose in place, so B is not copied.
+   Eigen::HouseholderQR<Eigen::Ref<Eigen::Matrix<realT, -1, -1>>> qr(B);
+
+   R = qr.matrixQR().topRows(nVec).template triangularView<Eigen::Upper>();
+
+   for(int i=0; i < nVec; ++i)
+   {
+      if(R(i,i) < 0) R.row(i) *= -1;
+   }
+}
+
+} //namespace impl
+
 ///Perform Gram-Schmidt ortogonalization of a basis set, and normalize the result.
-/** Performs the stabilized Gram-Schmidt procedure on the input basis set, followed
-  * by normalization of the result.
+/** Produces the same basis set as the stabilized Gram-Schmidt procedure, followed
+  * by normalization of the result.  This is calculated as in * R^-1 where R is the triangular factor of a blocked Householder
+  * QR decomposition, which is much faster for large basis sets.  As with Gram-Schmidt, the loss of orthogonality grows with
+  * the condition number of the input.  See impl::gramSchmidtR.
   *
   * \param out [out] is the orthonormal basis set constructed from the input
   * \param int [in] is a basis set, where each column represents one vector.
   * 
-  * \tparam progress if true, then the loop index is printed for progress reporting
+  * \tparam progress if true, then progress messages are printed
   * \tparam eigenTout is the Eigen array type of the desired output
   * \tparam eigenTin is the Eigen array type of the input
   * 
   * \ingroup signal_processing 
+  *
+  * \test Verify orthogonalization of a basis set \ref tests_sigproc_gramSchmidt "[test doc]"
   */ 
 template<int progress=0, typename eigenTout, typename eigenTin>
 void gramSchmidt(eigenTout & out, const eigenTin & in)
 {
-   out.resize(in.rows(), in.cols());
+   typedef typename eigenTin::Scalar realT;
 
-   out.col(0) = in.col(0);
-   
-   for(int i=1;i< in.cols(); ++i)
-   {
-      if(progress)
-      {
-         std::cout << i+1 << "/" << in.cols() << "\n";
-      }
-      
-      //out.col(i) = in.col(i);
-      
-      out.col(i) = in.col(i) - ((in.col(i).matrix().dot(out.col(0).matrix())) / (out.col(0).matrix().dot(out.col(0).matrix())) )* out.col(0);
+   Eigen::Matrix<realT, -1, -1> R;
+   impl::gramSchmidtR<progress, realT>(R, in, static_cast<const eigenTin *>(nullptr));
 
-      for(int j=1;j<i; ++j)
-      {       
-         out.col(i) = out.col(i) - ((out.col(i).matrix().dot(out.col(j).matrix()))/(out.col(j).matrix().dot(out.col(j).matrix())))* out.col(j);
-      }
-   }
-   
-   for(int i=0; i<out.cols(); ++i)
-   {
-      out.col(i) = out.col(i)/ out.col(i).matrix().norm();
-   }
+   out.resize(in.rows(), in.cols());
+   out = in;
+
+   R.template triangularView<Eigen::Upper>().template solveInPlace<Eigen::OnTheRight>(out.matrix());
 }
 
 
 ///Perform Gram-Schmidt ortogonalization of a basis set on a window, and normalize the result.
-/** Performs the stabilized Gram-Schmidt procedure on the input basis set over a window (or
-  * weight function), followed by normalization of the result.
+/** Produces the same basis set as the stabilized Gram-Schmidt procedure over a window (or
+  * weight function), followed by normalization of the result.  This is calculated as in * R^-1 where R is the triangular factor
+  * of a blocked Householder QR decomposition of the basis weighted by the square root of the window.  See impl::gramSchmidtR.
+  * Only the pixels where the window is non-zero are used in the decomposition, but the output is defined everywhere.
   *
-  * \param out [out] is the orthonormal basis set constructed from the input
+  * \param out [out] is the orthonormal basis set constructed from the input, must be the same size as in.
   * \param in [in] is a basis set, where each column represents one vector.
   * \param window [in] is the window, or weighting function
   * 
-  * \tparam progress if true, then the loop index is printed for progress reporting
+  * \tparam progress if true, then progress messages are printed
   * \tparam eigenTout is the Eigen array type of the desired output
   * \tparam eigenTin is the Eigen array type of the input
   * \tparam eigenTWin is the Eigen array type of the window
   * 
   * \ingroup signal_processing 
+  *
+  * \test Verify orthogonalization of a basis set \ref tests_sigproc_gramSchmidt "[test doc]"
   */ 
 template<int progress=0, typename eigenTout, typename eigenTin, typename eigenTWin>
 void gramSchmidt(eigenTout & out, const eigenTin & in, const eigenTWin & window)
 {
-   //out.resize(in.rows(), in.cols());
+   typedef typename eigenTin::Scalar realT;
 
-   out.col(0) = in.col(0);
-   
-   for(int i=1;i< in.cols(); ++i)
-   {
-      if(progress)
-      {
-         std::cout << i+1 << "/" << in.cols() << "\n";
-      }
-      
-      //out.col(i) = in.col(i);
-      
-      out.col(i) = in.col(i) - (((in.col(i)*window).matrix().dot(out.col(0).matrix())) / ( (out.col(0)*window).matrix().dot(out.col(0).matrix())) )* out.col(0);
+   Eigen::Matrix<realT, -1, -1> R;
+   impl::gramSchmidtR<progress, realT>(R, in, &window);
 
-      for(int j=1;j<i; ++j)
-      {       
-         out.col(i) = out.col(i) - ((  (out.col(i)*window).matrix().dot(out.col(j).matrix()))/((out.col(j)*window).matrix().dot(out.col(j).matrix())))* out.col(j);
-      }
-   }
-   
-   for(int i=0; i<out.cols(); ++i)
-   {
-      out.col(i) = out.col(i)/ (out.col(i)*window.sqrt()).matrix().norm();
-   }
+   out = in;
+
+   R.template triangularView<Eigen::Upper>().template solveInPlace<Eigen::OnTheRight>(out.matrix());
 }
 
 
@@ -147,17 +200,20 @@ void baseSpectrum(eigenT & bspect, eigenT & gsspect)
 }
 
 ///Perform Gram-Schmidt ortogonalization of a basis set, and normalize the result, while recording the spectrum.
-/** Performs the stabilized Gram-Schmidt procedure on the input basis set, followed
+/** Produces the same basis set as the stabilized Gram-Schmidt procedure on the input basis set, followed
   * by normalization of the result.  Also records the spectrum, that is the coefficients of the linear expansion
-  * in the orginal basis set for the resultant basis set.
+  * in the orginal basis set for the resultant basis set, before normalization.  This is calculated from the
+  * triangular factor of a blocked Householder QR decomposition, see impl::gramSchmidtR.
   *
   * 
-  * \tparam progress if true, then the loop index is printed for progress reporting
+  * \tparam progress if true, then progress messages are printed
   * \tparam eigenTout is the Eigen array type of the output orthogonalized array
   * \tparam eigenTout2 is the Eigen array type of the spectrum
   * \tparam eigenTin is the Eigen array type of the input
   * 
   * \ingroup signal_processing 
+  *
+  * \test Verify orthogonalization of a basis set \ref tests_sigproc_gramSchmidt "[test doc]"
   */ 
 template<int progress=0, typename eigenTout, typename eigenTout2, typename eigenTin>
 void gramSchmidtSpectrum( eigenTout & out,                        ///< [out] the orthonormal basis set constructed from the input
@@ -166,48 +222,31 @@ void gramSchmidtSpectrum( eigenTout & out,                        ///< [out] the
                           typename eigenTin::Scalar normPix = 1.0 ///< [in] [optional] area of (usually number of pixels in) the orthogonal region for normalization.
                         )
 {
-   typedef typename eigenTout::Scalar Scalar;
-   
+   typedef typename eigenTin::Scalar realT;
+   typedef typename eigenTout2::Scalar spectRealT;
+
+   Eigen::Matrix<realT, -1, -1> R;
+   impl::gramSchmidtR<progress, realT>(R, in, static_cast<const eigenTin *>(nullptr));
+
+   //The un-normalized Gram-Schmidt vectors are in * R^-1 * D, where D is the diagonal of R.
+   //So the spectrum, which gives them in terms of the original basis, is (R^-1 * D)^T
+   Eigen::Matrix<realT, -1, -1> RinvD = R.diagonal().asDiagonal();
+   R.template triangularView<Eigen::Upper>().solveInPlace(RinvD);
+
+   spect = RinvD.transpose().array().template cast<spectRealT>();
+
    out.resize(in.rows(), in.cols());
-   
-   eigenTout2 gsspect;
-   
-   gsspect.resize(in.cols(), in.cols());
-   gsspect.setZero();
-   
-   out.col(0) = in.col(0);
-   gsspect(0,0) = 1;
-   
-   for(int i=1;i< in.cols(); ++i)
-   {
-      if(progress)
-      {
-         std::cout << i+1 << "/" << in.cols() << "\n";
-      }
-      
-      gsspect(i,i)=1;
-      
-      gsspect(i,0) = ((in.col(i).matrix().dot(out.col(0).matrix())) / (out.col(0).matrix().dot(out.col(0).matrix())) );
-      out.col(i) = in.col(i) - gsspect(i,0) * out.col(0);
+   out = in;
 
-      for(int j=1;j<i; ++j)
-      {       
-         gsspect(i,j) = ((out.col(i).matrix().dot(out.col(j).matrix()))/(out.col(j).matrix().dot(out.col(j).matrix())));
-         out.col(i) = out.col(i) - gsspect(i,j)* out.col(j);
-      }
-   }
-   
-   //Here we unwrap the gram schmidt coefficients, giving us the coefficients in the original basis
-   baseSpectrum(spect, gsspect);
-   
-   Scalar norm;
+   R.template triangularView<Eigen::Upper>().template solveInPlace<Eigen::OnTheRight>(out.matrix());
+
+   realT norm;
       
    for(int i=0; i<out.cols(); ++i)
    {
       norm = sqrt(out.col(i).square().sum() / normPix);
       
       out.col(i) /= norm;
-      //spect.row(i) /= norm;
    }
 }
 
@@ -28,9 +28,14 @@
 #define psdFilter_hpp
 
 #include <vector>
+#include <algorithm>
 #include <complex>
+#include <cstdint>
+#include <cstring>
 #include <Eigen/Dense>
 
+#include <omp.h>
+
 #include "../mxError.hpp"
 #include "../math/fft/fft.hpp"
 #include "../improc/eigenCube.hpp"
@@ -123,7 +128,18 @@ class psdFilter;
   * PSD Requirements: 
   * - the PSD must be in FFT storage order form.  That means including negative frequencies reversed from the end of the array.
   * - the PSD used for this needs to be normalized properly, \ref psds "according to the mxlib standard", to produce filtered noise with the correct statistics.  
+  * - the PSD must be symmetric, i.e. have the same value at each frequency and its negative, as any PSD of a real process does.
   * 
+  * A single real noise field is filtered with real-to-complex and complex-to-real transforms, which only store and process the
+  * Hermitian half of the spectrum.  If a second noise field is passed to filter(), the two are packed as the real and imaginary parts
+  * of a complex field and filtered with one pair of complex transforms, producing two independent realizations for about the cost of one.
+  * The complex transforms are only planned the first time they are used.
+  *
+  * For rank 2 and 3, setting \ref threads() to more than 1 splits the transforms into slabs along the slowest dimension
+  * (columns of a screen, planes of a cube) which are transformed in parallel, followed by parallel 1D transforms along that
+  * dimension, during which the filter is applied.  Paired realizations are then filtered one after the other through the Hermitian
+  * half of the spectrum.  The same is done for any rank if \ref lowMemory() is set, in which case the full complex working array
+  * is never allocated.
   *
   * Array type varies based on rank. 
   * - For rank==1, the array type is std::vector<realT>
@@ -168,10 +184,25 @@ protected:
    realArrayT * m_psdSqrt {nullptr}; ///< Pointer to the real array containing the square root of the PSD.
    bool m_owner {false}; ///< Flag indicates whether or not m_psdSqrt was allocated by this instance, and so must be deallocated.
 
-   mutable complexArrayT m_ftWork;   ///< Working memory for the FFT.  Declared mutable so it can be accessed in the const filter method.
+   mutable complexArrayT m_ftHalf;   ///< Working memory for the real FFT, holding the Hermitian half of the spectrum.  Declared mutable so it can be accessed in the const filter method.
+
+   mutable complexArrayT m_ftWork;   ///< Working memory for the complex FFT used for paired realizations.  Declared mutable so it can be accessed in the const filter method.
    
-   math::fft::fftT< complexT, complexT,rank,0> m_fft_fwd; ///< FFT object for the forward transform.
-   math::fft::fftT< complexT, complexT,rank,0> m_fft_back; ///< FFT object for the backward transfsorm.
+   math::fft::fftT< realT, complexT,rank,0> m_fft_r2c; ///< FFT object for the real-to-complex forward transform.
+   math::fft::fftT< complexT, realT,rank,0> m_fft_c2r; ///< FFT object for the complex-to-real backward transform.
+
+   mutable math::fft::fftT< complexT, complexT,rank,0> m_fft_fwd; ///< FFT object for the forward transform of paired realizations.  Planned on first use.
+   mutable math::fft::fftT< complexT, complexT,rank,0> m_fft_back; ///< FFT object for the backward transfsorm of paired realizations.  Planned on first use.
+
+   int m_threads {1}; ///< The number of threads to use for rank 2 and 3.  If greater than 1 the transforms are split into slabs.
+
+   bool m_lowMemory {false}; ///< If true, paired realizations are filtered one at a time so m_ftWork is not needed.
+
+   mutable math::fft::fftT< realT, complexT, (rank > 1 ? rank-1 : 1), 0> m_slab_r2c; ///< FFT object for the real-to-complex transform of one slab.  Planned on first use.
+   mutable math::fft::fftT< complexT, realT, (rank > 1 ? rank-1 : 1), 0> m_slab_c2r; ///< FFT object for the complex-to-real transform of one slab.  Planned on first use.
+
+   mutable math::fft::fftT< complexT, complexT, 1, 0> m_pencil_fwd; ///< FFT object for the forward transform along the slab dimension.  Planned on first use.
+   mutable math::fft::fftT< complexT, complexT, 1, 0> m_pencil_back; ///< FFT object for the backward transform along the slab dimension.  Planned on first use.
    
 public:
    
@@ -250,6 +281,62 @@ protected:
    template<size_t crank=rank>
    int setSize(typename std::enable_if<crank==3>::type* = 0 );
    
+   ///Allocate m_ftWork and plan the complex transforms used for paired realizations.
+   /** Does nothing if already done for the current size.  This version compiles when rank==1
+     */
+   template<size_t crank=rank>
+   void planPaired(typename std::enable_if<crank==1>::type* = 0 ) const;
+
+   ///Allocate m_ftWork and plan the complex transforms used for paired realizations.
+   /** Does nothing if already done for the current size.  This version compiles when rank==2
+     */
+   template<size_t crank=rank>
+   void planPaired(typename std::enable_if<crank==2>::type* = 0 ) const;
+
+   ///Allocate m_ftWork and plan the complex transforms used for paired realizations.
+   /** Does nothing if already done for the current size.  This version compiles when rank==3
+     */
+   template<size_t crank=rank>
+   void planPaired(typename std::enable_if<crank==3>::type* = 0 ) const;
+
+   ///Plan the transforms used to filter in slabs.
+   /** Does nothing if already done for the current size.  This version compiles when rank==2
+     */
+   template<size_t crank=rank>
+   void planSlabs(typename std::enable_if<crank==2>::type* = 0 ) const;
+
+   ///Plan the transforms used to filter in slabs.
+   /** Does nothing if already done for the current size.  This version compiles when rank==3
+     */
+   template<size_t crank=rank>
+   void planSlabs(typename std::enable_if<crank==3>::type* = 0 ) const;
+
+   ///Filter a single noise field in slabs, using m_threads threads.
+   /** The real-to-complex transform of each slab (a column for rank 2, a plane for rank 3) is followed by 1D transforms
+     * along the slab dimension, which are done a few at a time so that reads and writes of m_ftHalf are contiguous.
+     *
+     * This version compiles when rank is 2 or 3.
+     *
+     * \returns 0 on success
+     */
+   template<size_t crank=rank>
+   int filterSlabs( realT * noise, ///< [in/out] the noise field, filtered in-place.
+                    realT norm,    ///< [in] the normalization to divide by
+                    typename std::enable_if<(crank > 1)>::type* = 0
+                  ) const;
+
+   ///Transform real noise to the Hermitian half of the Fourier domain, in m_ftHalf.
+   /** The plans were made with fftw_malloc-ed memory, so if noise is not aligned the same way it is copied through an
+     * aligned buffer.
+     */
+   void forwardHalf( realT * noise /**< [in] the noise field, m_rows x m_cols x m_planes */) const;
+
+   ///Transform the Hermitian half of the Fourier domain, in m_ftHalf, back to real noise.
+   /** The plans were made with fftw_malloc-ed memory, so if noise is not aligned the same way the result goes through
+     * an aligned buffer.
+     */
+   void backwardHalf( realT * noise /**< [out] the noise field, m_rows x m_cols x m_planes */) const;
+
 public:   
 
    ///Get the number of rows in the filter
@@ -275,6 +362,33 @@ public:
      * \test Verify compilation and initialization of the 3 ranks for psdFilter. \ref tests_sigproc_psdFilter_compile "[test doc]" 
      */
    int planes();
+
+   ///Set the number of threads used for filtering.
+   /** Only affects rank 2 and 3.  If greater than 1, the transforms are split into slabs which are processed in parallel.
+     *
+     * \test Verify filtering in slabs. \ref tests_sigproc_psdFilter_threads "[test doc]"
+     */
+   void threads( int nTh /**< [in] the number of threads.  If less than 1, omp_get_max_threads() is used. */);
+
+   ///Get the number of threads used for filtering.
+   /**
+     * \returns the current value of m_threads.
+     */
+   int threads();
+
+   ///Set whether paired realizations are filtered one at a time.
+   /** If true, the full complex working array used for paired realizations is de-allocated and never used.  This roughly
+     * halves the working memory at the cost of an extra pair of transforms.
+     *
+     * \test Verify filtering in slabs. \ref tests_sigproc_psdFilter_threads "[test doc]"
+     */
+   void lowMemory( bool lm /**< [in] the new value of the flag */);
+
+   ///Get whether paired realizations are filtered one at a time.
+   /**
+     * \returns the current value of m_lowMemory.
+     */
+   bool lowMemory();
    
    ///Set the sqaure-root of the PSD to be a pointer to an array containing the square root of the properly normalized PSD.
    /** This does not allocate _npsdSqrt, it merely points to the specified array, which remains your responsibility for deallocation, etc.
@@ -466,7 +580,7 @@ public:
      */ 
    template<size_t crank=rank>
    int filter( realArrayT & noise,             ///< [in/out] the noise field of size rows() X cols(), which is filtered in-place. 
-               realArrayT * noiseIm = nullptr, ///< [out] [optional] an array to fill with the imaginary output of the filter, allowing 2-for-1 calculation.
+               realArrayT * noiseIm = nullptr, ///< [in/out] [optional] a second noise field, filtered in-place along with noise as an independent realization.
                typename std::enable_if<crank==1>::type* = 0
              ) const;
    
@@ -481,7 +595,7 @@ public:
      */ 
    template<size_t crank=rank>
    int filter( realArrayT & noise,             ///< [in/out] the noise field of size rows() X cols(), which is filtered in-place. 
-               realArrayT * noiseIm = nullptr, ///< [out] [optional] an array to fill with the imaginary output of the filter, allowing 2-for-1 calculation.
+               realArrayT * noiseIm = nullptr, ///< [in/out] [optional] a second noise field, filtered in-place along with noise as an independent realization.
                typename std::enable_if<crank==2>::type* = 0
              ) const;
              
@@ -495,7 +609,7 @@ public:
      */ 
    template<size_t crank=rank>
    int filter( realArrayMapT  noise,             ///< [in/out] the noise field of size rows() X cols(), which is filtered in-place. 
-               realArrayT * noiseIm = nullptr, ///< [out] [optional] an array to fill with the imaginary output of the filter, allowing 2-for-1 calculation.
+               realArrayT * noiseIm = nullptr, ///< [in/out] [optional] a second noise field, filtered in-place along with noise as an independent realization.
                typename std::enable_if<crank==2>::type* = 0
              ) const;
 
@@ -510,7 +624,7 @@ public:
      */ 
    template<size_t crank=rank>
    int filter( realArrayT & noise,             ///< [in/out] the noise field of size rows() X cols(), which is filtered in-place. 
-               realArrayT * noiseIm = nullptr, ///< [out] [optional] an array to fill with the imaginary output of the filter, allowing 2-for-1 calculation.
+               realArrayT * noiseIm = nullptr, ///< [in/out] [optional] a second noise field, filtered in-place along with noise as an independent realization.
                typename std::enable_if<crank==3>::type* = 0
              ) const;
              
@@ -542,7 +656,7 @@ public:
      * \test Verify filtering and noise normalization. \ref tests_sigproc_psdFilter_filter "[test doc]" 
      */ 
    int operator()( realArrayT & noise,  ///< [in/out] the noise field of size rows() X cols(), which is filtered in-place. 
-                   realArrayT & noiseIm ///< [out] [optional] an array to fill with the imaginary output of the filter, allowing 2-for-1 calculation.
+                   realArrayT & noiseIm ///< [in/out] a second noise field, filtered in-place along with noise as an independent realization.
                  ) const; 
 };
 
@@ -613,11 +727,11 @@ int psdFilter<realT,rank>::setSize(typename std::enable_if<crank==1>::type* )
    m_cols = 1;
    m_planes = 1;
    
-   m_ftWork.resize(m_rows);
+   m_ftHalf.resize(m_rows/2 + 1);
 
-   m_fft_fwd.plan(m_rows, MXFFT_FORWARD, true);
+   m_fft_r2c.plan(m_rows, MXFFT_FORWARD, false);
       
-   m_fft_back.plan(m_rows, MXFFT_BACKWARD, true);      
+   m_fft_c2r.plan(m_rows, MXFFT_BACKWARD, false);      
 
    return 0;
 }
@@ -641,11 +755,12 @@ int psdFilter<realT,rank>::setSize(typename std::enable_if<crank==2>::type* )
    m_cols = m_psdSqrt->cols();
    m_planes = 1;
    
-   m_ftWork.resize(m_rows, m_cols);
+   m_ftHalf.resize(m_rows/2 + 1, m_cols);
 
-   m_fft_fwd.plan(m_rows, m_cols, MXFFT_FORWARD, true);
+   //fftw is row-major, eigen defaults to column-major
+   m_fft_r2c.plan(m_cols, m_rows, MXFFT_FORWARD, false);
       
-   m_fft_back.plan(m_rows, m_cols, MXFFT_BACKWARD, true);      
+   m_fft_c2r.plan(m_cols, m_rows, MXFFT_BACKWARD, false);      
 
    return 0;
 }
@@ -669,15 +784,227 @@ int psdFilter<realT,rank>::setSize(typename std::enable_if<crank==3>::type* )
    m_cols = m_psdSqrt->cols();
    m_planes = m_psdSqrt->planes();
    
+   m_ftHalf.resize(m_rows/2 + 1, m_cols, m_planes);
+
+   //fftw is row-major, eigen defaults to column-major
+   m_fft_r2c.plan(m_planes, m_cols, m_rows, MXFFT_FORWARD, false);
+      
+   m_fft_c2r.plan(m_planes, m_cols, m_rows, MXFFT_BACKWARD, false);      
+
+   return 0;
+}
+
+template<typename realT, size_t rank>
+template<size_t crank>
+void psdFilter<realT,rank>::planPaired(typename std::enable_if<crank==1>::type* ) const
+{
+   m_ftWork.resize(m_rows);
+
+   m_fft_fwd.plan(m_rows, MXFFT_FORWARD, true);
+      
+   m_fft_back.plan(m_rows, MXFFT_BACKWARD, true);
+}
+
+template<typename realT, size_t rank>
+template<size_t crank>
+void psdFilter<realT,rank>::planPaired(typename std::enable_if<crank==2>::type* ) const
+{
+   m_ftWork.resize(m_rows, m_cols);
+
+   m_fft_fwd.plan(m_cols, m_rows, MXFFT_FORWARD, true);
+      
+   m_fft_back.plan(m_cols, m_rows, MXFFT_BACKWARD, true);
+}
+
+template<typename realT, size_t rank>
+template<size_t crank>
+void psdFilter<realT,rank>::planPaired(typename std::enable_if<crank==3>::type* ) const
+{
    m_ftWork.resize(m_rows, m_cols, m_planes);
 
-   m_fft_fwd.plan(m_planes, m_rows, m_cols, MXFFT_FORWARD, true);
+   m_fft_fwd.plan(m_planes, m_cols, m_rows, MXFFT_FORWARD, true);
       
-   m_fft_back.plan(m_planes, m_rows, m_cols, MXFFT_BACKWARD, true);      
+   m_fft_back.plan(m_planes, m_cols, m_rows, MXFFT_BACKWARD, true);
+}
+
+template<typename realT, size_t rank>
+template<size_t crank>
+void psdFilter<realT,rank>::planSlabs(typename std::enable_if<crank==2>::type* ) const
+{
+   m_slab_r2c.plan(m_rows, MXFFT_FORWARD, false);
+
+   m_slab_c2r.plan(m_rows, MXFFT_BACKWARD, false);
+
+   m_pencil_fwd.plan(m_cols, MXFFT_FORWARD, true);
+
+   m_pencil_back.plan(m_cols, MXFFT_BACKWARD, true);
+}
+
+template<typename realT, size_t rank>
+template<size_t crank>
+void psdFilter<realT,rank>::planSlabs(typename std::enable_if<crank==3>::type* ) const
+{
+   //fftw is row-major, eigen defaults to column-major
+   m_slab_r2c.plan(m_cols, m_rows, MXFFT_FORWARD, false);
+
+   m_slab_c2r.plan(m_cols, m_rows, MXFFT_BACKWARD, false);
+
+   m_pencil_fwd.plan(m_planes, MXFFT_FORWARD, true);
+
+   m_pencil_back.plan(m_planes, MXFFT_BACKWARD, true);
+}
+
+template<typename realT, size_t rank>
+template<size_t crank>
+int psdFilter<realT,rank>::filterSlabs( realT * noise,
+                                        realT norm,
+                                        typename std::enable_if<(crank > 1)>::type*
+                                      ) const
+{
+   planSlabs();
+
+   //Number of 1D transforms along the slab dimension done together.
+   static constexpr int pencilBlock = 8;
+
+   const int nSlabs = (rank == 2) ? m_cols : m_planes;
+   const int slabSz = (rank == 2) ? m_rows : m_rows*m_cols;
+   const int halfRows = m_rows/2 + 1;
+   const int halfSz = (rank == 2) ? halfRows : halfRows*m_cols;
+   const int nBlocks = (halfSz + pencilBlock - 1)/pencilBlock;
+
+   //Each pencil starts on a 64 byte boundary, so that all are aligned the same way as the fftw_malloc-ed plan memory.
+   const int pencilStride = ((nSlabs*sizeof(complexT) + 63)/64)*64/sizeof(complexT);
+
+   complexT * ftHalf = m_ftHalf.data();
+   const realT * psdSqrt = m_psdSqrt->data();
+
+   //The plans were made with fftw_malloc-ed memory, so slabs which aren't aligned the same way go through a buffer.
+   auto aligned = [](const auto * ptr){ return math::fft::fftw_alignment_of(ptr) == 0; };
+
+   #pragma omp parallel num_threads(m_threads)
+   {
+      realT * slabBuf = math::fft::fftw_malloc<realT>(slabSz);
+      complexT * halfBuf = math::fft::fftw_malloc<complexT>(halfSz);
+      complexT * pencils = math::fft::fftw_malloc<complexT>(pencilBlock*pencilStride);
+
+      #pragma omp for
+      for(int s = 0; s < nSlabs; ++s)
+      {
+         realT * in = noise + static_cast<size_t>(s)*slabSz;
+         complexT * out = ftHalf + static_cast<size_t>(s)*halfSz;
+
+         if(aligned(in) && aligned(out))
+         {
+            m_slab_r2c(out, in);
+         }
+         else
+         {
+            memcpy(slabBuf, in, slabSz*sizeof(realT));
+            m_slab_r2c(halfBuf, slabBuf);
+            memcpy(out, halfBuf, halfSz*sizeof(complexT));
+         }
+      }
+
+      #pragma omp for
+      for(int b = 0; b < nBlocks; ++b)
+      {
+         int h0 = b*pencilBlock;
+         int nh = std::min(pencilBlock, halfSz - h0);
+
+         for(int s = 0; s < nSlabs; ++s)
+         {
+            const complexT * src = ftHalf + static_cast<size_t>(s)*halfSz + h0;
+            for(int k = 0; k < nh; ++k) pencils[k*pencilStride + s] = src[k];
+         }
+
+         for(int k = 0; k < nh; ++k)
+         {
+            complexT * pencil = pencils + k*pencilStride;
+
+            m_pencil_fwd(pencil, pencil);
+
+            //Position of this pixel of the half spectrum in the full PSD
+            int h = h0 + k;
+            size_t p0 = (h % halfRows) + static_cast<size_t>(h / halfRows)*m_rows;
+
+            for(int s = 0; s < nSlabs; ++s) pencil[s] *= psdSqrt[p0 + static_cast<size_t>(s)*slabSz];
+
+            m_pencil_back(pencil, pencil);
+         }
+
+         for(int s = 0; s < nSlabs; ++s)
+         {
+            complexT * dest = ftHalf + static_cast<size_t>(s)*halfSz + h0;
+            for(int k = 0; k < nh; ++k) dest[k] = pencils[k*pencilStride + s];
+         }
+      }
+
+      #pragma omp for
+      for(int s = 0; s < nSlabs; ++s)
+      {
+         complexT * in = ftHalf + static_cast<size_t>(s)*halfSz;
+         realT * out = noise + static_cast<size_t>(s)*slabSz;
+
+         if(aligned(in) && aligned(out))
+         {
+            m_slab_c2r(out, in);
+         }
+         else
+         {
+            memcpy(halfBuf, in, halfSz*sizeof(complexT));
+            m_slab_c2r(slabBuf, halfBuf);
+            memcpy(out, slabBuf, slabSz*sizeof(realT));
+         }
+
+         for(int n = 0; n < slabSz; ++n) out[n] /= norm;
+      }
+
+      math::fft::fftw_free<realT>(slabBuf);
+      math::fft::fftw_free<complexT>(halfBuf);
+      math::fft::fftw_free<complexT>(pencils);
+   }
 
    return 0;
 }
 
+template<typename realT, size_t rank>
+void psdFilter<realT,rank>::forwardHalf( realT * noise ) const
+{
+   if(math::fft::fftw_alignment_of(noise) == 0)
+   {
+      m_fft_r2c(m_ftHalf.data(), noise);
+      return;
+   }
+
+   size_t sz = static_cast<size_t>(m_rows)*m_cols*m_planes;
+
+   realT * buf = math::fft::fftw_malloc<realT>(sz);
+   memcpy(buf, noise, sz*sizeof(realT));
+
+   m_fft_r2c(m_ftHalf.data(), buf);
+
+   math::fft::fftw_free<realT>(buf);
+}
+
+template<typename realT, size_t rank>
+void psdFilter<realT,rank>::backwardHalf( realT * noise ) const
+{
+   if(math::fft::fftw_alignment_of(noise) == 0)
+   {
+      m_fft_c2r(noise, m_ftHalf.data());
+      return;
+   }
+
+   size_t sz = static_cast<size_t>(m_rows)*m_cols*m_planes;
+
+   realT * buf = math::fft::fftw_malloc<realT>(sz);
+
+   m_fft_c2r(buf, m_ftHalf.data());
+
+   memcpy(noise, buf, sz*sizeof(realT));
+   math::fft::fftw_free<realT>(buf);
+}
+
 template<typename realT, size_t rank>
 int psdFilter<realT,rank>::rows()
 {
@@ -696,6 +1023,37 @@ int psdFilter<realT,rank>::planes()
    return m_planes;
 }
 
+template<typename realT, size_t rank>
+void psdFilter<realT,rank>::threads( int nTh )
+{
+   if(nTh < 1) nTh = omp_get_max_threads();
+
+   m_threads = nTh;
+}
+
+template<typename realT, size_t rank>
+int psdFilter<realT,rank>::threads()
+{
+   return m_threads;
+}
+
+template<typename realT, size_t rank>
+void psdFilter<realT,rank>::lowMemory( bool lm )
+{
+   m_lowMemory = lm;
+
+   if(m_lowMemory)
+   {
+      psdFilterTypes::arrayT<realT,rank>::clear(m_ftWork);
+   }
+}
+
+template<typename realT, size_t rank>
+bool psdFilter<realT,rank>::lowMemory()
+{
+   return m_lowMemory;
+}
+
 template<typename realT, size_t rank>
 template<size_t crank>
 int psdFilter<realT,rank>::psdSqrt( realArrayT * npsdSqrt,
@@ -870,7 +1228,7 @@ int psdFilter<realT,rank>::psd( const realArrayT & npsd,
 template<typename realT, size_t rank>
 void psdFilter<realT,rank>::clear()
 {
-   //m_ftWork.resize(0,0);
+   psdFilterTypes::arrayT<realT,rank>::clear(m_ftHalf);
    psdFilterTypes::arrayT<realT,rank>::clear(m_ftWork);
    
    m_rows = 0;
@@ -891,7 +1249,34 @@ int psdFilter<realT,rank>::filter( realArrayT & noise,
                                    typename std::enable_if<crank==1>::type*
                                  ) const
 {
-   for(unsigned int nn=0; nn< noise.size(); ++nn) m_ftWork[nn] = complexT(noise[nn],0);
+   realT norm = sqrt(noise.size()/m_dFreq1);
+   
+   if(noiseIm != nullptr && m_lowMemory)
+   {
+      filter(noise);
+      return filter(*noiseIm);
+   }
+
+   if(noiseIm == nullptr)
+   {
+      //Transform real noise to the Hermitian half of the Fourier domain.
+      forwardHalf(noise.data());
+   
+      //Apply the filter.
+      for(unsigned int nn=0;nn<m_ftHalf.size();++nn) m_ftHalf[nn] *= (*m_psdSqrt)[nn];
+        
+      backwardHalf(noise.data());
+   
+      //Normalize.
+      for(unsigned int nn=0;nn<noise.size();++nn) noise[nn] /= norm;
+   
+      return 0;
+   }
+   
+   planPaired();
+   
+   //Pack the two realizations as a complex number
+   for(unsigned int nn=0; nn< noise.size(); ++nn) m_ftWork[nn] = complexT(noise[nn],(*noiseIm)[nn]);
    
    //Transform complex noise to Fourier domain.
    m_fft_fwd(m_ftWork.data(), m_ftWork.data() );
@@ -901,13 +1286,11 @@ int psdFilter<realT,rank>::filter( realArrayT & noise,
         
    m_fft_back(m_ftWork.data(), m_ftWork.data());
    
-   //Now take the real part, and normalize.
-   realT norm = sqrt(noise.size()/m_dFreq1);
-   for(unsigned int nn=0;nn<m_ftWork.size();++nn) noise[nn] = m_ftWork[nn].real()/norm;
-   
-   if(noiseIm != nullptr)
+   //Now unpack, and normalize.
+   for(unsigned int nn=0;nn<m_ftWork.size();++nn) 
    {
-      for(unsigned int nn=0;nn<m_ftWork.size();++nn) (*noiseIm)[nn] = m_ftWork[nn].imag()/norm;
+      noise[nn] = m_ftWork[nn].real()/norm;
+      (*noiseIm)[nn] = m_ftWork[nn].imag()/norm;
    }
    
    return 0;
@@ -920,34 +1303,7 @@ int psdFilter<realT,rank>::filter( realArrayT & noise,
                                    typename std::enable_if<crank==2>::type*
                                  ) const
 {
-   //Make noise a complex number
-   for(int ii=0;ii<noise.rows();++ii)
-   {
-      for(int jj=0; jj<noise.cols(); ++jj)
-      {
-         m_ftWork(ii,jj) = complexT(noise(ii,jj),0);
-      }
-   }
-   
-   //Transform complex noise to Fourier domain.
-   m_fft_fwd(m_ftWork.data(), m_ftWork.data() );
-   
-   //Apply the filter.
-   m_ftWork *= *m_psdSqrt;
-        
-   m_fft_back(m_ftWork.data(), m_ftWork.data());
-   
-   realT norm = sqrt(noise.rows()*noise.cols()/(m_dFreq1*m_dFreq2));
-   
-   //Now take the real part, and normalize.
-   noise = m_ftWork.real()/norm;
-   
-   if(noiseIm != nullptr)
-   {
-      *noiseIm = m_ftWork.imag()/norm;
-   }
-   
-   return 0;
+   return filter(realArrayMapT(noise.data(), noise.rows(), noise.cols()), noiseIm);
 }
 
 template<typename realT, size_t rank>
@@ -957,12 +1313,40 @@ int psdFilter<realT,rank>::filter( realArrayMapT  noise,
                                    typename std::enable_if<crank==2>::type*
                                  ) const
 {
-   //Make noise a complex number
-   for(int ii=0;ii<noise.rows();++ii)
+   realT norm = sqrt(noise.rows()*noise.cols()/(m_dFreq1*m_dFreq2));
+   
+   if(noiseIm != nullptr && (m_lowMemory || m_threads > 1))
    {
-      for(int jj=0; jj<noise.cols(); ++jj)
+      filter(noise);
+      return filter(*noiseIm);
+   }
+
+   if(noiseIm == nullptr)
+   {
+      if(m_threads > 1) return filterSlabs(noise.data(), norm);
+
+      //Transform real noise to the Hermitian half of the Fourier domain.
+      forwardHalf(noise.data());
+   
+      //Apply the filter.
+      m_ftHalf *= m_psdSqrt->topRows(m_ftHalf.rows());
+        
+      backwardHalf(noise.data());
+   
+      //Normalize.
+      noise /= norm;
+   
+      return 0;
+   }
+   
+   planPaired();
+   
+   //Pack the two realizations as a complex number
+   for(int jj=0; jj<noise.cols(); ++jj)
+   {
+      for(int ii=0;ii<noise.rows();++ii)
       {
-         m_ftWork(ii,jj) = complexT(noise(ii,jj),0);
+         m_ftWork(ii,jj) = complexT(noise(ii,jj),(*noiseIm)(ii,jj));
       }
    }
    
@@ -974,15 +1358,9 @@ int psdFilter<realT,rank>::filter( realArrayMapT  noise,
         
    m_fft_back(m_ftWork.data(), m_ftWork.data());
    
-   realT norm = sqrt(noise.rows()*noise.cols()/(m_dFreq1*m_dFreq2));
-   
-   //Now take the real part, and normalize.
+   //Now unpack, and normalize.
    noise = m_ftWork.real()/norm;
-   
-   if(noiseIm != nullptr)
-   {
-      *noiseIm = m_ftWork.imag()/norm;
-   }
+   *noiseIm = m_ftWork.imag()/norm;
    
    return 0;
 }
@@ -994,14 +1372,42 @@ int psdFilter<realT,rank>::filter( realArrayT & noise,
                                    typename std::enable_if<crank==3>::type*
                                  ) const
 {
-   //Make noise a complex number
+   realT norm = sqrt(m_rows*m_cols*m_planes/(m_dFreq1*m_dFreq2*m_dFreq3));
+   
+   if(noiseIm != nullptr && (m_lowMemory || m_threads > 1))
+   {
+      filter(noise);
+      return filter(*noiseIm);
+   }
+
+   if(noiseIm == nullptr)
+   {
+      if(m_threads > 1) return filterSlabs(noise.data(), norm);
+
+      //Transform real noise to the Hermitian half of the Fourier domain.
+      forwardHalf(noise.data());
+   
+      //Apply the filter.
+      for(int pp=0;pp<noise.planes();++pp)  m_ftHalf.image(pp) *= m_psdSqrt->image(pp).topRows(m_ftHalf.rows());
+        
+      backwardHalf(noise.data());
+   
+      //Normalize.
+      for(int pp=0; pp< noise.planes();++pp)  noise.image(pp) /= norm;
+   
+      return 0;
+   }
+   
+   planPaired();
+   
+   //Pack the two realizations as a complex number
    for(int pp=0;pp<noise.planes();++pp)
    {
-      for(int ii=0;ii<noise.rows();++ii)
+      for(int jj=0; jj<noise.cols(); ++jj)
       {
-         for(int jj=0; jj<noise.cols(); ++jj)
+         for(int ii=0;ii<noise.rows();++ii)
          {
-            m_ftWork.image(pp)(ii,jj) = complexT(noise.image(pp)(ii,jj),0);
+            m_ftWork.image(pp)(ii,jj) = complexT(noise.image(pp)(ii,jj),noiseIm->image(pp)(ii,jj));
          }
       }
    }
@@ -1014,14 +1420,11 @@ int psdFilter<realT,rank>::filter( realArrayT & noise,
         
    m_fft_back(m_ftWork.data(), m_ftWork.data());
    
-   //Now take the real part, and normalize.
-   
-   realT norm = sqrt(m_rows*m_cols*m_planes/(m_dFreq1*m_dFreq2*m_dFreq3));
-   for(int pp=0; pp< noise.planes();++pp)  noise.image(pp) = m_ftWork.image(pp).real()/norm;
-   
-   if(noiseIm != nullptr)
+   //Now unpack, and normalize.
+   for(int pp=0; pp< noise.planes();++pp)  
    {
-      for(int pp=0; pp< noise.planes();++pp) noiseIm->image(pp) = m_ftWork.image(pp).imag()/norm;
+      noise.image(pp) = m_ftWork.image(pp).real()/norm;
+      noiseIm->image(pp) = m_ftWork.image(pp).imag()/norm;
    }
    
    return 0;
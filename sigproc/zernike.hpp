@@ -472,12 +472,21 @@ namespace mx
 
       /// Fill in an Eigencube-like array with Zernike polynomials in Noll order
       /** The cube is pre-allocated to set the image size and the number of modes.
+       *
+       * The result is the same as calling \ref zernike for each plane, to within round-off, but is much faster for large
+       * bases.  The radius and angle of each pixel in the aperture are calculated once and shared by all modes.  The modes
+       * are grouped by |m|, so that \f$ \cos(m\phi) \f$ and \f$ \sin(m\phi) \f$ are calculated once per group, and the
+       * radial polynomials of a group are found with the recurrence of Kintner (1976) in n.  The groups are filled in
+       * parallel.  For large n the recurrence is also more accurate than the direct sum used by \ref zernikeR, which
+       * suffers from cancellation.
        *
        * \returns 0 on success
        * \returns -1 on error
        *
        * \tparam cubeT is an Eigencube-like array with real floating point type
        * \tparam calcRealT is a real floating type used for internal calculations, should be at least double
+       *
+       * \test Scenario: testing zernikeBasis \ref tests_sigproc_zernike_zernikeBasis "[test doc]"
        */
       template <typename cubeT, typename calcRealT>
       int zernikeBasis(cubeT &cube,                     ///< [in/out] the pre-allocated cube which will be filled with the Zernike basis
@@ -485,22 +494,134 @@ namespace mx
                        int minj = 2                     ///< [in] [optional] the minimum j value to include.  The default is j=2, which skips piston (j=1).
       )
       {
-         typedef typename cubeT::imageT arrayT;
+         typedef typename cubeT::Scalar realT;
+
+         int nModes = cube.planes();
+
+         // The n and m of each plane, and the planes grouped by |m| in order of increasing n
+         std::vector<int> ns(nModes), ms(nModes);
+         std::vector<std::vector<int>> groups;
+
+         for (int i = 0; i < nModes; ++i)
+         {
+            if (noll_nm(ns[i], ms[i], minj + i) < 0)
+               return -1;
+
+            size_t am = abs(ms[i]);
+            if (groups.size() < am + 1)
+               groups.resize(am + 1);
+
+            groups[am].push_back(i);
+         }
+
+         size_t l0 = cube.rows();
+         size_t l1 = cube.cols();
+
+         realT xcen = 0.5 * (l0 - 1.0);
+         realT ycen = 0.5 * (l1 - 1.0);
+
+         if (rad <= 0)
+            rad = 0.5 * std::min(l0 - 1, l1 - 1);
+
+         // The pixels in the aperture, following the rules of zernike(arrayT&, int, int, ...)
+         std::vector<size_t> idx;
+         std::vector<calcRealT> rho, phi;
+
+         for (size_t j = 0; j < l1; ++j)
+         {
+            for (size_t i = 0; i < l0; ++i)
+            {
+               realT x = i - xcen;
+               realT y = j - ycen;
+
+               realT r = std::sqrt(x * x + y * y);
+
+               if (r > rad && r <= rad + 0.5)
+                  r = rad;
+
+               if (r / rad <= 1.0)
+               {
+                  idx.push_back(i + j * l0);
+                  rho.push_back(r / rad);
+                  phi.push_back(std::atan2(y, x));
+               }
+            }
+         }
 
-         typename cubeT::imageT im;
+         size_t np = idx.size();
 
-         im.resize(cube.rows(), cube.cols());
+         cube.setZero();
 
-         int rv;
-         for (int i = 0; i < cube.planes(); ++i)
+#pragma omp parallel for schedule(dynamic)
+         for (int am = 0; am < (int)groups.size(); ++am)
          {
-            rv = zernike<arrayT, calcRealT>(im, minj + i, rad);
+            std::vector<int> &group = groups[am];
+
+            if (group.size() == 0)
+               continue;
+
+            std::vector<calcRealT> cm, sm;
+
+            if (am > 0)
+            {
+               cm.resize(np);
+               sm.resize(np);
 
-            if (rv < 0)
+               for (size_t k = 0; k < np; ++k)
+               {
+                  cm[k] = math::root_two<calcRealT>() * cos(am * phi[k]);
+                  sm[k] = math::root_two<calcRealT>() * sin(am * phi[k]);
+               }
+            }
+
+            // R is R_n^m, R1 is R_{n-2}^m, and R2 is R_{n-4}^m
+            std::vector<calcRealT> R(np), R1(np), R2(np);
+
+            size_t g = 0;
+            for (int n = am; g < group.size(); n += 2)
             {
-               return rv;
+               R2.swap(R1);
+               R1.swap(R);
+
+               if (n == am)
+               {
+                  for (size_t k = 0; k < np; ++k)
+                     R[k] = pow(rho[k], am);
+               }
+               else if (n == am + 2)
+               {
+                  for (size_t k = 0; k < np; ++k)
+                     R[k] = ((am + 2) * rho[k] * rho[k] - (am + 1)) * R1[k];
+               }
+               else
+               {
+                  calcRealT K1 = 0.5 * (n + am) * (n - am) * (n - 2);
+                  calcRealT K2 = 2.0 * n * (n - 1) * (n - 2);
+                  calcRealT K3 = -1.0 * am * am * (n - 1) - 1.0 * n * (n - 1) * (n - 2);
+                  calcRealT K4 = -0.5 * n * (n + am - 2) * (n - am - 2);
+
+                  for (size_t k = 0; k < np; ++k)
+                     R[k] = ((K2 * rho[k] * rho[k] + K3) * R1[k] + K4 * R2[k]) / K1;
+               }
+
+               calcRealT norm = sqrt((calcRealT)n + 1);
+
+               for (; g < group.size() && ns[group[g]] == n; ++g)
+               {
+                  int i = group[g];
+                  realT *im = cube.image(i).data();
+
+                  for (size_t k = 0; k < np; ++k)
+                  {
+                     if (ms[i] < 0)
+                        im[idx[k]] = norm * R[k] * sm[k];
+                     else if (ms[i] > 0)
+                        im[idx[k]] = norm * R[k] * cm[k];
+                     else
+                        im[idx[k]] = norm * R[k];
+                  }
+               }
             }
-            cube.image(i) = im;
          }
 
          return 0;
@@ -618,11 +739,11 @@ namespace mx
          if (noll_nm(n, m, j) < 0)
             return -1; // noll_nm will explain error
 
-         for (size_t i = 0; i < arr.rows(); ++i)
+         for (int rr = 0; rr < arr.rows(); ++rr)
          {
-            for (size_t j = 0; j < arr.cols(); ++j)
+            for (int cc = 0; cc < arr.cols(); ++cc)
             {
-               arr(i, j) = zernikeQNorm(k(i, j), phi(i, j), n, m);
+               arr(rr, cc) = zernikeQNorm(k(rr, cc), phi(rr, cc), n, m);
             }
          }
          return 0;
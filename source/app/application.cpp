@@ -23,8 +23,14 @@
 // along with mxlib.  If not, see <http://www.gnu.org/licenses/>.
 //***********************************************************************//
 
+#include <fstream>
+#include <memory>
+
+#include <omp.h>
+
 #include "app/application.hpp"
 #include "sys/environment.hpp"
+#include "sys/timeUtils.hpp"
 
 namespace mx
 {
@@ -51,6 +57,11 @@ int application::main( int argc,
       return 1;
    }
 
+   if(m_sweepParent == nullptr && m_sweepSpecs.size() > 0)
+   {
+      return sweep();
+   }
+
    if(!m_preserveConfig)
    {
       config.clear();
@@ -97,6 +108,7 @@ void application::setup( int argc,
 
    setupStandardConfig();
    setupStandardHelp();
+   if(m_allowSweep) setupStandardSweep();
 
    setupBasicConfig();
    setupConfig();
@@ -117,7 +129,17 @@ void application::setup( int argc,
    //Now parse the command line for real.
    config.parseCommandLine(argc, argv);
 
+   //In a sweep job, the swept values are applied last so they take precedence.
+   for(size_t n = 0; n < m_sweepSettings.size(); ++n)
+   {
+      configTarget & tgt = config.m_targets[m_sweepSettings[n].first];
+      tgt.values.push_back(m_sweepSettings[n].second);
+      tgt.sources.push_back("sweep");
+      tgt.set = true;
+   }
+
    loadStandardHelp();
+   if(m_allowSweep) loadStandardSweep();
 
    loadBasicConfig();
    loadConfig();
@@ -208,6 +230,151 @@ void application::loadStandardHelp() //virtual
    config(doHelp, "help");
 }
 
+void application::setupStandardSweep() //virtual
+{
+   config.add("sweep", "", "sweep", argType::Required, "sweep", "sweep", false, "string", "A parameter sweep specification, name=v1,v2,... or name=start:stop:step, with entries separated by ';'.  May be repeated.");
+   config.add("sweepThreads", "", "sweepThreads", argType::Required, "sweep", "threads", false, "int", "The number of sweep jobs to run at once.  Default is the number of OpenMP threads.");
+   config.add("sweepOutput", "", "sweepOutput", argType::Required, "sweep", "output", false, "string", "The file to write the sweep results to.  Default is stdout.");
+}
+
+void application::loadStandardSweep() //virtual
+{
+   m_sweepSpecs.clear();
+   for(int n = 0; n < config.count("sweep"); ++n)
+   {
+      std::string spec;
+      config.get(spec, "sweep", n);
+      m_sweepSpecs.push_back(spec);
+   }
+
+   config(m_sweepThreads, "sweepThreads");
+   config(m_sweepOutput, "sweepOutput");
+}
+
+application * application::newSweepJob() //virtual
+{
+   return nullptr;
+}
+
+int application::setupSweep() //virtual
+{
+   return 0;
+}
+
+int application::sweep()
+{
+   std::vector<sweepParam> params;
+   for(size_t n = 0; n < m_sweepSpecs.size(); ++n)
+   {
+      if(parseSweepSpec(params, m_sweepSpecs[n]) < 0)
+      {
+         mxError("application::sweep", MXE_INVALIDCONFIG, "error parsing sweep specification");
+         return -1;
+      }
+   }
+
+   //Catch typos here, rather than in every job.
+   for(size_t n = 0; n < params.size(); ++n)
+   {
+      if(config.m_targets.count(params[n].m_name) == 0)
+      {
+         mxError("application::sweep", MXE_INVALIDCONFIG, "unknown config target in sweep: " + params[n].m_name);
+         return -1;
+      }
+   }
+
+   std::vector<sweepJob> jobs;
+   expandSweep(jobs, params);
+
+   if(setupSweep() < 0)
+   {
+      mxError("application::sweep", MXE_PROCERR, "error from setupSweep");
+      return -1;
+   }
+
+   int nTh = m_sweepThreads;
+   if(nTh < 1) nTh = omp_get_max_threads();
+   if(nTh > (int) jobs.size()) nTh = jobs.size();
+   if(nTh < 1) nTh = 1;
+
+   bool newErr = false;
+
+   #pragma omp parallel for schedule(dynamic) num_threads(nTh)
+   for(size_t j = 0; j < jobs.size(); ++j)
+   {
+      std::unique_ptr<application> job;
+
+      //Configuration reads files and the environment, and derived setupConfig/loadConfig may not be reentrant.
+      #pragma omp critical(mx_app_sweep_job)
+      {
+         job.reset(newSweepJob());
+
+         if(job)
+         {
+            job->m_sweepParent = this;
+            job->m_sweepSettings = jobs[j].m_settings;
+            job->m_argc = m_argc;
+            job->m_argv = m_argv;
+            job->setup(m_argc, m_argv);
+
+            if(!job->m_preserveConfig)
+            {
+               job->config.clear();
+            }
+         }
+      }
+
+      if(!job)
+      {
+         #pragma omp critical(mx_app_sweep_err)
+         newErr = true;
+
+         jobs[j].m_status = -1;
+         continue;
+      }
+
+      double t0 = sys::get_curr_time();
+      jobs[j].m_status = job->execute();
+      jobs[j].m_time = sys::get_curr_time() - t0;
+
+      jobs[j].m_results.swap(job->m_sweepResults);
+
+      #pragma omp critical(mx_app_sweep_job)
+      {
+         job.reset();
+      }
+   }
+
+   if(newErr)
+   {
+      mxError("application::sweep", MXE_ALLOCERR, "newSweepJob did not create a job");
+      return -1;
+   }
+
+   if(m_sweepOutput != "")
+   {
+      std::ofstream fout(m_sweepOutput);
+      if(!fout.good())
+      {
+         mxError("application::sweep", MXE_FILEOERR, "error opening " + m_sweepOutput);
+         return -1;
+      }
+
+      writeSweepTable(fout, jobs);
+   }
+   else
+   {
+      writeSweepTable(std::cout, jobs);
+   }
+
+   return 0;
+}
+
+const application * application::sweepParent() const
+{
+   return m_sweepParent;
+}
+
 void application::setupBasicConfig() //virtual
 {
    return;
@@ -0,0 +1,242 @@
+/** \file sweep.cpp
+ * \author Jared R. Males
+ * \brief Implementation of parameter sweeps over application configuration targets
+ *
+ * \ingroup mxApp_files
+ *
+ */
+
+//***********************************************************************//
+// Copyright 2023 Jared R. Males (jaredmales@gmail.com)
+//
+// This file is part of mxlib.
+//
+// mxlib is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// mxlib is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with mxlib.  If not, see <http://www.gnu.org/licenses/>.
+//***********************************************************************//
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "app/sweep.hpp"
+#include "ioutils/stringUtils.hpp"
+#include "mxError.hpp"
+
+namespace mx
+{
+namespace app
+{
+
+namespace
+{
+
+//Check whether a range component is an integer
+bool isIntStr( const std::string & s )
+{
+   return s.find_first_of(".eE") == std::string::npos;
+}
+
+//Format a range value without round-off noise
+std::string rangeValue( double v,
+                        bool isInt
+                      )
+{
+   char str[64];
+
+   if(isInt) snprintf(str, sizeof(str), "%lld", static_cast<long long>(llround(v)));
+   else snprintf(str, sizeof(str), "%.12g", v);
+
+   return str;
+}
+
+//Make a value safe for a whitespace-delimited table
+std::string tableValue( const std::string & v )
+{
+   if(v == "") return "-";
+
+   std::string s = v;
+   for(size_t n = 0; n < s.size(); ++n)
+   {
+      if(isspace(s[n])) s[n] = '_';
+   }
+
+   return s;
+}
+
+} //namespace
+
+int parseSweepSpec( std::vector<sweepParam> & params,
+                    const std::string & spec
+                  )
+{
+   std::vector<std::string> entries;
+   ioutils::parseStringVector(entries, spec, ';');
+
+   for(size_t e = 0; e < entries.size(); ++e)
+   {
+      std::string entry = ioutils::removeWhiteSpace(entries[e]);
+      if(entry == "") continue;
+
+      size_t eq = entry.find('=');
+      if(eq == std::string::npos || eq == 0 || eq == entry.size()-1)
+      {
+         mxError("parseSweepSpec", MXE_PARSEERR, "sweep entry must be name=values: " + entry);
+         return -1;
+      }
+
+      sweepParam sp;
+      sp.m_name = entry.substr(0, eq);
+      std::string vals = entry.substr(eq+1);
+
+      for(size_t p = 0; p < params.size(); ++p)
+      {
+         if(params[p].m_name == sp.m_name)
+         {
+            mxError("parseSweepSpec", MXE_INVALIDARG, "sweep target repeated: " + sp.m_name);
+            return -1;
+         }
+      }
+
+      if(vals.find(':') != std::string::npos)
+      {
+         std::vector<std::string> rng;
+         ioutils::parseStringVector(rng, vals, ':');
+
+         if(rng.size() != 3)
+         {
+            mxError("parseSweepSpec", MXE_PARSEERR, "sweep range must be start:stop:step: " + entry);
+            return -1;
+         }
+
+         double start = ioutils::convertFromString<double>(rng[0]);
+         double stop = ioutils::convertFromString<double>(rng[1]);
+         double step = ioutils::convertFromString<double>(rng[2]);
+
+         if(step == 0 || (stop - start)/step < 0)
+         {
+            mxError("parseSweepSpec", MXE_INVALIDARG, "sweep range step does not reach stop: " + entry);
+            return -1;
+         }
+
+         bool isInt = isIntStr(rng[0]) && isIntStr(rng[1]) && isIntStr(rng[2]);
+
+         long nVals = static_cast<long>(floor((stop - start)/step + 1e-9)) + 1;
+
+         for(long n = 0; n < nVals; ++n)
+         {
+            sp.m_values.push_back(rangeValue(start + n*step, isInt));
+         }
+      }
+      else
+      {
+         ioutils::parseStringVector(sp.m_values, vals, ',');
+      }
+
+      if(sp.m_values.size() == 0)
+      {
+         mxError("parseSweepSpec", MXE_PARSEERR, "sweep entry has no values: " + entry);
+         return -1;
+      }
+
+      params.push_back(sp);
+   }
+
+   return 0;
+}
+
+void expandSweep( std::vector<sweepJob> & jobs,
+                  const std::vector<sweepParam> & params
+                )
+{
+   jobs.clear();
+
+   if(params.size() == 0) return;
+
+   size_t nJobs = 1;
+   for(size_t p = 0; p < params.size(); ++p) nJobs *= params[p].m_values.size();
+
+   jobs.resize(nJobs);
+
+   for(size_t j = 0; j < nJobs; ++j)
+   {
+      //Decompose j with the last dimension varying fastest
+      size_t rem = j;
+      jobs[j].m_settings.resize(params.size());
+
+      for(size_t p = params.size(); p > 0; --p)
+      {
+         const sweepParam & sp = params[p-1];
+         jobs[j].m_settings[p-1] = std::make_pair(sp.m_name, sp.m_values[rem % sp.m_values.size()]);
+         rem /= sp.m_values.size();
+      }
+   }
+}
+
+void writeSweepTable( std::ostream & out,
+                      const std::vector<sweepJob> & jobs
+                    )
+{
+   //Collect the result names in the order first seen
+   std::vector<std::string> resNames;
+   for(size_t j = 0; j < jobs.size(); ++j)
+   {
+      for(size_t r = 0; r < jobs[j].m_results.size(); ++r)
+      {
+         bool found = false;
+         for(size_t n = 0; n < resNames.size(); ++n)
+         {
+            if(resNames[n] == jobs[j].m_results[r].first)
+            {
+               found = true;
+               break;
+            }
+         }
+
+         if(!found) resNames.push_back(jobs[j].m_results[r].first);
+      }
+   }
+
+   out << "# job status time_s";
+   if(jobs.size() > 0)
+   {
+      for(size_t p = 0; p < jobs[0].m_settings.size(); ++p) out << " " << tableValue(jobs[0].m_settings[p].first);
+   }
+   for(size_t n = 0; n < resNames.size(); ++n) out << " " << tableValue(resNames[n]);
+   out << "\n";
+
+   for(size_t j = 0; j < jobs.size(); ++j)
+   {
+      out << j << " " << jobs[j].m_status << " " << jobs[j].m_time;
+
+      for(size_t p = 0; p < jobs[j].m_settings.size(); ++p) out << " " << tableValue(jobs[j].m_settings[p].second);
+
+      for(size_t n = 0; n < resNames.size(); ++n)
+      {
+         std::string val;
+
+         //The last value recorded with a name is used
+         for(size_t r = 0; r < jobs[j].m_results.size(); ++r)
+         {
+            if(jobs[j].m_results[r].first == resNames[n]) val = jobs[j].m_results[r].second;
+         }
+
+         out << " " << tableValue(val);
+      }
+
+      out << "\n";
+   }
+}
+
+} //namespace app
+} //namespace mx
@@ -0,0 +1,114 @@
+/** \file bitMaskCube.cpp
+  * \brief A compact cube of 1/0 masks, storing each distinct mask once as bits.
+  * \ingroup image_processing_files
+  * \author Jared R. Males (jaredmales@gmail.com)
+  *
+  */
+
+//***********************************************************************//
+// Copyright 2023 Jared R. Males (jaredmales@gmail.com)
+//
+// This file is part of mxlib.
+//
+// mxlib is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// mxlib is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with mxlib.  If not, see <http://www.gnu.org/licenses/>.
+//***********************************************************************//
+
+#include "improc/bitMaskCube.hpp"
+
+namespace mx
+{
+namespace improc
+{
+
+bitMaskCube::bitMaskCube()
+{
+}
+
+bitMaskCube::bitMaskCube( Index rows,
+                          Index cols,
+                          Index planes
+                        )
+{
+   resize(rows, cols, planes);
+}
+
+void bitMaskCube::resize( Index rows,
+                          Index cols,
+                          Index planes
+                        )
+{
+   m_rows = rows;
+   m_cols = cols;
+
+   m_words = (rows*cols + 63)/64;
+
+   m_bits.clear();
+   m_index.assign(planes, 0);
+}
+
+bitMaskCube::Index bitMaskCube::rows() const
+{
+   return m_rows;
+}
+
+bitMaskCube::Index bitMaskCube::cols() const
+{
+   return m_cols;
+}
+
+bitMaskCube::Index bitMaskCube::planes() const
+{
+   return m_index.size();
+}
+
+int bitMaskCube::nMasks() const
+{
+   if(m_words == 0) return 0;
+
+   return m_bits.size() / m_words;
+}
+
+int bitMaskCube::addMasks( int N )
+{
+   int maskNo = nMasks();
+
+   if(N > 0) m_bits.resize(m_bits.size() + N*m_words, 0);
+
+   return maskNo;
+}
+
+void bitMaskCube::setMask( Index k,
+                           int maskNo
+                         )
+{
+   if(k < 0 || k >= planes())
+   {
+      mxThrowException(err::invalidarg, "bitMaskCube::setMask", "plane out of range");
+   }
+
+   if(maskNo < 0 || maskNo >= nMasks())
+   {
+      mxThrowException(err::invalidarg, "bitMaskCube::setMask", "mask index out of range");
+   }
+
+   m_index[k] = maskNo;
+}
+
+int bitMaskCube::maskIndex( Index k ) const
+{
+   return m_index[k];
+}
+
+} //namespace improc
+} //namespace mx
@@ -0,0 +1,350 @@
+/** \file fitsCompactHeader.cpp
+  * \brief Implementation of a class to hold a read-only FITS header in compact form
+  * \ingroup fits_processing_files
+  * \author Jared R. Males (jaredmales@gmail.com)
+  *
+  */
+
+//***********************************************************************//
+// Copyright 2015-2022 Jared R. Males (jaredmales@gmail.com)
+//
+// This file is part of mxlib.
+//
+// mxlib is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// mxlib is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with mxlib.  If not, see <http://www.gnu.org/licenses/>.
+//***********************************************************************//
+
+#include <cstring>
+
+#include "ioutils/fits/fitsCompactHeader.hpp"
+
+namespace mx
+{
+namespace fits
+{
+
+constexpr uint8_t fitsCompactHeader::cardValue;
+constexpr uint8_t fitsCompactHeader::cardComment;
+constexpr uint8_t fitsCompactHeader::cardHistory;
+
+fitsCompactHeader::fitsCompactHeader()
+{
+}
+
+fitsCompactHeader::fitsCompactHeader( const char * hdr,
+                                      size_t len
+                                    )
+{
+   if( parse(hdr, len) < 0)
+   {
+      mxThrowException(err::invalidarg, "fitsCompactHeader::fitsCompactHeader", "header length is not a multiple of 80");
+   }
+}
+
+uint32_t fitsCompactHeader::hash( const char * kw,
+                                  size_t len
+                                )
+{
+   //FNV-1a
+   uint32_t h = 2166136261u;
+   for(size_t n = 0; n < len; ++n)
+   {
+      h ^= (unsigned char) kw[n];
+      h *= 16777619u;
+   }
+
+   return h;
+}
+
+void fitsCompactHeader::parseRecord( const char * rec )
+{
+   //Trim trailing blanks from the range [b, e)
+   auto rtrim = [](const char * b, const char * e)
+   {
+      while(e > b && *(e-1) == ' ') --e;
+      return e;
+   };
+
+   const char * end = rec + 80;
+
+   const char * kb = rec;
+   const char * ke;
+   const char * vp = nullptr; //start of the value field, if any
+
+   if(strncmp(rec, "HIERARCH ", 9) == 0 && memchr(rec, '=', 80) != nullptr)
+   {
+      kb = rec + 9;
+      while(kb < end && *kb == ' ') ++kb;
+      const char * eq = static_cast<const char *>(memchr(kb, '=', end-kb));
+      ke = rtrim(kb, eq);
+      vp = eq + 1;
+   }
+   else
+   {
+      ke = rtrim(rec, rec + 8);
+      if(rec[8] == '=' && rec[9] == ' ') vp = rec + 10;
+   }
+
+   cardRef cr;
+   cr.m_off = m_arena.size();
+   cr.m_keyLen = ke - kb;
+   cr.m_kind = cardValue;
+
+   if(cr.m_keyLen == 7 && strncmp(kb, "COMMENT", 7) == 0)
+   {
+      cr.m_kind = cardComment;
+      vp = nullptr;
+   }
+   else if(cr.m_keyLen == 7 && strncmp(kb, "HISTORY", 7) == 0)
+   {
+      cr.m_kind = cardHistory;
+      vp = nullptr;
+   }
+
+   const char * vb = end;
+   const char * ve = end;
+   const char * cb;
+   const char * ce;
+
+   if(vp == nullptr)
+   {
+      //No value, everything after the keyword is the comment
+      cb = rec + 8;
+      ce = rtrim(cb, end);
+   }
+   else
+   {
+      vb = vp;
+      while(vb < end && *vb == ' ') ++vb;
+
+      ve = vb;
+      if(ve < end && *ve == '\'')
+      {
+         //A string, with '' as an escaped quote
+         ++ve;
+         while(ve < end)
+         {
+            if(*ve == '\'')
+            {
+               if(ve + 1 < end && *(ve+1) == '\'') ve += 2;
+               else
+               {
+                  ++ve;
+                  break;
+               }
+            }
+            else ++ve;
+         }
+      }
+      else if(ve < end && *ve == '(')
+      {
+         //A complex number
+         while(ve < end && *ve != ')') ++ve;
+         if(ve < end) ++ve;
+      }
+      else
+      {
+         while(ve < end && *ve != ' ' && *ve != '/') ++ve;
+      }
+
+      cb = ve;
+      while(cb < end && *cb == ' ') ++cb;
+
+      if(cb < end && *cb == '/')
+      {
+         ++cb;
+         if(cb < end && *cb == ' ') ++cb;
+         ce = rtrim(cb, end);
+      }
+      else
+      {
+         ce = cb;
+      }
+   }
+
+   cr.m_valLen = ve - vb;
+   cr.m_comLen = ce - cb;
+
+   m_arena.append(kb, cr.m_keyLen);
+   m_arena.append(vb, cr.m_valLen);
+   m_arena.append(cb, cr.m_comLen);
+
+   m_cards.push_back(cr);
+}
+
+void fitsCompactHeader::makeIndex()
+{
+   size_t sz = 16;
+   while(sz < 2*m_cards.size()) sz *= 2;
+
+   m_index.assign(sz, 0);
+
+   for(size_t n = 0; n < m_cards.size(); ++n)
+   {
+      const char * kw = m_arena.data() + m_cards[n].m_off;
+      size_t len = m_cards[n].m_keyLen;
+
+      size_t s = hash(kw, len) & (sz - 1);
+      while(m_index[s] != 0)
+      {
+         const cardRef & o = m_cards[m_index[s]-1];
+         if(o.m_keyLen == len && memcmp(m_arena.data() + o.m_off, kw, len) == 0) break; //only index the first
+
+         s = (s + 1) & (sz - 1);
+      }
+
+      if(m_index[s] == 0) m_index[s] = n + 1;
+   }
+}
+
+int fitsCompactHeader::parse( const char * hdr,
+                              size_t len
+                            )
+{
+   clear();
+
+   if(len % 80 != 0) return -1;
+
+   size_t nrec = len/80;
+
+   m_cards.reserve(nrec);
+   m_arena.reserve(nrec*24); //typical keyword + value + comment
+
+   for(size_t n = 0; n < nrec; ++n)
+   {
+      const char * rec = hdr + n*80;
+
+      if(strncmp(rec, "END     ", 8) == 0) break;
+
+      parseRecord(rec);
+   }
+
+   m_arena.shrink_to_fit();
+   m_cards.shrink_to_fit();
+
+   makeIndex();
+
+   return 0;
+}
+
+void fitsCompactHeader::clear()
+{
+   m_arena.clear();
+   m_cards.clear();
+   m_index.clear();
+}
+
+bool fitsCompactHeader::empty() const
+{
+   return m_cards.empty();
+}
+
+size_t fitsCompactHeader::size() const
+{
+   return m_cards.size();
+}
+
+size_t fitsCompactHeader::memSize() const
+{
+   return sizeof(fitsCompactHeader) + m_arena.capacity() + m_cards.capacity()*sizeof(cardRef) + m_index.capacity()*sizeof(uint32_t);
+}
+
+long fitsCompactHeader::find( const std::string & keyword ) const
+{
+   if(m_index.size() == 0) return -1;
+
+   size_t sz = m_index.size();
+   size_t s = hash(keyword.data(), keyword.size()) & (sz - 1);
+
+   while(m_index[s] != 0)
+   {
+      const cardRef & o = m_cards[m_index[s]-1];
+      if(o.m_keyLen == keyword.size() && memcmp(m_arena.data() + o.m_off, keyword.data(), keyword.size()) == 0)
+      {
+         return m_index[s] - 1;
+      }
+
+      s = (s + 1) & (sz - 1);
+   }
+
+   return -1;
+}
+
+size_t fitsCompactHeader::count( const std::string & keyword ) const
+{
+   long n0 = find(keyword);
+   if(n0 < 0) return 0;
+
+   size_t cnt = 0;
+   for(size_t n = n0; n < m_cards.size(); ++n)
+   {
+      if(m_cards[n].m_keyLen == keyword.size() && memcmp(m_arena.data() + m_cards[n].m_off, keyword.data(), keyword.size()) == 0) ++cnt;
+   }
+
+   return cnt;
+}
+
+std::string fitsCompactHeader::keyword( size_t n ) const
+{
+   const cardRef & cr = m_cards[n];
+   return std::string(m_arena.data() + cr.m_off, cr.m_keyLen);
+}
+
+std::string fitsCompactHeader::valueStr( size_t n ) const
+{
+   const cardRef & cr = m_cards[n];
+   return std::string(m_arena.data() + cr.m_off + cr.m_keyLen, cr.m_valLen);
+}
+
+std::string fitsCompactHeader::comment( size_t n ) const
+{
+   const cardRef & cr = m_cards[n];
+   return std::string(m_arena.data() + cr.m_off + cr.m_keyLen + cr.m_valLen, cr.m_comLen);
+}
+
+fitsHeaderCard fitsCompactHeader::card( size_t n ) const
+{
+   if(m_cards[n].m_kind == cardComment)
+   {
+      return fitsHeaderCard(keyword(n), fitsCommentType(), comment(n));
+   }
+   else if(m_cards[n].m_kind == cardHistory)
+   {
+      return fitsHeaderCard(keyword(n), fitsHistoryType(), comment(n));
+   }
+
+   return fitsHeaderCard(keyword(n), valueStr(n), comment(n));
+}
+
+fitsHeaderCard fitsCompactHeader::operator[]( const std::string & keyword ) const
+{
+   long n = find(keyword);
+
+   if(n < 0)
+   {
+      mxThrowException(err::invalidarg, "fitsCompactHeader::operator[]", "keyword " + keyword + " not found");
+   }
+
+   return card(n);
+}
+
+void fitsCompactHeader::toHeader( fitsHeader & head ) const
+{
+   for(size_t n = 0; n < m_cards.size(); ++n)
+   {
+      head.append(card(n));
+   }
+}
+
+} //namespace fits
+} //namespace mx
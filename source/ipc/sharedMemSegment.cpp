@@ -157,7 +157,7 @@ namespace mx
       int sharedMemSegment::detach()
       {
 
-         if (attached)
+         if (!attached)
             return 0;
 
          if (addr == 0)
@@ -170,6 +170,9 @@ namespace mx
             return -1;
          }
 
+         attached = 0;
+         addr = 0;
+
          return 0;
       }
 
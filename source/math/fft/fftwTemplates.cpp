@@ -212,6 +212,56 @@ void fftw_free<complexQT>( complexQT * p)
 }
 #endif
 
+template<>
+int fftw_alignment_of<float>( const float * p)
+{
+   return ::fftwf_alignment_of( const_cast<float *>(p) );
+}
+
+template<>
+int fftw_alignment_of<complexFT>( const complexFT * p)
+{
+   return ::fftwf_alignment_of( reinterpret_cast<float *>(const_cast<complexFT *>(p)) );
+}
+
+template<>
+int fftw_alignment_of<double>( const double * p)
+{
+   return ::fftw_alignment_of( const_cast<double *>(p) );
+}
+
+template<>
+int fftw_alignment_of<complexDT>( const complexDT * p)
+{
+   return ::fftw_alignment_of( reinterpret_cast<double *>(const_cast<complexDT *>(p)) );
+}
+
+template<>
+int fftw_alignment_of<long double>( const long double * p)
+{
+   return ::fftwl_alignment_of( const_cast<long double *>(p) );
+}
+
+template<>
+int fftw_alignment_of<complexLT>( const complexLT * p)
+{
+   return ::fftwl_alignment_of( reinterpret_cast<long double *>(const_cast<complexLT *>(p)) );
+}
+
+#ifdef HASQUAD
+template<>
+int fftw_alignment_of<__float128>( const __float128 * p)
+{
+   return ::fftwq_alignment_of( const_cast<__float128 *>(p) );
+}
+
+template<>
+int fftw_alignment_of<complexQT>( const complexQT * p)
+{
+   return ::fftwq_alignment_of( reinterpret_cast<__float128 *>(const_cast<complexQT *>(p)) );
+}
+#endif
+
 template<>
 void fftw_make_planner_thread_safe<float>()
 {
@@ -408,6 +458,184 @@ fftwTypeSpec<complexQT, __float128>::planT fftw_plan_dft<complexQT, __float128>(
 
 #endif
 
+template<>
+fftwTypeSpec<complexFT, complexFT>::planT fftw_plan_many_dft<complexFT, complexFT>( std::vector<int> n,
+                                                                                    int howmany,
+                                                                                    complexFT * in,
+                                                                                    int idist,
+                                                                                    complexFT * out,
+                                                                                    int odist,
+                                                                                    int sign,
+                                                                                    unsigned flags
+                                                                                  )
+{
+   return ::fftwf_plan_many_dft( n.size(), n.data(), howmany, reinterpret_cast<fftwf_complex*>(in), nullptr, 1, idist, reinterpret_cast<fftwf_complex*>(out), nullptr, 1, odist, sign, flags);
+}
+
+template<>
+fftwTypeSpec<float, complexFT>::planT fftw_plan_many_dft<float, complexFT>( std::vector<int> n,
+                                                                            int howmany,
+                                                                            float * in,
+                                                                            int idist,
+                                                                            complexFT * out,
+                                                                            int odist,
+                                                                            int sign,
+                                                                            unsigned flags
+                                                                          )
+{
+   static_cast<void>(sign);
+   return ::fftwf_plan_many_dft_r2c( n.size(), n.data(), howmany, in, nullptr, 1, idist, reinterpret_cast<fftwf_complex*>(out), nullptr, 1, odist, flags);
+}
+
+template<>
+fftwTypeSpec<complexFT, float>::planT fftw_plan_many_dft<complexFT, float>( std::vector<int> n,
+                                                                            int howmany,
+                                                                            complexFT * in,
+                                                                            int idist,
+                                                                            float * out,
+                                                                            int odist,
+                                                                            int sign,
+                                                                            unsigned flags
+                                                                          )
+{
+   static_cast<void>(sign);
+   return ::fftwf_plan_many_dft_c2r( n.size(), n.data(), howmany, reinterpret_cast<fftwf_complex*>(in), nullptr, 1, idist, out, nullptr, 1, odist, flags);
+}
+
+template<>
+fftwTypeSpec<complexDT, complexDT>::planT fftw_plan_many_dft<complexDT, complexDT>( std::vector<int> n,
+                                                                                    int howmany,
+                                                                                    complexDT * in,
+                                                                                    int idist,
+                                                                                    complexDT * out,
+                                                                                    int odist,
+                                                                                    int sign,
+                                                                                    unsigned flags
+                                                                                  )
+{
+   return ::fftw_plan_many_dft( n.size(), n.data(), howmany, reinterpret_cast<fftw_complex*>(in), nullptr, 1, idist, reinterpret_cast<fftw_complex*>(out), nullptr, 1, odist, sign, flags);
+}
+
+template<>
+fftwTypeSpec<double, complexDT>::planT fftw_plan_many_dft<double, complexDT>( std::vector<int> n,
+                                                                              int howmany,
+                                                                              double * in,
+                                                                              int idist,
+                                                                              complexDT * out,
+                                                                              int odist,
+                                                                              int sign,
+                                                                              unsigned flags
+                                                                            )
+{
+   static_cast<void>(sign);
+   return ::fftw_plan_many_dft_r2c( n.size(), n.data(), howmany, in, nullptr, 1, idist, reinterpret_cast<fftw_complex*>(out), nullptr, 1, odist, flags);
+}
+
+template<>
+fftwTypeSpec<complexDT, double>::planT fftw_plan_many_dft<complexDT, double>( std::vector<int> n,
+                                                                              int howmany,
+                                                                              complexDT * in,
+                                                                              int idist,
+                                                                              double * out,
+                                                                              int odist,
+                                                                              int sign,
+                                                                              unsigned flags
+                                                                            )
+{
+   static_cast<void>(sign);
+   return ::fftw_plan_many_dft_c2r( n.size(), n.data(), howmany, reinterpret_cast<fftw_complex*>(in), nullptr, 1, idist, out, nullptr, 1, odist, flags);
+}
+
+template<>
+fftwTypeSpec<complexLT, complexLT>::planT fftw_plan_many_dft<complexLT, complexLT>( std::vector<int> n,
+                                                                                    int howmany,
+                                                                                    complexLT * in,
+                                                                                    int idist,
+                                                                                    complexLT * out,
+                                                                                    int odist,
+                                                                                    int sign,
+                                                                                    unsigned flags
+                                                                                  )
+{
+   return ::fftwl_plan_many_dft( n.size(), n.data(), howmany, reinterpret_cast<fftwl_complex*>(in), nullptr, 1, idist, reinterpret_cast<fftwl_complex*>(out), nullptr, 1, odist, sign, flags);
+}
+
+template<>
+fftwTypeSpec<long double, complexLT>::planT fftw_plan_many_dft<long double, complexLT>( std::vector<int> n,
+                                                                                        int howmany,
+                                                                                        long double * in,
+                                                                                        int idist,
+                                                                                        complexLT * out,
+                                                                                        int odist,
+                                                                                        int sign,
+                                                                                        unsigned flags
+                                                                                      )
+{
+   static_cast<void>(sign);
+   return ::fftwl_plan_many_dft_r2c( n.size(), n.data(), howmany, in, nullptr, 1, idist, reinterpret_cast<fftwl_complex*>(out), nullptr, 1, odist, flags);
+}
+
+template<>
+fftwTypeSpec<complexLT, long double>::planT fftw_plan_many_dft<complexLT, long double>( std::vector<int> n,
+                                                                                        int howmany,
+                                                                                        complexLT * in,
+                                                                                        int idist,
+                                                                                        long double * out,
+                                                                                        int odist,
+                                                                                        int sign,
+                                                                                        unsigned flags
+                                                                                      )
+{
+   static_cast<void>(sign);
+   return ::fftwl_plan_many_dft_c2r( n.size(), n.data(), howmany, reinterpret_cast<fftwl_complex*>(in), nullptr, 1, idist, out, nullptr, 1, odist, flags);
+}
+
+#ifdef HASQUAD
+template<>
+fftwTypeSpec<complexQT, complexQT>::planT fftw_plan_many_dft<complexQT, complexQT>( std::vector<int> n,
+                                                                                    int howmany,
+                                                                                    complexQT * in,
+                                                                                    int idist,
+                                                                                    complexQT * out,
+                                                                                    int odist,
+                                                                                    int sign,
+                                                                                    unsigned flags
+                                                                                  )
+{
+   return ::fftwq_plan_many_dft( n.size(), n.data(), howmany, reinterpret_cast<fftwq_complex*>(in), nullptr, 1, idist, reinterpret_cast<fftwq_complex*>(out), nullptr, 1, odist, sign, flags);
+}
+
+template<>
+fftwTypeSpec<__float128, complexQT>::planT fftw_plan_many_dft<__float128, complexQT>( std::vector<int> n,
+                                                                                      int howmany,
+                                                                                      __float128 * in,
+                                                                                      int idist,
+                                                                                      complexQT * out,
+                                                                                      int odist,
+                                                                                      int sign,
+                                                                                      unsigned flags
+                                                                                    )
+{
+   static_cast<void>(sign);
+   return ::fftwq_plan_many_dft_r2c( n.size(), n.data(), howmany, in, nullptr, 1, idist, reinterpret_cast<fftwq_complex*>(out), nullptr, 1, odist, flags);
+}
+
+template<>
+fftwTypeSpec<complexQT, __float128>::planT fftw_plan_many_dft<complexQT, __float128>( std::vector<int> n,
+                                                                                      int howmany,
+                                                                                      complexQT * in,
+                                                                                      int idist,
+                                                                                      __float128 * out,
+                                                                                      int odist,
+                                                                                      int sign,
+                                                                                      unsigned flags
+                                                                                    )
+{
+   static_cast<void>(sign);
+   return ::fftwq_plan_many_dft_c2r( n.size(), n.data(), howmany, reinterpret_cast<fftwq_complex*>(in), nullptr, 1, idist, out, nullptr, 1, odist, flags);
+}
+#endif
+
 template<>
 void fftw_cleanup<float>()
 {
@@ -0,0 +1,77 @@
+/** \file aoPSDs_test.cpp
+ */
+#include "../../../catch2/catch.hpp"
+
+#include <vector>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../../include/ao/analysis/aoPSDs.hpp"
+
+typedef double realT;
+
+using namespace mx::AO::analysis;
+
+/** Scenario: Evaluating the von Karman PSD from the filter table
+  * 
+  * Verify that the tabulated piston and tip/tilt filter meets its tolerance, and the vector evaluation.
+  * \anchor tests_ao_analysis_aoPSDs_vonKarmanTable
+  */
+SCENARIO( "Evaluating the von Karman PSD from the filter table", "[ao::analysis::aoPSDs]" ) 
+{
+   GIVEN("an atmosphere and a telescope")
+   {
+      aoAtmosphere<realT> atm;
+      atm.loadLCO();
+      
+      vonKarmanSpectrum<realT> psd(true, false, 6.5);
+      vonKarmanSpectrum<realT> psdTab(true, false, 6.5);
+      psdTab.useTable(true);
+      
+      std::vector<realT> k;
+      for(int n = 0; n < 20000; ++n) k.push_back(n*0.0013);
+      
+      WHEN("subtracting piston")
+      {
+         realT maxerr = 0;
+         for(size_t n = 1; n < k.size(); ++n)
+         {
+            realT P = psd(atm, k[n], 1.0);
+            realT err = fabs( psdTab(atm, k[n], 1.0) - P)/P;
+            if(err > maxerr) maxerr = err;
+         }
+         
+         REQUIRE(maxerr <= psdTab.tableTol());
+      }
+      WHEN("subtracting piston and tip/tilt")
+      {
+         psd.subTipTilt(true);
+         psdTab.subTipTilt(true);
+         
+         realT maxerr = 0;
+         for(size_t n = 1; n < k.size(); ++n)
+         {
+            realT P = psd(atm, k[n], 1.0);
+            realT err = fabs( psdTab(atm, k[n], 1.0) - P)/P;
+            if(err > maxerr) maxerr = err;
+         }
+         
+         REQUIRE(maxerr <= psdTab.tableTol());
+      }
+      WHEN("evaluating a vector of spatial frequencies")
+      {
+         std::vector<realT> P;
+         REQUIRE(psd(P, atm, k, 1.2) == 0);
+         REQUIRE(P.size() == k.size());
+         
+         realT maxerr = 0;
+         for(size_t n = 1; n < k.size(); ++n)
+         {
+            realT err = fabs( psd(atm, k[n], 1.2) - P[n])/P[n];
+            if(err > maxerr) maxerr = err;
+         }
+         
+         REQUIRE(maxerr < 1e-14);
+      }
+   }
+}
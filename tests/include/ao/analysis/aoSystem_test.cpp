@@ -6,6 +6,7 @@
 #define MX_NO_ERROR_REPORTS
 
 #include "../../../../include/ao/analysis/aoSystem.hpp"
+#include "../../../../include/improc/eigenImage.hpp"
 
 typedef double realT;
 
@@ -229,3 +230,77 @@ SCENARIO( "Loading aoSystem config settings", "[ao::analysis::aoSystem]" )
 }
 
          
+/** Scenario: Calculating the error budget and contrast maps
+  * 
+  * Verify that the grid based calculations match the single frequency functions.
+  * \anchor tests_ao_analysis_aoSystem_grid
+  */
+SCENARIO( "Calculating the error budget and contrast maps", "[ao::analysis::aoSystem]" ) 
+{
+   GIVEN("the MagAO-X system")
+   {
+      aoSystem<realT, mx::AO::analysis::vonKarmanSpectrum<realT>> aosys;
+      aosys.loadMagAOX();
+      aosys.starMag(5);
+      aosys.zeta(0.5);
+      aosys.fit_mn_max(40);
+      
+      WHEN("calculating the Strehl ratio with a square control region")
+      {
+         realT var = aosys.measurementError() + aosys.timeDelayError() + aosys.fittingError() + aosys.chromScintOPDError()
+                                + aosys.chromIndexError() + aosys.dispAnisoOPDError() + aosys.ncpError();
+            
+         REQUIRE(aosys.wfeVar() == Approx(var).epsilon(1e-10));
+         REQUIRE(aosys.strehl() == Approx(exp(-var)).epsilon(1e-10));
+      }
+      WHEN("calculating the Strehl ratio with a circular control region")
+      {
+         aosys.circularLimit(true);
+         
+         realT var = aosys.measurementError() + aosys.timeDelayError() + aosys.fittingError() + aosys.chromScintOPDError()
+                                + aosys.chromIndexError() + aosys.dispAnisoOPDError() + aosys.ncpError();
+            
+         REQUIRE(aosys.wfeVar() == Approx(var).epsilon(1e-10));
+      }
+      WHEN("calculating all of the contrast maps at once")
+      {
+         std::vector<mx::improc::eigenImage<realT>> ims(8);
+         std::vector<mx::improc::eigenImage<realT> *> maps(8);
+         std::vector<int> terms(8);
+         for(int t = 0; t < 8; ++t)
+         {
+            ims[t].resize(65,64);
+            maps[t] = &ims[t];
+            terms[t] = t;
+         }
+         
+         aosys.CMaps(maps, terms);
+         
+         typedef aoSystem<realT, mx::AO::analysis::vonKarmanSpectrum<realT>> aosysT;
+         realT (aosysT::*Cfuncs[])(realT, realT, bool) = { &aosysT::C0, &aosysT::C1, &aosysT::C2, &aosysT::C3, 
+                                                           &aosysT::C4, &aosysT::C5, &aosysT::C6, &aosysT::C7 };
+         
+         realT maxdiff = 0;
+         for(int t = 0; t < 8; ++t)
+         {
+            for(int i = 0; i < ims[t].rows(); ++i)
+            {
+               for(int j = 0; j < ims[t].cols(); ++j)
+               {
+                  realT C = (aosys.*Cfuncs[t])(i-32, j-31, true);
+                  realT d = fabs(ims[t](i,j) - C);
+                  if(C != 0) d /= fabs(C);
+                  if(d > maxdiff) maxdiff = d;
+               }
+            }
+         }
+         
+         REQUIRE(maxdiff < 1e-10);
+         
+         mx::improc::eigenImage<realT> im;
+         im.resize(65,64);
+         aosys.C2Map(im);
+         REQUIRE(im(10,5) == Approx(ims[2](10,5)).epsilon(1e-14));
+      }
+   }
+}
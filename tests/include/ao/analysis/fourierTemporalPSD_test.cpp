@@ -0,0 +1,158 @@
+/** \file fourierTemporalPSD_test.cpp
+ */
+#include "../../../catch2/catch.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include <unistd.h>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../../include/ao/analysis/fourierTemporalPSD.hpp"
+
+typedef double realT;
+
+using namespace mx::AO::analysis;
+
+typedef aoSystem<realT, vonKarmanSpectrum<realT>> aosysT;
+
+/** Scenario: Adaptive evaluation of temporal PSDs
+  *
+  * Verify that frequency-adaptive evaluation matches direct integration at every frequency.
+  *
+  * \anchor tests_ao_analysis_fourierTemporalPSD_adaptive
+  */
+SCENARIO( "Adaptive evaluation of temporal PSDs", "[ao::analysis::fourierTemporalPSD]" )
+{
+   GIVEN("the MagAO-X system")
+   {
+      aosysT aosys;
+      aosys.loadMagAOX();
+
+      fourierTemporalPSD<realT, aosysT> ftPSD;
+      ftPSD.m_aosys = &aosys;
+
+      std::vector<realT> freq;
+      mx::math::vectorScale(freq, 1000, 0.2, 0.2);
+
+      WHEN("adaptive evaluation is compared to the fixed grid")
+      {
+         std::vector<realT> psd0(freq.size()), psd1(freq.size());
+
+         ftPSD.multiLayerPSD<false>(psd0, freq, 5, 3, 1);
+
+         ftPSD.adaptive(true);
+         ftPSD.adaptiveStep(8);
+         ftPSD.adaptiveTol(1e-3);
+         REQUIRE(ftPSD.adaptive() == true);
+
+         ftPSD.multiLayerPSD<false>(psd1, freq, 5, 3, 1);
+
+         realT mxd = 0;
+         for(size_t i=0; i < freq.size(); ++i)
+         {
+            REQUIRE(psd0[i] > 0);
+            mxd = std::max(mxd, fabs(psd1[i] - psd0[i])/psd0[i]);
+         }
+
+         REQUIRE(mxd < 1e-2);
+      }
+   }
+}
+
+/** Scenario: Memoizing temporal PSD integrals
+  *
+  * Verify that memoized values are re-used, that a saved memo gives the same results when loaded, that identical memos
+  * give identical files, and that changing the system misses the memo.
+  *
+  * \anchor tests_ao_analysis_fourierTemporalPSD_memo
+  */
+SCENARIO( "Memoizing temporal PSD integrals", "[ao::analysis::fourierTemporalPSD]" )
+{
+   GIVEN("the MagAO-X system")
+   {
+      aosysT aosys;
+      aosys.loadMagAOX();
+
+      fourierTemporalPSD<realT, aosysT> ftPSD;
+      ftPSD.m_aosys = &aosys;
+      ftPSD.useMemo(true);
+
+      std::vector<realT> freq;
+      mx::math::vectorScale(freq, 200, 0.5, 0.5);
+
+      std::vector<realT> psd0(freq.size()), psd1(freq.size());
+
+      ftPSD.multiLayerPSD<false>(psd0, freq, 2, 1, -1);
+
+      size_t ms = ftPSD.memoSize();
+      REQUIRE(ms > 0);
+
+      char tmpl[] = "/tmp/mxlib_ftPSDMemo_XXXXXX";
+      int fd = mkstemp(tmpl);
+      REQUIRE(fd >= 0);
+      close(fd);
+      std::string fname0 = tmpl;
+      std::string fname1 = fname0 + "_1";
+
+      WHEN("the same PSD is calculated again")
+      {
+         ftPSD.multiLayerPSD<false>(psd1, freq, 2, 1, -1);
+
+         REQUIRE(ftPSD.memoSize() == ms);
+         for(size_t i=0; i < freq.size(); ++i) REQUIRE(psd1[i] == psd0[i]);
+      }
+
+      WHEN("the memo is saved and loaded")
+      {
+         REQUIRE(ftPSD.saveMemo(fname0) == 0);
+
+         fourierTemporalPSD<realT, aosysT> ftPSD2;
+         ftPSD2.m_aosys = &aosys;
+         ftPSD2.useMemo(true);
+
+         REQUIRE(ftPSD2.loadMemo(fname0) == 0);
+         REQUIRE(ftPSD2.memoSize() == ms);
+
+         ftPSD2.multiLayerPSD<false>(psd1, freq, 2, 1, -1);
+
+         REQUIRE(ftPSD2.memoSize() == ms);
+         for(size_t i=0; i < freq.size(); ++i) REQUIRE(psd1[i] == psd0[i]);
+
+         //The loaded memo was built in a different order, but must give the same file
+         REQUIRE(ftPSD2.saveMemo(fname1) == 0);
+
+         std::ifstream f0(fname0, std::ios::binary), f1(fname1, std::ios::binary);
+         std::vector<char> b0((std::istreambuf_iterator<char>(f0)), std::istreambuf_iterator<char>());
+         std::vector<char> b1((std::istreambuf_iterator<char>(f1)), std::istreambuf_iterator<char>());
+
+         REQUIRE(b0.size() == sizeof(uint64_t) + ms*(sizeof(uint64_t) + 6*sizeof(realT) + sizeof(int32_t)));
+         REQUIRE(b0 == b1);
+      }
+
+      WHEN("the filter table setting is changed")
+      {
+         aosys.psd.useTable(true);
+
+         ftPSD.multiLayerPSD<false>(psd1, freq, 2, 1, -1);
+
+         REQUIRE(ftPSD.memoSize() == 2*ms);
+      }
+
+      WHEN("the diameter is changed")
+      {
+         aosys.D(aosys.D()*1.1);
+
+         ftPSD.multiLayerPSD<false>(psd1, freq, 2, 1, -1);
+
+         REQUIRE(ftPSD.memoSize() == 2*ms);
+      }
+
+      remove(fname0.c_str());
+      remove(fname1.c_str());
+   }
+}
@@ -0,0 +1,171 @@
+/** \file sweep_test.cpp
+ */
+#include "../../catch2/catch.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include <unistd.h>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../include/app/application.hpp"
+#include "../../../include/ioutils/readColumns.hpp"
+
+namespace sweepTest
+{
+
+//An application which computes a*b, sharing an offset set up once for the sweep.
+class sweepApp : public mx::app::application
+{
+public:
+   int m_a {0};
+   double m_b {0};
+   double m_offset {0};
+
+   sweepApp()
+   {
+      m_allowSweep = true;
+   }
+
+   virtual void setupConfig()
+   {
+      config.add("a", "", "a", mx::app::argType::Required, "", "a", false, "int", "");
+      config.add("b", "", "b", mx::app::argType::Required, "", "b", false, "real", "");
+   }
+
+   virtual void loadConfig()
+   {
+      config(m_a, "a");
+      config(m_b, "b");
+   }
+
+   virtual mx::app::application * newSweepJob()
+   {
+      return new sweepApp;
+   }
+
+   virtual int setupSweep()
+   {
+      m_offset = 0.5;
+      return 0;
+   }
+
+   virtual int execute()
+   {
+      const sweepApp * parent = static_cast<const sweepApp *>(sweepParent());
+
+      sweepResult("prod", m_a*m_b + parent->m_offset);
+
+      return m_a;
+   }
+};
+
+} //namespace sweepTest
+
+/** Verify parsing and expanding sweep specifications
+  *
+  * \anchor tests_app_sweep_spec
+  */
+SCENARIO( "Parsing and expanding sweep specifications", "[app::sweep]" )
+{
+   using namespace mx::app;
+
+   GIVEN("a list and a range")
+   {
+      WHEN("the range is integer")
+      {
+         std::vector<sweepParam> params;
+         REQUIRE(parseSweepSpec(params, "method=fast,slow; n=2:8:3") == 0);
+
+         REQUIRE(params.size() == 2);
+         REQUIRE(params[0].m_name == "method");
+         REQUIRE(params[0].m_values.size() == 2);
+         REQUIRE(params[0].m_values[1] == "slow");
+         REQUIRE(params[1].m_name == "n");
+         REQUIRE(params[1].m_values.size() == 3);
+         REQUIRE(params[1].m_values[0] == "2");
+         REQUIRE(params[1].m_values[2] == "8");
+
+         std::vector<sweepJob> jobs;
+         expandSweep(jobs, params);
+
+         REQUIRE(jobs.size() == 6);
+         REQUIRE(jobs[0].m_settings[0].second == "fast");
+         REQUIRE(jobs[0].m_settings[1].second == "2");
+         REQUIRE(jobs[1].m_settings[0].second == "fast");
+         REQUIRE(jobs[1].m_settings[1].second == "5");
+         REQUIRE(jobs[5].m_settings[0].second == "slow");
+         REQUIRE(jobs[5].m_settings[1].second == "8");
+      }
+
+      WHEN("the range is real and stop is reached with round-off")
+      {
+         std::vector<sweepParam> params;
+         REQUIRE(parseSweepSpec(params, "x=0:0.3:0.1") == 0);
+
+         REQUIRE(params[0].m_values.size() == 4);
+         REQUIRE(params[0].m_values[1] == "0.1");
+         REQUIRE(params[0].m_values[3] == "0.3");
+      }
+   }
+
+   GIVEN("invalid specifications")
+   {
+      WHEN("various errors")
+      {
+         std::vector<sweepParam> params;
+         REQUIRE(parseSweepSpec(params, "x") == -1);
+         REQUIRE(parseSweepSpec(params, "x=1:2") == -1);
+         REQUIRE(parseSweepSpec(params, "x=2:1:1") == -1);
+         REQUIRE(parseSweepSpec(params, "x=1,2;x=3") == -1);
+      }
+   }
+}
+
+/** Verify running a sweep from the command line
+  *
+  * \anchor tests_app_sweep_run
+  */
+SCENARIO( "Running a parameter sweep", "[app::sweep]" )
+{
+   GIVEN("an application which allows sweeps")
+   {
+      WHEN("two targets are swept")
+      {
+         char tmpl[] = "/tmp/mxlib_sweep_XXXXXX";
+         int fd = mkstemp(tmpl);
+         REQUIRE(fd >= 0);
+         close(fd);
+         std::string fname = tmpl;
+         std::string outArg = "--sweepOutput=" + fname;
+
+         const char * args[] = {"sweepTest", "--b=2", "--sweep=a=1:3:1", "--sweep=b=0.5,4", "--sweepThreads=3", outArg.c_str()};
+         char * argv[6];
+         for(int n=0; n < 6; ++n) argv[n] = const_cast<char *>(args[n]);
+
+         sweepTest::sweepApp app;
+         REQUIRE(app.main(6, argv) == 0);
+
+         std::vector<int> job, status, a;
+         std::vector<double> time, b, prod;
+         REQUIRE(mx::ioutils::readColumns(fname, job, status, time, a, b, prod) == 0);
+
+         REQUIRE(job.size() == 6);
+         for(size_t n=0; n < job.size(); ++n)
+         {
+            REQUIRE(job[n] == (int) n);
+            REQUIRE(status[n] == a[n]);
+            REQUIRE(prod[n] == Approx(a[n]*b[n] + 0.5));
+         }
+
+         REQUIRE(a[0] == 1);
+         REQUIRE(b[0] == 0.5);
+         REQUIRE(a[5] == 3);
+         REQUIRE(b[5] == 4);
+
+         remove(fname.c_str());
+      }
+   }
+}
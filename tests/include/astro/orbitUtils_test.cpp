@@ -0,0 +1,155 @@
+/** \file orbitUtils_test.cpp
+ */
+#include "../../catch2/catch.hpp"
+
+#include <vector>
+#include <random>
+#include <limits>
+
+#include "../../../include/astro/orbitUtils.hpp"
+
+/** Scenario: solving Kepler's equation in batches
+  *
+  * Verify that the fixed-iteration batch solver satisfies Kepler's equation to near machine precision.
+  *
+  * \anchor tests_astro_kepler_batch
+  */
+SCENARIO( "solving Kepler's equation in batches", "[astro::kepler]" )
+{
+   GIVEN("a population of elliptical orbits")
+   {
+      WHEN("eccentricities up to 0.999, and a wide range of mean anomalies")
+      {
+         std::mt19937_64 gen(1);
+         std::uniform_real_distribution<double> ud(0,1);
+
+         size_t N = 100000;
+         std::vector<double> e(N), M(N), E(N);
+         for(size_t k=0; k < N; ++k)
+         {
+            e[k] = 0.999*ud(gen);
+            M[k] = -50 + 100*ud(gen);
+         }
+
+         //Near pericenter at high eccentricity is the hardest case
+         e[0] = 0.999;
+         M[0] = 1e-6;
+         e[1] = 0;
+         M[1] = 0;
+
+         mx::astro::keplerStarterTable<double> tab;
+         mx::astro::solve_kepler_batch(E.data(), e.data(), M.data(), N, tab);
+
+         double maxres = 0;
+         for(size_t k=0; k < N; ++k)
+         {
+            double res = fabs(E[k] - e[k]*sin(E[k]) - M[k]);
+            if(res > maxres) maxres = res;
+         }
+
+         REQUIRE(maxres < 1e-12);
+      }
+      WHEN("mean anomalies just outside [0, 2pi)")
+      {
+         const double two_pi = 6.28318530717958647692528676655900577;
+
+         mx::astro::keplerStarterTable<double> tab;
+
+         //Far enough outside that the unclamped grid index would be below -1
+         REQUIRE(fabs(tab(0.9, -1e-6)) < 1e-4);
+         REQUIRE(fabs(tab(0.9, two_pi + 1e-6) - two_pi) < 1e-4);
+
+         std::vector<double> e, M;
+         for(int n = -3; n <= 3; ++n)
+         {
+            double M0 = n*two_pi;
+            for(int k = -4; k <= 4; ++k)
+            {
+               e.push_back(0.9);
+               M.push_back(M0 + k*std::max(fabs(M0), 1.0)*std::numeric_limits<double>::epsilon());
+            }
+         }
+
+         std::vector<double> E(M.size());
+         mx::astro::solve_kepler_batch(E.data(), e.data(), M.data(), M.size(), tab);
+
+         for(size_t k=0; k < M.size(); ++k)
+         {
+            REQUIRE(fabs(E[k] - e[k]*sin(E[k]) - M[k]) < 1e-12);
+         }
+      }
+   }
+}
+
+/** Scenario: calculating positions for a population of orbits
+  *
+  * Verify that orbitCartesianPopulation matches orbitCartesianWork for each orbit.
+  *
+  * \anchor tests_astro_orbitUtils_population
+  */
+SCENARIO( "calculating positions for a population of orbits", "[astro::orbitUtils]" )
+{
+   GIVEN("a random population of orbits")
+   {
+      WHEN("several epochs")
+      {
+         std::mt19937_64 gen(2);
+         std::uniform_real_distribution<double> ud(0,1);
+
+         size_t Norb = 500;
+         mx::astro::orbitPopulation<double> pop;
+         pop.resize(Norb);
+
+         for(size_t k=0; k < Norb; ++k)
+         {
+            pop.m_a[k] = 1 + 10*ud(gen);
+            pop.m_P[k] = 1 + 20*ud(gen);
+            pop.m_e[k] = 0.95*ud(gen);
+            pop.m_t0[k] = 10*ud(gen);
+            pop.m_i[k] = 3.14*ud(gen);
+            pop.m_w[k] = 6.28*ud(gen);
+            pop.m_W[k] = 6.28*ud(gen);
+         }
+         pop.m_e[0] = 0;
+
+         std::vector<double> t(37);
+         for(size_t j=0; j < t.size(); ++j) t[j] = -5 + 0.77*j;
+
+         size_t Nt = t.size();
+         std::vector<double> x(Norb*Nt), y(Norb*Nt), z(Norb*Nt), r(Norb*Nt), rProj(Norb*Nt), f(Norb*Nt), cos_alf(Norb*Nt), phi(Norb*Nt);
+
+         int rv = mx::astro::orbitCartesianPopulation( x.data(), y.data(), z.data(), r.data(), rProj.data(), f.data(), cos_alf.data(), phi.data(),
+                                                        t.data(), Nt, pop);
+         REQUIRE(rv == 0);
+
+         std::vector<double> x0(Nt), y0(Nt), z0(Nt), r0(Nt), rProj0(Nt), f0(Nt), cos_alf0(Nt), phi0(Nt);
+
+         double maxdiff = 0;
+         double maxfdiff = 0;
+         for(size_t k=0; k < Norb; ++k)
+         {
+            mx::astro::orbitCartesianWork( &x0, &y0, &z0, &r0, &rProj0, &f0, &cos_alf0, &phi0, t, Nt, pop.m_a[k], pop.m_P[k], pop.m_e[k],
+                                           pop.m_t0[k], pop.m_i[k], pop.m_w[k], pop.m_W[k]);
+
+            for(size_t j=0; j < Nt; ++j)
+            {
+               size_t n = k*Nt + j;
+               maxdiff = std::max(maxdiff, fabs(x[n] - x0[j])/pop.m_a[k]);
+               maxdiff = std::max(maxdiff, fabs(y[n] - y0[j])/pop.m_a[k]);
+               maxdiff = std::max(maxdiff, fabs(z[n] - z0[j])/pop.m_a[k]);
+               maxdiff = std::max(maxdiff, fabs(r[n] - r0[j])/pop.m_a[k]);
+               maxdiff = std::max(maxdiff, fabs(rProj[n] - rProj0[j])/pop.m_a[k]);
+               maxdiff = std::max(maxdiff, fabs(cos_alf[n] - cos_alf0[j]));
+               maxdiff = std::max(maxdiff, fabs(phi[n] - phi0[j]));
+
+               //f is only defined modulo 2pi
+               maxfdiff = std::max(maxfdiff, fabs(sin(0.5*(f[n] - f0[j]))));
+            }
+         }
+
+         //The scalar solver converges to 1e-8
+         REQUIRE(maxdiff < 1e-7);
+         REQUIRE(maxfdiff < 1e-7);
+      }
+   }
+}
@@ -0,0 +1,129 @@
+/** \file spectrumCache_test.cpp
+ */
+#include "../../catch2/catch.hpp"
+
+#include <fstream>
+#include <vector>
+
+#include <stdlib.h>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../include/astro/astroSpectrum.hpp"
+#include "../../../include/astro/astroSpectra.hpp"
+
+/** Scenario: caching a library of spectra
+  *
+  * Verify that spectra loaded from a spectrumCache match those read from disk.
+  *
+  * \anchor tests_astro_spectrumCache
+  */
+SCENARIO( "caching a library of spectra", "[astro::spectrumCache]" )
+{
+   GIVEN("a directory of two-column spectra")
+   {
+      typedef mx::astro::basicSpectrum<mx::astro::units::si<double>> specT;
+
+      char tmpl[] = "/tmp/mxlib_spectrumCache_XXXXXX";
+      std::string dir = mkdtemp(tmpl);
+
+      std::vector<std::string> names = {"specA.dat", "specB.dat", "specC.dat"};
+
+      for(size_t n=0; n < names.size(); ++n)
+      {
+         std::ofstream fout(dir + "/" + names[n]);
+         fout.precision(17);
+         for(size_t i=0; i < 200 + 10*n; ++i)
+         {
+            double lam = 0.5e-6 + i*0.01e-6;
+            fout << lam << " " << (n+1)*exp(-pow((lam-1e-6)/(0.3e-6),2)) + 0.001*i << "\n";
+         }
+      }
+
+      std::string cacheFile = dir + "/spectra.mxspc";
+
+      WHEN("the cache is written and opened")
+      {
+         REQUIRE(mx::astro::spectrumCache<double>::write<specT>(cacheFile, names, dir) == 0);
+
+         mx::astro::spectrumCache<double> cache(cacheFile);
+
+         REQUIRE(cache.size() == names.size());
+         REQUIRE(cache.has("specB.dat"));
+         REQUIRE(!cache.has("specD.dat"));
+
+         const double * lam, * sp;
+         size_t N;
+         REQUIRE(cache.raw(lam, sp, N, "specC.dat") == 0);
+         REQUIRE(N == 220);
+         REQUIRE(lam[0] == Approx(0.5e-6));
+
+         std::vector<double> grid(100);
+         for(size_t i=0; i < grid.size(); ++i) grid[i] = 0.55e-6 + i*0.0123e-6;
+
+         for(size_t n=0; n < names.size(); ++n)
+         {
+            mx::astro::astroSpectrum<specT> spDisk(names[n], dir);
+            spDisk.setSpectrum(grid);
+
+            mx::astro::astroSpectrum<specT> spCache(names[n], dir);
+            REQUIRE(spCache.setSpectrum(grid, cache) == 0);
+
+            //And a second time, from the memoized resampling
+            mx::astro::astroSpectrum<specT> spMemo(names[n], dir);
+            REQUIRE(spMemo.setSpectrum(grid, cache) == 0);
+
+            REQUIRE(spCache.size() == grid.size());
+            for(size_t i=0; i < grid.size(); ++i)
+            {
+               REQUIRE(spCache[i] == Approx(spDisk[i]));
+               REQUIRE(spMemo[i] == spCache[i]);
+            }
+         }
+      }
+
+      WHEN("the spectra share a wavelength grid")
+      {
+         std::vector<std::string> snames = {"specS0.dat", "specS1.dat", "specS2.dat"};
+
+         for(size_t n=0; n < snames.size(); ++n)
+         {
+            std::ofstream fout(dir + "/" + snames[n]);
+            fout.precision(17);
+            for(size_t i=0; i < 150; ++i)
+            {
+               fout << 0.5e-6 + i*0.01e-6 << " " << (n+1)*0.5 + 0.002*i << "\n";
+            }
+         }
+
+         REQUIRE(mx::astro::spectrumCache<double>::write<specT>(cacheFile, snames, dir) == 0);
+
+         //Header, index, names padded to 8 bytes, one wavelength grid, and three spectra
+         std::ifstream fin(cacheFile, std::ios::binary | std::ios::ate);
+         REQUIRE(static_cast<size_t>(fin.tellg()) == 24 + 3*40 + 32 + 150*8 + 3*150*8);
+
+         mx::astro::spectrumCache<double> cache(cacheFile);
+         REQUIRE(cache.size() == snames.size());
+
+         const double * lam0, * sp0, * lam, * sp;
+         size_t N0, N;
+         REQUIRE(cache.raw(lam0, sp0, N0, "specS0.dat") == 0);
+         REQUIRE(N0 == 150);
+
+         for(size_t n=0; n < snames.size(); ++n)
+         {
+            REQUIRE(cache.raw(lam, sp, N, snames[n]) == 0);
+            REQUIRE(N == N0);
+            REQUIRE(lam == lam0);
+            REQUIRE(lam[149] == Approx(0.5e-6 + 149*0.01e-6));
+            REQUIRE(sp[10] == Approx((n+1)*0.5 + 0.02));
+         }
+
+         for(size_t n=0; n < snames.size(); ++n) remove((dir + "/" + snames[n]).c_str());
+      }
+
+      for(size_t n=0; n < names.size(); ++n) remove((dir + "/" + names[n]).c_str());
+      remove(cacheFile.c_str());
+      rmdir(dir.c_str());
+   }
+}
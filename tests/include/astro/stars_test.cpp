@@ -0,0 +1,74 @@
+/** \file stars_test.cpp
+ */
+#include "../../catch2/catch.hpp"
+
+#include <vector>
+#include <string>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../include/astro/stars.hpp"
+
+/** Scenario: batch main sequence queries
+  *
+  * Verify that the table-based batch queries match the scalar interpolators.
+  *
+  * \anchor tests_astro_stars_mainSequence_batch
+  */
+SCENARIO( "batch main sequence queries", "[astro::stars]" )
+{
+   GIVEN("the main sequence")
+   {
+      mx::astro::mainSequence<double> ms;
+
+      WHEN("numeric spectral types across and beyond the range")
+      {
+         std::vector<double> nums;
+         for(double x = -1; x <= 95; x += 0.05) nums.push_back(x);
+
+         std::vector<double> vals;
+
+         ms.Teff(vals, nums);
+         for(size_t k=0; k < nums.size(); ++k) REQUIRE(vals[k] == Approx(ms.Teff(nums[k])).margin(1e-10));
+
+         ms.radius(vals, nums);
+         for(size_t k=0; k < nums.size(); ++k) REQUIRE(vals[k] == Approx(ms.radius(nums[k])).margin(1e-10));
+
+         ms.logL(vals, nums);
+         for(size_t k=0; k < nums.size(); ++k) REQUIRE(vals[k] == Approx(ms.logL(nums[k])).margin(1e-10));
+
+         ms.Mv(vals, nums);
+         for(size_t k=0; k < nums.size(); ++k) REQUIRE(vals[k] == Approx(ms.Mv(nums[k])).margin(1e-10));
+
+         ms.V_Ks(vals, nums);
+         for(size_t k=0; k < nums.size(); ++k) REQUIRE(vals[k] == Approx(ms.V_Ks(nums[k])).margin(1e-10));
+
+         ms.H_Ks(vals, nums);
+         for(size_t k=0; k < nums.size(); ++k) REQUIRE(vals[k] == Approx(ms.H_Ks(nums[k])).margin(1e-10));
+      }
+
+      WHEN("spectral type strings, with repeats")
+      {
+         std::vector<std::string> spTypes = {"G2V", "M4.5V", "A0", "K7V", "G2V", "B9.5V", "X1", "F5IV", "M4.5V"};
+
+         std::vector<double> vals;
+         ms.Teff(vals, spTypes);
+
+         for(size_t k=0; k < spTypes.size(); ++k) REQUIRE(vals[k] == Approx(ms.Teff(spTypes[k])));
+
+         REQUIRE(vals[0] == Approx(5770));
+         REQUIRE(vals[6] == -999);
+      }
+
+      WHEN("effective temperatures")
+      {
+         std::vector<double> Teffs;
+         for(double T = 200; T <= 50000; T *= 1.01) Teffs.push_back(T);
+
+         std::vector<double> spTs;
+         ms.spTFromTeff(spTs, Teffs);
+
+         for(size_t k=0; k < Teffs.size(); ++k) REQUIRE(spTs[k] == Approx(ms.spTFromTeff(Teffs[k])));
+      }
+   }
+}
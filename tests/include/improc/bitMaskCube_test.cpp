@@ -0,0 +1,133 @@
+/** \file bitMaskCube_test.cpp
+ */
+#include "../../catch2/catch.hpp"
+
+#include <cmath>
+#include <Eigen/Dense>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../include/improc/eigenImage.hpp"
+#include "../../../include/improc/eigenCube.hpp"
+#include "../../../include/improc/bitMaskCube.hpp"
+
+/** Scenario: Using a bit-packed mask cube
+  *
+  * Verifies packing and unpacking, and that eigenCube::mean and sigmaMean give the same results with a bitMaskCube as
+  * with the equivalent eigenCube of masks.
+  *
+  * \anchor tests_improc_bitMaskCube
+  */
+SCENARIO( "Using a bit-packed mask cube", "[improc::bitMaskCube]" )
+{
+   GIVEN("three masks shared by 7 planes")
+   {
+      //An odd size so the masks do not fill whole words
+      int rows = 13, cols = 11, planes = 7;
+
+      std::vector<mx::improc::eigenImage<double>> masks(3);
+      for(size_t m=0; m < masks.size(); ++m)
+      {
+         masks[m].resize(rows, cols);
+         for(int i=0; i < rows; ++i)
+         {
+            for(int j=0; j < cols; ++j)
+            {
+               masks[m](i,j) = ((i*3 + j*5 + m*7) % 4 != 0);
+            }
+         }
+      }
+
+      mx::improc::bitMaskCube bmc(rows, cols, planes);
+      for(size_t m=0; m < masks.size(); ++m) REQUIRE(bmc.addMask(masks[m]) == (int) m);
+      REQUIRE(bmc.nMasks() == 3);
+
+      mx::improc::eigenCube<double> dmc(rows, cols, planes);
+      for(int k=0; k < planes; ++k)
+      {
+         bmc.setMask(k, (k*2) % 3);
+         dmc.image(k) = masks[(k*2) % 3];
+      }
+
+      WHEN("unpacking")
+      {
+         mx::improc::eigenCube<double> umc;
+         bmc.cube(umc);
+
+         REQUIRE(umc.planes() == planes);
+         for(int k=0; k < planes; ++k)
+         {
+            REQUIRE( (umc.image(k) - dmc.image(k)).abs().maxCoeff() == 0 );
+            REQUIRE( bmc.good(5,7,k) == (dmc.image(k)(5,7) == 1) );
+         }
+      }
+
+      WHEN("calculating masked means")
+      {
+         mx::improc::eigenCube<double> ims(rows, cols, planes);
+         for(int k=0; k < planes; ++k)
+         {
+            for(int i=0; i < rows; ++i)
+            {
+               for(int j=0; j < cols; ++j)
+               {
+                  ims.image(k)(i,j) = sin(0.3*i + 0.7*j + 1.1*k) + ((k == 3 && i == 2) ? 50 : 0);
+               }
+            }
+         }
+
+         std::vector<double> weights = {1, 2, 0.5, 1, 3, 1, 0.25};
+
+         mx::improc::eigenImage<double> m0, m1;
+
+         //Pixels bad in mask 0 are good in only 4 of 7 planes, so are NaN-ed
+         ims.mean(m0, dmc, 0.6);
+         ims.mean(m1, bmc, 0.6);
+         REQUIRE( (m0.isNaN() == m1.isNaN()).all() );
+         REQUIRE( (m0.isNaN()).any() );
+         REQUIRE( m0.isNaN().select(0, m0 - m1).abs().maxCoeff() == 0 );
+
+         ims.mean(m0, weights, dmc);
+         ims.mean(m1, weights, bmc);
+         REQUIRE( (m0 - m1).abs().maxCoeff() == 0 );
+
+         ims.sigmaMean(m0, dmc, 2.0);
+         ims.sigmaMean(m1, bmc, 2.0);
+         REQUIRE( (m0 - m1).abs().maxCoeff() == 0 );
+
+         ims.sigmaMean(m0, weights, dmc, 2.0);
+         ims.sigmaMean(m1, weights, bmc, 2.0);
+         REQUIRE( (m0 - m1).abs().maxCoeff() == 0 );
+      }
+
+      WHEN("filling reserved masks in parallel")
+      {
+         mx::improc::bitMaskCube pmc(rows, cols, planes);
+         REQUIRE(pmc.addMasks(3) == 0);
+         REQUIRE(pmc.nMasks() == 3);
+
+         #pragma omp parallel for
+         for(int m=0; m < 3; ++m)
+         {
+            pmc.fillMask(m, masks[m]);
+         }
+
+         for(int k=0; k < planes; ++k) pmc.setMask(k, (k*2) % 3);
+
+         mx::improc::eigenCube<double> umc;
+         pmc.cube(umc);
+
+         for(int k=0; k < planes; ++k)
+         {
+            REQUIRE( (umc.image(k) - dmc.image(k)).abs().maxCoeff() == 0 );
+         }
+      }
+
+      WHEN("setting an invalid mask")
+      {
+         REQUIRE_THROWS_AS(bmc.setMask(0, 3), mx::err::invalidarg);
+         REQUIRE_THROWS_AS(bmc.setMask(7, 0), mx::err::invalidarg);
+         REQUIRE_THROWS_AS(bmc.fillMask(3, masks[0]), mx::err::invalidarg);
+      }
+   }
+}
@@ -0,0 +1,113 @@
+/** \file fakeInjector_test.cpp
+ */
+#include "../../catch2/catch.hpp"
+
+#include <vector>
+#include <Eigen/Dense>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../include/improc/eigenImage.hpp"
+#include "../../../include/improc/imageTransforms.hpp"
+#include "../../../include/improc/imagePads.hpp"
+#include "../../../include/improc/fakeInjector.hpp"
+
+/** Scenario: Injecting fakes from a stamp
+  *
+  * Compares fakeInjector to adding the result of imageShift of the padded PSF.
+  *
+  * \anchor tests_improc_fakeInjector
+  */
+SCENARIO( "Injecting fakes from a stamp", "[improc::fakeInjector]" )
+{
+   GIVEN("a compact PSF smaller than the images")
+   {
+      //A PSF with compact, asymmetric support
+      mx::improc::eigenImage<double> psf(21,21), ppsf, shifted;
+      psf.setZero();
+      for(int i=4; i < 17; ++i)
+      {
+         for(int j=5; j < 15; ++j)
+         {
+            double x = i - 10.2, y = j - 9.7;
+            psf(i,j) = exp(-(x*x + 1.3*y*y)/6.0);
+         }
+      }
+
+      mx::improc::padImage(ppsf, psf, 0.5*(64-21), 0);
+      REQUIRE(ppsf.rows() == 63);
+
+      mx::improc::fakeInjector<double> fi;
+      REQUIRE(fi.setPSF(psf, 63, 63) == 0);
+      REQUIRE(fi.stamp().rows() == 13 + 6);
+      REQUIRE(fi.stamp().cols() == 10 + 6);
+
+      WHEN("several planets, with fractional and whole pixel shifts")
+      {
+         std::vector<double> dx = {10.3, -12.77, 4, -3.5};
+         std::vector<double> dy = {-7.6, 13.01, -9, 0.25};
+         std::vector<double> amp = {1e-3, 2.5, 1, -0.5};
+
+         mx::improc::eigenImage<double> im0(63,63), im1;
+         for(int i=0; i < 63; ++i) for(int j=0; j < 63; ++j) im0(i,j) = 0.01*i - 0.02*j;
+         im1 = im0;
+
+         for(size_t n=0; n < dx.size(); ++n)
+         {
+            shifted.resize(63,63);
+            mx::improc::imageShift(shifted, ppsf, dx[n], dy[n], mx::improc::cubicConvolTransform<double>());
+            im0 += amp[n]*shifted;
+         }
+
+         fi.inject(im1.data(), dx, dy, amp);
+
+         REQUIRE( (im0-im1).abs().maxCoeff() < 1e-12 );
+      }
+   }
+
+   GIVEN("a PSF larger than the images")
+   {
+      mx::improc::eigenImage<float> psf(80,80), cpsf, shifted;
+      psf.setZero();
+      for(int i=30; i < 50; ++i)
+      {
+         for(int j=33; j < 47; ++j)
+         {
+            float x = i - 39.5, y = j - 40.1;
+            psf(i,j) = exp(-(x*x + y*y)/8.0);
+         }
+      }
+
+      mx::improc::cutPaddedImage(cpsf, psf, 0.5*(80-50));
+
+      WHEN("the stamp is limited")
+      {
+         mx::improc::fakeInjector<float> fi;
+         REQUIRE(fi.setPSF(psf, 50, 50, 12) == 0);
+         REQUIRE(fi.stamp().rows() == 12 + 6);
+         REQUIRE(fi.stamp().cols() == 12 + 6);
+
+         mx::improc::eigenImage<float> im0(50,50), im1(50,50);
+         im1.setZero();
+
+         //Compare to the same stamp, shifted by imageShift
+         mx::improc::eigenImage<float> spsf(50,50);
+         spsf.setZero();
+         spsf.block(19,19,12,12) = cpsf.block(19,19,12,12);
+
+         im0.resize(50,50);
+         mx::improc::imageShift(im0, spsf, 5.3f, -2.2f, mx::improc::cubicConvolTransform<float>());
+
+         fi.inject(im1.data(), 5.3f, -2.2f, 1.0f);
+
+         REQUIRE( (im0-im1).abs().maxCoeff() < 1e-6 );
+      }
+
+      WHEN("the PSF is larger in one direction only")
+      {
+         mx::improc::eigenImage<float> bad(80,40);
+         mx::improc::fakeInjector<float> fi;
+         REQUIRE_THROWS_AS(fi.setPSF(bad, 50, 50), mx::err::sizeerr);
+      }
+   }
+}
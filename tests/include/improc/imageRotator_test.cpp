@@ -0,0 +1,108 @@
+/** \file imageRotator_test.cpp
+ */
+#include "../../catch2/catch.hpp"
+
+#include <vector>
+#include <Eigen/Dense>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../include/math/func/gaussian.hpp"
+
+#include "../../../include/improc/eigenImage.hpp"
+#include "../../../include/improc/eigenCube.hpp"
+#include "../../../include/improc/imageTransforms.hpp"
+#include "../../../include/improc/imageRotator.hpp"
+
+/** Scenario: Verify the planned image rotations
+  * 
+  * Compares imageRotator to imageRotate.
+  * 
+  * \anchor tests_improc_imageRotator_rotate
+  */
+SCENARIO( "Verify planned image rotations", "[improc::imageRotator]" ) 
+{
+   GIVEN("a Gaussian image")
+   {
+      mx::improc::eigenImage<double> im, rot0, rot1;
+      im.resize(64,64);
+
+      //An off-center Gaussian so that rotations are not trivial
+      mx::math::func::gaussian2D<double>(im.data(), im.rows(), im.cols(), 0., 1.0, 40.0, 25.0, 3);
+
+      WHEN("cubic convolution, 0.3 rad")
+      {
+         mx::improc::imageRotate(rot0, im, 0.3, mx::improc::cubicConvolTransform<double>());
+
+         mx::improc::imageRotator<double> rotator;
+         rotator.plan(im.rows(), im.cols(), 0.3);
+         rotator.rotate(rot1, im);
+
+         REQUIRE( (rot0-rot1).abs().maxCoeff() < 1e-12 );
+      }
+      WHEN("cubic convolution, -2.1 rad, non-square")
+      {
+         mx::improc::eigenImage<double> ims = im.block(0,0,64,60);
+         mx::improc::imageRotate(rot0, ims, -2.1, mx::improc::cubicConvolTransform<double>());
+
+         mx::improc::imageRotator<double> rotator;
+         rotator.plan(ims.rows(), ims.cols(), -2.1);
+         rotator.rotate(rot1, ims);
+
+         REQUIRE( (rot0-rot1).abs().maxCoeff() < 1e-12 );
+      }
+      WHEN("cubic convolution, smaller than the kernel")
+      {
+         //No output pixel has its 4x4 source block inside the image
+         mx::improc::eigenImage<double> ims = im.block(30,20,5,3);
+
+         mx::improc::imageRotator<double> rotator;
+         rotator.plan(ims.rows(), ims.cols(), 0.3);
+         rotator.rotate(rot1, ims);
+
+         REQUIRE( rot1.rows() == 5 );
+         REQUIRE( rot1.cols() == 3 );
+         REQUIRE( rot1.abs().maxCoeff() == 0 );
+      }
+      WHEN("cubic convolution, a plane of several cubes")
+      {
+         mx::improc::imageRotator<double> rotator;
+         rotator.plan(im.rows(), im.cols(), 0.3);
+         rotator.rotate(rot0, im);
+
+         std::vector<mx::improc::eigenCube<double>> cubes(3);
+         for(size_t n=0; n < cubes.size(); ++n)
+         {
+            cubes[n].resize(im.rows(), im.cols(), 2);
+            cubes[n].image(0) = (n+1.0)*im;
+            cubes[n].image(1) = im;
+         }
+
+         rotator.rotate(cubes, 0);
+
+         for(size_t n=0; n < cubes.size(); ++n)
+         {
+            REQUIRE( (cubes[n].image(0) - (n+1.0)*rot0).abs().maxCoeff() < 1e-12 );
+            REQUIRE( (cubes[n].image(1) - im).abs().maxCoeff() == 0 );
+         }
+      }
+      WHEN("FFT shear, 2.5 rad")
+      {
+         //The analytic rotated Gaussian
+         double q = 2.5;
+         double c = 31.5;
+         double x0 = cos(q)*(40.0-c) - sin(q)*(25.0-c) + c;
+         double y0 = sin(q)*(40.0-c) + cos(q)*(25.0-c) + c;
+
+         rot0.resize(im.rows(), im.cols());
+         mx::math::func::gaussian2D<double>(rot0.data(), rot0.rows(), rot0.cols(), 0., 1.0, x0, y0, 3);
+
+         mx::improc::imageRotator<double> rotator(mx::improc::imageRotator<double>::fftShear);
+         rotator.plan(im.rows(), im.cols(), q);
+         rotator.rotate(rot1, im);
+
+         REQUIRE( (rot0-rot1).abs().maxCoeff() < 1e-8 );
+         REQUIRE( rot1.sum() == Approx(im.sum()) );
+      }
+   }
+}
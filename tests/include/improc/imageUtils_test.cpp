@@ -52,3 +52,116 @@ SCENARIO( "Verify center of light calculation", "[improc::imageCenterOfLight]" )
 
          
 
+
+/** Scenario: zeroing NaNs and calculating statistics of a cube
+  * 
+  * Verify the vectorized NaN and statistics kernels against direct calculations
+  * 
+  * \anchor tests_improc_imageUtils_zeroNaNsStats
+  */
+SCENARIO( "Verify NaN zeroing and cube statistics", "[improc::zeroNaNsStats]" ) 
+{
+   GIVEN("a cube with NaNs and infinities")
+   {
+      mx::improc::eigenCube<float> cube(32,32,5);
+      for(size_t n=0; n < 32*32*5; ++n) cube.data()[n] = 1000 + 10*sin(0.1*n) + 0.001*n;
+
+      cube.data()[10] = std::numeric_limits<float>::quiet_NaN();
+      cube.data()[1000] = std::numeric_limits<float>::infinity();
+      cube.data()[2000] = -std::numeric_limits<float>::infinity();
+      cube.data()[3000] = std::numeric_limits<float>::denorm_min();
+
+      WHEN("zeroing NaNs")
+      {
+         mx::improc::eigenCube<float> c2(32,32,5);
+         for(size_t n=0; n < 32*32*5; ++n) c2.data()[n] = cube.data()[n];
+
+         mx::improc::zeroNaNCube(c2);
+
+         for(size_t n=0; n < 32*32*5; ++n)
+         {
+            if(!std::isnormal(cube.data()[n])) REQUIRE(c2.data()[n] == 0);
+            else REQUIRE(c2.data()[n] == cube.data()[n]);
+         }
+      }
+      WHEN("zeroing NaNs and calculating statistics in one pass")
+      {
+         mx::improc::imageStats<double> stats;
+         mx::improc::zeroNaNCube(cube, stats);
+
+         double m = 0, mn = cube.data()[0], mx = cube.data()[0];
+         for(size_t n=0; n < 32*32*5; ++n)
+         {
+            REQUIRE(std::isfinite(cube.data()[n]));
+            m += cube.data()[n];
+            mn = std::min(mn, (double) cube.data()[n]);
+            mx = std::max(mx, (double) cube.data()[n]);
+         }
+         m /= 32*32*5;
+
+         double v = 0;
+         for(size_t n=0; n < 32*32*5; ++n) v += pow(cube.data()[n]-m,2);
+         v /= 32*32*5;
+
+         REQUIRE(stats.n == 32*32*5);
+         REQUIRE(fabs(stats.mean - m)/m < 1e-12);
+         REQUIRE(fabs(stats.variance - v)/v < 1e-9);
+         REQUIRE(stats.min == mn);
+         REQUIRE(stats.max == mx);
+      }
+      WHEN("calculating masked statistics")
+      {
+         mx::improc::zeroNaNCube(cube);
+
+         mx::improc::eigenCube<float> mask(32,32,5);
+         for(size_t n=0; n < 32*32*5; ++n) mask.data()[n] = (n % 3 == 0);
+
+         mx::improc::imageStats<double> stats;
+         mx::improc::cubeStats(stats, cube, mask);
+
+         double m = 0;
+         size_t N = 0;
+         for(size_t n=0; n < 32*32*5; n += 3)
+         {
+            m += cube.data()[n];
+            ++N;
+         }
+         m /= N;
+
+         double v = 0;
+         for(size_t n=0; n < 32*32*5; n += 3) v += pow(cube.data()[n]-m,2);
+         v /= N;
+
+         REQUIRE(stats.n == N);
+         REQUIRE(fabs(stats.mean - m)/m < 1e-12);
+         REQUIRE(fabs(stats.variance - v)/v < 1e-9);
+      }
+   }
+   GIVEN("a float buffer with more than 2^24 values")
+   {
+      //Beyond 2^24 a float can no longer count by 1
+      size_t N = (static_cast<size_t>(1) << 24) + 4099;
+      std::vector<float> buff(N);
+      for(size_t n=0; n < N; ++n) buff[n] = 3 + (n % 7);
+
+      WHEN("calculating float statistics")
+      {
+         double m = 0;
+         for(size_t n=0; n < N; ++n) m += buff[n];
+         m /= N;
+
+         double v = 0;
+         for(size_t n=0; n < N; ++n) v += pow(buff[n]-m,2);
+         v /= N;
+
+         mx::improc::imageStats<float> stats;
+         mx::improc::bufferStats(stats, buff.data(), N);
+
+         REQUIRE(stats.n == N);
+         REQUIRE(fabs(stats.mean - m)/m < 1e-6);
+         REQUIRE(fabs(stats.variance - v)/v < 1e-5);
+         REQUIRE(stats.min == 3);
+         REQUIRE(stats.max == 9);
+      }
+   }
+}
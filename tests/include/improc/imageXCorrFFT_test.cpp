@@ -0,0 +1,81 @@
+/** \file imageXCorrFFT_test.cpp
+ */
+#include "../../catch2/catch.hpp"
+
+#include <vector>
+#include <Eigen/Dense>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../include/math/func/gaussian.hpp"
+
+#include "../../../include/improc/eigenImage.hpp"
+#include "../../../include/improc/eigenCube.hpp"
+#include "../../../include/improc/imageXCorrFFT.hpp"
+
+/** Scenario: Registering a cube of shifted images
+  * 
+  * Verifies the shifts found by the DFT upsampling peak method for a cube of shifted Gaussians.
+  * 
+  * \anchor tests_improc_imageXCorrFFT_registerCube
+  */
+SCENARIO( "Registering a cube of images with the Fourier cross-correlation", "[improc::imageXCorrFFT]" ) 
+{
+   GIVEN("a cube of shifted Gaussians")
+   {
+      mx::improc::eigenImage<double> im0;
+      im0.resize(64,64);
+      mx::math::func::gaussian2D<double>(im0.data(), im0.rows(), im0.cols(), 0., 1.0, 32.0, 32.0, 3);
+
+      std::vector<double> dx({0.0, 1.25, -2.5, 3.33, -0.71, 4.05});
+      std::vector<double> dy({0.0, -0.5, 1.75, 2.11, -3.62, 0.4});
+
+      mx::improc::eigenCube<double> ims(64, 64, dx.size());
+      for(size_t n=0; n < dx.size(); ++n)
+      {
+         mx::math::func::gaussian2D<double>(ims.image(n).data(), ims.rows(), ims.cols(), 0., 1.0, 32.0+dx[n], 32.0+dy[n], 3);
+      }
+
+      mx::improc::imageXCorrFFT<mx::improc::eigenImage<double>> xcf;
+      xcf.peakMethod(xcf.dftUpsample);
+      xcf.upsample(100);
+      xcf.setReference(im0);
+
+      WHEN("the full cross-correlation is calculated")
+      {
+         std::vector<double> xs, ys;
+         REQUIRE(xcf.registerCube(xs, ys, ims) == 0);
+
+         REQUIRE(xs.size() == dx.size());
+         for(size_t n=0; n < dx.size(); ++n)
+         {
+            REQUIRE(fabs(xs[n] - dx[n]) <= 0.011);
+            REQUIRE(fabs(ys[n] - dy[n]) <= 0.011);
+         }
+      }
+      WHEN("only lags up to maxLag are calculated")
+      {
+         xcf.maxLag(6);
+
+         std::vector<double> xs, ys;
+         REQUIRE(xcf.registerCube(xs, ys, ims) == 0);
+
+         for(size_t n=0; n < dx.size(); ++n)
+         {
+            REQUIRE(fabs(xs[n] - dx[n]) <= 0.011);
+            REQUIRE(fabs(ys[n] - dy[n]) <= 0.011);
+         }
+      }
+      WHEN("the images are shifted to align with the reference")
+      {
+         std::vector<double> xs, ys;
+         mx::improc::eigenCube<double> shifted;
+         REQUIRE(xcf.registerCube(xs, ys, shifted, ims) == 0);
+
+         for(size_t n=0; n < dx.size(); ++n)
+         {
+            REQUIRE( (shifted.image(n) - im0).abs().maxCoeff() < 0.01 );
+         }
+      }
+   }
+}
@@ -0,0 +1,78 @@
+/** \file radprofPlan_test.cpp
+ */
+#include "../../catch2/catch.hpp"
+
+#include <vector>
+#include <Eigen/Dense>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../include/math/randomT.hpp"
+#include "../../../include/improc/eigenImage.hpp"
+#include "../../../include/improc/eigenCube.hpp"
+#include "../../../include/improc/imageFilters.hpp"
+#include "../../../include/improc/radprofPlan.hpp"
+
+/** Scenario: radial profiles from a plan
+  * 
+  * Verify that the planned radial profile matches radprof
+  * 
+  * \anchor tests_improc_radprofPlan_profile
+  */
+SCENARIO( "Verify planned radial profiles", "[improc::radprofPlan]" ) 
+{
+   GIVEN("a noise image")
+   {
+      mx::improc::eigenImage<double> im, rad;
+      im.resize(64,64);
+      rad.resize(64,64);
+
+      mx::math::normDistT<double> norm;
+      norm.seed();
+      for(int i = 0; i < im.size(); ++i) im(i) = norm;
+
+      mx::improc::radiusImage(rad);
+
+      mx::improc::radprofPlan<double> rpp(64,64);
+
+      WHEN("median profile")
+      {
+         std::vector<double> r, p, pp;
+         mx::improc::radprof(r, p, im, rad, (mx::improc::eigenImage<double> *) nullptr, false);
+         rpp.profile(pp, im, false);
+
+         REQUIRE(pp.size() == p.size());
+         for(size_t n = 0; n < p.size(); ++n)
+         {
+            REQUIRE(rpp.radius()[n] == Approx(r[n]));
+            REQUIRE(pp[n] == Approx(p[n]));
+         }
+      }
+      WHEN("mean profile")
+      {
+         std::vector<double> r, p, pp;
+         mx::improc::radprof(r, p, im, rad, (mx::improc::eigenImage<double> *) nullptr, true);
+         rpp.profile(pp, im, true);
+
+         REQUIRE(pp.size() == p.size());
+         for(size_t n = 0; n < p.size(); ++n)
+         {
+            REQUIRE(pp[n] == Approx(p[n]));
+         }
+      }
+      WHEN("subtracting from a cube")
+      {
+         mx::improc::eigenCube<double> ims(64,64,4);
+         for(int n = 0; n < ims.planes(); ++n) ims.image(n) = im;
+
+         mx::improc::eigenImage<double> rpIm;
+         rpp.profileImage(rpIm, im, true);
+         rpp.subtract(ims);
+
+         for(int n = 0; n < ims.planes(); ++n)
+         {
+            REQUIRE( (ims.image(n) - im).abs().maxCoeff() < 1e-12 );
+         }
+      }
+   }
+}
@@ -0,0 +1,104 @@
+/** \file fitsCompactHeader_test.cpp
+ */
+#include "../../../catch2/catch.hpp"
+
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../../include/ioutils/fits/fitsCompactHeader.hpp"
+using namespace mx::fits;
+
+//Pad a card to 80 characters
+static std::string card80( const std::string & c )
+{
+   std::string s = c;
+   s.resize(80, ' ');
+   return s;
+}
+
+/** Verify parsing of a raw header
+  *
+  * \anchor tests_ioutils_fits_fitsCompactHeader_parse
+  */
+SCENARIO( "fitsCompactHeader parsing a raw header", "[ioutils::fits::fitsCompactHeader]" )
+{
+   GIVEN("a raw header block")
+   {
+      std::string hdr;
+      hdr += card80("SIMPLE  =                    T / conforms to FITS standard");
+      hdr += card80("BITPIX  =                  -64 / array data type");
+      hdr += card80("NAXIS   =                    2");
+      hdr += card80("EXPTIME =                 1.25 / [s] exposure time");
+      hdr += card80("OBJECT  = 'HD 1234 ''A'''      / the target");
+      hdr += card80("COMMENT this is a comment");
+      hdr += card80("HISTORY processed");
+      hdr += card80("COMMENT another comment");
+      hdr += card80("HIERARCH ESO DET DIT = 0.5 / detector integration time");
+      hdr += card80("END");
+      hdr.resize(2880, ' ');
+
+      WHEN("parsing the block")
+      {
+         fitsCompactHeader head;
+         REQUIRE(head.parse(hdr.data(), hdr.size()) == 0);
+
+         REQUIRE(head.size() == 9);
+
+         REQUIRE(head.find("BITPIX") == 1);
+         REQUIRE(head.find("NOTHERE") == -1);
+
+         REQUIRE(head.valueStr(0) == "T");
+         REQUIRE(head.comment(0) == "conforms to FITS standard");
+
+         REQUIRE(head.value<int>("BITPIX") == -64);
+         REQUIRE(head.value<int>("NAXIS") == 2);
+         REQUIRE(head.value<double>("EXPTIME") == 1.25);
+         REQUIRE(head.comment(head.find("EXPTIME")) == "[s] exposure time");
+
+         REQUIRE(head.valueStr(head.find("OBJECT")) == "'HD 1234 ''A'''");
+         REQUIRE(head.comment(head.find("OBJECT")) == "the target");
+
+         REQUIRE(head.count("COMMENT") == 2);
+         REQUIRE(head.comment(head.find("COMMENT")) == "this is a comment");
+         REQUIRE(head["HISTORY"].type() == fitsType<fitsHistoryType>());
+
+         REQUIRE(head.value<double>("ESO DET DIT") == 0.5);
+      }
+
+      WHEN("converting to a full fitsHeader")
+      {
+         fitsCompactHeader head(hdr.data(), hdr.size());
+
+         fitsHeader full;
+         head.toHeader(full);
+
+         REQUIRE(full.size() == head.size());
+         REQUIRE(full.count("COMMENT") == 2);
+         REQUIRE(full["EXPTIME"].value<double>() == 1.25);
+         REQUIRE(full["NAXIS"].comment() == "");
+      }
+
+      WHEN("looking up a missing keyword")
+      {
+         fitsCompactHeader head(hdr.data(), hdr.size());
+
+         bool thrown = false;
+         try
+         {
+            head.value<int>("NOTHERE");
+         }
+         catch(...)
+         {
+            thrown = true;
+         }
+
+         REQUIRE(thrown);
+      }
+
+      WHEN("the length is not a multiple of 80")
+      {
+         fitsCompactHeader head;
+         REQUIRE(head.parse(hdr.data(), 100) == -1);
+      }
+   }
+}
@@ -0,0 +1,149 @@
+/** \file readColumns_test.cpp
+ */
+#include "../../catch2/catch.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../include/ioutils/readColumns.hpp"
+
+/** Verify reading columns from a text file
+  *
+  * \anchor tests_ioutils_readColumns_readColumns
+  */
+SCENARIO( "reading columns from a text file", "[ioutils::readColumns]" )
+{
+   GIVEN("a small file with comments, missing values, and a long line")
+   {
+      std::string fname = "/tmp/mxlib_readColumns_test.txt";
+
+      std::ofstream fout(fname);
+      fout << "# a header comment\n";
+      fout << "1 1.5 one\n";
+      fout << "  2   2.5   two # a trailing comment\n";
+      fout << "\n";
+      fout << "#another comment\n";
+      fout << "3 " << std::string(5000, '0') << "3.5 three\n";
+      fout << "4 4.5 four";
+      fout.close();
+
+      WHEN("reading all columns")
+      {
+         std::vector<int> i1;
+         std::vector<double> d1;
+         std::vector<std::string> s1;
+
+         REQUIRE(mx::ioutils::readColumns(fname, i1, d1, s1) == 0);
+
+         REQUIRE(i1.size() == 4);
+         REQUIRE(d1.size() == 4);
+         REQUIRE(s1.size() == 4);
+
+         REQUIRE(i1[0] == 1);
+         REQUIRE(i1[3] == 4);
+         REQUIRE(d1[1] == 2.5);
+         REQUIRE(d1[2] == 3.5);
+         REQUIRE(s1[1] == "two");
+         REQUIRE(s1[3] == "four");
+      }
+
+      WHEN("skipping a column")
+      {
+         std::vector<int> i1;
+         std::vector<std::string> s1;
+         mx::ioutils::skipCol sk;
+
+         REQUIRE(mx::ioutils::readColumns(fname, i1, sk, s1) == 0);
+
+         REQUIRE(i1.size() == 4);
+         REQUIRE(s1.size() == 4);
+         REQUIRE(s1[2] == "three");
+      }
+
+      remove(fname.c_str());
+   }
+
+   GIVEN("a csv file with a missing value")
+   {
+      std::string fname = "/tmp/mxlib_readColumns_test.csv";
+
+      std::ofstream fout(fname);
+      fout << "1,2,3\n";
+      fout << "4,,6\n";
+      fout.close();
+
+      WHEN("reading with a comma delimiter")
+      {
+         std::vector<int> c1, c2, c3;
+
+         REQUIRE(mx::ioutils::readColumns<','>(fname, c1, c2, c3) == 0);
+
+         REQUIRE(c2.size() == 2);
+         REQUIRE(c2[0] == 2);
+         REQUIRE(c2[1] == -99);
+         REQUIRE(c3[1] == 6);
+      }
+
+      remove(fname.c_str());
+   }
+
+   GIVEN("a file large enough to be read in parallel")
+   {
+      std::string fname = "/tmp/mxlib_readColumns_test_large.txt";
+
+      size_t N = 200000;
+
+      std::ofstream fout(fname);
+      for(size_t n = 0; n < N; ++n)
+      {
+         fout << n << " " << 0.5*n << " x" << n << "\n";
+      }
+      fout.close();
+
+      WHEN("reading the whole file")
+      {
+         std::vector<size_t> i1;
+         std::vector<double> d1;
+         std::vector<std::string> s1;
+
+         REQUIRE(mx::ioutils::readColumns(fname, i1, d1, s1) == 0);
+
+         REQUIRE(i1.size() == N);
+         REQUIRE(d1.size() == N);
+         REQUIRE(s1.size() == N);
+
+         bool ok = true;
+         for(size_t n = 0; n < N; ++n)
+         {
+            if(i1[n] != n || d1[n] != 0.5*n || s1[n] != "x" + std::to_string(n)) ok = false;
+         }
+         REQUIRE(ok);
+      }
+
+      WHEN("streaming the file in small blocks")
+      {
+         std::vector<size_t> i1;
+         mx::ioutils::skipCol sk;
+
+         size_t nblocks = 0;
+         size_t nread = 0;
+         bool ok = true;
+
+         REQUIRE(mx::ioutils::readColumnsStream(fname, 65536, [&]()
+                                                {
+                                                   ++nblocks;
+                                                   for(size_t n = 0; n < i1.size(); ++n) if(i1[n] != nread + n) ok = false;
+                                                   nread += i1.size();
+                                                   return 0;
+                                                }, i1, sk, sk) == 0);
+
+         REQUIRE(nblocks > 1);
+         REQUIRE(nread == N);
+         REQUIRE(ok);
+      }
+
+      remove(fname.c_str());
+   }
+}
@@ -0,0 +1,132 @@
+/** \file shmImageStream_test.cpp
+ */
+#include "../../catch2/catch.hpp"
+
+#include <thread>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../include/ipc/shmImageStream.hpp"
+
+/** Verify publishing and reading frames through a shared memory image stream
+  *
+  * \anchor tests_ipc_shmImageStream
+  */
+SCENARIO( "Publishing and reading frames through a shared memory image stream", "[ipc::shmImageStream]" )
+{
+   using namespace mx::ipc;
+
+   int key = 0x4d580000 + (getpid() & 0xffff);
+
+   GIVEN("a producer and a consumer")
+   {
+      shmImageProducer<float> prod;
+      REQUIRE(prod.create(nullptr, key, 16, 12, 4) == 0);
+
+      shmImageConsumer<float> cons;
+      REQUIRE(cons.attach(nullptr, key) == 0);
+      REQUIRE(cons.rows() == 16);
+      REQUIRE(cons.cols() == 12);
+      REQUIRE(cons.nSlots() == 4);
+
+      WHEN("frames are published one at a time")
+      {
+         mx::improc::eigenImage<float> im(16,12), out;
+         uint64_t frame;
+
+         REQUIRE(cons.next(frame, 0) == 1); //nothing published yet
+
+         for(int n=0; n < 3; ++n)
+         {
+            im.setConstant(n);
+            im(3,4) = 100+n;
+            REQUIRE(prod.write(im) == 0);
+
+            REQUIRE(cons.next(frame, 1.0) == 0);
+            REQUIRE(frame == (uint64_t) n);
+
+            auto m = cons.map(frame);
+            REQUIRE(m(0,0) == n);
+            REQUIRE(m(3,4) == 100+n);
+            REQUIRE(cons.valid(frame));
+
+            REQUIRE(cons.copy(out, frame) == 0);
+            REQUIRE(out(15,11) == n);
+         }
+
+         REQUIRE(prod.frameCount() == 3);
+         REQUIRE(cons.next(frame, 0.01) == 1);
+         REQUIRE(cons.dropped() == 0);
+      }
+
+      WHEN("the consumer falls behind")
+      {
+         uint64_t frame;
+
+         for(int n=0; n < 10; ++n)
+         {
+            auto m = prod.beginFrame();
+            m.setConstant(n);
+            REQUIRE(prod.publish() == 0);
+         }
+
+         //frame 0 has been overwritten, and frame 6's slot is the next to be written
+         REQUIRE(!cons.valid(0));
+         REQUIRE(cons.next(frame, 0) == 0);
+         REQUIRE(frame == 7);
+         REQUIRE(cons.dropped() == 7);
+         REQUIRE(cons.map(frame)(0,0) == 7);
+
+         timespec ts;
+         REQUIRE(cons.frameTime(ts, frame) == 0);
+         REQUIRE(ts.tv_sec > 0);
+         REQUIRE(cons.frameTime(ts, 0) == -1);
+      }
+
+      WHEN("attaching with the wrong type")
+      {
+         shmImageConsumer<double> dcons;
+         REQUIRE(dcons.attach(nullptr, key) == -1);
+      }
+
+      WHEN("frames are published from another thread")
+      {
+         int nFrames = 2000;
+
+         std::thread thr( [&prod, nFrames]()
+                          {
+                             for(int n=0; n < nFrames; ++n)
+                             {
+                                prod.beginFrame().setConstant(n);
+                                prod.publish();
+                             }
+                          } );
+
+         mx::improc::eigenImage<float> out;
+         uint64_t frame = 0;
+         uint64_t nRead = 0;
+         bool consistent = true;
+
+         while(frame + 1 < (uint64_t) nFrames)
+         {
+            if(cons.next(frame, 5.0) != 0) break;
+
+            //A copy either succeeds with a whole frame, or reports that the frame was overwritten
+            if(cons.copy(out, frame) == 0)
+            {
+               if(out.minCoeff() != frame || out.maxCoeff() != frame) consistent = false;
+               ++nRead;
+            }
+         }
+
+         thr.join();
+
+         REQUIRE(consistent);
+         REQUIRE(frame + 1 == (uint64_t) nFrames);
+         REQUIRE(nRead > 0);
+      }
+
+      cons.detach();
+      REQUIRE(prod.remove() == 0);
+   }
+}
@@ -0,0 +1,127 @@
+/** \file fitBatch2D_test.cpp
+ */
+#include "../../../catch2/catch.hpp"
+
+#include <limits>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../../include/math/fit/fitGaussian.hpp"
+#include "../../../../include/math/fit/fitMoffat.hpp"
+#include "../../../../include/math/fit/fitBatch2D.hpp"
+
+/** Verify that batch fitting matches fitting each stamp individually
+  *
+  * \anchor tests_math_fit_fitBatch2D
+  */
+SCENARIO( "Fitting a batch of stamps", "[math::fit::fitBatch2D]" )
+{
+   using namespace mx::math::fit;
+
+   GIVEN("a cube of symmetric Gaussians")
+   {
+      int nStamps = 21;
+      mx::improc::eigenCube<double> stamps(15, 13, nStamps);
+      mx::improc::eigenImage<double> truth(5, nStamps), params(5, nStamps);
+
+      for(int s=0; s < nStamps; ++s)
+      {
+         truth(0,s) = 0.01*s;
+         truth(1,s) = 1 + 0.1*s;
+         truth(2,s) = 6.5 + 0.05*s;
+         truth(3,s) = 5.8 - 0.03*s;
+         truth(4,s) = 1.8 + 0.02*s;
+
+         mx::math::func::gaussian2D(stamps.image(s).data(), 15, 13, truth(0,s), truth(1,s), truth(2,s), truth(3,s), truth(4,s));
+
+         params(0,s) = 0;
+         params(1,s) = 1.2*truth(1,s);
+         params(2,s) = 7;
+         params(3,s) = 6;
+         params(4,s) = 2;
+      }
+
+      WHEN("fitting in parallel with 3 threads")
+      {
+         mx::improc::eigenImage<double> guess = params;
+
+         fitBatch2D<fitGaussian2Dsym<double>> batch(3);
+         REQUIRE(batch.nThreads() == 3);
+         REQUIRE(batch.nParams() == 5);
+
+         std::vector<int> status, reasons;
+         REQUIRE(batch.fit(params, status, reasons, stamps) == 0);
+         REQUIRE(status.size() == (size_t) nStamps);
+         REQUIRE(reasons.size() == (size_t) nStamps);
+
+         fitGaussian2Dsym<double> single;
+
+         for(int s=0; s < nStamps; ++s)
+         {
+            single.setArray(stamps.image(s).data(), 15, 13);
+            single.setGuess(guess(0,s), guess(1,s), guess(2,s), guess(3,s), guess(4,s));
+            single.fit();
+
+            REQUIRE(params(0,s) == Approx(single.G0()).margin(1e-10));
+            REQUIRE(params(1,s) == Approx(single.G()).epsilon(1e-10));
+            REQUIRE(params(2,s) == Approx(single.x0()).epsilon(1e-10));
+            REQUIRE(params(3,s) == Approx(single.y0()).epsilon(1e-10));
+            REQUIRE(params(4,s) == Approx(single.sigma()).epsilon(1e-10));
+
+            REQUIRE(params(2,s) == Approx(truth(2,s)).epsilon(1e-6));
+            REQUIRE(params(3,s) == Approx(truth(3,s)).epsilon(1e-6));
+            REQUIRE(params(4,s) == Approx(truth(4,s)).epsilon(1e-6));
+         }
+      }
+
+      WHEN("the background is fixed for every fitter")
+      {
+         fitBatch2D<fitGaussian2Dsym<double>> batch(2);
+         batch.configure( [](fitGaussian2Dsym<double> & f)
+                          {
+                             f.setFixed(true, false, false, false, false);
+                             f.setGuess(0, 1, 7, 6, 2); //sets the fixed value of G0
+                          } );
+         REQUIRE(batch.nParams() == 4);
+
+         //Only the first stamp has zero background
+         mx::improc::eigenCube<double> one(stamps.image(0).data(), 15, 13, 1);
+         mx::improc::eigenImage<double> p1 = params.block(1,0,4,1);
+
+         REQUIRE(batch.fit(p1, one) == 0);
+         REQUIRE(p1(1,0) == Approx(truth(2,0)).epsilon(1e-6));
+         REQUIRE(p1(2,0) == Approx(truth(3,0)).epsilon(1e-6));
+         REQUIRE(p1(3,0) == Approx(truth(4,0)).epsilon(1e-6));
+      }
+
+      WHEN("one stamp cannot be fit")
+      {
+         stamps.image(5)(7,6) = std::numeric_limits<double>::quiet_NaN();
+
+         fitBatch2D<fitGaussian2Dsym<double>> batch(3);
+
+         std::vector<int> status, reasons;
+         REQUIRE(batch.fit(params, status, reasons, stamps) == -1);
+         REQUIRE(status.size() == (size_t) nStamps);
+
+         for(int s=0; s < nStamps; ++s)
+         {
+            if(s == 5) REQUIRE(status[s] == -1);
+            else
+            {
+               REQUIRE(status[s] == 0);
+               REQUIRE(params(2,s) == Approx(truth(2,s)).epsilon(1e-6));
+            }
+         }
+
+         REQUIRE(batch.fit(params, stamps) == -1);
+      }
+
+      WHEN("params is the wrong size")
+      {
+         fitBatch2D<fitGaussian2Dsym<double>> batch(2);
+         mx::improc::eigenImage<double> bad(4, nStamps);
+         REQUIRE(batch.fit(bad, stamps) == -1);
+      }
+   }
+}
@@ -0,0 +1,164 @@
+/** \file jacobians_test.cpp
+ */
+#include "../../../catch2/catch.hpp"
+
+#include <vector>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../../include/math/fit/fitGaussian.hpp"
+#include "../../../../include/math/fit/fitMoffat.hpp"
+#include "../../../../include/math/fit/fitAiry.hpp"
+
+//Compare fitterT::jacf to a central finite difference of fitterT::func, returning the max relative error
+template<class fitterT>
+double jacobianError( std::vector<double> p,
+                      int n,
+                      void * adata
+                    )
+{
+   int m = p.size();
+
+   std::vector<double> jac(n*m), hp(n), hm(n);
+
+   fitterT::jacf(p.data(), jac.data(), m, n, adata);
+
+   double maxErr = 0;
+   for(int k=0; k < m; ++k)
+   {
+      double h = 1e-6*std::max(1.0, fabs(p[k]));
+
+      double pk = p[k];
+      p[k] = pk + h;
+      fitterT::func(p.data(), hp.data(), m, n, adata);
+      p[k] = pk - h;
+      fitterT::func(p.data(), hm.data(), m, n, adata);
+      p[k] = pk;
+
+      double colMax = 0;
+      for(int i=0; i < n; ++i) colMax = std::max(colMax, fabs(jac[i*m+k]));
+
+      for(int i=0; i < n; ++i)
+      {
+         double fd = (hp[i] - hm[i])/(2*h);
+         double err = fabs(fd - jac[i*m+k])/std::max(colMax, 1e-12);
+         if(err > maxErr) maxErr = err;
+      }
+   }
+
+   return maxErr;
+}
+
+/** Verify the analytic Jacobians of the 2D fitters against finite differences
+  *
+  * \anchor tests_math_fit_jacobians
+  */
+SCENARIO( "Verify the analytic Jacobians of the 2D fitters", "[math::fit::jacobians]" )
+{
+   using namespace mx::math::fit;
+
+   std::vector<double> data(16*12, 0.5);
+   std::vector<double> mask(16*12, 1.0);
+   for(size_t n=0; n < mask.size(); n += 5) mask[n] = 0;
+   int nmask = 0;
+   for(size_t n=0; n < mask.size(); ++n) nmask += mask[n];
+
+   GIVEN("the symmetric Gaussian")
+   {
+      array2FitGaussian2D<double> arr;
+      arr.setSymmetric();
+      arr.data = data.data();
+      arr.nx = 16;
+      arr.ny = 12;
+
+      WHEN("all parameters are free")
+      {
+         REQUIRE(arr.nparams() == 5);
+         REQUIRE(jacobianError<gaussian2D_sym_fitter<double>>({0.1, 2.0, 7.3, 5.6, 2.1}, 16*12, &arr) < 1e-6);
+      }
+
+      WHEN("G0 and y0 are fixed, and a mask is used")
+      {
+         arr.setFixed(true, false, false, true, false, false, false);
+         arr.m_G0 = 0.1;
+         arr.m_y0 = 5.6;
+         arr.mask = mask.data();
+         REQUIRE(arr.nparams() == 3);
+         REQUIRE(jacobianError<gaussian2D_sym_fitter<double>>({2.0, 7.3, 2.1}, nmask, &arr) < 1e-6);
+      }
+   }
+
+   GIVEN("the general Gaussian")
+   {
+      array2FitGaussian2D<double> arr;
+      arr.setGeneral();
+      arr.data = data.data();
+      arr.nx = 16;
+      arr.ny = 12;
+
+      double a, b, c;
+      mx::math::func::gaussian2D_rot2gen(a, b, c, 3.0, 1.5, 0.4);
+
+      WHEN("all parameters are free")
+      {
+         REQUIRE(arr.nparams() == 7);
+         REQUIRE(jacobianError<gaussian2D_gen_fitter<double>>({0.1, 2.0, 7.3, 5.6, a, b, c}, 16*12, &arr) < 1e-6);
+      }
+
+      WHEN("G is fixed, and a mask is used")
+      {
+         arr.setFixed(false, true, false, false, false, false, false);
+         arr.m_G = 2.0;
+         arr.mask = mask.data();
+         REQUIRE(arr.nparams() == 6);
+         REQUIRE(jacobianError<gaussian2D_gen_fitter<double>>({0.1, 7.3, 5.6, a, b, c}, nmask, &arr) < 1e-6);
+      }
+   }
+
+   GIVEN("the symmetric Moffat")
+   {
+      array2FitMoffat<double> arr;
+      arr.data = data.data();
+      arr.nx = 16;
+      arr.ny = 12;
+
+      WHEN("all parameters are free")
+      {
+         REQUIRE(jacobianError<moffat2D_sym_fitter<double>>({0.1, 2.0, 7.3, 5.6, 2.1, 1.7}, 16*12, &arr) < 1e-6);
+      }
+
+      WHEN("x0 and alpha are fixed")
+      {
+         arr.setFixed(false, false, true, false, true, false);
+         arr.m_x0 = 7.3;
+         arr.m_alpha = 2.1;
+         REQUIRE(arr.nparams() == 4);
+         REQUIRE(jacobianError<moffat2D_sym_fitter<double>>({0.1, 2.0, 5.6, 1.7}, 16*12, &arr) < 1e-6);
+      }
+   }
+
+   GIVEN("the obstructed Airy pattern")
+   {
+      array2FitAiry<double> arr;
+      arr.data = data.data();
+      arr.nx = 16;
+      arr.ny = 12;
+      arr.ps = 0.35;
+      arr.cenObs = 0.2;
+
+      WHEN("platescale and central obscuration are fixed")
+      {
+         REQUIRE(jacobianError<airy2D_obs_fitter<double>>({0.1, 2.0, 7.3, 5.6}, 16*12, &arr) < 1e-5);
+      }
+
+      WHEN("platescale is free")
+      {
+         REQUIRE(jacobianError<airy2D_obs_fitter_ps<double>>({0.1, 2.0, 7.3, 5.6, 0.35}, 16*12, &arr) < 1e-5);
+      }
+
+      WHEN("platescale and central obscuration are free")
+      {
+         REQUIRE(jacobianError<airy2D_obs_fitter_ps_eps<double>>({0.1, 2.0, 7.3, 5.6, 0.35, 0.2}, 16*12, &arr) < 1e-5);
+      }
+   }
+}
@@ -0,0 +1,135 @@
+/** \file jinc_test.cpp
+ */
+#include "../../../catch2/catch.hpp"
+
+#include <vector>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../../include/math/func/jinc.hpp"
+
+/** Scenario: fast Bessel function approximations
+  *
+  * Verify the accuracy of the fast Bessel functions against the full precision functions.
+  * 
+  * \anchor tests_math_func_bessel_fast
+  */
+SCENARIO( "fast Bessel function approximations", "[math::func::bessel]" ) 
+{
+   GIVEN("a range of arguments")
+   {
+      std::vector<double> x(4001);
+      for(size_t n = 0; n < x.size(); ++n) x[n] = -20 + n*0.025;
+      x.push_back(123.456);
+      x.push_back(-1011.1);
+      
+      WHEN("orders 0 through 4")
+      {
+         std::vector<double> j(x.size());
+         
+         for(int v = 0; v < 5; ++v)
+         {
+            mx::math::func::bessel_jn_fast(v, j.data(), x.data(), x.size());
+            
+            double maxerr = 0;
+            for(size_t n = 0; n < x.size(); ++n)
+            {
+               double err = fabs(j[n] - mx::math::func::bessel_j(v, x[n]));
+               if(err > maxerr) maxerr = err;
+            }
+            
+            REQUIRE(maxerr < 2e-8);
+         }
+      }
+   }
+}
+
+/** Scenario: fast Jinc function approximations
+  *
+  * Verify the accuracy of the fast Jinc functions against the full precision functions.
+  * 
+  * \anchor tests_math_func_jinc_fast
+  */
+SCENARIO( "fast Jinc function approximations", "[math::func::jinc]" ) 
+{
+   GIVEN("a range of arguments")
+   {
+      std::vector<double> x(4001);
+      for(size_t n = 0; n < x.size(); ++n) x[n] = -20 + n*0.025;
+      x.push_back(1e-10);
+      x.push_back(123.456);
+      
+      WHEN("jinc")
+      {
+         std::vector<double> j(x.size());
+         mx::math::func::jincFast(j.data(), x.data(), x.size());
+         
+         double maxerr = 0;
+         for(size_t n = 0; n < x.size(); ++n)
+         {
+            double err = fabs(j[n] - mx::math::func::jinc(x[n]));
+            if(err > maxerr) maxerr = err;
+         }
+         
+         REQUIRE(maxerr < 2e-8);
+         REQUIRE(fabs(mx::math::func::jincFast(0.0) - 0.5) < 2e-8);
+      }
+      WHEN("jincN, orders 2 through 4")
+      {
+         std::vector<double> j(x.size());
+         
+         for(int v = 2; v < 5; ++v)
+         {
+            mx::math::func::jincNFast(v, j.data(), x.data(), x.size());
+            
+            double maxerr = 0;
+            for(size_t n = 0; n < x.size(); ++n)
+            {
+               double err = fabs(j[n] - mx::math::func::jincN(v, x[n]));
+               if(err > maxerr) maxerr = err;
+            }
+            
+            REQUIRE(maxerr < 2e-8);
+         }
+      }
+   }
+}
+
+/** Scenario: benchmarking the fast Jinc functions
+  *
+  * Compares the speed of the fast Jinc functions to the full precision functions.  This is hidden, run it with the tag [.benchmark].
+  * 
+  * \anchor tests_math_func_jinc_benchmark
+  */
+SCENARIO( "benchmarking the fast Jinc functions", "[.benchmark][math::func::jinc]" ) 
+{
+   GIVEN("a large vector of arguments")
+   {
+      std::vector<double> x(1000000);
+      for(size_t n = 0; n < x.size(); ++n) x[n] = n*1e-4;
+      
+      std::vector<double> j(x.size());
+      
+      BENCHMARK("jinc")
+      {
+         for(size_t n = 0; n < x.size(); ++n) j[n] = mx::math::func::jinc(x[n]);
+      }
+      
+      BENCHMARK("jincFast")
+      {
+         mx::math::func::jincFast(j.data(), x.data(), x.size());
+      }
+      
+      BENCHMARK("jincN(2)")
+      {
+         for(size_t n = 0; n < x.size(); ++n) j[n] = mx::math::func::jincN(2, x[n]);
+      }
+      
+      BENCHMARK("jincNFast(2)")
+      {
+         mx::math::func::jincNFast(2, j.data(), x.data(), x.size());
+      }
+      
+      REQUIRE(j[1] == Approx(mx::math::func::jincN(2, x[1])).epsilon(1e-6));
+   }
+}
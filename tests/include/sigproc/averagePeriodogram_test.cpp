@@ -0,0 +1,79 @@
+/** \file averagePeriodogram_test.cpp
+ */
+#include "../../catch2/catch.hpp"
+
+#include <vector>
+#include <Eigen/Dense>
+
+#define MX_NO_ERROR_REPORTS
+
+//Use a small batch so that the remainder path is exercised
+#define MX_AVGPGRAM_BATCHSIZE (100)
+
+#include "../../../include/sigproc/averagePeriodogram.hpp"
+#include "../../../include/sigproc/signalWindows.hpp"
+#include "../../../include/math/randomT.hpp"
+
+/** Verify the batch calculation of periodograms
+  * The periodograms of a block of time-series must match those calculated one at a time.
+  * 
+  * \anchor tests_sigproc_averagePeriodogram_batch
+  */
+SCENARIO( "calculating a batch of periodograms", "[sigproc::averagePeriodogram]" ) 
+{
+   GIVEN("a block of time-series")
+   {
+      mx::math::normDistT<double> normVar;
+      
+      Eigen::Array<double, -1, -1> ts(1013, 7);
+      for(int cc=0; cc< ts.cols(); ++cc)
+      {
+         for(int rr=0; rr<ts.rows(); ++rr)
+         {
+            ts(rr,cc) = normVar;
+         }
+      }
+      
+      WHEN("no window, half overlap")
+      {
+         mx::sigproc::averagePeriodogram<double> avgPgram(32, 0.1);
+         
+         Eigen::Array<double, -1, -1> pgrams;
+         avgPgram(pgrams, ts);
+         
+         REQUIRE(pgrams.rows() == avgPgram.size());
+         REQUIRE(pgrams.cols() == ts.cols());
+         
+         double md = 0;
+         for(int cc=0; cc < ts.cols(); ++cc)
+         {
+            std::vector<double> t(ts.data() + cc*ts.rows(), ts.data() + (cc+1)*ts.rows());
+            std::vector<double> pgram = avgPgram(t);
+            
+            for(size_t n=0; n < pgram.size(); ++n) md = std::max(md, fabs(pgram[n] - pgrams(n,cc))/pgram[n]);
+         }
+         
+         REQUIRE(md < 1e-10);
+      }
+      
+      WHEN("hann window, no overlap")
+      {
+         mx::sigproc::averagePeriodogram<double> avgPgram(25, 0, 1.0);
+         avgPgram.win(mx::sigproc::window::hann);
+         
+         Eigen::Array<double, -1, -1> pgrams;
+         avgPgram(pgrams, ts);
+         
+         double md = 0;
+         for(int cc=0; cc < ts.cols(); ++cc)
+         {
+            std::vector<double> t(ts.data() + cc*ts.rows(), ts.data() + (cc+1)*ts.rows());
+            std::vector<double> pgram = avgPgram(t);
+            
+            for(size_t n=0; n < pgram.size(); ++n) md = std::max(md, fabs(pgram[n] - pgrams(n,cc))/pgram[n]);
+         }
+         
+         REQUIRE(md < 1e-10);
+      }
+   }
+}
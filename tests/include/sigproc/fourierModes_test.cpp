@@ -0,0 +1,58 @@
+/** \file fourierModes_test.cpp
+ */
+#include "../../catch2/catch.hpp"
+
+#include <Eigen/Dense>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../include/sigproc/fourierModes.hpp"
+#include "../../../include/improc/eigenCube.hpp"
+
+/** Scenario: filling a Fourier basis
+  * Verify that the basis matches the individual modes from makeFourierMode and makeModifiedFourierMode.
+  * \anchor tests_sigproc_fourierModes_fillFourierBasis
+  */
+SCENARIO( "filling a Fourier basis", "[sigproc::fourierModes]" )
+{
+   GIVEN("a set of mode definitions")
+   {
+      std::vector<mx::sigproc::fourierModeDef> spf;
+      REQUIRE(mx::sigproc::makeFourierModeFreqs_Rect(spf, 6) == 0);
+
+      WHEN("the basic basis")
+      {
+         mx::improc::eigenCube<double> cube;
+         REQUIRE(mx::sigproc::fillFourierBasis(cube, 31, spf, MX_FOURIER_BASIC) == 0);
+         REQUIRE(cube.planes() == (int) spf.size());
+
+         //The mode functions take their image by value, so use a Map
+         mx::improc::eigenCube<double> ref(31,31,1);
+         for(size_t p=0; p < spf.size(); ++p)
+         {
+            mx::sigproc::makeFourierMode(ref.image(0), spf[p].m, spf[p].n, spf[p].p);
+            REQUIRE( (cube.image(p) - ref.image(0)).abs().maxCoeff() < 1e-12 );
+         }
+      }
+
+      WHEN("the modified basis, rotated")
+      {
+         mx::improc::eigenCube<double> cube;
+         REQUIRE(mx::sigproc::fillFourierBasis(cube, 32, spf, MX_FOURIER_MODIFIED, 17.0) == 0);
+
+         mx::improc::eigenCube<double> ref(32,32,1);
+         for(size_t p=0; p < spf.size(); ++p)
+         {
+            mx::sigproc::makeModifiedFourierMode(ref.image(0), spf[p].m, spf[p].n, spf[p].p, 17.0);
+            REQUIRE( (cube.image(p) - ref.image(0)).abs().maxCoeff() < 1e-12 );
+         }
+      }
+
+      WHEN("a mode has an invalid p")
+      {
+         spf[3].p = 0;
+         mx::improc::eigenCube<double> cube;
+         REQUIRE(mx::sigproc::fillFourierBasis(cube, 16, spf, MX_FOURIER_MODIFIED) == -1);
+      }
+   }
+}
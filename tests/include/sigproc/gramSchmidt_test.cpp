@@ -0,0 +1,79 @@
+/** \file gramSchmidt_test.cpp
+ */
+#include "../../catch2/catch.hpp"
+
+#include <Eigen/Dense>
+
+#define MX_NO_ERROR_REPORTS
+
+#include "../../../include/sigproc/gramSchmidt.hpp"
+
+/** Verify orthogonalization of a basis set
+  * The result must be orthonormal, and the i-th vector must be orthogonal to the first i-1 input vectors, which together
+  * define the Gram-Schmidt basis.  The spectrum must reproduce the un-normalized vectors from the input.
+  *
+  * \anchor tests_sigproc_gramSchmidt
+  */
+SCENARIO( "Orthogonalizing a basis set", "[sigproc::gramSchmidt]" )
+{
+   GIVEN("a random basis set, with some rows outside the support")
+   {
+      int nPix = 300;
+      int nVec = 40;
+
+      Eigen::Array<double, -1, -1> in = Eigen::Array<double, -1, -1>::Random(nPix, nVec);
+      in.topRows(50) = 0;
+
+      //Make the basis far from orthogonal
+      for(int i=1; i < nVec; ++i) in.col(i) += 0.5*in.col(i-1);
+
+      WHEN("no window")
+      {
+         Eigen::Array<double, -1, -1> out;
+         mx::sigproc::gramSchmidt(out, in);
+
+         Eigen::MatrixXd I = out.matrix().transpose()*out.matrix();
+         REQUIRE( (I - Eigen::MatrixXd::Identity(nVec, nVec)).cwiseAbs().maxCoeff() < 1e-10 );
+
+         //Upper triangular, with positive diagonal, as Gram-Schmidt produces
+         Eigen::MatrixXd P = out.matrix().transpose()*in.matrix();
+         REQUIRE( P.triangularView<Eigen::StrictlyLower>().toDenseMatrix().cwiseAbs().maxCoeff() < 1e-10 );
+         REQUIRE( P.diagonal().minCoeff() > 0 );
+      }
+
+      WHEN("a window")
+      {
+         Eigen::Array<double, -1, 1> window(nPix);
+         for(int r=0; r < nPix; ++r) window(r) = (r % 3 == 0) ? 0 : 0.5 + (r % 7)/7.0;
+
+         Eigen::Array<double, -1, -1> out(nPix, nVec);
+         mx::sigproc::gramSchmidt(out, in, window);
+
+         Eigen::MatrixXd I = out.matrix().transpose()*window.matrix().asDiagonal()*out.matrix();
+         REQUIRE( (I - Eigen::MatrixXd::Identity(nVec, nVec)).cwiseAbs().maxCoeff() < 1e-10 );
+
+         Eigen::MatrixXd P = out.matrix().transpose()*window.matrix().asDiagonal()*in.matrix();
+         REQUIRE( P.triangularView<Eigen::StrictlyLower>().toDenseMatrix().cwiseAbs().maxCoeff() < 1e-10 );
+         REQUIRE( P.diagonal().minCoeff() > 0 );
+      }
+
+      WHEN("recording the spectrum")
+      {
+         Eigen::Array<double, -1, -1> out, spect;
+         mx::sigproc::gramSchmidtSpectrum(out, spect, in, 250.0);
+
+         REQUIRE(spect.rows() == nVec);
+         REQUIRE(spect.cols() == nVec);
+         REQUIRE( (spect.matrix().diagonal().array() - 1).abs().maxCoeff() < 1e-10 );
+
+         Eigen::Array<double, -1, -1> u = (in.matrix()*spect.matrix().transpose()).array();
+
+         for(int i=0; i < nVec; ++i)
+         {
+            REQUIRE( out.col(i).square().sum()/250.0 == Approx(1.0) );
+            double norm = sqrt(u.col(i).square().sum()/250.0);
+            REQUIRE( (u.col(i)/norm - out.col(i)).abs().maxCoeff() < 1e-8 );
+         }
+      }
+   }
+}
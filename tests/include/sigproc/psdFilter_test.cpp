@@ -607,3 +607,420 @@ SCENARIO( "filtering with psdFilter", "[sigproc::psdFilter]" )
       }
    }
 }
+
+/** Verify paired realizations
+  * Filtering two noise fields as a pair must give the same result as filtering each with the real transforms.  
+  * The rank 2 filter is not square, to check the storage order of the transforms.
+  * 
+  * \anchor tests_sigproc_psdFilter_paired
+  */
+SCENARIO( "filtering paired realizations with psdFilter", "[sigproc::psdFilter]" ) 
+{
+   mx::math::normDistT<double> normVar;
+   
+   //A symmetric PSD value for frequency index k in an array of size N
+   auto symf = [](int k, int N){ int kk = (k <= N/2) ? k : N - k; return 1.0/(1.0 + kk*kk); };
+   
+   GIVEN("a rank 1 psd")
+   {
+      WHEN("filtering a pair")
+      {
+         mx::sigproc::psdFilter<double, 1> psdF;
+         
+         std::vector<double> psd(128);
+         for(size_t n=0;n<psd.size();++n) psd[n] = symf(n, psd.size());
+         
+         psdF.psd(psd, 0.1);
+         
+         std::vector<double> n1(psd.size()), n2(psd.size());
+         for(size_t n=0;n<n1.size();++n) 
+         {
+            n1[n] = normVar;
+            n2[n] = normVar;
+         }
+         
+         std::vector<double> r1 = n1, r2 = n2;
+         
+         psdF(n1, n2);
+         psdF(r1);
+         psdF(r2);
+         
+         double md = 0;
+         for(size_t n=0;n<n1.size();++n) md = std::max(md, std::max(fabs(n1[n]-r1[n]), fabs(n2[n]-r2[n])));
+         
+         REQUIRE(md < 1e-10);
+      }
+   }
+   GIVEN("a rank 2 psd")
+   {
+      WHEN("filtering a pair, not square")
+      {
+         mx::sigproc::psdFilter<double, 2> psdF;
+         
+         Eigen::Array<double, -1, -1> psd(32, 24);
+         for(int cc=0; cc< psd.cols(); ++cc)
+         {
+            for(int rr=0; rr<psd.rows(); ++rr)
+            {
+               psd(rr,cc) = symf(rr, psd.rows())*pow(symf(cc, psd.cols()), 2);
+            }
+         }
+         
+         psdF.psd(psd, 0.1, 0.2);
+         
+         Eigen::Array<double, -1, -1> n1(psd.rows(), psd.cols()), n2(psd.rows(), psd.cols());
+         for(int cc=0; cc< psd.cols(); ++cc)
+         {
+            for(int rr=0; rr<psd.rows(); ++rr)
+            {
+               n1(rr,cc) = normVar;
+               n2(rr,cc) = normVar;
+            }
+         }
+         
+         Eigen::Array<double, -1, -1> r1 = n1, r2 = n2;
+         
+         psdF(n1, n2);
+         psdF(r1);
+         psdF(r2);
+         
+         REQUIRE((n1-r1).abs().maxCoeff() < 1e-10);
+         REQUIRE((n2-r2).abs().maxCoeff() < 1e-10);
+      }
+   }
+   GIVEN("a rank 3 psd")
+   {
+      WHEN("filtering a pair")
+      {
+         mx::sigproc::psdFilter<double, 3> psdF;
+         
+         mx::improc::eigenCube<double> psd(8, 8, 16);
+         for(int pp=0;pp<psd.planes(); ++pp)
+         {
+            for(int cc=0; cc< psd.cols(); ++cc)
+            {
+               for(int rr=0; rr<psd.rows(); ++rr)
+               {
+                  psd.image(pp)(rr,cc) = symf(rr, psd.rows())*symf(cc, psd.cols())*symf(pp, psd.planes());
+               }
+            }
+         }
+         
+         psdF.psd(psd, 1, 1, 1);
+         
+         mx::improc::eigenCube<double> n1(8, 8, 16), n2(8, 8, 16), r1(8, 8, 16), r2(8, 8, 16);
+         for(int pp=0;pp<psd.planes(); ++pp)
+         {
+            for(int cc=0; cc< psd.cols(); ++cc)
+            {
+               for(int rr=0; rr<psd.rows(); ++rr)
+               {
+                  n1.image(pp)(rr,cc) = normVar;
+                  n2.image(pp)(rr,cc) = normVar;
+                  r1.image(pp)(rr,cc) = n1.image(pp)(rr,cc);
+                  r2.image(pp)(rr,cc) = n2.image(pp)(rr,cc);
+               }
+            }
+         }
+         
+         psdF(n1, n2);
+         psdF(r1);
+         psdF(r2);
+         
+         double md = 0;
+         for(int pp=0;pp<psd.planes(); ++pp)
+         {
+            md = std::max(md, (n1.image(pp)-r1.image(pp)).abs().maxCoeff());
+            md = std::max(md, (n2.image(pp)-r2.image(pp)).abs().maxCoeff());
+         }
+         
+         REQUIRE(md < 1e-10);
+      }
+   }
+}
+
+/** Verify filtering unaligned memory
+  * The planes of an odd sized float cube are not aligned as the FFT plans expect, and filtering them through a map must
+  * give the same result as filtering a copy.
+  * 
+  * \anchor tests_sigproc_psdFilter_unaligned
+  */
+SCENARIO( "filtering unaligned memory with psdFilter", "[sigproc::psdFilter]" ) 
+{
+   mx::math::normDistT<float> normVar;
+   
+   //A symmetric PSD value for frequency index k in an array of size N
+   auto symf = [](int k, int N){ int kk = (k <= N/2) ? k : N - k; return 1.0/(1.0 + kk*kk); };
+   
+   GIVEN("a rank 2 psd")
+   {
+      WHEN("filtering the planes of an odd sized float cube")
+      {
+         mx::sigproc::psdFilter<float, 2> psdF;
+         
+         Eigen::Array<float, -1, -1> psd(9, 7);
+         for(int cc=0; cc< psd.cols(); ++cc)
+         {
+            for(int rr=0; rr<psd.rows(); ++rr)
+            {
+               psd(rr,cc) = symf(rr, psd.rows())*symf(cc, psd.cols());
+            }
+         }
+         
+         psdF.psd(psd, 0.1, 0.2);
+         
+         mx::improc::eigenCube<float> nc(9, 7, 4);
+         for(int pp=0;pp<nc.planes(); ++pp)
+         {
+            for(int cc=0; cc< nc.cols(); ++cc)
+            {
+               for(int rr=0; rr<nc.rows(); ++rr)
+               {
+                  nc.image(pp)(rr,cc) = normVar;
+               }
+            }
+         }
+         
+         float md = 0;
+         for(int pp=0;pp<nc.planes(); ++pp)
+         {
+            Eigen::Array<float, -1, -1> r = nc.image(pp);
+            psdF(r);
+            psdF(nc.image(pp));
+            
+            md = std::max(md, (nc.image(pp)-r).abs().maxCoeff());
+         }
+         
+         REQUIRE(md < 1e-5);
+      }
+   }
+}
+
+/** Verify filtering in slabs
+  * Filtering with several threads, which splits the transforms into slabs, must give the same result as filtering with one.
+  * The sizes are odd so that some slabs are not aligned for the FFT plans.  Filtering a pair in low memory mode must give the
+  * same result as the paired transforms.
+  * 
+  * \anchor tests_sigproc_psdFilter_threads
+  */
+SCENARIO( "filtering with psdFilter in slabs", "[sigproc::psdFilter]" ) 
+{
+   mx::math::normDistT<double> normVar;
+   
+   //A symmetric PSD value for frequency index k in an array of size N
+   auto symf = [](int k, int N){ int kk = (k <= N/2) ? k : N - k; return 1.0/(1.0 + kk*kk); };
+   
+   GIVEN("a rank 2 psd")
+   {
+      WHEN("3 threads, odd rows, not square")
+      {
+         mx::sigproc::psdFilter<double, 2> psdF;
+         
+         Eigen::Array<double, -1, -1> psd(33, 20);
+         for(int cc=0; cc< psd.cols(); ++cc)
+         {
+            for(int rr=0; rr<psd.rows(); ++rr)
+            {
+               psd(rr,cc) = symf(rr, psd.rows())*pow(symf(cc, psd.cols()), 2);
+            }
+         }
+         
+         psdF.psd(psd, 0.1, 0.2);
+         
+         Eigen::Array<double, -1, -1> n1(psd.rows(), psd.cols()), n2(psd.rows(), psd.cols());
+         for(int cc=0; cc< psd.cols(); ++cc)
+         {
+            for(int rr=0; rr<psd.rows(); ++rr)
+            {
+               n1(rr,cc) = normVar;
+               n2(rr,cc) = normVar;
+            }
+         }
+         
+         Eigen::Array<double, -1, -1> r1 = n1, r2 = n2;
+         
+         psdF(r1, r2);
+         
+         psdF.threads(3);
+         REQUIRE(psdF.threads() == 3);
+         psdF(n1, n2);
+         
+         REQUIRE((n1-r1).abs().maxCoeff() < 1e-10);
+         REQUIRE((n2-r2).abs().maxCoeff() < 1e-10);
+      }
+      WHEN("float, 3 threads, odd columns")
+      {
+         mx::sigproc::psdFilter<float, 2> psdF;
+         
+         Eigen::Array<float, -1, -1> psd(16, 21);
+         for(int cc=0; cc< psd.cols(); ++cc)
+         {
+            for(int rr=0; rr<psd.rows(); ++rr)
+            {
+               psd(rr,cc) = symf(rr, psd.rows())*pow(symf(cc, psd.cols()), 2);
+            }
+         }
+         
+         psdF.psd(psd, 0.1, 0.2);
+         
+         Eigen::Array<float, -1, -1> n1(psd.rows(), psd.cols());
+         for(int cc=0; cc< psd.cols(); ++cc)
+         {
+            for(int rr=0; rr<psd.rows(); ++rr)
+            {
+               n1(rr,cc) = normVar;
+            }
+         }
+         
+         Eigen::Array<float, -1, -1> r1 = n1;
+         
+         psdF(r1);
+         
+         psdF.threads(3);
+         psdF(n1);
+         
+         REQUIRE((n1-r1).abs().maxCoeff() < 1e-5);
+      }
+   }
+   GIVEN("a rank 3 psd")
+   {
+      WHEN("3 threads, odd planes")
+      {
+         mx::sigproc::psdFilter<double, 3> psdF;
+         
+         mx::improc::eigenCube<double> psd(9, 7, 15);
+         for(int pp=0;pp<psd.planes(); ++pp)
+         {
+            for(int cc=0; cc< psd.cols(); ++cc)
+            {
+               for(int rr=0; rr<psd.rows(); ++rr)
+               {
+                  psd.image(pp)(rr,cc) = symf(rr, psd.rows())*symf(cc, psd.cols())*symf(pp, psd.planes());
+               }
+            }
+         }
+         
+         psdF.psd(psd, 1, 1, 1);
+         
+         mx::improc::eigenCube<double> n1(9, 7, 15), r1(9, 7, 15);
+         for(int pp=0;pp<psd.planes(); ++pp)
+         {
+            for(int cc=0; cc< psd.cols(); ++cc)
+            {
+               for(int rr=0; rr<psd.rows(); ++rr)
+               {
+                  n1.image(pp)(rr,cc) = normVar;
+                  r1.image(pp)(rr,cc) = n1.image(pp)(rr,cc);
+               }
+            }
+         }
+         
+         psdF(r1);
+         
+         psdF.threads(3);
+         psdF(n1);
+         
+         double md = 0;
+         for(int pp=0;pp<psd.planes(); ++pp)
+         {
+            md = std::max(md, (n1.image(pp)-r1.image(pp)).abs().maxCoeff());
+         }
+         
+         REQUIRE(md < 1e-10);
+      }
+      
+      WHEN("float, 3 threads, odd planes")
+      {
+         mx::sigproc::psdFilter<float, 3> psdF;
+         
+         mx::improc::eigenCube<float> psd(8, 6, 13);
+         for(int pp=0;pp<psd.planes(); ++pp)
+         {
+            for(int cc=0; cc< psd.cols(); ++cc)
+            {
+               for(int rr=0; rr<psd.rows(); ++rr)
+               {
+                  psd.image(pp)(rr,cc) = symf(rr, psd.rows())*symf(cc, psd.cols())*symf(pp, psd.planes());
+               }
+            }
+         }
+         
+         psdF.psd(psd, 1, 1, 1);
+         
+         mx::improc::eigenCube<float> n1(8, 6, 13), r1(8, 6, 13);
+         for(int pp=0;pp<psd.planes(); ++pp)
+         {
+            for(int cc=0; cc< psd.cols(); ++cc)
+            {
+               for(int rr=0; rr<psd.rows(); ++rr)
+               {
+                  n1.image(pp)(rr,cc) = normVar;
+                  r1.image(pp)(rr,cc) = n1.image(pp)(rr,cc);
+               }
+            }
+         }
+         
+         psdF(r1);
+         
+         psdF.threads(3);
+         psdF(n1);
+         
+         float md = 0;
+         for(int pp=0;pp<psd.planes(); ++pp)
+         {
+            md = std::max(md, (n1.image(pp)-r1.image(pp)).abs().maxCoeff());
+         }
+         
+         REQUIRE(md < 1e-5);
+      }
+      
+      WHEN("low memory pair")
+      {
+         mx::sigproc::psdFilter<double, 3> psdF;
+         
+         mx::improc::eigenCube<double> psd(8, 8, 16);
+         for(int pp=0;pp<psd.planes(); ++pp)
+         {
+            for(int cc=0; cc< psd.cols(); ++cc)
+            {
+               for(int rr=0; rr<psd.rows(); ++rr)
+               {
+                  psd.image(pp)(rr,cc) = symf(rr, psd.rows())*symf(cc, psd.cols())*symf(pp, psd.planes());
+               }
+            }
+         }
+         
+         psdF.psd(psd, 1, 1, 1);
+         
+         mx::improc::eigenCube<double> n1(8, 8, 16), n2(8, 8, 16), r1(8, 8, 16), r2(8, 8, 16);
+         for(int pp=0;pp<psd.planes(); ++pp)
+         {
+            for(int cc=0; cc< psd.cols(); ++cc)
+            {
+               for(int rr=0; rr<psd.rows(); ++rr)
+               {
+                  n1.image(pp)(rr,cc) = normVar;
+                  n2.image(pp)(rr,cc) = normVar;
+                  r1.image(pp)(rr,cc) = n1.image(pp)(rr,cc);
+                  r2.image(pp)(rr,cc) = n2.image(pp)(rr,cc);
+               }
+            }
+         }
+         
+         psdF(r1, r2);
+         
+         psdF.lowMemory(true);
+         REQUIRE(psdF.lowMemory() == true);
+         psdF(n1, n2);
+         
+         double md = 0;
+         for(int pp=0;pp<psd.planes(); ++pp)
+         {
+            md = std::max(md, (n1.image(pp)-r1.image(pp)).abs().maxCoeff());
+            md = std::max(md, (n2.image(pp)-r2.image(pp)).abs().maxCoeff());
+         }
+         
+         REQUIRE(md < 1e-10);
+      }
+   }
+}
@@ -7,6 +7,7 @@
 #define MX_NO_ERROR_REPORTS
 
 #include "../../../include/sigproc/zernike.hpp"
+#include "../../../include/improc/eigenCube.hpp"
 
 /** Scenario: testing noll_nm
   * 
@@ -295,3 +296,45 @@ SCENARIO( "testing zernikeQNorm", "[sigproc::zernike]" )
       }
    }
 }
+
+/** Scenario: testing zernikeBasis
+  * Verify that the basis matches the individual polynomials from zernike().
+  * \anchor tests_sigproc_zernike_zernikeBasis
+  */
+SCENARIO( "testing zernikeBasis", "[sigproc::zernike]" ) 
+{
+   GIVEN("a cube")
+   {
+      WHEN("the default radius and j starting at 2")
+      {
+         mx::improc::eigenCube<double> cube(33,33,65);
+         REQUIRE(mx::sigproc::zernikeBasis<mx::improc::eigenCube<double>, double>(cube) == 0);
+
+         Eigen::Array<double, -1, -1> im(33,33);
+         for(int p=0; p < cube.planes(); ++p)
+         {
+            mx::sigproc::zernike<Eigen::Array<double, -1, -1>, double>(im, p+2);
+            REQUIRE( (cube.image(p) - im).abs().maxCoeff() < 1e-9 );
+         }
+      }
+
+      WHEN("a rectangular image, a smaller radius, and piston")
+      {
+         mx::improc::eigenCube<float> cube(40,31,28);
+         REQUIRE(mx::sigproc::zernikeBasis<mx::improc::eigenCube<float>, double>(cube, 12.5, 1) == 0);
+
+         Eigen::Array<float, -1, -1> im(40,31);
+         for(int p=0; p < cube.planes(); ++p)
+         {
+            mx::sigproc::zernike<Eigen::Array<float, -1, -1>, double>(im, p+1, 12.5f);
+            REQUIRE( (cube.image(p) - im).abs().maxCoeff() < 1e-4 );
+         }
+      }
+
+      WHEN("minj is invalid")
+      {
+         mx::improc::eigenCube<double> cube(8,8,3);
+         REQUIRE(mx::sigproc::zernikeBasis<mx::improc::eigenCube<double>, double>(cube, -1, 0) == -1);
+      }
+   }
+}